@@ -172,6 +172,69 @@ namespace vkx {
                 return vk::ImageAspectFlagBits::eColor;
         }
     }
+
+    struct FormatBlockInfo {
+        uint32_t size = {};
+        uint32_t width = {};
+        uint32_t height = {};
+    };
+
+    inline FormatBlockInfo getFormatBlockInfo(vk::Format format) {
+        switch (format) {
+            case vk::Format::eR8Unorm:
+            case vk::Format::eR8Snorm:
+            case vk::Format::eR8Uint:
+            case vk::Format::eR8Sint:
+                return {1, 1, 1};
+            case vk::Format::eR8G8Unorm:
+            case vk::Format::eR8G8Snorm:
+            case vk::Format::eR16Sfloat:
+            case vk::Format::eR16Unorm:
+            case vk::Format::eD16Unorm:
+                return {2, 1, 1};
+            case vk::Format::eR8G8B8A8Unorm:
+            case vk::Format::eR8G8B8A8Srgb:
+            case vk::Format::eR8G8B8A8Snorm:
+            case vk::Format::eB8G8R8A8Unorm:
+            case vk::Format::eB8G8R8A8Srgb:
+            case vk::Format::eA2B10G10R10UnormPack32:
+            case vk::Format::eB10G11R11UfloatPack32:
+            case vk::Format::eE5B9G9R9UfloatPack32:
+            case vk::Format::eR16G16Sfloat:
+            case vk::Format::eR16G16Unorm:
+            case vk::Format::eR32Sfloat:
+            case vk::Format::eR32Uint:
+            case vk::Format::eD32Sfloat:
+                return {4, 1, 1};
+            case vk::Format::eR16G16B16A16Sfloat:
+            case vk::Format::eR16G16B16A16Unorm:
+            case vk::Format::eR32G32Sfloat:
+                return {8, 1, 1};
+            case vk::Format::eR32G32B32A32Sfloat:
+                return {16, 1, 1};
+            case vk::Format::eBc1RgbUnormBlock:
+            case vk::Format::eBc1RgbSrgbBlock:
+            case vk::Format::eBc1RgbaUnormBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+            case vk::Format::eBc4UnormBlock:
+            case vk::Format::eBc4SnormBlock:
+                return {8, 4, 4};
+            case vk::Format::eBc2UnormBlock:
+            case vk::Format::eBc2SrgbBlock:
+            case vk::Format::eBc3UnormBlock:
+            case vk::Format::eBc3SrgbBlock:
+            case vk::Format::eBc5UnormBlock:
+            case vk::Format::eBc5SnormBlock:
+            case vk::Format::eBc6HUfloatBlock:
+            case vk::Format::eBc6HSfloatBlock:
+            case vk::Format::eBc7UnormBlock:
+            case vk::Format::eBc7SrgbBlock:
+                return {16, 4, 4};
+            default:
+                assert(false && "Unsupported format");
+                return {};
+        }
+    }
 }
 
 namespace vkx {
@@ -0,0 +1,131 @@
+struct CullInstance {
+    float4 BoundingSphere;
+    uint   IndexCount;
+    uint   FirstIndex;
+    int    VertexOffset;
+    uint   Padding;
+};
+
+struct DrawIndexedIndirectCommand {
+    uint IndexCount;
+    uint InstanceCount;
+    uint FirstIndex;
+    int  VertexOffset;
+    uint FirstInstance;
+};
+
+struct CullConstants {
+    float4 View[3];
+    float  P00;
+    float  P11;
+    float  P22;
+    float  P23;
+    float  ZNear;
+    float  ZFar;
+    uint   InstanceCount;
+    uint   DepthPyramidMipCount;
+    float2 DepthPyramidSize;
+};
+
+[[vk::push_constant]] ConstantBuffer<CullConstants> Constants;
+
+[[vk::binding(0)]] StructuredBuffer<CullInstance>                 Instances;
+[[vk::binding(1)]] RWStructuredBuffer<uint>                       VisibleInstances;
+[[vk::binding(2)]] RWStructuredBuffer<DrawIndexedIndirectCommand> DrawArguments;
+[[vk::binding(3)]] RWStructuredBuffer<uint>                       DrawCount;
+
+#ifdef OCCLUSION_CULLING
+[[vk::binding(4)]] Texture2D<float>                               DepthPyramid;
+#endif
+
+//View space looks down +Z; a sphere is outside when it is entirely behind one of the six planes
+bool IsInsideFrustum(float3 center, float radius) {
+    bool visible = center.z + radius > Constants.ZNear && center.z - radius < Constants.ZFar;
+    visible = visible && (center.z - abs(center.x) * abs(Constants.P00)) * rsqrt(1.0 + Constants.P00 * Constants.P00) > -radius;
+    visible = visible && (center.z - abs(center.y) * abs(Constants.P11)) * rsqrt(1.0 + Constants.P11 * Constants.P11) > -radius;
+    return visible;
+}
+
+#ifdef OCCLUSION_CULLING
+//Screen space bounds of the sphere from its tangent lines through the eye (Mara and McGuire 2013), as min and max uv
+bool ProjectSphere(float3 center, float radius, out float4 bounds) {
+    bounds = 0;
+    if (center.z < radius + Constants.ZNear)
+        return false;
+
+    float tx = sqrt(center.x * center.x + center.z * center.z - radius * radius);
+    float minX = (center.x * tx - center.z * radius) / (center.x * radius + center.z * tx);
+    float maxX = (center.x * tx + center.z * radius) / (center.z * tx - center.x * radius);
+
+    float ty = sqrt(center.y * center.y + center.z * center.z - radius * radius);
+    float minY = (center.y * ty - center.z * radius) / (center.y * radius + center.z * ty);
+    float maxY = (center.y * ty + center.z * radius) / (center.z * ty - center.y * radius);
+
+    bounds = float4(minX * Constants.P00, -maxY * Constants.P11, maxX * Constants.P00, -minY * Constants.P11) * 0.5 + 0.5;
+    return true;
+}
+
+//The mip is chosen so the bounds cover at most 2x2 texels; the sphere is hidden when its nearest point is behind all of them
+bool IsOccluded(float3 center, float radius) {
+    float4 bounds;
+    if (!ProjectSphere(center, radius, bounds))
+        return false;
+
+    bounds = saturate(bounds);
+    float2 size = (bounds.zw - bounds.xy) * Constants.DepthPyramidSize;
+    float level = min(ceil(log2(max(max(size.x, size.y), 1.0))), float(Constants.DepthPyramidMipCount - 1));
+    float2 levelSize = max(floor(Constants.DepthPyramidSize / exp2(level)), 1.0);
+
+    int2 texelMin = int2(min(bounds.xy * levelSize, levelSize - 1.0));
+    int2 texelMax = int2(min(bounds.zw * levelSize, levelSize - 1.0));
+    float depth = max(
+        max(DepthPyramid.Load(int3(texelMin.x, texelMin.y, level)), DepthPyramid.Load(int3(texelMax.x, texelMin.y, level))),
+        max(DepthPyramid.Load(int3(texelMin.x, texelMax.y, level)), DepthPyramid.Load(int3(texelMax.x, texelMax.y, level)))
+    );
+
+    float sphereDepth = Constants.P22 + Constants.P23 / (center.z - radius);
+    return sphereDepth > depth;
+}
+#endif
+
+[numthreads(64, 1, 1)]
+void CSMain(uint3 id : SV_DispatchThreadID) {
+    uint instanceID = id.x;
+    bool visible = instanceID < Constants.InstanceCount;
+
+    CullInstance instance = (CullInstance)0;
+    if (visible) {
+        instance = Instances[instanceID];
+        float4 position = float4(instance.BoundingSphere.xyz, 1.0);
+        float3 center = float3(dot(Constants.View[0], position), dot(Constants.View[1], position), dot(Constants.View[2], position));
+        float radius = instance.BoundingSphere.w;
+
+        visible = IsInsideFrustum(center, radius);
+#ifdef OCCLUSION_CULLING
+        visible = visible && !IsOccluded(center, radius);
+#endif
+    }
+
+    //One atomic per wave instead of one per surviving instance
+    uint visibleCount = WaveActiveCountBits(visible);
+    if (visibleCount == 0)
+        return;
+
+    uint baseSlot = 0;
+    if (WaveIsFirstLane())
+        InterlockedAdd(DrawCount[0], visibleCount, baseSlot);
+    baseSlot = WaveReadLaneFirst(baseSlot);
+
+    if (visible) {
+        uint slot = baseSlot + WavePrefixCountBits(visible);
+        VisibleInstances[slot] = instanceID;
+
+        DrawIndexedIndirectCommand command;
+        command.IndexCount = instance.IndexCount;
+        command.InstanceCount = 1;
+        command.FirstIndex = instance.FirstIndex;
+        command.VertexOffset = instance.VertexOffset;
+        command.FirstInstance = instanceID;
+        DrawArguments[slot] = command;
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <HAL/AsyncComputeScheduler.hpp>
+#include <HAL/CommandAllocatorRing.hpp>
+#include <HAL/Device.hpp>
+#include <HAL/Fence.hpp>
+#include <vulkan/vulkan_decl.h>
+
+#include <unordered_map>
+
+namespace HAL {
+
+    enum class AsyncQueue: uint32_t {
+        Graphics,
+        Compute
+    };
+
+    struct AsyncComputeNode {
+        AsyncQueue                      Queue = {};
+        CommandList const*              pCmdList = {};
+        std::vector<AsyncResourceUsage> Usages = {};
+    };
+
+    struct AsyncResourceState {
+        AsyncQueue      Owner = {};
+        AsyncQueue      DefaultOwner = {};
+        vk::ImageLayout Layout = vk::ImageLayout::eUndefined;
+        uint32_t        WriteQueueMask = {};
+        uint32_t        ReadQueueMask = {};
+        uint64_t        LastFrameIndex = {};
+    };
+
+    struct AsyncComputeFrame {
+        vk::UniqueQueryPool pQueryPool = {};
+        uint64_t            GraphicsValue = {};
+        uint64_t            ComputeValue = {};
+        bool                HasGraphicsTimestamps = {};
+        bool                HasComputeTimestamps = {};
+        bool                IsSubmitted = {};
+    };
+
+    class AsyncComputeScheduler::Internal {
+    public:
+        Internal(Device const& device, AsyncComputeSchedulerCreateInfo const& createInfo);
+
+        Internal(Internal&& rhs) noexcept = default;
+
+        Internal& operator=(Internal&& rhs) noexcept = default;
+
+        auto AddNode(AsyncQueue queue, CommandList const& cmdList, std::span<const AsyncResourceUsage> usages) -> void;
+
+        auto Execute() -> void;
+
+        auto GetGraphicsFence() const -> Fence const& { return *m_pGraphicsFence; }
+
+        auto GetComputeFence() const -> Fence const& { return *m_pComputeFence; }
+
+        auto GetStatistic() const -> AsyncComputeStatistic { return m_Statistic; }
+
+    private:
+        auto GetResourceState(AsyncResourceUsage const& usage) -> AsyncResourceState&;
+
+        auto ResolveFrame(AsyncComputeFrame& frame) -> void;
+
+    private:
+        Device*                                          m_pDevice = {};
+        std::unique_ptr<CommandAllocatorRing>            m_pGraphicsCmdRing = {};
+        std::unique_ptr<CommandAllocatorRing>            m_pComputeCmdRing = {};
+        std::unique_ptr<Fence>                           m_pGraphicsFence = {};
+        std::unique_ptr<Fence>                           m_pComputeFence = {};
+        std::vector<AsyncComputeNode>                    m_Nodes = {};
+        std::unordered_map<uint64_t, AsyncResourceState> m_Resources = {};
+        std::vector<AsyncComputeFrame>                   m_Frames = {};
+        std::array<uint64_t, 2>                          m_WaitedValues = {};
+        uint64_t                                         m_FrameIndex = {};
+        AsyncComputeStatistic                            m_Statistic = {};
+        float                                            m_TimestampPeriod = {};
+        bool                                             m_IsTimestampSupported = {};
+    };
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <HAL/Device.hpp>
+#include <vulkan/vulkan_decl.h>
+
+#include <map>
+#include <mutex>
+
+namespace HAL {
+
+    struct BufferBlock;
+
+    struct BufferSuballocation {
+        vk::Buffer   Buffer = {};
+        uint64_t     Offset = {};
+        uint64_t     Size = {};
+        uint8_t*     pMappedData = {};
+        BufferBlock* pBlock = {};
+    };
+
+    //Packs small buffers into large shared vk::Buffer blocks addressed by (buffer, offset, size)
+    class BufferAllocator {
+    public:
+        static constexpr uint64_t BlockSize = 32 << 20;
+        static constexpr uint64_t MaxSuballocationSize = BlockSize / 64;
+
+        static constexpr vk::BufferUsageFlags BlockUsage =
+            vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst |
+            vk::BufferUsageFlagBits::eUniformTexelBuffer | vk::BufferUsageFlagBits::eStorageTexelBuffer |
+            vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer |
+            vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndirectBuffer;
+
+    public:
+        BufferAllocator(Device const& device);
+
+        ~BufferAllocator();
+
+        auto IsSuballocatable(vk::BufferUsageFlags usage, vma::MemoryUsage memoryUsage, uint64_t size) const -> bool;
+
+        auto Allocate(vk::BufferUsageFlags usage, vma::MemoryUsage memoryUsage, uint64_t size) -> std::optional<BufferSuballocation>;
+
+        auto Free(BufferSuballocation const& suballocation) -> void;
+
+    private:
+        auto CreateBlock(vma::MemoryUsage memoryUsage) -> BufferBlock*;
+
+        auto AllocateFromBlock(BufferBlock& block, uint64_t size) -> std::optional<uint64_t>;
+
+    private:
+        Device*                                   m_pDevice = {};
+        uint64_t                                  m_Alignment = {};
+        std::mutex                                m_Mutex = {};
+        std::vector<std::unique_ptr<BufferBlock>> m_Blocks = {};
+    };
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <HAL/Buffer.hpp>
+#include <HAL/Device.hpp>
+#include <vulkan/vulkan_decl.h>
+
+#include "BufferAllocator.hpp"
+
+namespace HAL {
+
+    //Heap-stable so that a relocated buffer can recreate the views created on it
+    struct BufferViewRecord {
+        vk::BufferViewCreateInfo BufferViewCI = {};
+        vk::UniqueBufferView     pBufferView = {};
+    };
+
+    //Heap-stable so that relocation callbacks and views keep pointing at the current vk::Buffer after moves
+    struct BufferRecord {
+        vk::UniqueBuffer                                           pBuffer = {};
+        vma::UniqueAllocation                                      pAllocation = {};
+        std::optional<BufferSuballocation>                         Suballocation = {};
+        vk::Buffer                                                 Buffer = {};
+        uint64_t                                                   Offset = {};
+        uint64_t                                                   Size = {};
+        uint8_t*                                                   pMappedData = {};
+        bool                                                       IsRelocatable = {};
+        ResourceState                                              State = ResourceState::Undefined;
+        uint32_t                                                   QueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        std::vector<BufferViewRecord*>                             Views = {};
+        std::vector<std::pair<uint32_t, BufferRelocationCallback>> RelocationCallbacks = {};
+        uint32_t                                                   RelocationCallbackID = {};
+    };
+
+    class Buffer::Internal {
+    public:
+        Internal(Device const& device, BufferCreateInfo const& createInfo);
+
+        Internal(Internal&& rhs) noexcept = default;
+
+        Internal& operator=(Internal&& rhs) noexcept;
+
+        ~Internal();
+
+        auto GetCreateInfo() const -> BufferCreateInfo const& { return m_CreateInfo; }
+
+        auto GetVkBuffer() const -> vk::Buffer { return m_pRecord->Buffer; }
+
+        auto GetOffset() const -> uint64_t { return m_pRecord->Offset; }
+
+        auto GetSize() const -> uint64_t { return m_CreateInfo.Size; }
+
+        auto GetMappedData() const -> void* { return m_pRecord->pMappedData; }
+
+        auto IsSuballocated() const -> bool { return m_pRecord->Suballocation.has_value(); }
+
+        auto GetRecord() const -> BufferRecord const* { return m_pRecord.get(); }
+
+        auto AddRelocationCallback(BufferRelocationCallback&& callback) -> uint32_t;
+
+        auto RemoveRelocationCallback(uint32_t id) -> void;
+
+    private:
+        auto Release() -> void;
+
+    private:
+        Device*                       m_pDevice = {};
+        BufferCreateInfo              m_CreateInfo = {};
+        std::unique_ptr<BufferRecord> m_pRecord = {};
+    };
+
+    class BufferView::Internal {
+    public:
+        Internal(Device const& device, Buffer const& buffer, BufferViewCreateInfo const& createInfo);
+
+        Internal(Internal&& rhs) noexcept = default;
+
+        Internal& operator=(Internal&& rhs) noexcept;
+
+        ~Internal();
+
+        auto GetVkBuffer() const -> vk::Buffer { return m_pRecord->Buffer; }
+
+        auto GetVkBufferView() const -> vk::BufferView { return m_pViewRecord ? *m_pViewRecord->pBufferView : vk::BufferView{}; }
+
+        auto GetOffset() const -> uint64_t { return m_pRecord->Offset + m_Offset; }
+
+        auto GetRange() const -> uint64_t { return m_Range; }
+
+    private:
+        auto Release() -> void;
+
+    private:
+        BufferRecord*                     m_pRecord = {};
+        uint64_t                          m_Offset = {};
+        uint64_t                          m_Range = {};
+        std::unique_ptr<BufferViewRecord> m_pViewRecord = {};
+    };
+}
@@ -7,7 +7,9 @@ namespace HAL {
 
     class CommandAllocator::Internal {
     public:
-        Internal(Device const& device, uint32_t queueFamilyIndex);
+        Internal(Device const& device, uint32_t queueFamilyIndex, CommandAllocatorResetMode resetMode);
+
+        auto Reset() -> void;
 
         auto GetCommandPool() const -> vk::CommandPool;
 
@@ -15,8 +17,11 @@ namespace HAL {
 
         auto GetDevice() const -> Device*;
 
+        auto GetQueueFamilyIndex() const -> uint32_t;
+
     private:      
         Device*               m_pDevice;
         vk::UniqueCommandPool m_pCommandPool = {};
+        uint32_t              m_QueueFamilyIndex = {};
     };
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <HAL/CommandAllocatorRing.hpp>
+#include <HAL/CommandAllocator.hpp>
+#include <HAL/Device.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    template<typename T>
+    struct CommandListFreeList {
+        std::vector<std::unique_ptr<T>> Used = {};
+        std::vector<std::unique_ptr<T>> Free = {};
+    };
+
+    struct CommandRingFrame {
+        vk::Semaphore                                  Semaphore = {};
+        uint64_t                                       FenceValue = {};
+        std::unique_ptr<TransferCommandAllocator>      pTransferAllocator = {};
+        std::unique_ptr<ComputeCommandAllocator>       pComputeAllocator = {};
+        std::unique_ptr<GraphicsCommandAllocator>      pGraphicsAllocator = {};
+        CommandListFreeList<TransferCommandList>       TransferCmdLists = {};
+        CommandListFreeList<ComputeCommandList>        ComputeCmdLists = {};
+        CommandListFreeList<GraphicsCommandList>       GraphicsCmdLists = {};
+        CommandListFreeList<GraphicsCommandList>       GraphicsSecondaryCmdLists = {};
+    };
+
+    class CommandAllocatorRing::Internal {
+    public:
+        Internal(Device const& device, CommandAllocatorRingCreateInfo const& createInfo);
+
+        Internal(Internal&& rhs) noexcept = default;
+
+        Internal& operator=(Internal&& rhs) noexcept;
+
+        ~Internal();
+
+        auto AllocateTransferCommandList() -> TransferCommandList&;
+
+        auto AllocateComputeCommandList() -> ComputeCommandList&;
+
+        auto AllocateGraphicsCommandList(CommandListLevel level) -> GraphicsCommandList&;
+
+        auto NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void;
+
+    private:
+        auto WaitFrame(CommandRingFrame& frame) -> void;
+
+        auto Release() -> void;
+
+    private:
+        Device*                       m_pDevice = {};
+        std::vector<CommandRingFrame> m_Frames = {};
+        uint32_t                      m_FrameIndex = {};
+    };
+}
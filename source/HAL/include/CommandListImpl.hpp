@@ -2,8 +2,12 @@
 
 #include <HAL/CommandList.hpp>
 #include <HAL/Pipeline.hpp>
+#include "PipelineImpl.hpp"
 #include <vulkan/vulkan_decl.h>
 
+#include <mutex>
+#include <unordered_map>
+
 namespace HAL {
 
     struct FrameState {
@@ -11,9 +15,115 @@ namespace HAL {
         uint32_t    CurrentSubpass = {};
     };
 
+    constexpr uint32_t MaxDescriptorSetCount = 8;
+
+    constexpr uint32_t MaxVertexBufferCount = 8;
+
+    enum class CommandListBindPoint: uint32_t {
+        Graphics,
+        Compute
+    };
+
+    //Null handles and empty ranges stand for state the command buffer does not hold yet
+    struct CommandListBindState {
+        vk::Pipeline                                         Pipeline = {};
+        vk::PipelineLayout                                   Layout = {};
+        std::array<vk::DescriptorSet, MaxDescriptorSetCount> DescriptorSets = {};
+        std::array<std::byte, MaxPushConstantSize>           PushConstants = {};
+        uint32_t                                             PushConstantKnownBegin = {};
+        uint32_t                                             PushConstantKnownEnd = {};
+        uint32_t                                             PushConstantDirtyBegin = {};
+        uint32_t                                             PushConstantDirtyEnd = {};
+        uint32_t                                             DirtyDescriptorSetMask = {};
+        bool                                                 IsPipelineDirty = {};
+    };
+
+    struct CommandListGraphicsState {
+        vk::Viewport                                     Viewport = {};
+        vk::Rect2D                                       Scissor = {};
+        std::array<vk::Buffer, MaxVertexBufferCount>     VertexBuffers = {};
+        std::array<vk::DeviceSize, MaxVertexBufferCount> VertexBufferOffsets = {};
+        vk::Buffer                                       IndexBuffer = {};
+        vk::DeviceSize                                   IndexBufferOffset = {};
+        vk::IndexType                                    IndexType = vk::IndexType::eUint16;
+        uint32_t                                         DirtyVertexBufferMask = {};
+        bool                                             HasViewport = {};
+        bool                                             HasScissor = {};
+        bool                                             IsViewportDirty = {};
+        bool                                             IsScissorDirty = {};
+        bool                                             IsIndexBufferDirty = {};
+    };
+
+    struct ResourceStateInfo {
+        vk::PipelineStageFlags Stages = {};
+        vk::AccessFlags        Access = {};
+        vk::ImageLayout        Layout = vk::ImageLayout::eUndefined;
+        bool                   IsWrite = {};
+    };
+
+    struct ResourceBarrierBatch {
+        vk::PipelineStageFlags               SrcStages = {};
+        vk::PipelineStageFlags               DstStages = {};
+        std::vector<vk::BufferMemoryBarrier> BufferBarriers = {};
+        std::vector<vk::ImageMemoryBarrier>  ImageBarriers = {};
+
+        auto IsEmpty() const -> bool { return BufferBarriers.empty() && ImageBarriers.empty(); }
+    };
+
+    //pGlobalState points at the state the resource is left in by submitted work and pGlobalQueueFamilyIndex at the
+    //family that submitted it, VK_QUEUE_FAMILY_IGNORED before any. Both are only touched at submit time, under GetResourceStateMutex
+    struct TrackedResource {
+        ResourceState*       pGlobalState = {};
+        uint32_t*            pGlobalQueueFamilyIndex = {};
+        vk::Buffer           Buffer = {};
+        uint64_t             Offset = {};
+        uint64_t             Size = {};
+        vk::Image            Image = {};
+        vk::ImageAspectFlags Aspect = {};
+        ResourceState        FirstState = ResourceState::Undefined;
+        ResourceState        CurrentState = ResourceState::Undefined;
+        int32_t              PendingBarrierIndex = -1;
+        int32_t              SplitEventIndex = -1;
+        ResourceBarrierBatch SplitBarriers = {};
+    };
+
+    auto GetResourceStateInfo(ResourceState state) -> ResourceStateInfo;
+
+    auto GetSupportedStages(vk::QueueFlags queueFlags) -> vk::PipelineStageFlags;
+
+    auto GetImageAspect(vk::Format format) -> vk::ImageAspectFlags;
+
+    auto AppendTransition(ResourceBarrierBatch& batch, TrackedResource const& resource, ResourceState stateBefore, ResourceState stateAfter, vk::PipelineStageFlags supportedStages) -> int32_t;
+
+    //Queues submit from any thread, so every read and write of the global states holds this lock
+    auto GetResourceStateMutex() -> std::mutex&;
+
+    auto GetTrackedBuffer(Buffer const& buffer) -> TrackedResource;
+
+    auto GetTrackedTexture(Texture const& texture) -> TrackedResource;
+
+    //Legacy stage and access bits keep their values in the 64-bit synchronization2 masks
+    inline auto ToPipelineStageFlags2(vk::PipelineStageFlags stages) -> vk::PipelineStageFlags2KHR {
+        return vk::PipelineStageFlags2KHR(static_cast<VkPipelineStageFlags2KHR>(static_cast<VkPipelineStageFlags>(stages)));
+    }
+
+    inline auto ToAccessFlags2(vk::AccessFlags access) -> vk::AccessFlags2KHR {
+        return vk::AccessFlags2KHR(static_cast<VkAccessFlags2KHR>(static_cast<VkAccessFlags>(access)));
+    }
+
+    //Stages only synchronization2 knows widen to all commands on the legacy path
+    inline auto ToPipelineStageFlags(vk::PipelineStageFlags2KHR stages) -> vk::PipelineStageFlags {
+        auto mask = static_cast<VkPipelineStageFlags2KHR>(stages);
+        if (mask == 0)
+            return vk::PipelineStageFlagBits::eTopOfPipe;
+        if (mask >> 32)
+            return vk::PipelineStageFlagBits::eAllCommands;
+        return vk::PipelineStageFlags(static_cast<VkPipelineStageFlags>(mask));
+    }
+
     class CommandList::Internal {
     public:
-        Internal(CommandAllocator const& allocator);
+        Internal(CommandAllocator const& allocator, CommandListLevel level);
 
         auto Begin() -> void;
 
@@ -21,20 +131,97 @@ namespace HAL {
 
         auto BeginRenderPass(RenderPassBeginInfo const& beginInfo) -> void;
 
+        auto NextSubpass(vk::SubpassContents contents) -> void;
+
         auto EndRenderPass() -> void;
+
+        auto BeginSecondary(Internal const& primary) -> void;
+
+        auto ExecuteCommands(std::span<const Internal* const> cmdLists) -> void;
+
+        auto TransitionResource(TrackedResource const& resource, ResourceState state) -> void;
+
+        auto FlushBarriers() -> void;
+
+        //Like TransitionResource, but inside a render pass only checks the state instead of recording a barrier
+        auto UseResource(TrackedResource const& resource, ResourceState state) -> void;
+
+        auto BeginTransitionResource(TrackedResource const& resource, ResourceState state) -> void;
+
+        auto EndTransitionResource(ResourceState const* pGlobalState) -> void;
+
+        //Returns the barriers that bring every resource from its global state to the state this list expects first,
+        //and advances the global states to the ones this list leaves behind. Every resource has to be last used on
+        //the same queue family or not at all. The caller holds GetResourceStateMutex until the submission is enqueued,
+        //so submissions reach the queue in the order their states were resolved
+        auto ResolveInitialStates(uint32_t queueFamilyIndex) -> ResourceBarrierBatch;
     
         auto SetComputePipeline(ComputePipeline const& pipeline, ComputeState const& state) -> void;
 
         auto SetGraphicsPipeline(GraphicsPipeline const& pipeline, GraphicsState const& state) -> void;
         
+        auto SetDescriptorSet(CommandListBindPoint bindPoint, uint32_t slot, vk::DescriptorSet descriptorSet) -> void;
+
+        auto SetPushConstants(CommandListBindPoint bindPoint, uint32_t offset, std::span<const std::byte> data) -> void;
+
+        auto SetViewport(vk::Viewport const& viewport) -> void;
+
+        auto SetScissor(vk::Rect2D const& scissor) -> void;
+
+        auto SetVertexBuffer(uint32_t slot, vk::Buffer buffer, vk::DeviceSize offset) -> void;
+
+        auto SetIndexBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::IndexType indexType) -> void;
+        
         auto Dispath(uint32_t x, uint32_t y, uint32_t z) -> void;
 
+        auto Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) -> void;
+
+        auto DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) -> void;
+
+        auto DispatchIndirect(vk::Buffer buffer, vk::DeviceSize offset) -> void;
+
+        auto DrawIndirect(vk::Buffer buffer, vk::DeviceSize offset, uint32_t drawCount, uint32_t stride) -> void;
+
+        auto DrawIndexedIndirect(vk::Buffer buffer, vk::DeviceSize offset, uint32_t drawCount, uint32_t stride) -> void;
+
+        auto DrawIndexedIndirectCount(vk::Buffer buffer, vk::DeviceSize offset, vk::Buffer countBuffer, vk::DeviceSize countOffset, uint32_t maxDrawCount, uint32_t stride) -> void;
+
+        auto InvalidateState() -> void;
+
+        auto GetStatistic() const -> CommandListStatistic { return m_Statistic; }
+
         auto GetVkCommandBuffer() const -> vk::CommandBuffer { return *m_pCommandBuffer; }
 
+    private:
+        auto AppendBarrier(TrackedResource& resource, ResourceState state) -> void;
+
+        auto AcquireEvent() -> int32_t;
+
+        auto ResetEvents() -> void;
+
+        auto SetPipeline(CommandListBindPoint bindPoint, vk::Pipeline pipeline, vk::PipelineLayout layout) -> void;
+
+        auto FlushBindState(CommandListBindPoint bindPoint) -> void;
+
+        auto FlushGraphicsState() -> void;
+
     private:
         Device*                 m_pDevice;
         vk::UniqueCommandBuffer m_pCommandBuffer;
         vk::RenderPass          m_CurrentRenderPass;
+        vk::Framebuffer         m_CurrentFramebuffer;
         uint32_t                m_CurrentSubpass;
+
+        std::array<CommandListBindState, 2>                       m_BindStates = {};
+        CommandListGraphicsState                                  m_GraphicsState = {};
+        CommandListStatistic                                      m_Statistic = {};
+
+        vk::PipelineStageFlags                                    m_SupportedStages = {};
+        std::unordered_map<ResourceState const*, TrackedResource> m_TrackedResources = {};
+        ResourceBarrierBatch                                      m_PendingBarriers = {};
+
+        std::vector<vk::UniqueEvent>                              m_Events = {};
+        uint32_t                                                  m_EventCount = {};
+        bool                                                      m_IsSynchronization2Enabled = {};
     };
 }
\ No newline at end of file
@@ -4,21 +4,69 @@
 #include <HAL/SwapChain.hpp>
 #include <HAL/Fence.hpp>
 #include <vulkan/vulkan_decl.h>
+#include "CommandListImpl.hpp"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <thread>
 
 namespace HAL {
 
+    struct SubmissionState;
+
+    using SubmissionJob = std::function<void(SubmissionState& state)>;
+
+    struct SubmissionNode {
+        SubmissionJob   Job = {};
+        SubmissionNode* pNext = {};
+    };
+
+    struct FixupCommandBuffer {
+        vk::UniqueCommandBuffer pCmdBuffer = {};
+        uint64_t                ProgressValue = {};
+    };
+
+    //Heap-stable so that the submit thread keeps a valid pointer while the owning queue moves
+    struct SubmissionState {
+        vk::Queue                      Queue = {};
+        uint32_t                       QueueFamilyIndex = {};
+        bool                           IsSynchronization2Enabled = {};
+        vk::UniqueSemaphore            pProgressSemaphore = {};
+        vk::UniqueCommandPool          pFixupPool = {};
+        std::deque<FixupCommandBuffer> FixupCmdBuffers = {};
+        std::atomic<uint64_t>          SubmittedValue = {};
+        std::atomic<uint64_t>          PendingJobCount = {};
+        std::atomic<SubmissionNode*>   pHead = {};
+        std::atomic<uint64_t>          PushCount = {};
+        std::atomic<bool>              IsStopping = {};
+        std::thread                    Thread = {};
+    };
+
+    //Every vkQueueSubmit and vkQueuePresentKHR runs on one thread per queue, fed by a lock-free MPSC list,
+    //so producers never block in the driver and the order of each producer's work is preserved
     class CommandQueue::Internal {
     public:
-        Internal(vk::Queue queue);
+        Internal(vk::Device device, vk::Queue queue, uint32_t queueFamilyIndex, bool isSynchronization2Enabled);
+
+        Internal(Internal&& rhs) noexcept = default;
+
+        Internal& operator=(Internal&& rhs) noexcept;
+
+        ~Internal();
 
         auto Signal(Fence const& fence, std::optional<uint64_t> value = std::nullopt) const -> void;
 
-        auto Wait(Fence const& fence, std::optional<uint64_t> value = std::nullopt) const -> void;
+        auto Wait(Fence const& fence, std::optional<uint64_t> value = std::nullopt, vk::PipelineStageFlags2KHR stages = vk::PipelineStageFlagBits2KHR::eAllCommands) const -> void;
 
         auto NextImage(SwapChain const& swapChain, Fence const& fence, std::optional<uint64_t> signalValue = std::nullopt) const -> uint32_t;
+
+        auto AcquireNextImage(SwapChain const& swapChain) const -> uint32_t;
  
         auto Present(SwapChain const& swapChain, uint32_t frameID, Fence const& fence, std::optional<uint64_t> waitValue = std::nullopt) const -> void;
 
+        auto Submit(SubmitBatch const& batch) const -> void;
+
         auto WaitIdle() const -> void;
 
         template<typename T>
@@ -29,8 +77,25 @@ namespace HAL {
       
         auto GetVkQueue() const -> vk::Queue;
 
+        auto GetOutstandingWork() const -> uint64_t;
+
+        auto Enqueue(SubmissionJob&& job) const -> void;
+
     private:
-        vk::Queue m_Queue = {};
+        auto Release() -> void;
+
+        //Only the submit thread records into the fix-up pool, so it needs no lock
+        static auto InsertFixups(SubmissionState& state, std::span<const vk::CommandBuffer> cmdBuffers, std::span<const ResourceBarrierBatch> fixups) -> std::vector<vk::CommandBuffer>;
+
+        //A submission without command buffers; a null semaphore leaves out the wait or the signal
+        static auto SubmitSemaphores(SubmissionState& state, vk::Semaphore waitSemaphore, uint64_t waitValue, vk::PipelineStageFlags2KHR waitStages, vk::Semaphore signalSemaphore, uint64_t signalValue) -> void;
+
+        static auto PresentImage(vk::Queue queue, vk::SwapchainKHR swapChain, vk::Semaphore semaphore, uint32_t frameID) -> void;
+
+        static auto SubmitLoop(SubmissionState* pState) -> void;
+
+    private:
+        std::unique_ptr<SubmissionState> m_pState = {};
     };
 }
 
@@ -40,18 +105,37 @@ namespace HAL {
     inline auto CommandQueue::Internal::ExecuteCommandList(ArraySpan<T> cmdLists) const -> void {
         static_assert(std::is_base_of<CommandList, T>::value);
 
-        std::vector<vk::CommandBuffer> commandBuffers(cmdLists.size());
-        std::transform(std::begin(cmdLists), std::end(cmdLists), std::begin(commandBuffers), [] (auto const& e) {
-            return e.get().GetVkCommandBuffer();
-        });
+        //First-use states are resolved in submission order on the calling thread, the barriers are recorded on the submit thread.
+        //The lock spans the enqueue, so another thread cannot resolve against these states and reach the queue first
+        std::vector<vk::CommandBuffer> commandBuffers;
+        std::vector<ResourceBarrierBatch> fixups;
+        for (auto const& cmdList : cmdLists)
+            commandBuffers.push_back(cmdList.get().GetVkCommandBuffer());
+
+        std::lock_guard<std::mutex> lock(GetResourceStateMutex());
+        for (auto const& cmdList : cmdLists)
+            fixups.push_back(const_cast<CommandList::Internal*>(reinterpret_cast<const CommandList::Internal*>(&cmdList.get()))->ResolveInitialStates(m_pState->QueueFamilyIndex));
 
-        vk::SubmitInfo submitInfo = {
-           .commandBufferCount = static_cast<uint32_t>(std::size(commandBuffers)),
-           .pCommandBuffers = std::data(commandBuffers),
-        };
-        m_Queue.submit(submitInfo, {});
+        this->Enqueue([commandBuffers = std::move(commandBuffers), fixups = std::move(fixups)](SubmissionState& state) -> void {
+            vk::Semaphore progressSemaphore = *state.pProgressSemaphore;
+            uint64_t progressValue = ++state.SubmittedValue;
+            auto cmdBuffers = Internal::InsertFixups(state, commandBuffers, fixups);
+
+            vk::TimelineSemaphoreSubmitInfo timelineInfo = {
+                .signalSemaphoreValueCount = 1,
+                .pSignalSemaphoreValues = &progressValue
+            };
+            vk::SubmitInfo submitInfo = {
+               .pNext = &timelineInfo,
+               .commandBufferCount = static_cast<uint32_t>(std::size(cmdBuffers)),
+               .pCommandBuffers = std::data(cmdBuffers),
+               .signalSemaphoreCount = 1,
+               .pSignalSemaphores = &progressSemaphore
+            };
+            state.Queue.submit(submitInfo, {});
+        });
     }
-    
+
     template<typename T>
     inline auto CommandQueue::Internal::ExecuteCommandList(ArrayView<T> cmdLists) const -> void {
         static_assert(std::is_base_of<CommandList, T>::value);       
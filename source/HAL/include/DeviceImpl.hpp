@@ -5,8 +5,10 @@
 #include <HAL/Adapter.hpp>
 #include <HAL/CommandQueue.hpp>
 
+#include "BufferAllocator.hpp"
 #include "MemoryAllocator.hpp"
 #include "PipelineCache.hpp"
+#include "ReleaseQueue.hpp"
 
 #include <vulkan/vulkan_decl.h>
 
@@ -15,8 +17,14 @@ namespace HAL {
     class Device::Internal {
     public:           
         Internal(Instance const& instance, Adapter const& adapter, DeviceCreateInfo const& createInfo);
+
+        ~Internal();
         
-        auto WaitIdle() const -> void { m_pDevice->waitIdle(); }
+        auto WaitIdle() const -> void;
+
+        auto NextFrame() -> void;
+
+        auto ReleaseDeferred(std::function<void()>&& release, Fence const& fence, std::optional<uint64_t> value) -> void;
 
         auto GetGraphicsQueueFamilyIndex() const -> uint32_t { return m_QueueFamilyGraphics->queueIndex; }
         
@@ -24,11 +32,23 @@ namespace HAL {
 
         auto GetTransferQueueFamilyIndex() const -> uint32_t { return m_QueueFamilyTransfer->queueIndex; }
 
-        auto GetGraphicsCommandQueue() -> HAL::GraphicsCommandQueue& { return *reinterpret_cast<HAL::GraphicsCommandQueue*>(&m_QueuesGraphics[0]); }
+        auto GetGraphicsCommandQueue(uint32_t index = 0) -> HAL::GraphicsCommandQueue& { return *reinterpret_cast<HAL::GraphicsCommandQueue*>(&m_QueuesGraphics.at(index)); }
 
-        auto GetComputeCommandQueue()  -> HAL::ComputeCommandQueue& { return *reinterpret_cast<HAL::ComputeCommandQueue*>(&m_QueuesCompute[0]); }
+        auto GetComputeCommandQueue(uint32_t index = 0)  -> HAL::ComputeCommandQueue& { return *reinterpret_cast<HAL::ComputeCommandQueue*>(&m_QueuesCompute.at(index)); }
         
-        auto GetTransferCommandQueue() -> HAL::TransferCommandQueue& { return *reinterpret_cast<HAL::TransferCommandQueue*>(&m_QueuesTransfer[0]); }  
+        auto GetTransferCommandQueue(uint32_t index = 0) -> HAL::TransferCommandQueue& { return *reinterpret_cast<HAL::TransferCommandQueue*>(&m_QueuesTransfer.at(index)); }  
+
+        auto GetGraphicsCommandQueueCount() const -> uint32_t { return static_cast<uint32_t>(std::size(m_QueuesGraphics)); }
+
+        auto GetComputeCommandQueueCount() const -> uint32_t { return static_cast<uint32_t>(std::size(m_QueuesCompute)); }
+
+        auto GetTransferCommandQueueCount() const -> uint32_t { return static_cast<uint32_t>(std::size(m_QueuesTransfer)); }
+
+        auto AcquireGraphicsCommandQueue() -> HAL::GraphicsCommandQueue& { return *reinterpret_cast<HAL::GraphicsCommandQueue*>(&SelectLeastLoaded(m_QueuesGraphics)); }
+
+        auto AcquireComputeCommandQueue() -> HAL::ComputeCommandQueue& { return *reinterpret_cast<HAL::ComputeCommandQueue*>(&SelectLeastLoaded(m_QueuesCompute)); }
+
+        auto AcquireTransferCommandQueue() -> HAL::TransferCommandQueue& { return *reinterpret_cast<HAL::TransferCommandQueue*>(&SelectLeastLoaded(m_QueuesTransfer)); }
 
         auto GetVkDevice() const -> vk::Device { return *m_pDevice; } 
 
@@ -40,19 +60,41 @@ namespace HAL {
 
         auto GetPipelineCache() const -> PipelineCache const&;
 
+        auto GetReleaseQueue() const -> ReleaseQueue& { return *m_pReleaseQueue; }
+
+        auto GetMemoryAllocator() const -> MemoryAllocator& { return *m_pAllocator; }
+
+        auto GetBufferAllocator() const -> BufferAllocator& { return *m_pBufferAllocator; }
+
+        auto IsSynchronization2Enabled() const -> bool { return m_IsSynchronization2Enabled; }
+
+        auto IsDrawIndirectCountEnabled() const -> bool { return m_IsDrawIndirectCountEnabled; }
+
+        auto IsMultiDrawIndirectEnabled() const -> bool { return m_IsMultiDrawIndirectEnabled; }
+
+    private:
+        static auto SelectLeastLoaded(std::vector<HAL::CommandQueue>& queues) -> HAL::CommandQueue&;
+
     private:   
         vk::UniqueDevice        m_pDevice = {};  
         vk::PhysicalDevice      m_PhysicalDevice = {};
 
-        std::vector<HAL::CommandQueue> m_QueuesGraphics = {};
-        std::vector<HAL::CommandQueue> m_QueuesCompute = {};
-        std::vector<HAL::CommandQueue> m_QueuesTransfer = {};
-
         std::optional<vkx::QueueFamilyInfo> m_QueueFamilyGraphics = {}; 
         std::optional<vkx::QueueFamilyInfo> m_QueueFamilyCompute = {};  
         std::optional<vkx::QueueFamilyInfo> m_QueueFamilyTransfer = {}; 
 
         std::unique_ptr<MemoryAllocator> m_pAllocator;
         std::unique_ptr<PipelineCache>   m_pPipelineCache;
+        std::unique_ptr<BufferAllocator> m_pBufferAllocator;
+        std::unique_ptr<ReleaseQueue>    m_pReleaseQueue;
+
+        //Declared after the release queue so the queues are destroyed first, and the release queue after them
+        std::vector<HAL::CommandQueue> m_QueuesGraphics = {};
+        std::vector<HAL::CommandQueue> m_QueuesCompute = {};
+        std::vector<HAL::CommandQueue> m_QueuesTransfer = {};
+
+        bool                             m_IsSynchronization2Enabled = {};
+        bool                             m_IsDrawIndirectCountEnabled = {};
+        bool                             m_IsMultiDrawIndirectEnabled = {};
     };
 }  
\ No newline at end of file
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <HAL/FrameGraph.hpp>
+#include <HAL/CommandAllocator.hpp>
+#include <HAL/CommandList.hpp>
+#include <HAL/Device.hpp>
+#include <HAL/Fence.hpp>
+#include <HAL/TransientResourcePlanner.hpp>
+#include <vulkan/vulkan_decl.h>
+#include "CommandListImpl.hpp"
+
+#include <unordered_map>
+
+namespace HAL {
+
+    //Orders are positions among the passes that survive culling; the Last* fields follow the walk that derives the barriers
+    struct FrameGraphResourceNode {
+        TrackedResource      Resource = {};
+        vk::ImageCreateInfo  ImageCI = {};
+        vk::BufferCreateInfo BufferCI = {};
+        ResourceState        InitialState = ResourceState::Undefined;
+        ResourceState        LastState = ResourceState::Undefined;
+        int32_t              LastPass = -1;
+        FrameGraphQueue      LastQueue = {};
+        uint32_t             FirstOrder = {};
+        uint32_t             LastOrder = {};
+        uint32_t             TransientID = {};
+        bool                 IsTransient = {};
+        bool                 IsOutput = {};
+        bool                 IsNeeded = {};
+        bool                 IsReferenced = {};
+        bool                 IsUsedAsync = {};
+        bool                 IsWritten = {};
+    };
+
+    //WaitPasses holds, per queue, the latest pass of that queue this one has to wait for, or -1
+    struct FrameGraphPassNode {
+        std::string            Name = {};
+        FrameGraphPassExecutor Executor = {};
+        uint32_t               FirstUsage = {};
+        uint32_t               UsageCount = {};
+        uint32_t               Order = {};
+        FrameGraphQueue        Queue = {};
+        bool                   HasSideEffects = {};
+        bool                   IsCulled = {};
+        bool                   IsSignaled = {};
+        bool                   IsPrologueWaited = {};
+        std::array<int32_t, 2> WaitPasses = {-1, -1};
+        uint64_t               SignalValue = {};
+        ResourceBarrierBatch   PreBarriers = {};
+        ResourceBarrierBatch   PostBarriers = {};
+    };
+
+    //Command pools are externally synchronized, so every pass records from its own allocator
+    struct FrameGraphRecorder {
+        std::unique_ptr<GraphicsCommandAllocator> pGraphicsAllocator = {};
+        std::unique_ptr<GraphicsCommandList>      pGraphicsCmdList = {};
+        std::unique_ptr<ComputeCommandAllocator>  pComputeAllocator = {};
+        std::unique_ptr<ComputeCommandList>       pComputeCmdList = {};
+    };
+
+    struct FrameGraphFrame {
+        std::unique_ptr<TransientResourcePlanner> pPlanner = {};
+        uint64_t                                  PlannerHash = {};
+        std::vector<FrameGraphRecorder>           Recorders = {};
+        FrameGraphRecorder                        Prologue = {};
+        FrameGraphRecorder                        Epilogue = {};
+        uint64_t                                  GraphicsValue = {};
+        uint64_t                                  ComputeValue = {};
+        bool                                      IsSubmitted = {};
+    };
+
+    class FrameGraph::Internal {
+    public:
+        Internal(Device const& device, FrameGraphCreateInfo const& createInfo);
+
+        Internal(Internal&& rhs) noexcept = default;
+
+        Internal& operator=(Internal&& rhs) noexcept;
+
+        ~Internal();
+
+        auto ImportResource(TrackedResource const& resource) -> FrameGraphResource;
+
+        auto CreateBuffer(vk::BufferCreateInfo const& createInfo) -> FrameGraphResource;
+
+        auto CreateTexture(vk::ImageCreateInfo const& createInfo) -> FrameGraphResource;
+
+        auto MarkOutput(FrameGraphResource resource) -> void;
+
+        auto AddPass(FrameGraphPassCreateInfo const& createInfo, FrameGraphPassExecutor&& executor) -> void;
+
+        auto Compile() -> void;
+
+        auto Execute(FrameGraphExecuteInfo const& executeInfo) -> void;
+
+        auto GetVkBuffer(FrameGraphResource resource) const -> vk::Buffer { return m_Resources[resource.Index].Resource.Buffer; }
+
+        auto GetVkImage(FrameGraphResource resource) const -> vk::Image { return m_Resources[resource.Index].Resource.Image; }
+
+        auto GetGraphicsFence() const -> Fence const& { return *m_pGraphicsFence; }
+
+        auto GetComputeFence() const -> Fence const& { return *m_pComputeFence; }
+
+        auto GetStatistic() const -> FrameGraphStatistic { return m_Statistic; }
+
+    private:
+        auto SortPasses() -> bool;
+
+        auto CullPasses() -> void;
+
+        auto PlaceTransientResources(FrameGraphFrame& frame) -> void;
+
+        auto BuildBarriers(FrameGraphFrame const& frame) -> void;
+
+        auto PrepareRecorder(FrameGraphRecorder& recorder, FrameGraphQueue queue) -> CommandList&;
+
+        auto RecordPass(FrameGraphFrame& frame, uint32_t passIndex) const -> void;
+
+        auto RecycleFrame(FrameGraphFrame& frame) -> void;
+
+        auto WaitFrame(FrameGraphFrame& frame) -> void;
+
+        auto Release() -> void;
+
+    private:
+        Device*                                            m_pDevice = {};
+        std::unique_ptr<Fence>                             m_pGraphicsFence = {};
+        std::unique_ptr<Fence>                             m_pComputeFence = {};
+        std::vector<FrameGraphResourceNode>                m_Resources = {};
+        std::vector<FrameGraphPassNode>                    m_Passes = {};
+        std::vector<FrameGraphResourceUsage>               m_Usages = {};
+        std::vector<uint32_t>                              m_CompiledPasses = {};
+        std::unordered_map<ResourceState const*, uint32_t> m_ImportedResources = {};
+        std::vector<FrameGraphFrame>                       m_Frames = {};
+        ResourceBarrierBatch                               m_PrologueBarriers = {};
+        ResourceBarrierBatch                               m_EpilogueBarriers = {};
+        std::array<uint32_t, 2>                            m_QueueFamilyIndices = {};
+        std::array<vk::PipelineStageFlags, 2>              m_SupportedStages = {};
+        int32_t                                            m_EpilogueWaitPass = -1;
+        uint64_t                                           m_FrameIndex = {};
+        FrameGraphStatistic                                m_Statistic = {};
+        bool                                               m_IsAsyncComputeEnabled = {};
+        bool                                               m_IsPrologueSignaled = {};
+        bool                                               m_IsCompiled = {};
+    };
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <HAL/Instance.hpp>
+#include <vulkan/vulkan_decl.h>
+
+#include <atomic>
+#include <mutex>
+
+namespace HAL {
+
+    //Routes driver host allocations by VkSystemAllocationScope:
+    //command scope -> thread-local bump arena, small allocations -> size-class pools, the rest -> malloc.
+    class HostAllocator {
+    private:
+        enum class AllocationKind: uint16_t {
+            Arena,
+            Pool,
+            System
+        };
+
+        struct alignas(16) AllocationHeader {
+            void*          pSource = {};
+            uint64_t       Size = {};
+            uint32_t       Tag = {};
+            uint16_t       Scope = {};
+            AllocationKind Kind = {};
+            uint32_t       SizeClass = {};
+        };
+
+        struct Counter {
+            std::atomic<uint64_t> AllocatedBytes = {};
+            std::atomic<uint64_t> PeakBytes = {};
+            std::atomic<uint64_t> AllocationCount = {};
+            std::atomic<uint64_t> TotalAllocationCount = {};
+        };
+
+        struct FreeBlock {
+            FreeBlock* pNext = {};
+        };
+
+        struct SizeClassPool {
+            std::mutex         Mutex = {};
+            FreeBlock*         pFreeList = {};
+            std::vector<void*> Pages = {};
+        };
+
+        static constexpr size_t   DefaultAlignment = 16;
+        static constexpr size_t   PageSize = 64 * 1024;
+        static constexpr size_t   ArenaChunkSize = 64 * 1024;
+        static constexpr size_t   MinSizeClass = 64;
+        static constexpr uint32_t SizeClassCount = 7;
+
+    public:
+        static auto Get() -> HostAllocator&;
+
+        static auto GetAllocationCallbacks(HostMemoryTag tag) -> vk::AllocationCallbacks const* { return &Get().m_Callbacks[static_cast<size_t>(tag)]; }
+
+        ~HostAllocator();
+
+        auto GetStatistic() const -> HostMemoryStatistic;
+
+    private:
+        HostAllocator();
+
+        auto Allocate(HostMemoryTag tag, size_t size, size_t alignment, vk::SystemAllocationScope scope) -> void*;
+
+        auto Reallocate(HostMemoryTag tag, void* pOriginal, size_t size, size_t alignment, vk::SystemAllocationScope scope) -> void*;
+
+        auto Free(void* pMemory) -> void;
+
+        auto AllocateArena(size_t size, size_t alignment) -> std::pair<void*, void*>;
+
+        auto FreeArena(void* pChunk) -> void;
+
+        auto AllocatePool(uint32_t sizeClass) -> void*;
+
+        auto FreePool(uint32_t sizeClass, void* pBlock) -> void;
+
+        auto TrackAllocation(AllocationHeader const& header) -> void;
+
+        auto TrackFree(AllocationHeader const& header) -> void;
+
+        static auto GetHeader(void* pMemory) -> AllocationHeader* { return reinterpret_cast<AllocationHeader*>(pMemory) - 1; }
+
+        static auto AlignUp(uintptr_t value, size_t alignment) -> uintptr_t { return (value + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1); }
+
+        friend struct ThreadArena;
+
+    private:
+        std::array<vk::AllocationCallbacks, static_cast<size_t>(HostMemoryTag::Count)> m_Callbacks = {};
+        std::array<Counter, static_cast<size_t>(HostMemoryTag::Count)>                 m_TagCounters = {};
+        std::array<Counter, static_cast<size_t>(HostMemoryScope::Count)>               m_ScopeCounters = {};
+        std::array<SizeClassPool, SizeClassCount>                                      m_Pools = {};
+        std::atomic<uint64_t>                                                          m_ArenaReservedBytes = {};
+        std::atomic<uint64_t>                                                          m_PoolReservedBytes = {};
+        std::atomic<uint64_t>                                                          m_InternalAllocatedBytes = {};
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <HAL/InstanceCuller.hpp>
+#include <HAL/Device.hpp>
+#include <HAL/Pipeline.hpp>
+#include <vulkan/vulkan_decl.h>
+#include "PipelineImpl.hpp"
+
+namespace HAL {
+
+    //Matches CullConstants in content/shaders/InstanceCulling.hlsl
+    struct InstanceCullingConstants {
+        float    View[3][4] = {};
+        float    P00 = {};
+        float    P11 = {};
+        float    P22 = {};
+        float    P23 = {};
+        float    ZNear = {};
+        float    ZFar = {};
+        uint32_t InstanceCount = {};
+        uint32_t DepthPyramidMipCount = {};
+        float    DepthPyramidWidth = {};
+        float    DepthPyramidHeight = {};
+    };
+
+    static_assert(sizeof(InstanceCullingConstants) <= MaxPushConstantSize);
+
+    struct InstanceCullerFrame {
+        vk::Semaphore                         Semaphore = {};
+        uint64_t                              FenceValue = {};
+        std::vector<vk::UniqueDescriptorPool> DescriptorPools = {};
+        uint32_t                              SetCount = {};
+    };
+
+    class InstanceCuller::Internal {
+    public:
+        Internal(Device const& device, InstanceCullerCreateInfo const& createInfo);
+
+        Internal(Internal&& rhs) noexcept = default;
+
+        Internal& operator=(Internal&& rhs) noexcept;
+
+        ~Internal();
+
+        auto Cull(ComputeCommandList& cmdList, InstanceCullingInfo const& cullingInfo) -> void;
+
+        auto NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void;
+
+    private:
+        auto AllocateDescriptorSet(vk::DescriptorSetLayout layout) -> vk::DescriptorSet;
+
+        auto WaitFrame(InstanceCullerFrame& frame) -> void;
+
+        auto Release() -> void;
+
+    private:
+        Device*                          m_pDevice = {};
+        std::unique_ptr<ComputePipeline> m_pFrustumPipeline = {};
+        std::unique_ptr<ComputePipeline> m_pOcclusionPipeline = {};
+        std::vector<InstanceCullerFrame> m_Frames = {};
+        uint32_t                         m_FrameIndex = {};
+    };
+}
@@ -1,29 +1,98 @@
 #pragma once
 #include <HAL/Device.hpp>
 #include <HAL/Instance.hpp>
+#include <HAL/CommandAllocator.hpp>
+#include <HAL/CommandList.hpp>
+#include <HAL/Fence.hpp>
+#include <HAL/MemoryPool.hpp>
+
+#include "MemoryTelemetry.hpp"
 
 #include <vulkan/vulkan_decl.h>
+#include <mutex>
 
 namespace HAL {
 
     struct AllocatorCreateInfo {
         vma::AllocatorCreateFlags  Flags = {};
-        vma::DeviceMemoryCallbacks DeviceMemoryCallbacks = {};
         uint32_t                   FrameInUseCount = {};
+        float                      SoftThreshold = {};
+        float                      HardThreshold = {};
     };
 
 
+    using RelocationCallback = std::function<void(vma::Allocation allocation, Fence const& fence, std::optional<uint64_t> value)>;
+
     class MemoryAllocator {
     public:
         MemoryAllocator(Instance const& instance, Device const& device, AllocatorCreateInfo const& createInfo);
 
+        ~MemoryAllocator();
+
         auto NextFrame() -> void;
 
+        auto CreateBuffer(vk::BufferCreateInfo const& bufferCI, vma::AllocationCreateInfo const& allocationCI, MemoryFallbackPolicy policy, vma::AllocationInfo* pAllocationInfo = nullptr) -> std::pair<vk::UniqueBuffer, vma::UniqueAllocation>;
+
+        auto CreateImage(vk::ImageCreateInfo const& imageCI, vma::AllocationCreateInfo const& allocationCI, MemoryFallbackPolicy policy, vma::AllocationInfo* pAllocationInfo = nullptr) -> std::pair<vk::UniqueImage, vma::UniqueAllocation>;
+
+        auto CreatePool(MemoryPoolCreateInfo const& createInfo) const -> std::pair<vma::UniquePool, uint32_t>;
+
+        auto GetMemoryBudget() const -> std::vector<MemoryHeapBudget>;
+
+        auto GetHeapPressure(uint32_t memoryTypeIndex) const -> MemoryPressure;
+
+        auto AddMemoryPressureCallback(MemoryPressureCallback&& callback) -> uint32_t;
+
+        auto RemoveMemoryPressureCallback(uint32_t callbackID) -> void;
+
+        auto RegisterRelocatable(vma::Allocation allocation, RelocationCallback&& callback) -> void;
+
+        auto UnregisterRelocatable(vma::Allocation allocation) -> void;
+
+        auto Defragment(Fence const& fence, std::optional<uint64_t> value, DefragmentationInfo const& info) -> DefragmentationStatistic;
+
+        auto GetMemoryStatistic() const -> MemoryStatistic;
+
+        auto GetMemoryTelemetry() const -> MemoryTelemetry const& { return *m_pTelemetry; }
+
         auto GetVmaAllocator() const -> vma::Allocator { return *m_pAllocator; }
 
     private:
-        vma::UniqueAllocator m_pAllocator;
-        uint32_t             m_FrameIndex;
-        uint32_t             m_FrameCount;
+        auto UpdateBudget() -> void;
+
+        auto EndDefragmentation() -> void;
+
+        auto IsDeviceLocalRequest(vma::AllocationCreateInfo const& allocationCI) const -> bool;
+
+        auto GetHostFallbackCreateInfo(vma::AllocationCreateInfo const& allocationCI) const -> vma::AllocationCreateInfo;
+
+    private:
+        std::unique_ptr<MemoryTelemetry>   m_pTelemetry;
+        vma::UniqueAllocator               m_pAllocator;
+        vk::Device                         m_Device;
+        vk::PhysicalDeviceMemoryProperties m_MemoryProperties;
+        uint32_t                           m_HostMemoryTypeBits;
+        uint32_t                           m_FrameIndex;
+        float                              m_SoftThreshold;
+        float                              m_HardThreshold;
+
+        //Refreshed on the frame thread, read by allocations and budget queries on any thread
+        mutable std::mutex                 m_BudgetMutex;
+        std::vector<MemoryHeapBudget>      m_HeapBudgets;
+
+        std::mutex                                               m_CallbackMutex;
+        std::vector<std::pair<uint32_t, MemoryPressureCallback>> m_PressureCallbacks;
+        uint32_t                                                 m_CallbackID;
+
+        Device*                                                  m_pDevice;
+        std::recursive_mutex                                     m_RelocationMutex;
+        std::vector<std::pair<vma::Allocation, RelocationCallback>> m_Relocatables;
+        std::unique_ptr<GraphicsCommandAllocator>                m_pDefragmentationAllocator;
+        std::unique_ptr<GraphicsCommandList>                     m_pDefragmentationCommandList;
+        std::unique_ptr<Fence>                                   m_pDefragmentationFence;
+        vma::DefragmentationContext                              m_DefragmentationContext;
+        uint64_t                                                 m_DefragmentationValue;
+        std::vector<vma::Allocation>                             m_DefragmentationAllocations;
+        std::vector<vk::Bool32>                                  m_DefragmentationChanged;
     };
-}
\ No newline at end of file
+}
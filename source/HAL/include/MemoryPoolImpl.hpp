@@ -0,0 +1,29 @@
+#pragma once
+
+#include <HAL/MemoryPool.hpp>
+#include <HAL/Device.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    class MemoryPool::Internal {
+    public:
+        Internal(Device const& device, MemoryPoolCreateInfo const& createInfo);
+
+        auto GetName() const -> std::string const& { return m_Name; }
+
+        auto GetStatistic() const -> MemoryPoolStatistic;
+
+        auto GetVmaPool() const -> vma::Pool { return m_pPool ? *m_pPool : vma::Pool{}; }
+
+        auto IsValid() const -> bool { return static_cast<bool>(m_pPool); }
+
+        auto GetMemoryTypeIndex() const -> uint32_t { return m_MemoryTypeIndex; }
+
+    private:
+        vma::UniquePool     m_pPool = {};
+        std::string         m_Name = {};
+        MemoryPoolAlgorithm m_Algorithm = {};
+        uint32_t            m_MemoryTypeIndex = {};
+    };
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <HAL/Device.hpp>
+#include <vulkan/vulkan_decl.h>
+
+#include <atomic>
+#include <chrono>
+
+namespace HAL {
+
+    //Lock-free counters and event ring fed from VMA device memory callbacks.
+    //Writers never allocate, lock or print; readers take consistent snapshots.
+    class MemoryTelemetry {
+    public:
+        static constexpr uint32_t EventCapacity = 4096;
+
+    private:
+        struct HeapCounters {
+            std::atomic<uint64_t> UsedBytes = {};
+            std::atomic<uint64_t> PeakBytes = {};
+            std::atomic<uint64_t> AllocatedBytes = {};
+            std::atomic<uint64_t> FreedBytes = {};
+            std::atomic<uint32_t> AllocationCount = {};
+        };
+
+        //Per-slot seqlock: Sequence is zero while the slot is being written, otherwise event index + 1
+        struct EventSlot {
+            std::atomic<uint64_t> Sequence = {};
+            std::atomic<int64_t>  TimePoint = {};
+            std::atomic<uint64_t> Size = {};
+            std::atomic<uint64_t> HeapUsage = {};
+            std::atomic<uint32_t> HeapIndex = {};
+            std::atomic<uint32_t> Type = {};
+        };
+
+    public:
+        MemoryTelemetry(vk::PhysicalDeviceMemoryProperties const& memoryProperties);
+
+        auto OnAllocate(uint32_t memoryTypeIndex, uint64_t size) -> void;
+
+        auto OnFree(uint32_t memoryTypeIndex, uint64_t size) -> void;
+
+        auto GetSnapshot() const -> MemorySnapshot;
+
+        auto ReadEvents(uint64_t sequence, std::vector<MemoryEvent>& events) const -> uint64_t;
+
+        auto GetDeviceMemoryCallbacks() -> vma::DeviceMemoryCallbacks;
+
+    private:
+        auto PushEvent(MemoryEventType type, uint32_t heapIndex, uint64_t size, uint64_t heapUsage) -> void;
+
+        auto GetTimePoint() const -> int64_t;
+
+    private:
+        std::array<HeapCounters, MemorySnapshot::MaxHeapCount> m_Heaps = {};
+        std::array<uint64_t, MemorySnapshot::MaxHeapCount>     m_HeapSizes = {};
+        std::array<bool, MemorySnapshot::MaxHeapCount>         m_HeapDeviceLocal = {};
+        std::array<uint32_t, VK_MAX_MEMORY_TYPES>              m_TypeToHeap = {};
+        uint32_t                                               m_HeapCount = {};
+        std::unique_ptr<EventSlot[]>                           m_pEvents = {};
+        std::atomic<uint64_t>                                  m_EventHead = {};
+        std::chrono::steady_clock::time_point                  m_TimeStamp = {};
+    };
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <HAL/ParallelCommandRecorder.hpp>
+#include <HAL/CommandAllocator.hpp>
+#include <HAL/CommandList.hpp>
+#include <HAL/Device.hpp>
+#include <vulkan/vulkan_decl.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace HAL {
+
+    //Command pools are externally synchronized, so every thread records from its own allocator
+    struct RecorderContext {
+        std::unique_ptr<GraphicsCommandAllocator>         pAllocator = {};
+        std::vector<std::unique_ptr<GraphicsCommandList>> CmdLists = {};
+        std::vector<std::unique_ptr<GraphicsCommandList>> FreeCmdLists = {};
+    };
+
+    struct RecorderFrame {
+        vk::Semaphore                                 Semaphore = {};
+        uint64_t                                      FenceValue = {};
+        std::vector<std::unique_ptr<RecorderContext>> Contexts = {};
+    };
+
+    //Heap-stable so that the worker threads keep a valid pointer while the owning recorder moves
+    struct RecorderState {
+        vk::Device                        Device = {};
+        std::vector<RecorderFrame>        Frames = {};
+        uint32_t                          FrameIndex = {};
+        uint32_t                          ThreadCount = {};
+
+        GraphicsCommandList const*        pPrimary = {};
+        CommandChunkRecorder const*       pRecorder = {};
+        uint32_t                          ChunkCount = {};
+        std::atomic<uint32_t>             NextChunk = {};
+        std::vector<GraphicsCommandList*> ChunkCmdLists = {};
+
+        std::mutex                        Mutex = {};
+        std::condition_variable           WorkCondition = {};
+        std::condition_variable           DoneCondition = {};
+        uint64_t                          JobIndex = {};
+        uint32_t                          ActiveWorkerCount = {};
+        bool                              IsStopping = {};
+        std::vector<std::thread>          Workers = {};
+    };
+
+    class ParallelCommandRecorder::Internal {
+    public:
+        Internal(Device const& device, ParallelCommandRecorderCreateInfo const& createInfo);
+
+        Internal(Internal&& rhs) noexcept = default;
+
+        Internal& operator=(Internal&& rhs) noexcept;
+
+        ~Internal();
+
+        auto Record(GraphicsCommandList& primary, uint32_t chunkCount, CommandChunkRecorder const& recorder) -> void;
+
+        auto NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void;
+
+        auto GetThreadCount() const -> uint32_t { return m_pState->ThreadCount; }
+
+    private:
+        auto Release() -> void;
+
+        static auto WaitFrame(RecorderState& state, RecorderFrame& frame) -> void;
+
+        static auto RecordChunks(RecorderState& state, uint32_t threadIndex) -> void;
+
+        static auto WorkerLoop(RecorderState* pState, uint32_t threadIndex) -> void;
+
+    private:
+        std::unique_ptr<RecorderState> m_pState = {};
+    };
+}
@@ -6,6 +6,8 @@
 #include "ShaderModule.hpp"
 #include "PipelineImpl.hpp"
 
+#include <mutex>
+
 namespace HAL {
 
     struct PipelineCacheCreateInfo {
@@ -29,7 +31,17 @@ namespace HAL {
         };
 
         struct GraphicsPipelineKey {
-
+            vk::ShaderModule   VertexStage;
+            vk::ShaderModule   PixelStage;
+            vk::RenderPass     RenderPass;
+            uint32_t           SubpassIndex;
+            FillMode           FillMode;
+            CullMode           CullMode;
+            FrontFace          FrontFace;
+            bool               DepthEnable;
+            bool               DepthWrite;
+            ComparisonFunction DepthFunc;
+            bool operator==(const GraphicsPipelineKey&) const = default;
         };
 
         struct ComputePipelineKey {
@@ -39,7 +51,15 @@ namespace HAL {
 
         struct GraphicsPipelineKeyHash {
             std::size_t operator()(GraphicsPipelineKey const& key) const noexcept {
-                return 0;
+                //Draws switch pipelines far more often than dispatches, so the graphics key is actually hashed
+                std::size_t hash = std::hash<uint64_t>{}(reinterpret_cast<uint64_t>(static_cast<VkShaderModule>(key.VertexStage)));
+                auto Combine = [&](uint64_t value) -> void { hash ^= std::hash<uint64_t>{}(value) + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2); };
+                Combine(reinterpret_cast<uint64_t>(static_cast<VkShaderModule>(key.PixelStage)));
+                Combine(reinterpret_cast<uint64_t>(static_cast<VkRenderPass>(key.RenderPass)));
+                Combine(key.SubpassIndex);
+                Combine(static_cast<uint64_t>(key.FillMode) | static_cast<uint64_t>(key.CullMode) << 8 | static_cast<uint64_t>(key.FrontFace) << 16 |
+                    static_cast<uint64_t>(key.DepthEnable) << 24 | static_cast<uint64_t>(key.DepthWrite) << 25 | static_cast<uint64_t>(key.DepthFunc) << 32);
+                return hash;
             }
         };
 
@@ -57,7 +77,8 @@ namespace HAL {
 
         auto GetComputePipeline(ComputePipeline const& pipeline, ComputeState const& state) const -> vk::Pipeline;
 
-        auto GetGraphicsPipeline(GraphicsPipeline const& pipeline, RenderPass const& renderPass, GraphicsState const& state) const -> vk::Pipeline;
+        //Graphics pipelines are created against the render pass and subpass the command list is recording
+        auto GetGraphicsPipeline(GraphicsPipeline const& pipeline, vk::RenderPass renderPass, uint32_t subpassIndex, GraphicsState const& state) const -> vk::Pipeline;
     
         auto GetVkPipelineCache() -> vk::PipelineCache { return m_pVkPipelineCache.get(); }
 
@@ -67,5 +88,6 @@ namespace HAL {
         vk::UniquePipelineCache m_pVkPipelineCache = {};
         mutable PipelinesCache<GraphicsPipelineKey, GraphicsPipelineKeyHash> m_GraphicsPipelineCache;
         mutable PipelinesCache<ComputePipelineKey, ComputePipelineKeyyHash>  m_ComputePipelineCache;
+        mutable std::mutex                                                  m_Mutex;
     };
 }
\ No newline at end of file
@@ -8,6 +8,8 @@
 
 namespace HAL {
 
+    //Guaranteed minimum of maxPushConstantsSize; every layout declares the whole range so all layouts stay push constant compatible
+    constexpr uint32_t MaxPushConstantSize = 128;
 
     class Pipeline {
     public:
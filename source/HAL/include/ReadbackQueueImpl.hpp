@@ -0,0 +1,72 @@
+#pragma once
+
+#include <HAL/ReadbackQueue.hpp>
+#include <HAL/Device.hpp>
+#include <vulkan/vulkan_decl.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace HAL {
+
+    struct ReadbackRequest {
+        uint64_t         Offset = {};
+        uint64_t         Size = {};
+        uint64_t         AllocatedSize = {};
+        ReadbackCallback Callback = {};
+    };
+
+    struct ReadbackBatch {
+        vk::Semaphore                Semaphore = {};
+        uint64_t                     FenceValue = {};
+        std::vector<ReadbackRequest> Requests = {};
+    };
+
+    //Heap-stable so that the watcher thread keeps a valid pointer while the owning queue moves
+    struct ReadbackState {
+        vk::Device                 Device = {};
+        vma::Allocator             Allocator = {};
+        vk::UniqueBuffer           pBuffer = {};
+        vma::UniqueAllocation      pAllocation = {};
+        uint8_t*                   pMappedData = {};
+        uint64_t                   Capacity = {};
+        uint64_t                   Alignment = {};
+        uint64_t                   Head = {};
+        uint64_t                   UsedSize = {};
+        std::deque<ReadbackBatch>  Batches = {};
+        std::mutex                 Mutex = {};
+        std::condition_variable    Condition = {};
+        bool                       IsStopping = {};
+        std::thread                Watcher = {};
+    };
+
+    class ReadbackQueue::Internal {
+    public:
+        Internal(Device const& device, ReadbackQueueCreateInfo const& createInfo);
+
+        Internal(Internal&& rhs) noexcept = default;
+
+        Internal& operator=(Internal&& rhs) noexcept;
+
+        ~Internal();
+
+        auto ReadBuffer(ComputeCommandList& cmdList, Buffer const& buffer, uint64_t offset, uint64_t size, ReadbackCallback&& callback) -> bool;
+
+        auto Commit(Fence const& fence, uint64_t value) -> void;
+
+        auto GetPendingCount() const -> uint32_t;
+
+    private:
+        auto AllocateRing(uint64_t size) -> std::optional<std::pair<uint64_t, uint64_t>>;
+
+        auto Release() -> void;
+
+        static auto WatcherLoop(ReadbackState* pState) -> void;
+
+    private:
+        std::unique_ptr<ReadbackState> m_pState = {};
+        std::vector<ReadbackRequest>   m_Requests = {};
+    };
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <HAL/Device.hpp>
+#include <vulkan/vulkan_decl.h>
+
+#include <functional>
+#include <mutex>
+
+namespace HAL {
+
+    class ReleaseQueue {
+    private:
+        struct ReleaseEntry {
+            vk::Semaphore         Semaphore = {};
+            uint64_t              Value = {};
+            std::function<void()> Release = {};
+        };
+
+    public:
+        ReleaseQueue(vk::Device device);
+
+        ~ReleaseQueue();
+
+        auto Enqueue(vk::Semaphore semaphore, uint64_t value, std::function<void()>&& release) -> void;
+
+        auto Poll() -> void;
+
+        auto Flush() -> void;
+
+    private:
+        vk::Device                m_Device = {};
+        std::mutex                m_Mutex = {};
+        std::vector<ReleaseEntry> m_Entries = {};
+    };
+}
@@ -10,7 +10,7 @@ namespace HAL {
     public:
         Internal(Device const& device, vk::RenderPassCreateInfo const& createInfo);
 
-        auto GenerateFrameBufferAndCommit(vk::CommandBuffer cmdBuffer, RenderPassBeginInfo const& beginInfo) -> void;
+        auto GenerateFrameBufferAndCommit(vk::CommandBuffer cmdBuffer, RenderPassBeginInfo const& beginInfo) -> vk::Framebuffer;
 
         auto GetRenderPass() const -> vk::RenderPass { return *m_pRenderPass; }
 
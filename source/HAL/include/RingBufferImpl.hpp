@@ -0,0 +1,37 @@
+#pragma once
+
+#include <HAL/RingBuffer.hpp>
+#include <HAL/Device.hpp>
+#include <HAL/Fence.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    class RingBuffer::Internal {
+    private:
+        struct Segment {
+            vk::Semaphore Semaphore = {};
+            uint64_t      FenceValue = {};
+        };
+    public:
+        Internal(Device const& device, RingBufferCreateInfo const& createInfo);
+
+        auto Allocate(uint64_t size, uint64_t alignment) -> std::optional<RingBufferAllocation>;
+
+        auto Push(void const* pData, uint64_t size, uint64_t alignment) -> std::optional<RingBufferAllocation>;
+
+        auto NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void;
+
+        auto GetVkBuffer() const -> vk::Buffer { return *m_pBuffer; }
+
+    private:
+        vk::UniqueBuffer      m_pBuffer = {};
+        vma::UniqueAllocation m_pAllocation = {};
+        uint8_t*              m_pMappedData = {};
+        uint64_t              m_SegmentSize = {};
+        uint64_t              m_SegmentOffset = {};
+        uint32_t              m_SegmentIndex = {};
+        uint32_t              m_SegmentCount = {};
+        std::vector<Segment>  m_Segments = {};
+    };
+}
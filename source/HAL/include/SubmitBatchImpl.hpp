@@ -0,0 +1,43 @@
+#pragma once
+
+#include <HAL/SubmitBatch.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    struct SubmitBatchSubmission {
+        std::vector<vk::Semaphore>              WaitSemaphores = {};
+        std::vector<uint64_t>                   WaitValues = {};
+        std::vector<vk::PipelineStageFlags2KHR> WaitStages = {};
+        std::vector<vk::CommandBuffer>          CommandBuffers = {};
+        std::vector<CommandList const*>         CommandLists = {};
+        std::vector<vk::Semaphore>              SignalSemaphores = {};
+        std::vector<uint64_t>                   SignalValues = {};
+    };
+
+    class SubmitBatch::Internal {
+    public:
+        auto Wait(vk::Semaphore semaphore, uint64_t value, vk::PipelineStageFlags2KHR stages) -> void;
+
+        auto Execute(CommandList const& cmdList) -> void;
+
+        auto Signal(vk::Semaphore semaphore, uint64_t value) -> void;
+
+        auto Present(SwapChain const& swapChain, uint32_t frameID) -> void;
+
+        auto Reset() -> void;
+
+        auto IsEmpty() const -> bool { return m_Submissions.empty() && !m_pPresentSwapChain; }
+
+        auto GetSubmissions() const -> std::vector<SubmitBatchSubmission> const& { return m_Submissions; }
+
+        auto GetPresentSwapChain() const -> SwapChain const* { return m_pPresentSwapChain; }
+
+        auto GetPresentFrameID() const -> uint32_t { return m_PresentFrameID; }
+
+    private:
+        std::vector<SubmitBatchSubmission> m_Submissions = {};
+        SwapChain const*                   m_pPresentSwapChain = {};
+        uint32_t                           m_PresentFrameID = {};
+    };
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <HAL/TextureContainer.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    class TextureContainer::Internal {
+    public:
+        Internal(std::filesystem::path const& path);
+
+        Internal(Internal&& rhs) noexcept;
+
+        Internal& operator=(Internal&& rhs) noexcept;
+
+        ~Internal();
+
+        auto IsValid() const -> bool { return m_pData != nullptr; }
+
+        auto GetHeader() const -> TextureContainerHeader const& { return *reinterpret_cast<TextureContainerHeader const*>(m_pData); }
+
+        auto GetTextureCreateInfo() const -> TextureCreateInfo;
+
+        auto GetSubresourceData(uint32_t mipLevel, uint32_t arrayLayer) const -> std::span<const uint8_t>;
+
+        auto GetMipWriter() const -> TextureMipWriter;
+
+    private:
+        auto Validate() const -> bool;
+
+        auto Release() -> void;
+
+    private:
+        void*          m_hFile = {};
+        void*          m_hMapping = {};
+        uint8_t const* m_pData = {};
+        uint64_t       m_Size = {};
+    };
+}
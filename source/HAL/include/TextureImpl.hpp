@@ -0,0 +1,47 @@
+#pragma once
+
+#include <HAL/Texture.hpp>
+#include <HAL/Device.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    class Texture::Internal {
+    public:
+        Internal(Device const& device, TextureCreateInfo const& createInfo);
+
+        auto GetCreateInfo() const -> TextureCreateInfo const& { return m_CreateInfo; }
+
+        auto GetVkImage() const -> vk::Image { return *m_pImage; }
+
+        auto GetResidentMipLevel() const -> uint32_t { return m_ResidentMipLevel; }
+
+        //Streamed mips are left shader-readable by the streamer and the upload batcher
+        auto SetResidentMipLevel(uint32_t mipLevel) -> void { m_ResidentMipLevel = mipLevel; m_State = ResourceState::ShaderResource; }
+
+        auto GetState() -> ResourceState& { return m_State; }
+
+        auto GetQueueFamilyIndex() -> uint32_t& { return m_QueueFamilyIndex; }
+
+    private:
+        TextureCreateInfo     m_CreateInfo = {};
+        vk::UniqueImage       m_pImage = {};
+        vma::UniqueAllocation m_pAllocation = {};
+        uint32_t              m_ResidentMipLevel = {};
+        ResourceState         m_State = ResourceState::Undefined;
+        uint32_t              m_QueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    };
+
+    class TextureView::Internal {
+    public:
+        Internal(Device const& device, Texture const& texture, TextureViewCreateInfo const& createInfo);
+
+        auto GetCreateInfo() const -> TextureViewCreateInfo const& { return m_CreateInfo; }
+
+        auto GetVkImageView() const -> vk::ImageView { return *m_pImageView; }
+
+    private:
+        TextureViewCreateInfo m_CreateInfo = {};
+        vk::UniqueImageView   m_pImageView = {};
+    };
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <HAL/TextureStreamer.hpp>
+#include <HAL/CommandAllocator.hpp>
+#include <HAL/CommandList.hpp>
+#include <HAL/Device.hpp>
+#include <HAL/Fence.hpp>
+#include <HAL/RingBuffer.hpp>
+#include <HAL/Texture.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    class TextureStreamer::Internal {
+    private:
+        struct StreamRequest {
+            Texture*         pTexture = {};
+            TextureMipWriter Writer = {};
+            float            Priority = {};
+            uint32_t         MipTailLevel = {};
+            uint32_t         StagedMipLevel = {};
+        };
+
+        struct StreamContext {
+            StreamContext(Device const& device) : TransferAllocator(device), TransferCmdList(TransferAllocator), GraphicsAllocator(device), GraphicsCmdList(GraphicsAllocator), ComputeAllocator(device), ComputeCmdList(ComputeAllocator) {}
+
+            TransferCommandAllocator                             TransferAllocator;
+            TransferCommandList                                  TransferCmdList;
+            GraphicsCommandAllocator                             GraphicsAllocator;
+            GraphicsCommandList                                  GraphicsCmdList;
+            ComputeCommandAllocator                              ComputeAllocator;
+            ComputeCommandList                                   ComputeCmdList;
+            uint64_t                                             TransferFenceValue = {};
+            uint64_t                                             GraphicsFenceValue = {};
+            uint64_t                                             ComputeFenceValue = {};
+            std::vector<std::pair<Texture::Internal*, uint32_t>> Residency = {};
+        };
+
+        struct StreamCopy {
+            vk::Image           Image = {};
+            vk::BufferImageCopy Region = {};
+        };
+
+        struct StreamBatch {
+            std::vector<vk::ImageMemoryBarrier>                    TransferBarriers = {};
+            std::vector<vk::ImageMemoryBarrier>                    ReleaseBarriers = {};
+            std::vector<vk::ImageMemoryBarrier>                    GraphicsAcquireBarriers = {};
+            std::vector<vk::ImageMemoryBarrier>                    ComputeAcquireBarriers = {};
+            std::vector<StreamCopy>                                Copies = {};
+            std::vector<std::pair<Texture::Internal*, uint32_t>>   Residency = {};
+            uint64_t                                               StagingSize = {};
+            bool                                                   IsGraphicsUsed = {};
+            bool                                                   IsComputeUsed = {};
+        };
+
+    public:
+        Internal(Device const& device, TextureStreamerCreateInfo const& createInfo);
+
+        auto Request(Texture& texture, TextureMipWriter&& writer, float priority) -> void;
+
+        auto SetPriority(Texture const& texture, float priority) -> void;
+
+        auto Cancel(Texture const& texture) -> void;
+
+        auto Update() -> uint64_t;
+
+        auto GetFence() const -> Fence const& { return m_TransferFence; }
+
+        auto GetStatistic() const -> TextureStreamerStatistic;
+
+    private:
+        auto GetMipRangeSize(TextureCreateInfo const& createInfo, uint32_t firstMip, uint32_t lastMip) const -> uint64_t;
+
+        auto StageMips(StreamRequest& request, uint32_t firstMip, uint32_t lastMip, StreamBatch& batch) -> bool;
+
+        auto RecordAndSubmit(StreamContext& context, StreamBatch const& batch) -> uint64_t;
+
+        auto IsContextCompleted(StreamContext const& context) const -> bool;
+
+        auto RetireContexts() -> void;
+
+    private:
+        Device*                                     m_pDevice = {};
+        TextureStreamerCreateInfo                   m_CreateInfo = {};
+        RingBuffer                                  m_StagingBuffer;
+        Fence                                       m_TransferFence;
+        Fence                                       m_GraphicsFence;
+        Fence                                       m_ComputeFence;
+        std::vector<std::unique_ptr<StreamContext>> m_Contexts = {};
+        std::vector<std::unique_ptr<StreamRequest>> m_Requests = {};
+        uint64_t                                    m_Alignment = {};
+        uint32_t                                    m_ContextIndex = {};
+        bool                                        m_IsStagingAdvancePending = {};
+        TextureStreamerStatistic                    m_Statistic = {};
+    };
+}
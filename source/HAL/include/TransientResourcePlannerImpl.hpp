@@ -0,0 +1,60 @@
+#pragma once
+
+#include <HAL/TransientResourcePlanner.hpp>
+#include <HAL/CommandList.hpp>
+#include <HAL/Device.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    class TransientResourcePlanner::Internal {
+    private:
+        struct TransientResource {
+            vk::ImageCreateInfo    ImageCI = {};
+            vk::BufferCreateInfo   BufferCI = {};
+            vk::ImageLayout        InitialLayout = {};
+            uint32_t               FirstPass = {};
+            uint32_t               LastPass = {};
+            bool                   IsImage = {};
+            vk::UniqueImage        pImage = {};
+            vk::UniqueBuffer       pBuffer = {};
+            vk::MemoryRequirements Requirements = {};
+            uint32_t               AllocationIndex = {};
+            uint64_t               Offset = {};
+            bool                   IsAliased = {};
+        };
+
+    public:
+        Internal(Device const& device);
+
+        auto AddImage(TransientImageCreateInfo const& createInfo) -> uint32_t;
+
+        auto AddBuffer(TransientBufferCreateInfo const& createInfo) -> uint32_t;
+
+        auto Compile(Fence const& fence, std::optional<uint64_t> value) -> TransientMemoryReport;
+
+        auto Reset(Fence const& fence, std::optional<uint64_t> value) -> void;
+
+        auto RecordAliasingBarriers(CommandList& cmdList, uint32_t passIndex) const -> void;
+
+        auto GetAliasingBarriers(uint32_t passIndex) const -> std::span<const TransientAliasingBarrier>;
+
+        auto GetReport() const -> TransientMemoryReport { return m_Report; }
+
+        auto GetVkImage(uint32_t resourceID) const -> vk::Image { return *m_Resources[resourceID].pImage; }
+
+        auto GetVkBuffer(uint32_t resourceID) const -> vk::Buffer { return *m_Resources[resourceID].pBuffer; }
+
+    private:
+        auto PlaceResources(std::vector<uint32_t> const& resources) -> uint64_t;
+
+        auto Retire(Fence const& fence, std::optional<uint64_t> value) -> void;
+
+    private:
+        Device*                               m_pDevice = {};
+        std::vector<TransientResource>        m_Resources = {};
+        std::vector<vma::UniqueAllocation>    m_Allocations = {};
+        std::vector<TransientAliasingBarrier> m_AliasingBarriers = {};
+        TransientMemoryReport                 m_Report = {};
+    };
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <HAL/UploadBatcher.hpp>
+#include <HAL/Buffer.hpp>
+#include <HAL/CommandAllocator.hpp>
+#include <HAL/CommandList.hpp>
+#include <HAL/Device.hpp>
+#include <HAL/Fence.hpp>
+#include <HAL/RingBuffer.hpp>
+#include <HAL/Texture.hpp>
+#include <vulkan/vulkan_decl.h>
+#include "BufferImpl.hpp"
+
+#include <unordered_map>
+
+namespace HAL {
+
+    class UploadBatcher::Internal {
+    private:
+        struct UploadContext {
+            UploadContext(Device const& device) : TransferAllocator(device), TransferCmdList(TransferAllocator), GraphicsAllocator(device), GraphicsReleaseCmdList(GraphicsAllocator), GraphicsAcquireCmdList(GraphicsAllocator), ComputeAllocator(device), ComputeReleaseCmdList(ComputeAllocator), ComputeAcquireCmdList(ComputeAllocator) {}
+
+            TransferCommandAllocator TransferAllocator;
+            TransferCommandList      TransferCmdList;
+            GraphicsCommandAllocator GraphicsAllocator;
+            GraphicsCommandList      GraphicsReleaseCmdList;
+            GraphicsCommandList      GraphicsAcquireCmdList;
+            ComputeCommandAllocator  ComputeAllocator;
+            ComputeCommandList       ComputeReleaseCmdList;
+            ComputeCommandList       ComputeAcquireCmdList;
+            uint64_t                 TransferFenceValue = {};
+            uint64_t                 GraphicsFenceValue = {};
+            uint64_t                 ComputeFenceValue = {};
+        };
+
+        struct TextureCopies {
+            std::vector<vk::BufferImageCopy> Regions = {};
+            uint32_t                         MinMipLevel = {};
+            uint32_t                         MipLevelMask = {};
+        };
+
+        struct OwnerBarriers {
+            std::vector<vk::BufferMemoryBarrier> ReleaseBuffers = {};
+            std::vector<vk::ImageMemoryBarrier>  ReleaseImages = {};
+            std::vector<vk::ImageMemoryBarrier>  AcquireImages = {};
+            std::vector<vk::BufferMemoryBarrier> AcquireBuffers = {};
+            bool                                 IsUsed = {};
+        };
+
+        struct OwnerQueue {
+            ComputeCommandQueue* pQueue = {};
+            ComputeCommandList*  pReleaseCmdList = {};
+            ComputeCommandList*  pAcquireCmdList = {};
+            Fence*               pFence = {};
+            uint64_t*            pFenceValue = {};
+            uint32_t             QueueFamily = {};
+        };
+
+    public:
+        Internal(Device const& device, UploadBatcherCreateInfo const& createInfo);
+
+        auto WriteBuffer(Buffer const& buffer, uint64_t offset, void const* pData, uint64_t size) -> void;
+
+        auto WriteTexture(Texture& texture, TextureUploadRegion const& region, void const* pData) -> void;
+
+        auto Flush() -> uint64_t;
+
+        auto GetFence() const -> Fence const& { return m_TransferFence; }
+
+        auto GetStatistic() const -> UploadBatcherStatistic { return m_Statistic; }
+
+    private:
+        auto AllocateStaging(uint64_t size) -> std::optional<RingBufferAllocation>;
+
+        auto GetOwnerQueue(UploadContext& context, TextureOwner owner) -> OwnerQueue;
+
+        auto SubmitBarriers(OwnerQueue const& owner, ComputeCommandList& cmdList, vk::PipelineStageFlags srcStage, vk::PipelineStageFlags dstStage, std::span<const vk::BufferMemoryBarrier> bufferBarriers, std::span<const vk::ImageMemoryBarrier> imageBarriers) -> uint64_t;
+
+    private:
+        Device*                                                              m_pDevice = {};
+        uint64_t                                                             m_SegmentSize = {};
+        RingBuffer                                                           m_StagingBuffer;
+        Fence                                                                m_TransferFence;
+        Fence                                                                m_GraphicsFence;
+        Fence                                                                m_ComputeFence;
+        std::vector<std::unique_ptr<UploadContext>>                          m_Contexts = {};
+        std::unordered_map<BufferRecord const*, std::vector<vk::BufferCopy>> m_BufferCopies = {};
+        std::unordered_map<Texture::Internal*, TextureCopies>                m_TextureCopies = {};
+        uint64_t                                                             m_Alignment = {};
+        uint64_t                                                             m_StagingSize = {};
+        uint32_t                                                             m_ContextIndex = {};
+        UploadBatcherStatistic                                               m_Statistic = {};
+    };
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    struct AsyncComputeSchedulerCreateInfo {
+        uint32_t FrameCount = 3;
+    };
+
+    //Exactly one of pBuffer and pTexture is set; Layout is the layout the texture must be in while the work runs
+    struct AsyncResourceUsage {
+        Buffer const*   pBuffer = {};
+        Texture const*  pTexture = {};
+        bool            IsWrite = {};
+        vk::ImageLayout Layout = vk::ImageLayout::eGeneral;
+    };
+
+    struct AsyncComputeStatistic {
+        uint32_t GraphicsPassCount = {};
+        uint32_t ComputeJobCount = {};
+        uint32_t CrossQueueWaitCount = {};
+        uint32_t OwnershipTransferCount = {};
+        float    GraphicsTime = {};
+        float    ComputeTime = {};
+        float    OverlapTime = {};
+        float    OverlapRatio = {};
+    };
+
+    //Orders graphics passes and compute jobs by their resource usage, places compute jobs on the compute queue and
+    //inserts only the timeline waits and queue family ownership transfers the usages require. Jobs that do not
+    //touch the same resources as the graphics work are free to overlap it, including the next frame's passes, and
+    //reads that follow reads on the other queue of the same family run without a wait.
+    //The layouts the usages leave behind become the tracked states command lists resolve their transitions against
+    class AsyncComputeScheduler: NonCopyable {
+    public:
+        class Internal;
+    public:
+        AsyncComputeScheduler(Device const& device, AsyncComputeSchedulerCreateInfo const& createInfo);
+
+        AsyncComputeScheduler(AsyncComputeScheduler&&) noexcept;
+
+        AsyncComputeScheduler& operator=(AsyncComputeScheduler&&) noexcept;
+
+        ~AsyncComputeScheduler();
+
+        auto AddGraphicsPass(GraphicsCommandList const& cmdList, std::span<const AsyncResourceUsage> usages) -> void;
+
+        auto AddComputeJob(ComputeCommandList const& cmdList, std::span<const AsyncResourceUsage> usages) -> void;
+
+        //Submits everything added since the last call; both fences are signalled at the end of their streams
+        auto Execute() -> void;
+
+        auto GetGraphicsFence() const -> Fence const&;
+
+        auto GetComputeFence() const -> Fence const&;
+
+        //Counters of the last Execute and GPU timings of the most recent frame whose timestamps are available
+        auto GetStatistic() const -> AsyncComputeStatistic;
+
+    private:
+        InternalPtr<Internal, InternalSize_AsyncComputeScheduler> m_pInternal;
+    };
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+#include <functional>
+
+namespace HAL {
+
+    //IsRelocatable lets Device::Defragment move a dedicated GPU only buffer. It is a promise that the buffer is only
+    //used by work on the first graphics queue, where the moves are recorded between frames
+    struct BufferCreateInfo {
+        uint64_t             Size = {};
+        vk::BufferUsageFlags Usage = {};
+        vma::MemoryUsage     MemoryUsage = vma::MemoryUsage::eGpuOnly;
+        bool                 IsDedicated = {};
+        bool                 IsRelocatable = {};
+    };
+
+    //Called after defragmentation moved the buffer, with its views already recreated; descriptors written with the
+    //old vk::Buffer or vk::BufferView have to be rewritten
+    using BufferRelocationCallback = std::function<void(vk::Buffer buffer)>;
+
+    struct BufferViewCreateInfo {
+        uint64_t   Offset = {};
+        uint64_t   Range = {};
+        vk::Format Format = vk::Format::eUndefined;
+    };
+
+    class Buffer: NonCopyable {
+    public:
+        class Internal;
+    public:
+        Buffer(Device const& device, BufferCreateInfo const& createInfo);
+
+        Buffer(Buffer&&) noexcept;
+
+        Buffer& operator=(Buffer&&) noexcept;
+
+        ~Buffer();
+
+        auto GetCreateInfo() const -> BufferCreateInfo const&;
+
+        auto GetVkBuffer() const -> vk::Buffer;
+
+        auto GetOffset() const -> uint64_t;
+
+        auto GetSize() const -> uint64_t;
+
+        auto GetMappedData() const -> void*;
+
+        auto IsSuballocated() const -> bool;
+
+        auto AddRelocationCallback(BufferRelocationCallback&& callback) -> uint32_t;
+
+        auto RemoveRelocationCallback(uint32_t id) -> void;
+
+    private:
+        InternalPtr<Internal, InternalSize_Buffer> m_pInternal;
+    };
+
+    class BufferView: NonCopyable {
+    public:
+        class Internal;
+    public:
+        BufferView(Device const& device, Buffer const& buffer, BufferViewCreateInfo const& createInfo);
+
+        BufferView(BufferView&&) noexcept;
+
+        BufferView& operator=(BufferView&&) noexcept;
+
+        ~BufferView();
+
+        auto GetVkBuffer() const -> vk::Buffer;
+
+        auto GetVkBufferView() const -> vk::BufferView;
+
+        auto GetOffset() const -> uint64_t;
+
+        auto GetRange() const -> uint64_t;
+
+        auto GetDescriptorBufferInfo() const -> vk::DescriptorBufferInfo;
+
+    private:
+        InternalPtr<Internal, InternalSize_BufferView> m_pInternal;
+    };
+}
@@ -4,11 +4,18 @@
 
 namespace HAL {
 
+    enum class CommandAllocatorResetMode {
+        //Every list resets itself on Begin; the pool is created with eResetCommandBuffer
+        CommandList,
+        //Lists are only reset together through Reset(), which lets the driver recycle the whole pool at once
+        Pool
+    };
+
     class CommandAllocator: NonCopyable {
     public:
         class Internal;
     protected:
-        CommandAllocator(Device const& device, uint32_t indexQueueFamily);
+        CommandAllocator(Device const& device, uint32_t indexQueueFamily, CommandAllocatorResetMode resetMode);
     public:
         CommandAllocator(CommandAllocator&&) noexcept;
 
@@ -16,6 +23,9 @@ namespace HAL {
 
         ~CommandAllocator();
 
+        //Returns every list allocated from the pool to the initial state; none of them may be pending on the GPU
+        auto Reset() -> void;
+
         auto GetVkCommandPool() const -> vk::CommandPool;
 
     protected:
@@ -24,16 +34,16 @@ namespace HAL {
 
     class TransferCommandAllocator: public CommandAllocator {
     public:
-        TransferCommandAllocator(Device const& device);
+        TransferCommandAllocator(Device const& device, CommandAllocatorResetMode resetMode = CommandAllocatorResetMode::CommandList);
     };
 
     class ComputeCommandAllocator: public CommandAllocator {
     public:
-        ComputeCommandAllocator(Device const& device);
+        ComputeCommandAllocator(Device const& device, CommandAllocatorResetMode resetMode = CommandAllocatorResetMode::CommandList);
     };
 
     class GraphicsCommandAllocator: public CommandAllocator {
     public:
-        GraphicsCommandAllocator(Device const& device);
+        GraphicsCommandAllocator(Device const& device, CommandAllocatorResetMode resetMode = CommandAllocatorResetMode::CommandList);
     };
 }
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <HAL/CommandList.hpp>
+
+namespace HAL {
+
+    struct CommandAllocatorRingCreateInfo {
+        uint32_t FrameCount = 3;
+    };
+
+    //Per-frame allocators that are reset as whole pools once the frame's fence value is reached.
+    //Lists handed out stay valid until the ring wraps around to the same frame again
+    class CommandAllocatorRing: NonCopyable {
+    public:
+        class Internal;
+    public:
+        CommandAllocatorRing(Device const& device, CommandAllocatorRingCreateInfo const& createInfo);
+
+        CommandAllocatorRing(CommandAllocatorRing&&) noexcept;
+
+        CommandAllocatorRing& operator=(CommandAllocatorRing&&) noexcept;
+
+        ~CommandAllocatorRing();
+
+        auto AllocateTransferCommandList() -> TransferCommandList&;
+
+        auto AllocateComputeCommandList() -> ComputeCommandList&;
+
+        auto AllocateGraphicsCommandList(CommandListLevel level = CommandListLevel::Primary) -> GraphicsCommandList&;
+
+        auto NextFrame(Fence const& fence, std::optional<uint64_t> value = std::nullopt) -> void;
+
+    private:
+        InternalPtr<Internal, InternalSize_CommandAllocatorRing> m_pInternal;
+    };
+}
@@ -5,16 +5,29 @@
 
 namespace HAL {
 
+    enum class CommandListLevel {
+        Primary,
+        Secondary
+    };
+
     struct RenderPassBeginInfo {
         const RenderPass*                   pRenderPass = {};
         std::span<RenderPassAttachmentInfo> Attachments = {};
+        vk::SubpassContents                 Contents = vk::SubpassContents::eInline;
+    };
+
+    //State calls are shadowed and applied at the next draw or dispatch; redundant ones never reach the command buffer
+    struct CommandListStatistic {
+        uint32_t RecordedCommandCount = {};
+        uint32_t ElidedCommandCount = {};
+        uint32_t BarrierCount = {};
     };
 
     class CommandList: NonCopyable {
     public:
         class Internal;
     protected:
-        CommandList(CommandAllocator const& allocator);
+        CommandList(CommandAllocator const& allocator, CommandListLevel level = CommandListLevel::Primary);
     public:
         CommandList(CommandList&&) noexcept;
 
@@ -26,6 +39,32 @@ namespace HAL {
 
         auto End() -> void;
 
+        //Transitions are batched and recorded as one barrier right before the next command that consumes them.
+        //The first state of each resource is resolved against the state left by earlier submissions at submit time
+        auto TransitionBuffer(Buffer const& buffer, ResourceState state) -> void;
+
+        auto TransitionTexture(Texture const& texture, ResourceState state) -> void;
+
+        //Split transition: Begin is recorded right after the last use in the old state and End right before the first
+        //use in the new one, so the GPU may overlap the commands in between with the transition. The resource must not
+        //be used between the two calls, and neither may be called inside a render pass. End of the list completes
+        //every split transition that is still open
+        auto BeginTransitionBuffer(Buffer const& buffer, ResourceState state) -> void;
+
+        auto EndTransitionBuffer(Buffer const& buffer) -> void;
+
+        auto BeginTransitionTexture(Texture const& texture, ResourceState state) -> void;
+
+        auto EndTransitionTexture(Texture const& texture) -> void;
+
+        //Records pending transitions now, for commands recorded through GetVkCommandBuffer directly
+        auto FlushBarriers() -> void;
+
+        //Forgets the shadowed state after commands were recorded through GetVkCommandBuffer directly
+        auto InvalidateState() -> void;
+
+        auto GetStatistic() const -> CommandListStatistic;
+
         auto GetVkCommandBuffer() const -> vk::CommandBuffer;
 
     protected:
@@ -35,6 +74,8 @@ namespace HAL {
     class TransferCommandList: public CommandList {
     public:
         TransferCommandList(TransferCommandAllocator const& allocator);
+    protected:
+        TransferCommandList(CommandAllocator const& allocator, CommandListLevel level);
     };
 
     class ComputeCommandList: public TransferCommandList {
@@ -45,18 +86,62 @@ namespace HAL {
 
         auto SetDescriptorTable(uint32_t slot, DescriptorTable const& table) -> void;
 
+        auto SetComputeDescriptorSet(uint32_t slot, vk::DescriptorSet descriptorSet) -> void;
+
+        auto SetComputePushConstants(uint32_t offset, std::span<const std::byte> data) -> void;
+
         auto Dispatch(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ) -> void;
+
+        //Reads a vk::DispatchIndirectCommand at the offset within the buffer and moves the buffer to ResourceState::IndirectArgument
+        auto DispatchIndirect(Buffer const& buffer, uint64_t offset = 0) -> void;
+    protected:
+        ComputeCommandList(CommandAllocator const& allocator, CommandListLevel level);
     };
 
     class GraphicsCommandList: public ComputeCommandList {
     public:
-        GraphicsCommandList(GraphicsCommandAllocator const& allocator);
+        GraphicsCommandList(GraphicsCommandAllocator const& allocator, CommandListLevel level = CommandListLevel::Primary);
 
         auto BeginRenderPass(RenderPassBeginInfo const& beginInfo) -> void;
 
+        auto NextSubpass(vk::SubpassContents contents = vk::SubpassContents::eInline) -> void;
+
         auto EndRenderPass() -> void;
 
-        auto SetGraphicsPipeline(GraphicsPipeline const& pipeline, GraphicsState const& state) const -> void;
+        //Begins a secondary list that continues the render pass and subpass the primary list is currently in
+        auto BeginSecondary(GraphicsCommandList const& primary) -> void;
+
+        auto ExecuteCommands(ArraySpan<GraphicsCommandList> cmdLists) -> void;
+
+        auto ExecuteCommands(ArrayView<GraphicsCommandList> cmdLists) -> void;
+
+        //Must be called inside a render pass; the pipeline is created for the current subpass on first use
+        auto SetGraphicsPipeline(GraphicsPipeline const& pipeline, GraphicsState const& state) -> void;
+
+        auto SetGraphicsDescriptorSet(uint32_t slot, vk::DescriptorSet descriptorSet) -> void;
+
+        auto SetGraphicsPushConstants(uint32_t offset, std::span<const std::byte> data) -> void;
+
+        auto SetViewport(vk::Viewport const& viewport) -> void;
+
+        auto SetScissor(vk::Rect2D const& scissor) -> void;
+
+        auto SetVertexBuffer(uint32_t slot, Buffer const& buffer) -> void;
+
+        auto SetIndexBuffer(Buffer const& buffer, vk::IndexType indexType) -> void;
+
+        auto Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) -> void;
+
+        auto DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) -> void;
+
+        //Argument buffers are used in ResourceState::IndirectArgument. Barriers cannot be recorded inside a render pass,
+        //so a buffer written earlier in the same list must be transitioned before BeginRenderPass, or the draw asserts.
+        //A drawCount above one requires the multiDrawIndirect feature
+        auto DrawIndirect(Buffer const& buffer, uint64_t offset, uint32_t drawCount, uint32_t stride = sizeof(vk::DrawIndirectCommand)) -> void;
+
+        auto DrawIndexedIndirect(Buffer const& buffer, uint64_t offset, uint32_t drawCount, uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand)) -> void;
 
+        //The draw count is read from countBuffer on the GPU and clamped to maxDrawCount
+        auto DrawIndexedIndirectCount(Buffer const& buffer, uint64_t offset, Buffer const& countBuffer, uint64_t countOffset, uint32_t maxDrawCount, uint32_t stride = sizeof(vk::DrawIndexedIndirectCommand)) -> void;
     };
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
 
 namespace HAL {
 
@@ -12,16 +13,29 @@ namespace HAL {
        
         CommandQueue& operator=(CommandQueue&&) noexcept;        
 
+        ~CommandQueue();
+
+
         auto Signal(Fence const& fence, std::optional<uint64_t> value = std::nullopt) const -> void;
 
-        auto Wait(Fence const& fence, std::optional<uint64_t> value = std::nullopt) const -> void;
+        //Work submitted afterwards stalls only from the given stages on, the rest of it may start before the fence is reached
+        auto Wait(Fence const& fence, std::optional<uint64_t> value = std::nullopt, vk::PipelineStageFlags2KHR stages = vk::PipelineStageFlagBits2KHR::eAllCommands) const -> void;
 
         auto NextImage(SwapChain const& swapChain, Fence const& fence, std::optional<uint64_t> signalValue = std::nullopt) const -> uint32_t;
 
+        //Only acquires the image; a SubmitBatch waits on it through WaitImage instead of a separate bridging submit
+        auto AcquireNextImage(SwapChain const& swapChain) const -> uint32_t;
+
         auto Present(SwapChain const& swapChain, uint32_t frameID, Fence const& fence, std::optional<uint64_t> waitValue = std::nullopt) const -> void;
        
+        //Submits the whole batch with a single vkQueueSubmit and presents if the batch requested it
+        auto Submit(SubmitBatch const& batch) const -> void;
+
         auto WaitIdle() const -> void;
   
+        //Queued jobs plus submissions the GPU has not finished; used to pick the least loaded queue
+        auto GetOutstandingWork() const -> uint64_t;
+
         auto GetVkQueue() const -> vk::Queue;      
 
     protected:     
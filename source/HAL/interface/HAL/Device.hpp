@@ -1,11 +1,94 @@
 #pragma once
 
 #include <HAL/InternalPtr.hpp>
+#include <array>
+#include <functional>
+#include <memory>
 
 namespace HAL {
 
+    enum class MemoryPressure {
+        None,
+        Soft,
+        Hard
+    };
+
+    enum class MemoryFallbackPolicy {
+        None,
+        //Ignored on UMA devices, where no heap lies outside device local memory
+        HostMemory
+    };
+
+    struct MemoryHeapBudget {
+        uint64_t       BudgetSize = {};
+        uint64_t       UsageSize = {};
+        uint64_t       BlockSize = {};
+        uint64_t       AllocationSize = {};
+        bool           IsDeviceLocal = {};
+        MemoryPressure Pressure = {};
+    };
+
+    struct MemoryStatistic {
+        uint32_t BlockCount = {};
+        uint32_t AllocationCount = {};
+        uint64_t UsedBytes = {};
+        uint64_t UnusedBytes = {};
+    };
+
+    struct DefragmentationInfo {
+        uint64_t MaxBytesPerFrame = 16 << 20;
+        uint32_t MaxAllocationsPerFrame = 64;
+    };
+
+    struct DefragmentationStatistic {
+        uint64_t BytesMoved = {};
+        uint64_t BytesFreed = {};
+        uint32_t AllocationsMoved = {};
+        uint32_t BlocksFreed = {};
+    };
+
+    enum class MemoryEventType {
+        Allocate,
+        Free
+    };
+
+    struct MemoryEvent {
+        double          TimePoint = {};
+        uint64_t        Size = {};
+        uint64_t        HeapUsage = {};
+        uint32_t        HeapIndex = {};
+        MemoryEventType Type = {};
+    };
+
+    struct MemoryHeapSnapshot {
+        uint64_t HeapSize = {};
+        uint64_t UsedBytes = {};
+        uint64_t PeakBytes = {};
+        uint64_t AllocatedBytes = {};
+        uint64_t FreedBytes = {};
+        uint32_t AllocationCount = {};
+        bool     IsDeviceLocal = {};
+    };
+
+    struct MemorySnapshot {
+        static constexpr uint32_t MaxHeapCount = 16;
+
+        std::array<MemoryHeapSnapshot, MaxHeapCount> Heaps = {};
+        uint32_t                                      HeapCount = {};
+        uint64_t                                      EventSequence = {};
+        double                                        TimePoint = {};
+    };
+
+    using MemoryPressureCallback = std::function<void(uint32_t heapIndex, MemoryHeapBudget const& budget)>;
+
     struct DeviceCreateInfo {    
-      
+        float              MemorySoftThreshold = 0.80f;
+        float              MemoryHardThreshold = 0.95f;
+        std::vector<float> GraphicsQueuePriorities = {};
+        std::vector<float> ComputeQueuePriorities = {};
+        std::vector<float> TransferQueuePriorities = {};
+        //Opt-in VK_KHR_synchronization2: queue waits use 64-bit stage masks and split barriers use vkCmdSetEvent2
+        bool               IsSynchronization2Enabled = {};
     };
     
     class Device: NonCopyable {
@@ -20,13 +103,52 @@ namespace HAL {
 
         ~Device();
         
-        auto GetTransferCommandQueue() -> TransferCommandQueue const&;
+        auto GetTransferCommandQueue(uint32_t index = 0) -> TransferCommandQueue const&;
                                      
-        auto GetComputeCommandQueue()  -> ComputeCommandQueue const&;  
+        auto GetComputeCommandQueue(uint32_t index = 0)  -> ComputeCommandQueue const&;  
                                      
-        auto GetGraphicsCommandQueue() -> GraphicsCommandQueue const&;
+        auto GetGraphicsCommandQueue(uint32_t index = 0) -> GraphicsCommandQueue const&;
+
+        auto GetTransferCommandQueueCount() const -> uint32_t;
+
+        auto GetComputeCommandQueueCount() const -> uint32_t;
+
+        auto GetGraphicsCommandQueueCount() const -> uint32_t;
+
+        //Returns the queue of the family with the least outstanding work
+        auto AcquireTransferCommandQueue() -> TransferCommandQueue const&;
+
+        auto AcquireComputeCommandQueue() -> ComputeCommandQueue const&;
+
+        auto AcquireGraphicsCommandQueue() -> GraphicsCommandQueue const&;
       
         auto WaitIdle() -> void;
+
+        auto NextFrame() -> void;
+
+        auto ReleaseDeferred(std::function<void()>&& release, Fence const& fence, std::optional<uint64_t> value = std::nullopt) -> void;
+
+        template<typename T>
+        auto DestroyDeferred(T&& object, Fence const& fence, std::optional<uint64_t> value = std::nullopt) -> void;
+
+        //Returns a snapshot; the budgets are refreshed by NextFrame
+        auto GetMemoryBudget() const -> std::vector<MemoryHeapBudget>;
+
+        auto AddMemoryPressureCallback(MemoryPressureCallback&& callback) -> uint32_t;
+
+        auto RemoveMemoryPressureCallback(uint32_t callbackID) -> void;
+
+        //Runs one bounded pass over buffers created with BufferCreateInfo::IsRelocatable; images are never relocated.
+        //The moves are queued on the graphics queue behind the work already submitted, and the memory they vacate is
+        //freed by a later call once they finished, so it never blocks; a call while a pass is in flight does nothing.
+        //The old buffer handles retire once the fence reaches the value, the last frame that used them
+        auto Defragment(Fence const& fence, std::optional<uint64_t> value = std::nullopt, DefragmentationInfo const& info = {}) -> DefragmentationStatistic;
+
+        auto GetMemoryStatistic() const -> MemoryStatistic;
+
+        auto GetMemorySnapshot() const -> MemorySnapshot;
+
+        auto ReadMemoryEvents(uint64_t sequence, std::vector<MemoryEvent>& events) const -> uint64_t;
          
         auto GetVkDevice() const -> vk::Device;
 
@@ -40,4 +162,12 @@ namespace HAL {
         InternalPtr<Internal, InternalSize_Device> m_pInternal;   
     };
 }
- 
\ No newline at end of file
+
+namespace HAL {
+
+    template<typename T>
+    inline auto Device::DestroyDeferred(T&& object, Fence const& fence, std::optional<uint64_t> value) -> void {
+        auto pObject = std::make_shared<std::decay_t<T>>(std::forward<T>(object));
+        this->ReleaseDeferred([pObject]() mutable { pObject.reset(); }, fence, value);
+    }
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+#include <functional>
+
+namespace HAL {
+
+    struct FrameGraphCreateInfo {
+        uint32_t FrameCount = 3;
+    };
+
+    enum class FrameGraphQueue: uint32_t {
+        Graphics,
+        //Falls back to the graphics queue when the device has no separate compute family
+        AsyncCompute
+    };
+
+    struct FrameGraphResource {
+        uint32_t Index = std::numeric_limits<uint32_t>::max();
+    };
+
+    //A pass writes a resource when the state is one of the writable ones: General, UnorderedAccess, RenderTarget, DepthWrite or CopyDest
+    struct FrameGraphResourceUsage {
+        FrameGraphResource Resource = {};
+        ResourceState      State = ResourceState::Undefined;
+    };
+
+    //Each resource appears at most once in the usages of a pass. Passes without side effects whose writes are never
+    //read by a pass that survives, or by an output, are culled
+    struct FrameGraphPassCreateInfo {
+        std::string_view                         Name = {};
+        FrameGraphQueue                          Queue = FrameGraphQueue::Graphics;
+        std::span<const FrameGraphResourceUsage> Usages = {};
+        bool                                     HasSideEffects = {};
+    };
+
+    //pGraphicsCmdList is null for passes that run on the compute queue. The list is begun and every declared resource
+    //is already in its state; the executor must not transition declared resources itself
+    struct FrameGraphPassContext {
+        GraphicsCommandList* pGraphicsCmdList = {};
+        ComputeCommandList*  pComputeCmdList = {};
+        uint32_t             PassIndex = {};
+    };
+
+    //Called on the thread that executes the frame, one call per pass that survives culling, in execution order
+    using FrameGraphPassExecutor = std::function<void(FrameGraphPassContext const& context)>;
+
+    struct FrameGraphExecuteInfo {
+        SwapChain const* pSwapChain = {};
+        uint32_t         FrameID = {};
+    };
+
+    struct FrameGraphStatistic {
+        uint32_t PassCount = {};
+        uint32_t CulledPassCount = {};
+        uint32_t AsyncComputePassCount = {};
+        uint32_t BarrierCount = {};
+        uint32_t CrossQueueWaitCount = {};
+        uint32_t TransientResourceCount = {};
+        float    CompileTime = {};
+        float    RecordTime = {};
+    };
+
+    //Passes are declared every frame. Compile orders them by the dependencies their usages imply, keeping declaration
+    //order among independent passes, and asserts on a dependency cycle or when a pass reads a transient resource no
+    //pass wrote. It culls unreferenced passes, places transient resources in aliased memory, assigns queues and derives
+    //every barrier, queue family ownership transfer and cross-queue wait from the declared usages. Execute records the
+    //passes into one list each and submits them.
+    //Imported resources start and end the frame owned by the graphics queue family
+    class FrameGraph: NonCopyable {
+    public:
+        class Internal;
+    public:
+        FrameGraph(Device const& device, FrameGraphCreateInfo const& createInfo);
+
+        FrameGraph(FrameGraph&&) noexcept;
+
+        FrameGraph& operator=(FrameGraph&&) noexcept;
+
+        ~FrameGraph();
+
+        auto ImportBuffer(Buffer const& buffer) -> FrameGraphResource;
+
+        auto ImportTexture(Texture const& texture) -> FrameGraphResource;
+
+        //Transient resources live for the frame only; the sharing mode and queue families are chosen by the graph
+        auto CreateBuffer(vk::BufferCreateInfo const& createInfo) -> FrameGraphResource;
+
+        auto CreateTexture(vk::ImageCreateInfo const& createInfo) -> FrameGraphResource;
+
+        //Keeps the passes that produce the resource alive; passes that render to the swap chain use HasSideEffects instead
+        auto MarkOutput(FrameGraphResource resource) -> void;
+
+        auto AddPass(FrameGraphPassCreateInfo const& createInfo, FrameGraphPassExecutor&& executor) -> void;
+
+        //Reads the current states of imported resources, so no other work on them may be submitted before Execute
+        auto Compile() -> void;
+
+        //Records and submits the compiled passes and clears the declarations for the next frame
+        auto Execute(FrameGraphExecuteInfo const& executeInfo = {}) -> void;
+
+        //Valid between Compile and Execute, and inside the pass executors
+        auto GetVkBuffer(FrameGraphResource resource) const -> vk::Buffer;
+
+        auto GetVkImage(FrameGraphResource resource) const -> vk::Image;
+
+        auto GetGraphicsFence() const -> Fence const&;
+
+        auto GetComputeFence() const -> Fence const&;
+
+        auto GetStatistic() const -> FrameGraphStatistic;
+
+    private:
+        InternalPtr<Internal, InternalSize_FrameGraph> m_pInternal;
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <HAL/InternalPtr.hpp>
+#include <array>
 
 namespace HAL {
 
@@ -9,6 +10,43 @@ namespace HAL {
         bool IsEnableDebugUtils = {};
     };    
 
+    enum class HostMemoryTag: uint32_t {
+        Instance,
+        Device,
+        SwapChain,
+        Command,
+        Pipeline,
+        Descriptor,
+        RenderPass,
+        Resource,
+        Synchronization,
+        Count
+    };
+
+    enum class HostMemoryScope: uint32_t {
+        Command,
+        Object,
+        Cache,
+        Device,
+        Instance,
+        Count
+    };
+
+    struct HostMemoryCounter {
+        uint64_t AllocatedBytes = {};
+        uint64_t PeakBytes = {};
+        uint64_t AllocationCount = {};
+        uint64_t TotalAllocationCount = {};
+    };
+
+    struct HostMemoryStatistic {
+        std::array<HostMemoryCounter, static_cast<size_t>(HostMemoryTag::Count)>   Tags = {};
+        std::array<HostMemoryCounter, static_cast<size_t>(HostMemoryScope::Count)> Scopes = {};
+        uint64_t ArenaReservedBytes = {};
+        uint64_t PoolReservedBytes = {};
+        uint64_t InternalAllocatedBytes = {};
+    };
+
     class Instance: NonCopyable {
     public:
         class Internal;
@@ -25,6 +63,8 @@ namespace HAL {
 
         auto GetAdapters() const -> std::vector<HAL::Adapter> const&;
 
+        auto GetHostMemoryStatistic() const -> HostMemoryStatistic;
+
     private:    
         InternalPtr<Internal, InternalSize_Instance> m_pInternal;   
     };
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    struct InstanceCullerCreateInfo {
+        ShaderCompiler const* pCompiler = {};
+        std::wstring_view     ShaderPath = L"content/shaders/InstanceCulling.hlsl";
+        uint32_t              FrameCount = 3;
+    };
+
+    //Element of the instance buffer; matches CullInstance in content/shaders/InstanceCulling.hlsl
+    struct CullInstance {
+        float    BoundingSphere[4] = {};
+        uint32_t IndexCount = {};
+        uint32_t FirstIndex = {};
+        int32_t  VertexOffset = {};
+        uint32_t Padding = {};
+    };
+
+    //View space looks down +Z with Y up. The projection is symmetric, so it is described by P00 and P11, and
+    //depth = P22 + P23 / z, growing from 0 at the near to 1 at the far plane. The depth pyramid holds the farthest depth of
+    //each texel with row 0 at the top of the screen
+    struct InstanceCullingCamera {
+        float View[3][4] = {};
+        float P00 = {};
+        float P11 = {};
+        float P22 = {};
+        float P23 = {};
+        float ZNear = {};
+        float ZFar = {};
+    };
+
+    //Instances are read in ResourceState::ShaderResource. The three outputs are left in ResourceState::UnorderedAccess
+    //and hold InstanceCount elements; pDrawCount holds one uint32_t. Without a depth pyramid only the frustum is tested
+    struct InstanceCullingInfo {
+        Buffer const*         pInstances = {};
+        Buffer const*         pVisibleInstances = {};
+        Buffer const*         pDrawArguments = {};
+        Buffer const*         pDrawCount = {};
+        Texture const*        pDepthPyramid = {};
+        TextureView const*    pDepthPyramidView = {};
+        uint32_t              InstanceCount = {};
+        InstanceCullingCamera Camera = {};
+    };
+
+    //Culls instances by their bounding spheres on the GPU and compacts the survivors into vk::DrawIndexedIndirectCommand
+    //arguments, one draw per instance with FirstInstance set to the instance index, for DrawIndexedIndirectCount
+    class InstanceCuller: NonCopyable {
+    public:
+        class Internal;
+    public:
+        InstanceCuller(Device const& device, InstanceCullerCreateInfo const& createInfo);
+
+        InstanceCuller(InstanceCuller&&) noexcept;
+
+        InstanceCuller& operator=(InstanceCuller&&) noexcept;
+
+        ~InstanceCuller();
+
+        auto Cull(ComputeCommandList& cmdList, InstanceCullingInfo const& cullingInfo) -> void;
+
+        //Descriptor sets of a frame are recycled once the fence reaches the value, as in CommandAllocatorRing
+        auto NextFrame(Fence const& fence, std::optional<uint64_t> value = std::nullopt) -> void;
+
+    private:
+        InternalPtr<Internal, InternalSize_InstanceCuller> m_pInternal;
+    };
+}
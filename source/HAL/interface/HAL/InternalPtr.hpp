@@ -95,30 +95,64 @@ namespace HAL {
 #ifdef _DEBUG
     constexpr size_t InternalSize_Adapter = 2632;
     constexpr size_t InternalSize_Instance = 128;
-    constexpr size_t InternalSize_Device = 184;
+    constexpr size_t InternalSize_Device = 208;
     constexpr size_t InternalSize_SwapChain = 360;
     constexpr size_t InternalSize_Fence = 40;
     constexpr size_t InternalSize_CommandQueue = 8;
-    constexpr size_t InternalSize_CommandAllocator = 40;
-    constexpr size_t InternalSize_CommandList = 56;
+    constexpr size_t InternalSize_SubmitBatch = 48;
+    constexpr size_t InternalSize_CommandAllocator = 48;
+    constexpr size_t InternalSize_CommandAllocatorRing = 48;
+    constexpr size_t InternalSize_CommandList = 936;
     constexpr size_t InternalSize_RenderPass = 144;
     constexpr size_t InternalSize_ShaderCompiler = 56;
     constexpr size_t InternalSize_Pipeline = 152;
     constexpr size_t InternalSize_DescriptorTableLayout = 112;
+    constexpr size_t InternalSize_RingBuffer = 112;
+    constexpr size_t InternalSize_MemoryPool = 64;
+    constexpr size_t InternalSize_TransientResourcePlanner = 128;
+    constexpr size_t InternalSize_Buffer = 40;
+    constexpr size_t InternalSize_BufferView = 32;
+    constexpr size_t InternalSize_Texture = 104;
+    constexpr size_t InternalSize_TextureView = 56;
+    constexpr size_t InternalSize_TextureStreamer = 360;
+    constexpr size_t InternalSize_UploadBatcher = 480;
+    constexpr size_t InternalSize_TextureContainer = 32;
+    constexpr size_t InternalSize_ReadbackQueue = 40;
+    constexpr size_t InternalSize_ParallelCommandRecorder = 8;
+    constexpr size_t InternalSize_AsyncComputeScheduler = 248;
+    constexpr size_t InternalSize_InstanceCuller = 64;
+    constexpr size_t InternalSize_FrameGraph = 480;
 #else
     constexpr size_t InternalSize_Adapter = 2616;
     constexpr size_t InternalSize_Instance = 104;
-    constexpr size_t InternalSize_Device = 160;
+    constexpr size_t InternalSize_Device = 184;
     constexpr size_t InternalSize_SwapChain = 320;
     constexpr size_t InternalSize_Fence = 40;
     constexpr size_t InternalSize_Compiler = 64;
     constexpr size_t InternalSize_CommandQueue = 8;
-    constexpr size_t InternalSize_CommandAllocator = 40;
-    constexpr size_t InternalSize_CommandList = 56;
+    constexpr size_t InternalSize_SubmitBatch = 40;
+    constexpr size_t InternalSize_CommandAllocator = 48;
+    constexpr size_t InternalSize_CommandAllocatorRing = 40;
+    constexpr size_t InternalSize_CommandList = 896;
     constexpr size_t InternalSize_RenderPass = 120;
     constexpr size_t InternalSize_ShaderCompiler = 56;
     constexpr size_t InternalSize_Pipeline = 128;
     constexpr size_t InternalSize_DescriptorTableLayout = 96;
+    constexpr size_t InternalSize_RingBuffer = 104;
+    constexpr size_t InternalSize_MemoryPool = 56;
+    constexpr size_t InternalSize_TransientResourcePlanner = 104;
+    constexpr size_t InternalSize_Buffer = 40;
+    constexpr size_t InternalSize_BufferView = 32;
+    constexpr size_t InternalSize_Texture = 104;
+    constexpr size_t InternalSize_TextureView = 56;
+    constexpr size_t InternalSize_TextureStreamer = 336;
+    constexpr size_t InternalSize_UploadBatcher = 432;
+    constexpr size_t InternalSize_TextureContainer = 32;
+    constexpr size_t InternalSize_ReadbackQueue = 32;
+    constexpr size_t InternalSize_ParallelCommandRecorder = 8;
+    constexpr size_t InternalSize_AsyncComputeScheduler = 216;
+    constexpr size_t InternalSize_InstanceCuller = 56;
+    constexpr size_t InternalSize_FrameGraph = 392;
 #endif
 }
 
@@ -134,11 +168,13 @@ namespace HAL {
     class TransferCommandQueue;
     class ComputeCommandQueue;
     class GraphicsCommandQueue;
+    class SubmitBatch;
 
     class CommandAllocator;
     class TransferCommandAllocator;
     class ComputeCommandAllocator;
     class GraphicsCommandAllocator;
+    class CommandAllocatorRing;
     
     class CommandList;
     class TransferCommandList;
@@ -149,6 +185,21 @@ namespace HAL {
     class ComputePipeline;
     class DescriptorTable;
     class DescriptorTableLayout;
+    class RingBuffer;
+    class MemoryPool;
+    class TransientResourcePlanner;
+    class Buffer;
+    class BufferView;
+    class ReadbackQueue;
+    class ParallelCommandRecorder;
+    class AsyncComputeScheduler;
+    class InstanceCuller;
+    class FrameGraph;
+    class Texture;
+    class TextureView;
+    class TextureContainer;
+    class TextureStreamer;
+    class UploadBatcher;
        
 }
 
@@ -203,6 +254,24 @@ namespace HAL {
         Compute
     };
 
+    //How a command uses a buffer or texture; command lists derive stages, access masks and image layouts from it
+    enum class ResourceState: uint32_t {
+        Undefined,
+        General,
+        VertexBuffer,
+        IndexBuffer,
+        UniformBuffer,
+        IndirectArgument,
+        ShaderResource,
+        UnorderedAccess,
+        RenderTarget,
+        DepthWrite,
+        DepthRead,
+        CopySource,
+        CopyDest,
+        Present
+    };
+
     struct PipelineResource {
         uint32_t                SetID = {};
         uint32_t                BindingID = {};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    enum class MemoryPoolAlgorithm {
+        Default,
+        Linear,
+        Buddy
+    };
+
+    struct MemoryPoolCreateInfo {
+        std::string          Name = {};
+        MemoryPoolAlgorithm  Algorithm = {};
+        vma::MemoryUsage     MemoryUsage = {};
+        vk::BufferUsageFlags BufferUsage = {};
+        vk::ImageUsageFlags  ImageUsage = {};
+        vk::Format           ImageFormat = {};
+        uint64_t             BlockSize = {};
+        uint32_t             MinBlockCount = {};
+        uint32_t             MaxBlockCount = {};
+    };
+
+    struct MemoryPoolStatistic {
+        uint64_t Size = {};
+        uint64_t UnusedSize = {};
+        uint64_t AllocationCount = {};
+        uint64_t BlockCount = {};
+    };
+
+    class MemoryPool: NonCopyable {
+    public:
+        class Internal;
+    public:
+        MemoryPool(Device const& device, MemoryPoolCreateInfo const& createInfo);
+
+        MemoryPool(MemoryPool&&) noexcept;
+
+        MemoryPool& operator=(MemoryPool&&) noexcept;
+
+        ~MemoryPool();
+
+        auto GetName() const -> std::string const&;
+
+        auto GetStatistic() const -> MemoryPoolStatistic;
+
+        //Null when the pool could not be created, allocations then come from the default pools
+        auto GetVmaPool() const -> vma::Pool;
+
+        auto IsValid() const -> bool;
+
+    private:
+        InternalPtr<Internal, InternalSize_MemoryPool> m_pInternal;
+    };
+}
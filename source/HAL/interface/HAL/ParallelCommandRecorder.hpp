@@ -0,0 +1,39 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <functional>
+
+namespace HAL {
+
+    struct ParallelCommandRecorderCreateInfo {
+        uint32_t ThreadCount = 0;
+        uint32_t FrameCount = 3;
+    };
+
+    //Called concurrently from several threads; the list is already begun as a secondary list of the primary
+    using CommandChunkRecorder = std::function<void(GraphicsCommandList& cmdList, uint32_t chunkIndex)>;
+
+    class ParallelCommandRecorder: NonCopyable {
+    public:
+        class Internal;
+    public:
+        ParallelCommandRecorder(Device const& device, ParallelCommandRecorderCreateInfo const& createInfo);
+
+        ParallelCommandRecorder(ParallelCommandRecorder&&) noexcept;
+
+        ParallelCommandRecorder& operator=(ParallelCommandRecorder&&) noexcept;
+
+        ~ParallelCommandRecorder();
+
+        //Records the chunks into secondary lists on the worker threads and executes them in chunk order inside the primary.
+        //The primary must be inside a render pass begun with vk::SubpassContents::eSecondaryCommandBuffers
+        auto Record(GraphicsCommandList& primary, uint32_t chunkCount, CommandChunkRecorder const& recorder) -> void;
+
+        auto NextFrame(Fence const& fence, std::optional<uint64_t> value = std::nullopt) -> void;
+
+        auto GetThreadCount() const -> uint32_t;
+
+    private:
+        InternalPtr<Internal, InternalSize_ParallelCommandRecorder> m_pInternal;
+    };
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+#include <functional>
+
+namespace HAL {
+
+    struct ReadbackQueueCreateInfo {
+        uint64_t RingSize = 4 << 20;
+    };
+
+    //Invoked on the watcher thread; the span is only valid for the duration of the call
+    using ReadbackCallback = std::function<void(std::span<const uint8_t> data)>;
+
+    class ReadbackQueue: NonCopyable {
+    public:
+        class Internal;
+    public:
+        ReadbackQueue(Device const& device, ReadbackQueueCreateInfo const& createInfo);
+
+        ReadbackQueue(ReadbackQueue&&) noexcept;
+
+        ReadbackQueue& operator=(ReadbackQueue&&) noexcept;
+
+        ~ReadbackQueue();
+
+        //Records a copy into the readback ring; returns false without blocking when the ring is full
+        auto ReadBuffer(ComputeCommandList& cmdList, Buffer const& buffer, uint64_t offset, uint64_t size, ReadbackCallback&& callback) -> bool;
+
+        //Hands the reads recorded since the last commit to the watcher, which fires them once the fence reaches the value
+        auto Commit(Fence const& fence, uint64_t value) -> void;
+
+        auto GetPendingCount() const -> uint32_t;
+
+    private:
+        InternalPtr<Internal, InternalSize_ReadbackQueue> m_pInternal;
+    };
+}
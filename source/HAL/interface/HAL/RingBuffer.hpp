@@ -0,0 +1,44 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    struct RingBufferCreateInfo {
+        uint64_t          SegmentSize = {};
+        uint32_t          SegmentCount = {};
+        MemoryPool const* pMemoryPool = {};
+    };
+
+    struct RingBufferAllocation {
+        vk::Buffer Buffer = {};
+        uint64_t   Offset = {};
+        uint64_t   Size = {};
+        void*      pData = {};
+    };
+
+    class RingBuffer: NonCopyable {
+    public:
+        class Internal;
+    public:
+        RingBuffer(Device const& device, RingBufferCreateInfo const& createInfo);
+
+        RingBuffer(RingBuffer&&) noexcept;
+
+        RingBuffer& operator=(RingBuffer&&) noexcept;
+
+        ~RingBuffer();
+
+        auto Allocate(uint64_t size, uint64_t alignment) -> std::optional<RingBufferAllocation>;
+
+        auto Push(void const* pData, uint64_t size, uint64_t alignment) -> std::optional<RingBufferAllocation>;
+
+        auto NextFrame(Fence const& fence, std::optional<uint64_t> value = std::nullopt) -> void;
+
+        auto GetVkBuffer() const -> vk::Buffer;
+
+    private:
+        InternalPtr<Internal, InternalSize_RingBuffer> m_pInternal;
+    };
+}
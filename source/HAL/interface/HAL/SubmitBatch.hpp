@@ -0,0 +1,49 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    //Accumulates waits, command lists and signals in submission order and folds them into as few
+    //VkSubmitInfos as the ordering allows; a new submission only starts when a wait follows work
+    //or work follows a signal
+    class SubmitBatch: NonCopyable {
+    public:
+        class Internal;
+    public:
+        SubmitBatch();
+
+        SubmitBatch(SubmitBatch&&) noexcept;
+
+        SubmitBatch& operator=(SubmitBatch&&) noexcept;
+
+        ~SubmitBatch();
+
+        auto Wait(Fence const& fence, std::optional<uint64_t> value = std::nullopt, vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eAllCommands) -> SubmitBatch&;
+
+        //Stages only synchronization2 knows are widened to all commands when the device runs the legacy path
+        auto Wait(Fence const& fence, std::optional<uint64_t> value, vk::PipelineStageFlags2KHR stages) -> SubmitBatch&;
+
+        //Waits on the binary semaphore of the image acquired by CommandQueue::AcquireNextImage
+        auto WaitImage(SwapChain const& swapChain, vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eColorAttachmentOutput) -> SubmitBatch&;
+
+        auto WaitImage(SwapChain const& swapChain, vk::PipelineStageFlags2KHR stages) -> SubmitBatch&;
+
+        auto Execute(CommandList const& cmdList) -> SubmitBatch&;
+
+        auto Execute(ArraySpan<CommandList> cmdLists) -> SubmitBatch&;
+
+        auto Signal(Fence const& fence, std::optional<uint64_t> value = std::nullopt) -> SubmitBatch&;
+
+        //Signals the present semaphore from the last submission and presents right after the batch is submitted
+        auto Present(SwapChain const& swapChain, uint32_t frameID) -> SubmitBatch&;
+
+        auto Reset() -> void;
+
+        auto IsEmpty() const -> bool;
+
+    private:
+        InternalPtr<Internal, InternalSize_SubmitBatch> m_pInternal;
+    };
+}
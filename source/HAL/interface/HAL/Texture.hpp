@@ -0,0 +1,78 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    enum class TextureOwner {
+        Graphics,
+        Compute
+    };
+
+    struct TextureCreateInfo {
+        vk::ImageType       Type = vk::ImageType::e2D;
+        vk::Format          Format = vk::Format::eUndefined;
+        uint32_t            Width = 1;
+        uint32_t            Height = 1;
+        uint32_t            Depth = 1;
+        uint32_t            ArraySize = 1;
+        uint32_t            MipLevels = 1;
+        vk::ImageUsageFlags Usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst;
+        TextureOwner        Owner = TextureOwner::Graphics;
+    };
+
+    struct TextureViewCreateInfo {
+        vk::ImageViewType ViewType = vk::ImageViewType::e2D;
+        vk::Format        Format = vk::Format::eUndefined;
+        uint32_t          BaseMipLevel = {};
+        uint32_t          MipLevelCount = VK_REMAINING_MIP_LEVELS;
+        uint32_t          BaseArrayLayer = {};
+        uint32_t          ArrayLayerCount = VK_REMAINING_ARRAY_LAYERS;
+    };
+
+    class Texture: NonCopyable {
+    public:
+        class Internal;
+    public:
+        Texture(Device const& device, TextureCreateInfo const& createInfo);
+
+        Texture(Texture&&) noexcept;
+
+        Texture& operator=(Texture&&) noexcept;
+
+        ~Texture();
+
+        auto GetCreateInfo() const -> TextureCreateInfo const&;
+
+        auto GetVkImage() const -> vk::Image;
+
+        //Most detailed mip level that may be sampled; equals MipLevels while nothing is resident
+        auto GetResidentMipLevel() const -> uint32_t;
+
+    private:
+        InternalPtr<Internal, InternalSize_Texture> m_pInternal;
+    };
+
+    class TextureView: NonCopyable {
+    public:
+        class Internal;
+    public:
+        TextureView(Device const& device, Texture const& texture, TextureViewCreateInfo const& createInfo);
+
+        TextureView(TextureView&&) noexcept;
+
+        TextureView& operator=(TextureView&&) noexcept;
+
+        ~TextureView();
+
+        auto GetCreateInfo() const -> TextureViewCreateInfo const&;
+
+        auto GetVkImageView() const -> vk::ImageView;
+
+        auto GetDescriptorImageInfo() const -> vk::DescriptorImageInfo;
+
+    private:
+        InternalPtr<Internal, InternalSize_TextureView> m_pInternal;
+    };
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <HAL/Texture.hpp>
+#include <HAL/TextureStreamer.hpp>
+#include <filesystem>
+
+namespace HAL {
+
+    //File layout: header, subresource table indexed by (mipLevel * ArraySize + arrayLayer), then texel data.
+    //Texel data is stored in the final GPU format with tightly packed rows, smallest mip level first.
+    struct TextureContainerHeader {
+        static constexpr uint32_t MagicValue = 0x58455456;
+        static constexpr uint32_t VersionValue = 1;
+        static constexpr uint64_t DataAlignment = 4096;
+        static constexpr uint64_t SubresourceAlignment = 16;
+
+        uint32_t Magic = MagicValue;
+        uint32_t Version = VersionValue;
+        uint32_t Format = {};
+        uint32_t Type = {};
+        uint32_t Width = {};
+        uint32_t Height = {};
+        uint32_t Depth = {};
+        uint32_t ArraySize = {};
+        uint32_t MipLevels = {};
+        uint32_t Reserved = {};
+        uint64_t DataOffset = {};
+        uint64_t DataSize = {};
+    };
+
+    struct TextureContainerSubresource {
+        uint64_t Offset = {};
+        uint64_t Size = {};
+    };
+
+    class TextureContainer: NonCopyable {
+    public:
+        class Internal;
+    public:
+        TextureContainer(std::filesystem::path const& path);
+
+        TextureContainer(TextureContainer&&) noexcept;
+
+        TextureContainer& operator=(TextureContainer&&) noexcept;
+
+        ~TextureContainer();
+
+        auto IsValid() const -> bool;
+
+        auto GetTextureCreateInfo() const -> TextureCreateInfo;
+
+        auto GetSubresourceData(uint32_t mipLevel, uint32_t arrayLayer) const -> std::span<const uint8_t>;
+
+        //Copies mapped pages straight into staging memory; the container must outlive the streaming request
+        auto GetMipWriter() const -> TextureMipWriter;
+
+    private:
+        InternalPtr<Internal, InternalSize_TextureContainer> m_pInternal;
+    };
+}
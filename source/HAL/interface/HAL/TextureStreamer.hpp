@@ -0,0 +1,52 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+#include <functional>
+
+namespace HAL {
+
+    struct TextureStreamerCreateInfo {
+        uint64_t StagingSegmentSize = 16 << 20;
+        uint32_t StagingSegmentCount = 3;
+        uint64_t MipTailSize = 64 << 10;
+    };
+
+    struct TextureStreamerStatistic {
+        uint64_t UploadedBytes = {};
+        uint32_t UploadedMipCount = {};
+        uint32_t PendingRequestCount = {};
+    };
+
+    //Fills tightly packed texel blocks of one subresource directly in staging memory
+    using TextureMipWriter = std::function<void(uint32_t mipLevel, uint32_t arrayLayer, std::span<uint8_t> data)>;
+
+    class TextureStreamer: NonCopyable {
+    public:
+        class Internal;
+    public:
+        TextureStreamer(Device const& device, TextureStreamerCreateInfo const& createInfo);
+
+        TextureStreamer(TextureStreamer&&) noexcept;
+
+        TextureStreamer& operator=(TextureStreamer&&) noexcept;
+
+        ~TextureStreamer();
+
+        auto Request(Texture& texture, TextureMipWriter&& writer, float priority = 0.0f) -> void;
+
+        auto SetPriority(Texture const& texture, float priority) -> void;
+
+        auto Cancel(Texture const& texture) -> void;
+
+        //Never blocks on the GPU. Staged mips become resident in a later Update, once their copies are polled as complete
+        auto Update() -> uint64_t;
+
+        auto GetFence() const -> Fence const&;
+
+        auto GetStatistic() const -> TextureStreamerStatistic;
+
+    private:
+        InternalPtr<Internal, InternalSize_TextureStreamer> m_pInternal;
+    };
+}
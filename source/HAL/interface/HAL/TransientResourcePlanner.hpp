@@ -0,0 +1,70 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    struct TransientImageCreateInfo {
+        vk::ImageCreateInfo ImageCI = {};
+        vk::ImageLayout     InitialLayout = vk::ImageLayout::eGeneral;
+        uint32_t            FirstPass = {};
+        uint32_t            LastPass = {};
+    };
+
+    struct TransientBufferCreateInfo {
+        vk::BufferCreateInfo BufferCI = {};
+        uint32_t             FirstPass = {};
+        uint32_t             LastPass = {};
+    };
+
+    struct TransientAliasingBarrier {
+        uint32_t PassIndex = {};
+        uint32_t ResourceID = {};
+    };
+
+    //PeakMemoryUnaliased is the memory of every resource in its own allocation, PeakMemoryAliased the memory of the shared heaps
+    struct TransientMemoryReport {
+        uint64_t PeakMemoryUnaliased = {};
+        uint64_t PeakMemoryAliased = {};
+        uint32_t ResourceCount = {};
+        uint32_t AllocationCount = {};
+    };
+
+    class TransientResourcePlanner: NonCopyable {
+    public:
+        class Internal;
+    public:
+        TransientResourcePlanner(Device const& device);
+
+        TransientResourcePlanner(TransientResourcePlanner&&) noexcept;
+
+        TransientResourcePlanner& operator=(TransientResourcePlanner&&) noexcept;
+
+        ~TransientResourcePlanner();
+
+        auto AddImage(TransientImageCreateInfo const& createInfo) -> uint32_t;
+
+        auto AddBuffer(TransientBufferCreateInfo const& createInfo) -> uint32_t;
+
+        //Images, buffers and memory of the previous Compile are retired once the fence reaches the value,
+        //so frames recorded against the previous layout may still be in flight. When the memory cannot be allocated
+        //nothing of this Compile is kept and the report is empty
+        auto Compile(Fence const& fence, std::optional<uint64_t> value = std::nullopt) -> TransientMemoryReport;
+
+        auto Reset(Fence const& fence, std::optional<uint64_t> value = std::nullopt) -> void;
+
+        auto RecordAliasingBarriers(CommandList& cmdList, uint32_t passIndex) const -> void;
+
+        auto GetAliasingBarriers(uint32_t passIndex) const -> std::span<const TransientAliasingBarrier>;
+
+        auto GetReport() const -> TransientMemoryReport;
+
+        auto GetVkImage(uint32_t resourceID) const -> vk::Image;
+
+        auto GetVkBuffer(uint32_t resourceID) const -> vk::Buffer;
+
+    private:
+        InternalPtr<Internal, InternalSize_TransientResourcePlanner> m_pInternal;
+    };
+}
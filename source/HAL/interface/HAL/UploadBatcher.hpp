@@ -0,0 +1,53 @@
+#pragma once
+
+#include <HAL/InternalPtr.hpp>
+#include <vulkan/vulkan_decl.h>
+
+namespace HAL {
+
+    struct UploadBatcherCreateInfo {
+        uint64_t StagingSegmentSize = 8 << 20;
+        uint32_t StagingSegmentCount = 3;
+    };
+
+    struct UploadBatcherStatistic {
+        uint64_t UploadedBytes = {};
+        uint32_t WriteCount = {};
+        uint32_t SubmitCount = {};
+    };
+
+    //An empty extent covers the whole mip level
+    struct TextureUploadRegion {
+        uint32_t     MipLevel = {};
+        uint32_t     ArrayLayer = {};
+        vk::Offset3D Offset = {};
+        vk::Extent3D Extent = {};
+    };
+
+    class UploadBatcher: NonCopyable {
+    public:
+        class Internal;
+    public:
+        UploadBatcher(Device const& device, UploadBatcherCreateInfo const& createInfo);
+
+        UploadBatcher(UploadBatcher&&) noexcept;
+
+        UploadBatcher& operator=(UploadBatcher&&) noexcept;
+
+        ~UploadBatcher();
+
+        //Destinations must not be read by in-flight GPU work when Flush submits the copies
+        auto WriteBuffer(Buffer const& buffer, uint64_t offset, void const* pData, uint64_t size) -> void;
+
+        auto WriteTexture(Texture& texture, TextureUploadRegion const& region, void const* pData) -> void;
+
+        auto Flush() -> uint64_t;
+
+        auto GetFence() const -> Fence const&;
+
+        auto GetStatistic() const -> UploadBatcherStatistic;
+
+    private:
+        InternalPtr<Internal, InternalSize_UploadBatcher> m_pInternal;
+    };
+}
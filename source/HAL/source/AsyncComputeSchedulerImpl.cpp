@@ -0,0 +1,413 @@
+#include "../include/AsyncComputeSchedulerImpl.hpp"
+#include "../include/CommandListImpl.hpp"
+#include "../include/DeviceImpl.hpp"
+#include "../include/HostAllocator.hpp"
+
+#include <HAL/Buffer.hpp>
+#include <HAL/CommandList.hpp>
+#include <HAL/CommandQueue.hpp>
+#include <HAL/SubmitBatch.hpp>
+#include <HAL/Texture.hpp>
+
+namespace HAL {
+
+    struct AsyncStream {
+        SubmitBatch           Batch = {};
+        Fence*                pFence = {};
+        CommandAllocatorRing* pCmdRing = {};
+        uint32_t              FamilyIndex = {};
+        uint64_t              SignaledValue = {};
+        bool                  HasPendingWork = {};
+        bool                  HasNodes = {};
+    };
+
+    //Layouts without a state of their own map to General, which covers every access
+    static auto GetLayoutState(vk::ImageLayout layout) -> ResourceState {
+        switch (layout) {
+            case vk::ImageLayout::eUndefined:                     return ResourceState::Undefined;
+            case vk::ImageLayout::eShaderReadOnlyOptimal:         return ResourceState::ShaderResource;
+            case vk::ImageLayout::eColorAttachmentOptimal:        return ResourceState::RenderTarget;
+            case vk::ImageLayout::eDepthStencilAttachmentOptimal: return ResourceState::DepthWrite;
+            case vk::ImageLayout::eDepthStencilReadOnlyOptimal:   return ResourceState::DepthRead;
+            case vk::ImageLayout::eTransferSrcOptimal:            return ResourceState::CopySource;
+            case vk::ImageLayout::eTransferDstOptimal:            return ResourceState::CopyDest;
+            case vk::ImageLayout::ePresentSrcKHR:                 return ResourceState::Present;
+            default:                                              return ResourceState::General;
+        }
+    }
+
+    static auto AllocateCommandList(AsyncStream& stream, AsyncQueue queue) -> CommandList& {
+        if (queue == AsyncQueue::Graphics)
+            return stream.pCmdRing->AllocateGraphicsCommandList();
+        return stream.pCmdRing->AllocateComputeCommandList();
+    }
+
+    static auto SignalStream(AsyncStream& stream) -> void {
+        if (!stream.HasPendingWork)
+            return;
+        stream.SignaledValue = stream.pFence->Increment();
+        stream.Batch.Signal(*stream.pFence, stream.SignaledValue);
+        stream.HasPendingWork = false;
+    }
+
+    AsyncComputeScheduler::Internal::Internal(Device const& device, AsyncComputeSchedulerCreateInfo const& createInfo) {
+        assert(createInfo.FrameCount > 0);
+
+        auto pImplDevice = reinterpret_cast<const Device::Internal*>(&device);
+        auto const& limits = device.GetVkPhysicalDevice().getProperties().limits;
+        auto queueFamilyProperties = device.GetVkPhysicalDevice().getQueueFamilyProperties();
+
+        m_pDevice = const_cast<Device*>(&device);
+        m_pGraphicsCmdRing = std::make_unique<CommandAllocatorRing>(device, CommandAllocatorRingCreateInfo{.FrameCount = createInfo.FrameCount});
+        m_pComputeCmdRing = std::make_unique<CommandAllocatorRing>(device, CommandAllocatorRingCreateInfo{.FrameCount = createInfo.FrameCount});
+        m_pGraphicsFence = std::make_unique<Fence>(device);
+        m_pComputeFence = std::make_unique<Fence>(device);
+        m_TimestampPeriod = limits.timestampPeriod;
+        m_IsTimestampSupported = limits.timestampComputeAndGraphics &&
+            queueFamilyProperties[pImplDevice->GetGraphicsQueueFamilyIndex()].timestampValidBits > 0 &&
+            queueFamilyProperties[pImplDevice->GetComputeQueueFamilyIndex()].timestampValidBits > 0;
+
+        m_Frames.resize(createInfo.FrameCount);
+        if (m_IsTimestampSupported) {
+            //Begin and end timestamps of the graphics stream followed by the compute stream
+            for (auto& frame : m_Frames)
+                frame.pQueryPool = device.GetVkDevice().createQueryPoolUnique(vk::QueryPoolCreateInfo{.queryType = vk::QueryType::eTimestamp, .queryCount = 4}, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Synchronization));
+        }
+    }
+
+    auto AsyncComputeScheduler::Internal::AddNode(AsyncQueue queue, CommandList const& cmdList, std::span<const AsyncResourceUsage> usages) -> void {
+        m_Nodes.push_back(AsyncComputeNode{
+            .Queue = queue,
+            .pCmdList = &cmdList,
+            .Usages = {std::begin(usages), std::end(usages)}
+        });
+    }
+
+    auto AsyncComputeScheduler::Internal::Execute() -> void {
+        auto pImplDevice = reinterpret_cast<Device::Internal*>(m_pDevice);
+        auto& frame = m_Frames[m_FrameIndex % std::size(m_Frames)];
+        this->ResolveFrame(frame);
+
+        m_Statistic.GraphicsPassCount = 0;
+        m_Statistic.ComputeJobCount = 0;
+        m_Statistic.CrossQueueWaitCount = 0;
+        m_Statistic.OwnershipTransferCount = 0;
+
+        std::array<AsyncStream, 2> streams;
+        streams[uint32_t(AsyncQueue::Graphics)].pFence = m_pGraphicsFence.get();
+        streams[uint32_t(AsyncQueue::Graphics)].pCmdRing = m_pGraphicsCmdRing.get();
+        streams[uint32_t(AsyncQueue::Graphics)].FamilyIndex = pImplDevice->GetGraphicsQueueFamilyIndex();
+        streams[uint32_t(AsyncQueue::Compute)].pFence = m_pComputeFence.get();
+        streams[uint32_t(AsyncQueue::Compute)].pCmdRing = m_pComputeCmdRing.get();
+        streams[uint32_t(AsyncQueue::Compute)].FamilyIndex = pImplDevice->GetComputeQueueFamilyIndex();
+        for (auto& stream : streams)
+            stream.SignaledValue = stream.pFence->GetExpectedValue();
+        for (auto const& node : m_Nodes)
+            streams[uint32_t(node.Queue)].HasNodes = true;
+
+        auto WriteTimestamp = [&](AsyncQueue queue, uint32_t query, vk::PipelineStageFlagBits stage) -> void {
+            auto& stream = streams[uint32_t(queue)];
+            auto& cmdList = AllocateCommandList(stream, queue);
+            cmdList.Begin();
+            if (query % 2 == 0)
+                cmdList.GetVkCommandBuffer().resetQueryPool(*frame.pQueryPool, query, 2);
+            cmdList.GetVkCommandBuffer().writeTimestamp(stage, *frame.pQueryPool, query);
+            cmdList.End();
+            stream.Batch.Execute(cmdList);
+            stream.HasPendingWork = true;
+        };
+
+        frame.HasGraphicsTimestamps = m_IsTimestampSupported && streams[uint32_t(AsyncQueue::Graphics)].HasNodes;
+        frame.HasComputeTimestamps = m_IsTimestampSupported && streams[uint32_t(AsyncQueue::Compute)].HasNodes;
+        if (frame.HasGraphicsTimestamps)
+            WriteTimestamp(AsyncQueue::Graphics, 0, vk::PipelineStageFlagBits::eTopOfPipe);
+        if (frame.HasComputeTimestamps)
+            WriteTimestamp(AsyncQueue::Compute, 2, vk::PipelineStageFlagBits::eTopOfPipe);
+
+        //Each stream is submitted before the next node publishes its states, so the command lists resolve their first
+        //transitions against the state the earlier nodes left behind rather than the one at the end of the schedule.
+        //Each queue may wait for a value the other one signals in a later submission, which timeline semaphores allow
+        auto FlushStream = [&](AsyncQueue queue) -> void {
+            auto& stream = streams[uint32_t(queue)];
+            if (stream.Batch.IsEmpty())
+                return;
+            if (queue == AsyncQueue::Graphics)
+                pImplDevice->GetGraphicsCommandQueue().Submit(stream.Batch);
+            else
+                pImplDevice->GetComputeCommandQueue().Submit(stream.Batch);
+            stream.Batch.Reset();
+        };
+
+        for (auto const& node : m_Nodes) {
+            auto& stream = streams[uint32_t(node.Queue)];
+            auto otherQueue = node.Queue == AsyncQueue::Graphics ? AsyncQueue::Compute : AsyncQueue::Graphics;
+            auto& otherStream = streams[uint32_t(otherQueue)];
+            auto queueMask = 1u << uint32_t(node.Queue);
+            auto otherQueueMask = 1u << uint32_t(otherQueue);
+
+            std::vector<vk::BufferMemoryBarrier> releaseBufferBarriers;
+            std::vector<vk::ImageMemoryBarrier>  releaseImageBarriers;
+            std::vector<vk::BufferMemoryBarrier> acquireBufferBarriers;
+            std::vector<vk::ImageMemoryBarrier>  acquireImageBarriers;
+
+            bool isWaitRequired = false;
+            for (auto const& usage : node.Usages) {
+                auto& state = this->GetResourceState(usage);
+                state.LastFrameIndex = m_FrameIndex;
+
+                auto newLayout = usage.pTexture ? usage.Layout : vk::ImageLayout::eUndefined;
+                bool isQueueSwitch = state.Owner != node.Queue;
+                state.Owner = node.Queue;
+
+                //Queues of the same family share ownership, and undefined contents need no release on the previous
+                //owner, the new owner simply discards them
+                bool isOwnershipTransfer = isQueueSwitch && stream.FamilyIndex != otherStream.FamilyIndex;
+                bool isContentDefined = !usage.pTexture || state.Layout != vk::ImageLayout::eUndefined;
+                bool isLayoutChange = usage.pTexture && state.Layout != newLayout;
+
+                //A layout transition rewrites the image, so it orders like a write. Reads after reads of the other
+                //queue run concurrently; everything after its writes, and writes after its reads, wait for it
+                bool isWrite = usage.IsWrite || isLayoutChange;
+                bool isWaitUsage = isOwnershipTransfer || (state.WriteQueueMask & otherQueueMask) || (isWrite && (state.ReadQueueMask & otherQueueMask));
+                if (isWaitUsage) {
+                    state.WriteQueueMask &= ~otherQueueMask;
+                    state.ReadQueueMask &= ~otherQueueMask;
+                }
+                isWaitRequired |= isWaitUsage;
+
+                if (isWrite) {
+                    state.WriteQueueMask = queueMask;
+                    state.ReadQueueMask = 0;
+                } else {
+                    state.ReadQueueMask |= queueMask;
+                }
+
+                if (isOwnershipTransfer && isContentDefined) {
+                    m_Statistic.OwnershipTransferCount++;
+
+                    if (usage.pBuffer) {
+                        vk::BufferMemoryBarrier barrier = {
+                            .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+                            .srcQueueFamilyIndex = otherStream.FamilyIndex,
+                            .dstQueueFamilyIndex = stream.FamilyIndex,
+                            .buffer = usage.pBuffer->GetVkBuffer(),
+                            .offset = usage.pBuffer->GetOffset(),
+                            .size = usage.pBuffer->GetSize()
+                        };
+                        releaseBufferBarriers.push_back(barrier);
+                        barrier.srcAccessMask = {};
+                        barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite;
+                        acquireBufferBarriers.push_back(barrier);
+                    } else {
+                        vk::ImageMemoryBarrier barrier = {
+                            .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+                            .oldLayout = state.Layout,
+                            .newLayout = newLayout,
+                            .srcQueueFamilyIndex = otherStream.FamilyIndex,
+                            .dstQueueFamilyIndex = stream.FamilyIndex,
+                            .image = usage.pTexture->GetVkImage(),
+                            .subresourceRange = {vk::ImageAspectFlagBits::eColor, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}
+                        };
+                        releaseImageBarriers.push_back(barrier);
+                        barrier.srcAccessMask = {};
+                        barrier.dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite;
+                        acquireImageBarriers.push_back(barrier);
+                    }
+                } else if (isLayoutChange) {
+                    //Without an ownership transfer the layout changes once, on the queue that runs after the wait
+                    acquireImageBarriers.push_back(vk::ImageMemoryBarrier{
+                        .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+                        .dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite,
+                        .oldLayout = state.Layout,
+                        .newLayout = newLayout,
+                        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                        .image = usage.pTexture->GetVkImage(),
+                        .subresourceRange = {vk::ImageAspectFlagBits::eColor, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}
+                    });
+                }
+                state.Layout = newLayout;
+            }
+
+            //The release goes to the end of the other stream, after every access it made to these resources
+            if (!releaseBufferBarriers.empty() || !releaseImageBarriers.empty()) {
+                auto& cmdList = AllocateCommandList(otherStream, otherQueue);
+                cmdList.Begin();
+                cmdList.GetVkCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eBottomOfPipe, {}, {}, releaseBufferBarriers, releaseImageBarriers);
+                cmdList.End();
+                otherStream.Batch.Execute(cmdList);
+                otherStream.HasPendingWork = true;
+            }
+
+            if (isWaitRequired) {
+                SignalStream(otherStream);
+                FlushStream(otherQueue);
+                if (m_WaitedValues[uint32_t(node.Queue)] < otherStream.SignaledValue) {
+                    stream.Batch.Wait(*otherStream.pFence, otherStream.SignaledValue, vk::PipelineStageFlagBits::eAllCommands);
+                    m_WaitedValues[uint32_t(node.Queue)] = otherStream.SignaledValue;
+                    m_Statistic.CrossQueueWaitCount++;
+                }
+            }
+
+            if (!acquireBufferBarriers.empty() || !acquireImageBarriers.empty()) {
+                auto& cmdList = AllocateCommandList(stream, node.Queue);
+                cmdList.Begin();
+                cmdList.GetVkCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands, {}, {}, acquireBufferBarriers, acquireImageBarriers);
+                cmdList.End();
+                stream.Batch.Execute(cmdList);
+            }
+
+            //The node's command list resolves its first transitions against the state right after the acquire
+            {
+                std::lock_guard<std::mutex> lock(GetResourceStateMutex());
+                for (auto const& usage : node.Usages) {
+                    auto tracked = usage.pBuffer ? GetTrackedBuffer(*usage.pBuffer) : GetTrackedTexture(*usage.pTexture);
+                    *tracked.pGlobalState = usage.pBuffer ? ResourceState::General : GetLayoutState(usage.Layout);
+                    *tracked.pGlobalQueueFamilyIndex = stream.FamilyIndex;
+                }
+            }
+
+            stream.Batch.Execute(*node.pCmdList);
+            stream.HasPendingWork = true;
+            FlushStream(node.Queue);
+
+            //Picks up the layout the command list itself left the texture in; changing it counts as a write
+            for (auto const& usage : node.Usages) {
+                if (!usage.pTexture)
+                    continue;
+                auto layout = vk::ImageLayout::eUndefined;
+                {
+                    std::lock_guard<std::mutex> lock(GetResourceStateMutex());
+                    layout = GetResourceStateInfo(*GetTrackedTexture(*usage.pTexture).pGlobalState).Layout;
+                }
+                auto& state = this->GetResourceState(usage);
+                if (layout != state.Layout) {
+                    state.Layout = layout;
+                    state.WriteQueueMask = queueMask;
+                    state.ReadQueueMask = 0;
+                }
+            }
+
+            if (node.Queue == AsyncQueue::Graphics)
+                m_Statistic.GraphicsPassCount++;
+            else
+                m_Statistic.ComputeJobCount++;
+        }
+
+        if (frame.HasGraphicsTimestamps)
+            WriteTimestamp(AsyncQueue::Graphics, 1, vk::PipelineStageFlagBits::eBottomOfPipe);
+        if (frame.HasComputeTimestamps)
+            WriteTimestamp(AsyncQueue::Compute, 3, vk::PipelineStageFlagBits::eBottomOfPipe);
+
+        for (auto& stream : streams)
+            SignalStream(stream);
+        FlushStream(AsyncQueue::Graphics);
+        FlushStream(AsyncQueue::Compute);
+
+        frame.GraphicsValue = streams[uint32_t(AsyncQueue::Graphics)].SignaledValue;
+        frame.ComputeValue = streams[uint32_t(AsyncQueue::Compute)].SignaledValue;
+        frame.IsSubmitted = true;
+
+        m_pGraphicsCmdRing->NextFrame(*m_pGraphicsFence, frame.GraphicsValue);
+        m_pComputeCmdRing->NextFrame(*m_pComputeFence, frame.ComputeValue);
+        m_Nodes.clear();
+
+        //Only resources returned to their default owner can be forgotten without losing ownership information
+        std::erase_if(m_Resources, [&](auto const& entry) -> bool {
+            auto const& state = entry.second;
+            return state.Owner == state.DefaultOwner && m_FrameIndex - state.LastFrameIndex >= std::size(m_Frames);
+        });
+        m_FrameIndex++;
+    }
+
+    auto AsyncComputeScheduler::Internal::GetResourceState(AsyncResourceUsage const& usage) -> AsyncResourceState& {
+        assert((usage.pBuffer != nullptr) != (usage.pTexture != nullptr));
+
+        auto key = usage.pBuffer ? reinterpret_cast<uint64_t>(usage.pBuffer) : reinterpret_cast<uint64_t>(usage.pTexture);
+        auto [iterator, isInserted] = m_Resources.try_emplace(key);
+        if (isInserted) {
+            auto& state = iterator->second;
+            if (usage.pTexture) {
+                auto const& createInfo = usage.pTexture->GetCreateInfo();
+                //Starts from the layout the submitted work left the texture in, as tracked for the command lists
+                state.DefaultOwner = createInfo.Owner == TextureOwner::Compute ? AsyncQueue::Compute : AsyncQueue::Graphics;
+                std::lock_guard<std::mutex> lock(GetResourceStateMutex());
+                state.Layout = GetResourceStateInfo(*GetTrackedTexture(*usage.pTexture).pGlobalState).Layout;
+            } else {
+                state.DefaultOwner = AsyncQueue::Graphics;
+            }
+            state.Owner = state.DefaultOwner;
+        }
+        return iterator->second;
+    }
+
+    auto AsyncComputeScheduler::Internal::ResolveFrame(AsyncComputeFrame& frame) -> void {
+        if (!frame.IsSubmitted)
+            return;
+
+        m_pGraphicsFence->Wait(frame.GraphicsValue);
+        m_pComputeFence->Wait(frame.ComputeValue);
+        frame.IsSubmitted = false;
+
+        if (!frame.HasGraphicsTimestamps && !frame.HasComputeTimestamps)
+            return;
+
+        //A stream without nodes never reset or wrote its pair of queries, so only the written pairs are read back
+        std::array<uint64_t, 4> timestamps = {};
+        auto ReadTimestamps = [&](uint32_t query) -> bool {
+            auto result = m_pDevice->GetVkDevice().getQueryPoolResults(*frame.pQueryPool, query, 2, 2 * sizeof(uint64_t), &timestamps[query], sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+            return result == vk::Result::eSuccess;
+        };
+        if (frame.HasGraphicsTimestamps && !ReadTimestamps(0))
+            return;
+        if (frame.HasComputeTimestamps && !ReadTimestamps(2))
+            return;
+
+        auto ToMilliseconds = [&](uint64_t ticks) -> float { return static_cast<float>(ticks) * m_TimestampPeriod / 1e6f; };
+
+        m_Statistic.GraphicsTime = frame.HasGraphicsTimestamps ? ToMilliseconds(timestamps[1] - timestamps[0]) : 0.0f;
+        m_Statistic.ComputeTime = frame.HasComputeTimestamps ? ToMilliseconds(timestamps[3] - timestamps[2]) : 0.0f;
+        m_Statistic.OverlapTime = 0.0f;
+        if (frame.HasGraphicsTimestamps && frame.HasComputeTimestamps) {
+            auto begin = std::max(timestamps[0], timestamps[2]);
+            auto end = std::min(timestamps[1], timestamps[3]);
+            m_Statistic.OverlapTime = end > begin ? ToMilliseconds(end - begin) : 0.0f;
+        }
+        m_Statistic.OverlapRatio = m_Statistic.ComputeTime > 0.0f ? m_Statistic.OverlapTime / m_Statistic.ComputeTime : 0.0f;
+    }
+}
+
+namespace HAL {
+
+    AsyncComputeScheduler::AsyncComputeScheduler(Device const& device, AsyncComputeSchedulerCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    AsyncComputeScheduler::AsyncComputeScheduler(AsyncComputeScheduler&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    AsyncComputeScheduler& AsyncComputeScheduler::operator=(AsyncComputeScheduler&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    AsyncComputeScheduler::~AsyncComputeScheduler() = default;
+
+    auto AsyncComputeScheduler::AddGraphicsPass(GraphicsCommandList const& cmdList, std::span<const AsyncResourceUsage> usages) -> void {
+        m_pInternal->AddNode(AsyncQueue::Graphics, cmdList, usages);
+    }
+
+    auto AsyncComputeScheduler::AddComputeJob(ComputeCommandList const& cmdList, std::span<const AsyncResourceUsage> usages) -> void {
+        m_pInternal->AddNode(AsyncQueue::Compute, cmdList, usages);
+    }
+
+    auto AsyncComputeScheduler::Execute() -> void {
+        m_pInternal->Execute();
+    }
+
+    auto AsyncComputeScheduler::GetGraphicsFence() const -> Fence const& {
+        return m_pInternal->GetGraphicsFence();
+    }
+
+    auto AsyncComputeScheduler::GetComputeFence() const -> Fence const& {
+        return m_pInternal->GetComputeFence();
+    }
+
+    auto AsyncComputeScheduler::GetStatistic() const -> AsyncComputeStatistic {
+        return m_pInternal->GetStatistic();
+    }
+}
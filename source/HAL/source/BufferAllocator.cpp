@@ -0,0 +1,145 @@
+#include "../include/BufferAllocator.hpp"
+#include "../include/DeviceImpl.hpp"
+
+namespace HAL {
+
+    struct BufferBlock {
+        vk::UniqueBuffer             pBuffer = {};
+        vma::UniqueAllocation        pAllocation = {};
+        uint8_t*                     pMappedData = {};
+        vma::MemoryUsage             MemoryUsage = {};
+        uint64_t                     UsedSize = {};
+        std::map<uint64_t, uint64_t> FreeRanges = {};
+    };
+
+    BufferAllocator::BufferAllocator(Device const& device) {
+        auto const& limits = device.GetVkPhysicalDevice().getProperties().limits;
+
+        m_pDevice = const_cast<Device*>(&device);
+        m_Alignment = std::max({
+            uint64_t(16),
+            limits.minUniformBufferOffsetAlignment,
+            limits.minStorageBufferOffsetAlignment,
+            limits.minTexelBufferOffsetAlignment,
+            limits.nonCoherentAtomSize
+        });
+    }
+
+    BufferAllocator::~BufferAllocator() {
+        for (auto const& pBlock : m_Blocks)
+            if (pBlock->UsedSize != 0)
+                fmt::print("Warning: BufferAllocator block destroyed with {} bytes still in use \n", pBlock->UsedSize);
+    }
+
+    auto BufferAllocator::IsSuballocatable(vk::BufferUsageFlags usage, vma::MemoryUsage memoryUsage, uint64_t size) const -> bool {
+        return size <= MaxSuballocationSize && (usage & BlockUsage) == usage && memoryUsage != vma::MemoryUsage::eUnknown && memoryUsage != vma::MemoryUsage::eGpuLazilyAllocated;
+    }
+
+    auto BufferAllocator::Allocate(vk::BufferUsageFlags usage, vma::MemoryUsage memoryUsage, uint64_t size) -> std::optional<BufferSuballocation> {
+        assert(this->IsSuballocatable(usage, memoryUsage, size));
+        size = (std::max<uint64_t>(size, 1) + m_Alignment - 1) / m_Alignment * m_Alignment;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        auto allocate = [&](BufferBlock* pBlock) -> std::optional<BufferSuballocation> {
+            auto offset = this->AllocateFromBlock(*pBlock, size);
+            if (!offset)
+                return std::nullopt;
+            return BufferSuballocation{
+                .Buffer = *pBlock->pBuffer,
+                .Offset = *offset,
+                .Size = size,
+                .pMappedData = pBlock->pMappedData ? pBlock->pMappedData + *offset : nullptr,
+                .pBlock = pBlock
+            };
+        };
+
+        for (auto const& pBlock : m_Blocks) {
+            if (pBlock->MemoryUsage != memoryUsage)
+                continue;
+            if (auto suballocation = allocate(pBlock.get()))
+                return suballocation;
+        }
+
+        if (auto pBlock = this->CreateBlock(memoryUsage))
+            return allocate(pBlock);
+        return std::nullopt;
+    }
+
+    auto BufferAllocator::Free(BufferSuballocation const& suballocation) -> void {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        auto& block = *suballocation.pBlock;
+        auto& ranges = block.FreeRanges;
+        block.UsedSize -= suballocation.Size;
+
+        auto [iterator, isInserted] = ranges.emplace(suballocation.Offset, suballocation.Size);
+        assert(isInserted);
+
+        //Coalesce with the following and the preceding free ranges
+        auto next = std::next(iterator);
+        if (next != ranges.end() && iterator->first + iterator->second == next->first) {
+            iterator->second += next->second;
+            ranges.erase(next);
+        }
+
+        if (iterator != ranges.begin()) {
+            auto prev = std::prev(iterator);
+            if (prev->first + prev->second == iterator->first) {
+                prev->second += iterator->second;
+                ranges.erase(iterator);
+            }
+        }
+
+        //Keep one empty block per memory usage to avoid allocation ping-pong
+        if (block.UsedSize == 0) {
+            auto count = std::count_if(m_Blocks.begin(), m_Blocks.end(), [&](auto const& pBlock) { return pBlock->MemoryUsage == block.MemoryUsage; });
+            if (count > 1)
+                std::erase_if(m_Blocks, [&](auto const& pBlock) { return pBlock.get() == &block; });
+        }
+    }
+
+    auto BufferAllocator::CreateBlock(vma::MemoryUsage memoryUsage) -> BufferBlock* {
+        vk::BufferCreateInfo bufferCI = {
+            .size = BlockSize,
+            .usage = BlockUsage,
+            .sharingMode = vk::SharingMode::eExclusive
+        };
+
+        bool isHostVisible = memoryUsage != vma::MemoryUsage::eGpuOnly;
+        vma::AllocationCreateInfo allocationCI = {
+            .flags = isHostVisible ? vma::AllocationCreateFlags(vma::AllocationCreateFlagBits::eMapped) : vma::AllocationCreateFlags{},
+            .usage = memoryUsage
+        };
+
+        auto pBlock = std::make_unique<BufferBlock>();
+        vma::AllocationInfo allocationInfo = {};
+        std::tie(pBlock->pBuffer, pBlock->pAllocation) = reinterpret_cast<Device::Internal*>(m_pDevice)->GetMemoryAllocator().CreateBuffer(bufferCI, allocationCI, MemoryFallbackPolicy::HostMemory, &allocationInfo);
+        if (!pBlock->pBuffer)
+            return nullptr;
+
+        vkx::setDebugName(m_pDevice->GetVkDevice(), *pBlock->pBuffer, fmt::format("BufferBlock: {}", std::size(m_Blocks)));
+        pBlock->pMappedData = static_cast<uint8_t*>(allocationInfo.pMappedData);
+        pBlock->MemoryUsage = memoryUsage;
+        pBlock->FreeRanges.emplace(0, BlockSize);
+
+        m_Blocks.push_back(std::move(pBlock));
+        return m_Blocks.back().get();
+    }
+
+    auto BufferAllocator::AllocateFromBlock(BufferBlock& block, uint64_t size) -> std::optional<uint64_t> {
+        //First fit; sizes and offsets are multiples of the alignment so ranges never need padding
+        for (auto iterator = block.FreeRanges.begin(); iterator != block.FreeRanges.end(); iterator++) {
+            auto [offset, rangeSize] = *iterator;
+            if (rangeSize < size)
+                continue;
+
+            block.FreeRanges.erase(iterator);
+            if (rangeSize > size)
+                block.FreeRanges.emplace(offset + size, rangeSize - size);
+            block.UsedSize += size;
+            return offset;
+        }
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,225 @@
+#include "../include/BufferImpl.hpp"
+#include "../include/DeviceImpl.hpp"
+#include "../include/HostAllocator.hpp"
+
+namespace HAL {
+
+    Buffer::Internal::Internal(Device const& device, BufferCreateInfo const& createInfo) {
+        auto pImplDevice = reinterpret_cast<const Device::Internal*>(&device);
+        auto& bufferAllocator = pImplDevice->GetBufferAllocator();
+
+        m_pDevice = const_cast<Device*>(&device);
+        m_CreateInfo = createInfo;
+        m_pRecord = std::make_unique<BufferRecord>();
+
+        if (!createInfo.IsDedicated && bufferAllocator.IsSuballocatable(createInfo.Usage, createInfo.MemoryUsage, createInfo.Size)) {
+            if (auto suballocation = bufferAllocator.Allocate(createInfo.Usage, createInfo.MemoryUsage, createInfo.Size)) {
+                m_pRecord->Suballocation = suballocation;
+                m_pRecord->Buffer = suballocation->Buffer;
+                m_pRecord->Offset = suballocation->Offset;
+                m_pRecord->Size = suballocation->Size;
+                m_pRecord->pMappedData = suballocation->pMappedData;
+                return;
+            }
+        }
+
+        vk::BufferCreateInfo bufferCI = {
+            .size = createInfo.Size,
+            .usage = createInfo.Usage,
+            .sharingMode = vk::SharingMode::eExclusive
+        };
+
+        bool isHostVisible = createInfo.MemoryUsage != vma::MemoryUsage::eGpuOnly && createInfo.MemoryUsage != vma::MemoryUsage::eGpuLazilyAllocated;
+        vma::AllocationCreateInfo allocationCI = {
+            .flags = isHostVisible ? vma::AllocationCreateFlags(vma::AllocationCreateFlagBits::eMapped) : vma::AllocationCreateFlags{},
+            .usage = createInfo.MemoryUsage
+        };
+
+        vma::AllocationInfo allocationInfo = {};
+        auto& memoryAllocator = pImplDevice->GetMemoryAllocator();
+        std::tie(m_pRecord->pBuffer, m_pRecord->pAllocation) = memoryAllocator.CreateBuffer(bufferCI, allocationCI, MemoryFallbackPolicy::HostMemory, &allocationInfo);
+        assert(m_pRecord->pBuffer);
+
+        m_pRecord->Buffer = *m_pRecord->pBuffer;
+        m_pRecord->Offset = 0;
+        m_pRecord->Size = createInfo.Size;
+        m_pRecord->pMappedData = static_cast<uint8_t*>(allocationInfo.pMappedData);
+
+        //Views are recreated on the new buffer and the owners are told to rewrite their descriptors
+        if (createInfo.IsRelocatable && createInfo.MemoryUsage == vma::MemoryUsage::eGpuOnly) {
+            m_pRecord->IsRelocatable = true;
+            memoryAllocator.RegisterRelocatable(*m_pRecord->pAllocation, [pDevice = m_pDevice, pRecord = m_pRecord.get(), bufferCI](vma::Allocation allocation, Fence const& fence, std::optional<uint64_t> value) -> void {
+                auto pImplDevice = reinterpret_cast<Device::Internal*>(pDevice);
+                auto pBuffer = pImplDevice->GetVkDevice().createBufferUnique(bufferCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Resource));
+                pImplDevice->GetVmaAllocator().bindBufferMemory(allocation, *pBuffer);
+
+                pDevice->DestroyDeferred(std::exchange(pRecord->pBuffer, std::move(pBuffer)), fence, value);
+                pRecord->Buffer = *pRecord->pBuffer;
+
+                for (auto pView : pRecord->Views) {
+                    pView->BufferViewCI.buffer = pRecord->Buffer;
+                    auto pBufferView = pImplDevice->GetVkDevice().createBufferViewUnique(pView->BufferViewCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Resource));
+                    pDevice->DestroyDeferred(std::exchange(pView->pBufferView, std::move(pBufferView)), fence, value);
+                }
+
+                for (auto const& [id, callback] : pRecord->RelocationCallbacks)
+                    callback(pRecord->Buffer);
+            });
+        }
+    }
+
+    Buffer::Internal& Buffer::Internal::operator=(Internal&& rhs) noexcept {
+        if (this != &rhs) {
+            this->Release();
+            m_pDevice = rhs.m_pDevice;
+            m_CreateInfo = rhs.m_CreateInfo;
+            m_pRecord = std::move(rhs.m_pRecord);
+        }
+        return *this;
+    }
+
+    Buffer::Internal::~Internal() {
+        this->Release();
+    }
+
+    auto Buffer::Internal::Release() -> void {
+        if (!m_pRecord)
+            return;
+
+        auto pImplDevice = reinterpret_cast<Device::Internal*>(m_pDevice);
+        if (m_pRecord->Suballocation)
+            pImplDevice->GetBufferAllocator().Free(*m_pRecord->Suballocation);
+        if (m_pRecord->IsRelocatable)
+            pImplDevice->GetMemoryAllocator().UnregisterRelocatable(*m_pRecord->pAllocation);
+        m_pRecord.reset();
+    }
+
+    auto Buffer::Internal::AddRelocationCallback(BufferRelocationCallback&& callback) -> uint32_t {
+        auto id = m_pRecord->RelocationCallbackID++;
+        m_pRecord->RelocationCallbacks.emplace_back(id, std::move(callback));
+        return id;
+    }
+
+    auto Buffer::Internal::RemoveRelocationCallback(uint32_t id) -> void {
+        std::erase_if(m_pRecord->RelocationCallbacks, [id](auto const& e) { return e.first == id; });
+    }
+
+    BufferView::Internal::Internal(Device const& device, Buffer const& buffer, BufferViewCreateInfo const& createInfo) {
+        auto pImplBuffer = reinterpret_cast<const Buffer::Internal*>(&buffer);
+
+        m_pRecord = const_cast<BufferRecord*>(pImplBuffer->GetRecord());
+        m_Offset = createInfo.Offset;
+        m_Range = createInfo.Range ? createInfo.Range : buffer.GetSize() - createInfo.Offset;
+        assert(m_Offset + m_Range <= buffer.GetSize());
+
+        if (createInfo.Format != vk::Format::eUndefined) {
+            m_pViewRecord = std::make_unique<BufferViewRecord>();
+            m_pViewRecord->BufferViewCI = vk::BufferViewCreateInfo{
+                .buffer = m_pRecord->Buffer,
+                .format = createInfo.Format,
+                .offset = m_pRecord->Offset + m_Offset,
+                .range = m_Range
+            };
+            m_pViewRecord->pBufferView = device.GetVkDevice().createBufferViewUnique(m_pViewRecord->BufferViewCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Resource));
+            m_pRecord->Views.push_back(m_pViewRecord.get());
+        }
+    }
+
+    BufferView::Internal& BufferView::Internal::operator=(Internal&& rhs) noexcept {
+        if (this != &rhs) {
+            this->Release();
+            m_pRecord = rhs.m_pRecord;
+            m_Offset = rhs.m_Offset;
+            m_Range = rhs.m_Range;
+            m_pViewRecord = std::move(rhs.m_pViewRecord);
+        }
+        return *this;
+    }
+
+    BufferView::Internal::~Internal() {
+        this->Release();
+    }
+
+    auto BufferView::Internal::Release() -> void {
+        if (!m_pViewRecord)
+            return;
+
+        std::erase(m_pRecord->Views, m_pViewRecord.get());
+        m_pViewRecord.reset();
+    }
+}
+
+namespace HAL {
+
+    Buffer::Buffer(Device const& device, BufferCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    Buffer::Buffer(Buffer&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    Buffer& Buffer::operator=(Buffer&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    Buffer::~Buffer() = default;
+
+    auto Buffer::GetCreateInfo() const -> BufferCreateInfo const& {
+        return m_pInternal->GetCreateInfo();
+    }
+
+    auto Buffer::GetVkBuffer() const -> vk::Buffer {
+        return m_pInternal->GetVkBuffer();
+    }
+
+    auto Buffer::GetOffset() const -> uint64_t {
+        return m_pInternal->GetOffset();
+    }
+
+    auto Buffer::GetSize() const -> uint64_t {
+        return m_pInternal->GetSize();
+    }
+
+    auto Buffer::GetMappedData() const -> void* {
+        return m_pInternal->GetMappedData();
+    }
+
+    auto Buffer::IsSuballocated() const -> bool {
+        return m_pInternal->IsSuballocated();
+    }
+
+    auto Buffer::AddRelocationCallback(BufferRelocationCallback&& callback) -> uint32_t {
+        return m_pInternal->AddRelocationCallback(std::move(callback));
+    }
+
+    auto Buffer::RemoveRelocationCallback(uint32_t id) -> void {
+        m_pInternal->RemoveRelocationCallback(id);
+    }
+
+    BufferView::BufferView(Device const& device, Buffer const& buffer, BufferViewCreateInfo const& createInfo) : m_pInternal(device, buffer, createInfo) {}
+
+    BufferView::BufferView(BufferView&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    BufferView& BufferView::operator=(BufferView&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    BufferView::~BufferView() = default;
+
+    auto BufferView::GetVkBuffer() const -> vk::Buffer {
+        return m_pInternal->GetVkBuffer();
+    }
+
+    auto BufferView::GetVkBufferView() const -> vk::BufferView {
+        return m_pInternal->GetVkBufferView();
+    }
+
+    auto BufferView::GetOffset() const -> uint64_t {
+        return m_pInternal->GetOffset();
+    }
+
+    auto BufferView::GetRange() const -> uint64_t {
+        return m_pInternal->GetRange();
+    }
+
+    auto BufferView::GetDescriptorBufferInfo() const -> vk::DescriptorBufferInfo {
+        return vk::DescriptorBufferInfo{
+            .buffer = m_pInternal->GetVkBuffer(),
+            .offset = m_pInternal->GetOffset(),
+            .range = m_pInternal->GetRange()
+        };
+    }
+}
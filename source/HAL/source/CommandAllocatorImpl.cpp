@@ -1,10 +1,17 @@
 #include "../include/CommandAllocatorImpl.hpp"
 #include "../include/DeviceImpl.hpp"
+#include "../include/HostAllocator.hpp"
 
 namespace HAL {
-    CommandAllocator::Internal::Internal(Device const& device, uint32_t queueFamilyIndex) {
-        m_pCommandPool = device.GetVkDevice().createCommandPoolUnique(vk::CommandPoolCreateInfo{.flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer, .queueFamilyIndex = queueFamilyIndex});
+    CommandAllocator::Internal::Internal(Device const& device, uint32_t queueFamilyIndex, CommandAllocatorResetMode resetMode) {
+        auto flags = resetMode == CommandAllocatorResetMode::Pool ? vk::CommandPoolCreateFlagBits::eTransient : vk::CommandPoolCreateFlagBits::eResetCommandBuffer;
+        m_pCommandPool = device.GetVkDevice().createCommandPoolUnique(vk::CommandPoolCreateInfo{.flags = flags, .queueFamilyIndex = queueFamilyIndex}, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Command));
         m_pDevice = const_cast<Device*>(&device);
+        m_QueueFamilyIndex = queueFamilyIndex;
+    }
+
+    auto CommandAllocator::Internal::Reset() -> void {
+        m_pDevice->GetVkDevice().resetCommandPool(*m_pCommandPool, vk::CommandPoolResetFlags{});
     }
 
     auto CommandAllocator::Internal::GetCommandPool() const -> vk::CommandPool { return m_pCommandPool.get(); }
@@ -12,20 +19,30 @@ namespace HAL {
     auto CommandAllocator::Internal::GetVkDevice() const -> vk::Device { return m_pDevice->GetVkDevice(); }
 
     auto CommandAllocator::Internal::GetDevice() const -> Device* { return m_pDevice; }
+
+    auto CommandAllocator::Internal::GetQueueFamilyIndex() const -> uint32_t { return m_QueueFamilyIndex; }
 }
 
 namespace HAL {
-    CommandAllocator::CommandAllocator(Device const& device, uint32_t queueFamily) : m_pInternal(device, queueFamily) {}
+    CommandAllocator::CommandAllocator(Device const& device, uint32_t queueFamily, CommandAllocatorResetMode resetMode) : m_pInternal(device, queueFamily, resetMode) {}
+
+    CommandAllocator::CommandAllocator(CommandAllocator&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    CommandAllocator& CommandAllocator::operator=(CommandAllocator&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
 
     CommandAllocator::~CommandAllocator() = default;
 
+    auto CommandAllocator::Reset() -> void {
+        m_pInternal->Reset();
+    }
+
     auto CommandAllocator::GetVkCommandPool() const -> vk::CommandPool {
         return m_pInternal->GetCommandPool();
     }
 
-    TransferCommandAllocator::TransferCommandAllocator(Device const& device) : CommandAllocator(device, reinterpret_cast<const Device::Internal*>(&device)->GetTransferQueueFamilyIndex()) {}
+    TransferCommandAllocator::TransferCommandAllocator(Device const& device, CommandAllocatorResetMode resetMode) : CommandAllocator(device, reinterpret_cast<const Device::Internal*>(&device)->GetTransferQueueFamilyIndex(), resetMode) {}
 
-    ComputeCommandAllocator::ComputeCommandAllocator(Device const& device) : CommandAllocator(device, reinterpret_cast<const Device::Internal*>(&device)->GetComputeQueueFamilyIndex()) {}
+    ComputeCommandAllocator::ComputeCommandAllocator(Device const& device, CommandAllocatorResetMode resetMode) : CommandAllocator(device, reinterpret_cast<const Device::Internal*>(&device)->GetComputeQueueFamilyIndex(), resetMode) {}
 
-    GraphicsCommandAllocator::GraphicsCommandAllocator(Device const& device) : CommandAllocator(device, reinterpret_cast<const Device::Internal*>(&device)->GetGraphicsQueueFamilyIndex()) {}
+    GraphicsCommandAllocator::GraphicsCommandAllocator(Device const& device, CommandAllocatorResetMode resetMode) : CommandAllocator(device, reinterpret_cast<const Device::Internal*>(&device)->GetGraphicsQueueFamilyIndex(), resetMode) {}
 }
\ No newline at end of file
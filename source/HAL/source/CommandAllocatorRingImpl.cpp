@@ -0,0 +1,137 @@
+#include "../include/CommandAllocatorRingImpl.hpp"
+
+#include <HAL/Fence.hpp>
+
+namespace HAL {
+
+    template<typename T, typename Create>
+    static auto AcquireCommandList(CommandListFreeList<T>& freeList, Create&& create) -> T& {
+        if (freeList.Free.empty()) {
+            freeList.Used.push_back(create());
+        } else {
+            freeList.Used.push_back(std::move(freeList.Free.back()));
+            freeList.Free.pop_back();
+        }
+        return *freeList.Used.back();
+    }
+
+    template<typename T>
+    static auto RecycleCommandLists(CommandListFreeList<T>& freeList) -> void {
+        std::move(freeList.Used.begin(), freeList.Used.end(), std::back_inserter(freeList.Free));
+        freeList.Used.clear();
+    }
+
+    CommandAllocatorRing::Internal::Internal(Device const& device, CommandAllocatorRingCreateInfo const& createInfo) {
+        assert(createInfo.FrameCount > 0);
+
+        m_pDevice = const_cast<Device*>(&device);
+        m_Frames.resize(createInfo.FrameCount);
+        m_FrameIndex = 0;
+    }
+
+    CommandAllocatorRing::Internal& CommandAllocatorRing::Internal::operator=(Internal&& rhs) noexcept {
+        if (this != &rhs) {
+            this->Release();
+            m_pDevice = rhs.m_pDevice;
+            m_Frames = std::move(rhs.m_Frames);
+            m_FrameIndex = rhs.m_FrameIndex;
+        }
+        return *this;
+    }
+
+    CommandAllocatorRing::Internal::~Internal() {
+        this->Release();
+    }
+
+    auto CommandAllocatorRing::Internal::AllocateTransferCommandList() -> TransferCommandList& {
+        auto& frame = m_Frames[m_FrameIndex];
+        if (!frame.pTransferAllocator)
+            frame.pTransferAllocator = std::make_unique<TransferCommandAllocator>(*m_pDevice, CommandAllocatorResetMode::Pool);
+        return AcquireCommandList(frame.TransferCmdLists, [&] { return std::make_unique<TransferCommandList>(*frame.pTransferAllocator); });
+    }
+
+    auto CommandAllocatorRing::Internal::AllocateComputeCommandList() -> ComputeCommandList& {
+        auto& frame = m_Frames[m_FrameIndex];
+        if (!frame.pComputeAllocator)
+            frame.pComputeAllocator = std::make_unique<ComputeCommandAllocator>(*m_pDevice, CommandAllocatorResetMode::Pool);
+        return AcquireCommandList(frame.ComputeCmdLists, [&] { return std::make_unique<ComputeCommandList>(*frame.pComputeAllocator); });
+    }
+
+    auto CommandAllocatorRing::Internal::AllocateGraphicsCommandList(CommandListLevel level) -> GraphicsCommandList& {
+        auto& frame = m_Frames[m_FrameIndex];
+        if (!frame.pGraphicsAllocator)
+            frame.pGraphicsAllocator = std::make_unique<GraphicsCommandAllocator>(*m_pDevice, CommandAllocatorResetMode::Pool);
+        auto& freeList = level == CommandListLevel::Primary ? frame.GraphicsCmdLists : frame.GraphicsSecondaryCmdLists;
+        return AcquireCommandList(freeList, [&] { return std::make_unique<GraphicsCommandList>(*frame.pGraphicsAllocator, level); });
+    }
+
+    auto CommandAllocatorRing::Internal::NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void {
+        m_Frames[m_FrameIndex].Semaphore = fence.GetVkSemaphore();
+        m_Frames[m_FrameIndex].FenceValue = value.value_or(fence.GetExpectedValue());
+
+        m_FrameIndex = (m_FrameIndex + 1) % std::size(m_Frames);
+        this->WaitFrame(m_Frames[m_FrameIndex]);
+
+        //One vkResetCommandPool per queue family instead of an implicit reset in every Begin
+        auto& frame = m_Frames[m_FrameIndex];
+        if (frame.pTransferAllocator)
+            frame.pTransferAllocator->Reset();
+        if (frame.pComputeAllocator)
+            frame.pComputeAllocator->Reset();
+        if (frame.pGraphicsAllocator)
+            frame.pGraphicsAllocator->Reset();
+
+        RecycleCommandLists(frame.TransferCmdLists);
+        RecycleCommandLists(frame.ComputeCmdLists);
+        RecycleCommandLists(frame.GraphicsCmdLists);
+        RecycleCommandLists(frame.GraphicsSecondaryCmdLists);
+    }
+
+    auto CommandAllocatorRing::Internal::WaitFrame(CommandRingFrame& frame) -> void {
+        if (!frame.Semaphore)
+            return;
+
+        vk::SemaphoreWaitInfo waitInfo = {
+            .semaphoreCount = 1,
+            .pSemaphores = &frame.Semaphore,
+            .pValues = &frame.FenceValue
+        };
+        auto result = m_pDevice->GetVkDevice().waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
+        assert(result == vk::Result::eSuccess);
+        frame.Semaphore = vk::Semaphore{};
+    }
+
+    auto CommandAllocatorRing::Internal::Release() -> void {
+        //Lists must outlive their submissions, so every frame still in flight is waited for
+        for (auto& frame : m_Frames)
+            this->WaitFrame(frame);
+        m_Frames.clear();
+    }
+}
+
+namespace HAL {
+
+    CommandAllocatorRing::CommandAllocatorRing(Device const& device, CommandAllocatorRingCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    CommandAllocatorRing::CommandAllocatorRing(CommandAllocatorRing&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    CommandAllocatorRing& CommandAllocatorRing::operator=(CommandAllocatorRing&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    CommandAllocatorRing::~CommandAllocatorRing() = default;
+
+    auto CommandAllocatorRing::AllocateTransferCommandList() -> TransferCommandList& {
+        return m_pInternal->AllocateTransferCommandList();
+    }
+
+    auto CommandAllocatorRing::AllocateComputeCommandList() -> ComputeCommandList& {
+        return m_pInternal->AllocateComputeCommandList();
+    }
+
+    auto CommandAllocatorRing::AllocateGraphicsCommandList(CommandListLevel level) -> GraphicsCommandList& {
+        return m_pInternal->AllocateGraphicsCommandList(level);
+    }
+
+    auto CommandAllocatorRing::NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void {
+        m_pInternal->NextFrame(fence, value);
+    }
+}
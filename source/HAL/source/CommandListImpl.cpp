@@ -4,48 +4,719 @@
 #include "../include/RenderPassImpl.hpp"
 #include "../include/DeviceImpl.hpp"
 
+#include "../include/BufferImpl.hpp"
+#include "../include/TextureImpl.hpp"
+#include "../include/HostAllocator.hpp"
+
+#include <fmt/format.h>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+
 namespace HAL {
 
-    CommandList::Internal::Internal(CommandAllocator const& allocator) {
+    static auto GetVkPipelineBindPoint(CommandListBindPoint bindPoint) -> vk::PipelineBindPoint {
+        return bindPoint == CommandListBindPoint::Graphics ? vk::PipelineBindPoint::eGraphics : vk::PipelineBindPoint::eCompute;
+    }
+
+    auto GetResourceStateInfo(ResourceState state) -> ResourceStateInfo {
+        constexpr auto ShaderStages = vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader;
+        constexpr auto DepthStages = vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+
+        switch (state) {
+            case ResourceState::Undefined:
+                return {vk::PipelineStageFlagBits::eTopOfPipe, {}, vk::ImageLayout::eUndefined, false};
+            case ResourceState::General:
+                return {vk::PipelineStageFlagBits::eAllCommands, vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite, vk::ImageLayout::eGeneral, true};
+            case ResourceState::VertexBuffer:
+                return {vk::PipelineStageFlagBits::eVertexInput, vk::AccessFlagBits::eVertexAttributeRead, vk::ImageLayout::eUndefined, false};
+            case ResourceState::IndexBuffer:
+                return {vk::PipelineStageFlagBits::eVertexInput, vk::AccessFlagBits::eIndexRead, vk::ImageLayout::eUndefined, false};
+            case ResourceState::UniformBuffer:
+                return {ShaderStages, vk::AccessFlagBits::eUniformRead, vk::ImageLayout::eUndefined, false};
+            case ResourceState::IndirectArgument:
+                return {vk::PipelineStageFlagBits::eDrawIndirect, vk::AccessFlagBits::eIndirectCommandRead, vk::ImageLayout::eUndefined, false};
+            case ResourceState::ShaderResource:
+                return {ShaderStages, vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eShaderReadOnlyOptimal, false};
+            case ResourceState::UnorderedAccess:
+                return {ShaderStages, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite, vk::ImageLayout::eGeneral, true};
+            case ResourceState::RenderTarget:
+                return {vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite, vk::ImageLayout::eColorAttachmentOptimal, true};
+            case ResourceState::DepthWrite:
+                return {DepthStages, vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite, vk::ImageLayout::eDepthStencilAttachmentOptimal, true};
+            case ResourceState::DepthRead:
+                return {DepthStages | vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eShaderRead, vk::ImageLayout::eDepthStencilReadOnlyOptimal, false};
+            case ResourceState::CopySource:
+                return {vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferRead, vk::ImageLayout::eTransferSrcOptimal, false};
+            case ResourceState::CopyDest:
+                return {vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferWrite, vk::ImageLayout::eTransferDstOptimal, true};
+            case ResourceState::Present:
+                return {vk::PipelineStageFlagBits::eBottomOfPipe, {}, vk::ImageLayout::ePresentSrcKHR, false};
+        }
+        assert(false);
+        return {};
+    }
+
+    auto GetSupportedStages(vk::QueueFlags queueFlags) -> vk::PipelineStageFlags {
+        vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eTopOfPipe | vk::PipelineStageFlagBits::eBottomOfPipe | vk::PipelineStageFlagBits::eHost | vk::PipelineStageFlagBits::eAllCommands | vk::PipelineStageFlagBits::eTransfer;
+        if (queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute))
+            stages |= vk::PipelineStageFlagBits::eComputeShader | vk::PipelineStageFlagBits::eDrawIndirect;
+        if (queueFlags & vk::QueueFlagBits::eGraphics)
+            stages |= vk::PipelineStageFlagBits::eAllGraphics;
+        return stages;
+    }
+
+    auto GetImageAspect(vk::Format format) -> vk::ImageAspectFlags {
+        switch (format) {
+            case vk::Format::eD16Unorm:
+            case vk::Format::eX8D24UnormPack32:
+            case vk::Format::eD32Sfloat:
+                return vk::ImageAspectFlagBits::eDepth;
+            case vk::Format::eD16UnormS8Uint:
+            case vk::Format::eD24UnormS8Uint:
+            case vk::Format::eD32SfloatS8Uint:
+                return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+            default:
+                return vk::ImageAspectFlagBits::eColor;
+        }
+    }
+
+    //Appends the barrier a resource needs to go from one state to another and returns its index, or -1 when the
+    //transition is free: read to read without a layout change, or a buffer whose previous contents do not matter
+    auto AppendTransition(ResourceBarrierBatch& batch, TrackedResource const& resource, ResourceState stateBefore, ResourceState stateAfter, vk::PipelineStageFlags supportedStages) -> int32_t {
+        auto infoBefore = GetResourceStateInfo(stateBefore);
+        auto infoAfter = GetResourceStateInfo(stateAfter);
+
+        bool isImage = static_cast<bool>(resource.Image);
+        bool isLayoutChange = isImage && infoBefore.Layout != infoAfter.Layout;
+        if (!isImage && stateBefore == ResourceState::Undefined)
+            return -1;
+        if (!isLayoutChange && !infoBefore.IsWrite && !infoAfter.IsWrite)
+            return -1;
+
+        //Stages of another queue family are not valid here; the submission boundary already orders them
+        auto srcStages = infoBefore.Stages & supportedStages;
+        auto dstStages = infoAfter.Stages & supportedStages;
+        batch.SrcStages |= srcStages ? srcStages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTopOfPipe);
+        batch.DstStages |= dstStages ? dstStages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eBottomOfPipe);
+
+        //Only writes have to be made available; a read before a write needs nothing but the execution dependency.
+        //Access masks must match the stages, so nothing is made available when the source stages were masked away
+        auto srcAccess = infoBefore.IsWrite && srcStages ? infoBefore.Access : vk::AccessFlags{};
+        if (isImage) {
+            batch.ImageBarriers.push_back(vk::ImageMemoryBarrier{
+                .srcAccessMask = srcAccess,
+                .dstAccessMask = infoAfter.Access,
+                .oldLayout = infoBefore.Layout,
+                .newLayout = infoAfter.Layout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = resource.Image,
+                .subresourceRange = {resource.Aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}
+            });
+            return static_cast<int32_t>(std::size(batch.ImageBarriers) - 1);
+        }
+
+        batch.BufferBarriers.push_back(vk::BufferMemoryBarrier{
+            .srcAccessMask = srcAccess,
+            .dstAccessMask = infoAfter.Access,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = resource.Buffer,
+            .offset = resource.Offset,
+            .size = resource.Size
+        });
+        return static_cast<int32_t>(std::size(batch.BufferBarriers) - 1);
+    }
+
+    //The dependency info passed to vkCmdSetEvent2 and vkCmdWaitEvents2 must match, so both build it from the same batch
+    static auto GetBarriers2(ResourceBarrierBatch const& batch, std::vector<vk::BufferMemoryBarrier2KHR>& bufferBarriers, std::vector<vk::ImageMemoryBarrier2KHR>& imageBarriers) -> vk::DependencyInfoKHR {
+        auto srcStages = ToPipelineStageFlags2(batch.SrcStages);
+        auto dstStages = ToPipelineStageFlags2(batch.DstStages);
+        for (auto const& barrier : batch.BufferBarriers) {
+            bufferBarriers.push_back(vk::BufferMemoryBarrier2KHR{
+                .srcStageMask = srcStages,
+                .srcAccessMask = ToAccessFlags2(barrier.srcAccessMask),
+                .dstStageMask = dstStages,
+                .dstAccessMask = ToAccessFlags2(barrier.dstAccessMask),
+                .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+                .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+                .buffer = barrier.buffer,
+                .offset = barrier.offset,
+                .size = barrier.size
+            });
+        }
+        for (auto const& barrier : batch.ImageBarriers) {
+            imageBarriers.push_back(vk::ImageMemoryBarrier2KHR{
+                .srcStageMask = srcStages,
+                .srcAccessMask = ToAccessFlags2(barrier.srcAccessMask),
+                .dstStageMask = dstStages,
+                .dstAccessMask = ToAccessFlags2(barrier.dstAccessMask),
+                .oldLayout = barrier.oldLayout,
+                .newLayout = barrier.newLayout,
+                .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+                .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+                .image = barrier.image,
+                .subresourceRange = barrier.subresourceRange
+            });
+        }
+        return vk::DependencyInfoKHR{
+            .bufferMemoryBarrierCount = static_cast<uint32_t>(std::size(bufferBarriers)),
+            .pBufferMemoryBarriers = std::data(bufferBarriers),
+            .imageMemoryBarrierCount = static_cast<uint32_t>(std::size(imageBarriers)),
+            .pImageMemoryBarriers = std::data(imageBarriers)
+        };
+    }
+
+    auto GetResourceStateMutex() -> std::mutex& {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    auto GetTrackedBuffer(Buffer const& buffer) -> TrackedResource {
+        auto pImplBuffer = reinterpret_cast<const Buffer::Internal*>(&buffer);
+        auto pRecord = const_cast<BufferRecord*>(pImplBuffer->GetRecord());
+        return TrackedResource{
+            .pGlobalState = &pRecord->State,
+            .pGlobalQueueFamilyIndex = &pRecord->QueueFamilyIndex,
+            .Buffer = pImplBuffer->GetVkBuffer(),
+            .Offset = pImplBuffer->GetOffset(),
+            .Size = pImplBuffer->GetSize()
+        };
+    }
+
+    auto GetTrackedTexture(Texture const& texture) -> TrackedResource {
+        auto pImplTexture = const_cast<Texture::Internal*>(reinterpret_cast<const Texture::Internal*>(&texture));
+        return TrackedResource{
+            .pGlobalState = &pImplTexture->GetState(),
+            .pGlobalQueueFamilyIndex = &pImplTexture->GetQueueFamilyIndex(),
+            .Image = pImplTexture->GetVkImage(),
+            .Aspect = GetImageAspect(pImplTexture->GetCreateInfo().Format)
+        };
+    }
+
+    CommandList::Internal::Internal(CommandAllocator const& allocator, CommandListLevel level) {
         auto pCmdAllocator = reinterpret_cast<const CommandAllocator::Internal*>(&allocator);
         vk::CommandBufferAllocateInfo cmdBufferAI = {
             .commandPool = pCmdAllocator->GetCommandPool(),
-            .level = vk::CommandBufferLevel::ePrimary,
+            .level = level == CommandListLevel::Primary ? vk::CommandBufferLevel::ePrimary : vk::CommandBufferLevel::eSecondary,
             .commandBufferCount = 1
         };
         m_pCommandBuffer = std::move(pCmdAllocator->GetVkDevice().allocateCommandBuffersUnique(cmdBufferAI).at(0));
         m_pDevice = pCmdAllocator->GetDevice();
+        m_SupportedStages = GetSupportedStages(m_pDevice->GetVkPhysicalDevice().getQueueFamilyProperties()[pCmdAllocator->GetQueueFamilyIndex()].queueFlags);
+        m_IsSynchronization2Enabled = reinterpret_cast<Device::Internal*>(m_pDevice)->IsSynchronization2Enabled();
     }
     
     auto CommandList::Internal::Begin() -> void {
         m_pCommandBuffer->begin(vk::CommandBufferBeginInfo{.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+        this->ResetEvents();
+        this->InvalidateState();
+        m_Statistic = {};
+        m_TrackedResources.clear();
+        m_PendingBarriers = {};
     }
 
     auto CommandList::Internal::End() -> void {
+        //A split transition that is never waited would leave the resource in the old state while the global state
+        //already says the new one
+        for (auto const& [pGlobalState, resource] : m_TrackedResources) {
+            if (resource.SplitEventIndex >= 0)
+                this->EndTransitionResource(pGlobalState);
+        }
+        this->FlushBarriers();
         m_pCommandBuffer->end();
     }
 
     auto CommandList::Internal::BeginRenderPass(RenderPassBeginInfo const& beginInfo) -> void {
-        ((RenderPass::Internal*)(beginInfo.pRenderPass))->GenerateFrameBufferAndCommit(*m_pCommandBuffer, beginInfo);
+        this->FlushBarriers();
+        auto pImplRenderPass = (RenderPass::Internal*)(beginInfo.pRenderPass);
+        m_CurrentFramebuffer = pImplRenderPass->GenerateFrameBufferAndCommit(*m_pCommandBuffer, beginInfo);
+        m_CurrentRenderPass = pImplRenderPass->GetRenderPass();
+        m_CurrentSubpass = 0;
+    }
+
+    auto CommandList::Internal::NextSubpass(vk::SubpassContents contents) -> void {
+        m_pCommandBuffer->nextSubpass(contents);
+        m_CurrentSubpass++;
     }
 
     auto CommandList::Internal::EndRenderPass() -> void {
         m_pCommandBuffer->endRenderPass();
+        m_CurrentRenderPass = vk::RenderPass{};
+        m_CurrentFramebuffer = vk::Framebuffer{};
+        m_CurrentSubpass = 0;
+    }
+
+    auto CommandList::Internal::BeginSecondary(Internal const& primary) -> void {
+        assert(primary.m_CurrentRenderPass);
+
+        vk::CommandBufferInheritanceInfo inheritanceInfo = {
+            .renderPass = primary.m_CurrentRenderPass,
+            .subpass = primary.m_CurrentSubpass,
+            .framebuffer = primary.m_CurrentFramebuffer
+        };
+        m_pCommandBuffer->begin(vk::CommandBufferBeginInfo{
+            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+            .pInheritanceInfo = &inheritanceInfo
+        });
+
+        //Split transitions are not allowed inside a render pass, so a secondary list never holds events
+        m_CurrentRenderPass = primary.m_CurrentRenderPass;
+        m_CurrentFramebuffer = primary.m_CurrentFramebuffer;
+        m_CurrentSubpass = primary.m_CurrentSubpass;
+        this->InvalidateState();
+        m_Statistic = {};
+        m_TrackedResources.clear();
+        m_PendingBarriers = {};
+    }
+
+    auto CommandList::Internal::ExecuteCommands(std::span<const Internal* const> cmdLists) -> void {
+        this->FlushBarriers();
+
+        //Secondary lists are resolved against the primary as if their commands were recorded into it
+        std::vector<vk::CommandBuffer> cmdBuffers;
+        cmdBuffers.reserve(std::size(cmdLists));
+        for (auto pCmdList : cmdLists) {
+            cmdBuffers.push_back(pCmdList->GetVkCommandBuffer());
+            for (auto const& [pGlobalState, secondaryResource] : pCmdList->m_TrackedResources) {
+                auto [iterator, isInserted] = m_TrackedResources.try_emplace(pGlobalState, secondaryResource);
+                auto& resource = iterator->second;
+                if (isInserted) {
+                    resource.PendingBarrierIndex = -1;
+                    resource.SplitEventIndex = -1;
+                    continue;
+                }
+                assert(resource.SplitEventIndex < 0);
+                if (resource.CurrentState != secondaryResource.FirstState)
+                    this->AppendBarrier(resource, secondaryResource.FirstState);
+                resource.CurrentState = secondaryResource.CurrentState;
+            }
+        }
+
+        //A barrier inside a render pass needs a subpass self-dependency, which the render passes here do not declare,
+        //so the resources the secondaries use have to be transitioned before BeginRenderPass
+        if (m_CurrentRenderPass && !m_PendingBarriers.IsEmpty()) {
+            fmt::print("Error: secondary command lists expect other resource states than the render pass leaves them in\n");
+            assert(false);
+        }
+        this->FlushBarriers();
+
+        m_pCommandBuffer->executeCommands(static_cast<uint32_t>(std::size(cmdBuffers)), std::data(cmdBuffers));
+        //State bound in the primary is undefined after vkCmdExecuteCommands
+        this->InvalidateState();
+    }
+
+    auto CommandList::Internal::TransitionResource(TrackedResource const& resource, ResourceState state) -> void {
+        //The first use is not recorded here, the queue resolves it against the global state at submit time
+        auto [iterator, isInserted] = m_TrackedResources.try_emplace(resource.pGlobalState, resource);
+        if (isInserted) {
+            iterator->second.FirstState = state;
+            iterator->second.CurrentState = state;
+            return;
+        }
+        //The resource is still in its old state on the GPU until the split transition is ended
+        assert(iterator->second.SplitEventIndex < 0);
+        this->AppendBarrier(iterator->second, state);
+    }
+
+    auto CommandList::Internal::FlushBarriers() -> void {
+        if (m_PendingBarriers.IsEmpty())
+            return;
+
+        m_pCommandBuffer->pipelineBarrier(m_PendingBarriers.SrcStages, m_PendingBarriers.DstStages, {}, {}, m_PendingBarriers.BufferBarriers, m_PendingBarriers.ImageBarriers);
+        m_Statistic.BarrierCount += static_cast<uint32_t>(std::size(m_PendingBarriers.BufferBarriers) + std::size(m_PendingBarriers.ImageBarriers));
+
+        for (auto& [pGlobalState, resource] : m_TrackedResources)
+            resource.PendingBarrierIndex = -1;
+        m_PendingBarriers.SrcStages = {};
+        m_PendingBarriers.DstStages = {};
+        m_PendingBarriers.BufferBarriers.clear();
+        m_PendingBarriers.ImageBarriers.clear();
+    }
+
+    auto CommandList::Internal::UseResource(TrackedResource const& resource, ResourceState state) -> void {
+        //A barrier inside a render pass needs a subpass self-dependency, which the render passes here do not declare
+        auto iterator = m_TrackedResources.find(resource.pGlobalState);
+        if (m_CurrentRenderPass && iterator != m_TrackedResources.end() && iterator->second.CurrentState != state) {
+            fmt::print("Error: resource is used inside a render pass in another state than it was left in before the pass\n");
+            assert(false);
+            return;
+        }
+        this->TransitionResource(resource, state);
+    }
+
+    auto CommandList::Internal::BeginTransitionResource(TrackedResource const& resource, ResourceState state) -> void {
+        assert(!m_CurrentRenderPass);
+
+        //Without an earlier use in this list there is nothing to overlap, the queue resolves the first state anyway
+        auto iterator = m_TrackedResources.find(resource.pGlobalState);
+        if (iterator == m_TrackedResources.end()) {
+            this->TransitionResource(resource, state);
+            return;
+        }
+
+        auto& tracked = iterator->second;
+        assert(tracked.SplitEventIndex < 0);
+        //The event only orders commands recorded before it, so a batched transition of the same resource goes first
+        if (tracked.PendingBarrierIndex >= 0)
+            this->FlushBarriers();
+
+        tracked.SplitBarriers = {};
+        if (AppendTransition(tracked.SplitBarriers, tracked, tracked.CurrentState, state, m_SupportedStages) >= 0) {
+            tracked.SplitEventIndex = this->AcquireEvent();
+            auto event = *m_Events[tracked.SplitEventIndex];
+            if (m_IsSynchronization2Enabled) {
+                std::vector<vk::BufferMemoryBarrier2KHR> bufferBarriers;
+                std::vector<vk::ImageMemoryBarrier2KHR> imageBarriers;
+                m_pCommandBuffer->setEvent2KHR(event, GetBarriers2(tracked.SplitBarriers, bufferBarriers, imageBarriers));
+            } else {
+                m_pCommandBuffer->setEvent(event, tracked.SplitBarriers.SrcStages);
+            }
+        }
+        tracked.CurrentState = state;
+    }
+
+    auto CommandList::Internal::EndTransitionResource(ResourceState const* pGlobalState) -> void {
+        assert(!m_CurrentRenderPass);
+
+        auto iterator = m_TrackedResources.find(pGlobalState);
+        if (iterator == m_TrackedResources.end() || iterator->second.SplitEventIndex < 0)
+            return;
+
+        auto& tracked = iterator->second;
+        auto const& barriers = tracked.SplitBarriers;
+        auto event = *m_Events[tracked.SplitEventIndex];
+        if (m_IsSynchronization2Enabled) {
+            std::vector<vk::BufferMemoryBarrier2KHR> bufferBarriers;
+            std::vector<vk::ImageMemoryBarrier2KHR> imageBarriers;
+            auto dependencyInfo = GetBarriers2(barriers, bufferBarriers, imageBarriers);
+            m_pCommandBuffer->waitEvents2KHR(1, &event, &dependencyInfo);
+        } else {
+            m_pCommandBuffer->waitEvents(event, barriers.SrcStages, barriers.DstStages, {}, barriers.BufferBarriers, barriers.ImageBarriers);
+        }
+        m_Statistic.BarrierCount += static_cast<uint32_t>(std::size(barriers.BufferBarriers) + std::size(barriers.ImageBarriers));
+
+        tracked.SplitEventIndex = -1;
+        tracked.SplitBarriers = {};
+    }
+
+    auto CommandList::Internal::AcquireEvent() -> int32_t {
+        if (m_EventCount == std::size(m_Events))
+            m_Events.push_back(m_pCommandBuffer.getOwner().createEventUnique(vk::EventCreateInfo{}, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Synchronization)));
+        return static_cast<int32_t>(m_EventCount++);
+    }
+
+    auto CommandList::Internal::ResetEvents() -> void {
+        //A submission of the previous recording may still be waiting on the events, so they are reset in the command
+        //stream instead of from the host, after every command submitted earlier to the queue
+        for (uint32_t index = 0; index < m_EventCount; index++)
+            m_pCommandBuffer->resetEvent(*m_Events[index], vk::PipelineStageFlagBits::eAllCommands);
+        m_EventCount = 0;
+    }
+
+    auto CommandList::Internal::ResolveInitialStates(uint32_t queueFamilyIndex) -> ResourceBarrierBatch {
+        ResourceBarrierBatch barriers;
+        for (auto const& [pGlobalState, resource] : m_TrackedResources) {
+            //The fix-up barriers carry no ownership transfer; work that moves a resource to another family goes through
+            //the frame graph or the async compute scheduler, which record the release and acquire pairs themselves
+            uint32_t lastQueueFamilyIndex = *resource.pGlobalQueueFamilyIndex;
+            if (lastQueueFamilyIndex != VK_QUEUE_FAMILY_IGNORED && lastQueueFamilyIndex != queueFamilyIndex && *resource.pGlobalState != ResourceState::Undefined) {
+                fmt::print("Error: resource was last used on queue family {} and is submitted to queue family {} without an ownership transfer\n", lastQueueFamilyIndex, queueFamilyIndex);
+                assert(false);
+            }
+            AppendTransition(barriers, resource, *resource.pGlobalState, resource.FirstState, m_SupportedStages);
+            *resource.pGlobalState = resource.CurrentState;
+            *resource.pGlobalQueueFamilyIndex = queueFamilyIndex;
+        }
+        return barriers;
+    }
+
+    auto CommandList::Internal::AppendBarrier(TrackedResource& resource, ResourceState state) -> void {
+        //A transition still pending since the last consuming command is retargeted instead of chained
+        if (resource.PendingBarrierIndex >= 0) {
+            auto infoAfter = GetResourceStateInfo(state);
+            auto dstStages = infoAfter.Stages & m_SupportedStages;
+            m_PendingBarriers.DstStages |= dstStages ? dstStages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eBottomOfPipe);
+            if (resource.Image) {
+                auto& barrier = m_PendingBarriers.ImageBarriers[resource.PendingBarrierIndex];
+                barrier.dstAccessMask |= infoAfter.Access;
+                barrier.newLayout = infoAfter.Layout;
+            } else {
+                m_PendingBarriers.BufferBarriers[resource.PendingBarrierIndex].dstAccessMask |= infoAfter.Access;
+            }
+            m_Statistic.ElidedCommandCount++;
+        } else {
+            resource.PendingBarrierIndex = AppendTransition(m_PendingBarriers, resource, resource.CurrentState, state, m_SupportedStages);
+        }
+        resource.CurrentState = state;
     }
 
     auto CommandList::Internal::SetComputePipeline(ComputePipeline const& pipeline, ComputeState const& state) -> void {
         auto pImplDevice = reinterpret_cast<Device::Internal*>(m_pDevice);
-        m_pCommandBuffer->bindPipeline(vk::PipelineBindPoint::eCompute, pImplDevice->GetPipelineCache().GetComputePipeline(pipeline, state));
+        auto pImplPipeline = reinterpret_cast<const Pipeline*>(&pipeline);
+        this->SetPipeline(CommandListBindPoint::Compute, pImplDevice->GetPipelineCache().GetComputePipeline(pipeline, state), pImplPipeline->GetVkPiplineLayout());
+    }
+
+    auto CommandList::Internal::SetGraphicsPipeline(GraphicsPipeline const& pipeline, GraphicsState const& state) -> void {
+        //The pipeline is compiled against the subpass being recorded, so it can only be set inside a render pass
+        assert(m_CurrentRenderPass);
+        auto pImplDevice = reinterpret_cast<Device::Internal*>(m_pDevice);
+        auto pImplPipeline = reinterpret_cast<const Pipeline*>(&pipeline);
+        this->SetPipeline(CommandListBindPoint::Graphics, pImplDevice->GetPipelineCache().GetGraphicsPipeline(pipeline, m_CurrentRenderPass, m_CurrentSubpass, state), pImplPipeline->GetVkPiplineLayout());
+    }
+
+    auto CommandList::Internal::SetDescriptorSet(CommandListBindPoint bindPoint, uint32_t slot, vk::DescriptorSet descriptorSet) -> void {
+        assert(slot < MaxDescriptorSetCount);
+
+        auto& state = m_BindStates[uint32_t(bindPoint)];
+        auto bit = 1u << slot;
+        if (state.DescriptorSets[slot] == descriptorSet || (state.DirtyDescriptorSetMask & bit))
+            m_Statistic.ElidedCommandCount++;
+        if (state.DescriptorSets[slot] == descriptorSet)
+            return;
+
+        state.DescriptorSets[slot] = descriptorSet;
+        state.DirtyDescriptorSetMask |= bit;
+    }
+
+    auto CommandList::Internal::SetPushConstants(CommandListBindPoint bindPoint, uint32_t offset, std::span<const std::byte> data) -> void {
+        auto size = static_cast<uint32_t>(std::size(data));
+        assert(offset + size <= MaxPushConstantSize);
+
+        auto& state = m_BindStates[uint32_t(bindPoint)];
+        auto end = offset + size;
+        bool isKnown = offset >= state.PushConstantKnownBegin && end <= state.PushConstantKnownEnd;
+        if (isKnown && std::memcmp(std::data(state.PushConstants) + offset, std::data(data), size) == 0) {
+            m_Statistic.ElidedCommandCount++;
+            return;
+        }
+
+        //Pending ranges are merged, so only one vkCmdPushConstants is recorded at the next draw or dispatch
+        if (state.PushConstantDirtyBegin != state.PushConstantDirtyEnd) {
+            state.PushConstantDirtyBegin = std::min(state.PushConstantDirtyBegin, offset);
+            state.PushConstantDirtyEnd = std::max(state.PushConstantDirtyEnd, end);
+            m_Statistic.ElidedCommandCount++;
+        } else {
+            state.PushConstantDirtyBegin = offset;
+            state.PushConstantDirtyEnd = end;
+        }
+        std::memcpy(std::data(state.PushConstants) + offset, std::data(data), size);
+    }
+
+    auto CommandList::Internal::SetViewport(vk::Viewport const& viewport) -> void {
+        auto& state = m_GraphicsState;
+        if ((state.HasViewport && state.Viewport == viewport) || state.IsViewportDirty)
+            m_Statistic.ElidedCommandCount++;
+        if (state.HasViewport && state.Viewport == viewport)
+            return;
+
+        state.Viewport = viewport;
+        state.HasViewport = true;
+        state.IsViewportDirty = true;
+    }
+
+    auto CommandList::Internal::SetScissor(vk::Rect2D const& scissor) -> void {
+        auto& state = m_GraphicsState;
+        if ((state.HasScissor && state.Scissor == scissor) || state.IsScissorDirty)
+            m_Statistic.ElidedCommandCount++;
+        if (state.HasScissor && state.Scissor == scissor)
+            return;
+
+        state.Scissor = scissor;
+        state.HasScissor = true;
+        state.IsScissorDirty = true;
+    }
+
+    auto CommandList::Internal::SetVertexBuffer(uint32_t slot, vk::Buffer buffer, vk::DeviceSize offset) -> void {
+        assert(slot < MaxVertexBufferCount);
+
+        auto& state = m_GraphicsState;
+        auto bit = 1u << slot;
+        bool isBound = state.VertexBuffers[slot] == buffer && state.VertexBufferOffsets[slot] == offset;
+        if (isBound || (state.DirtyVertexBufferMask & bit))
+            m_Statistic.ElidedCommandCount++;
+        if (isBound)
+            return;
+
+        state.VertexBuffers[slot] = buffer;
+        state.VertexBufferOffsets[slot] = offset;
+        state.DirtyVertexBufferMask |= bit;
+    }
+
+    auto CommandList::Internal::SetIndexBuffer(vk::Buffer buffer, vk::DeviceSize offset, vk::IndexType indexType) -> void {
+        auto& state = m_GraphicsState;
+        bool isBound = state.IndexBuffer == buffer && state.IndexBufferOffset == offset && state.IndexType == indexType;
+        if (isBound || state.IsIndexBufferDirty)
+            m_Statistic.ElidedCommandCount++;
+        if (isBound)
+            return;
+
+        state.IndexBuffer = buffer;
+        state.IndexBufferOffset = offset;
+        state.IndexType = indexType;
+        state.IsIndexBufferDirty = true;
     }
 
     auto CommandList::Internal::Dispath(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) -> void {
+        this->FlushBarriers();
+        this->FlushBindState(CommandListBindPoint::Compute);
         m_pCommandBuffer->dispatch(groupCountX, groupCountY, groupCountZ);
     }
+
+    auto CommandList::Internal::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) -> void {
+        this->FlushBarriers();
+        this->FlushBindState(CommandListBindPoint::Graphics);
+        this->FlushGraphicsState();
+        m_pCommandBuffer->draw(vertexCount, instanceCount, firstVertex, firstInstance);
+    }
+
+    auto CommandList::Internal::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) -> void {
+        this->FlushBarriers();
+        this->FlushBindState(CommandListBindPoint::Graphics);
+        this->FlushGraphicsState();
+        m_pCommandBuffer->drawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+    }
+
+    auto CommandList::Internal::DispatchIndirect(vk::Buffer buffer, vk::DeviceSize offset) -> void {
+        this->FlushBarriers();
+        this->FlushBindState(CommandListBindPoint::Compute);
+        m_pCommandBuffer->dispatchIndirect(buffer, offset);
+    }
+
+    auto CommandList::Internal::DrawIndirect(vk::Buffer buffer, vk::DeviceSize offset, uint32_t drawCount, uint32_t stride) -> void {
+        assert(drawCount <= 1 || reinterpret_cast<Device::Internal*>(m_pDevice)->IsMultiDrawIndirectEnabled());
+
+        this->FlushBarriers();
+        this->FlushBindState(CommandListBindPoint::Graphics);
+        this->FlushGraphicsState();
+        m_pCommandBuffer->drawIndirect(buffer, offset, drawCount, stride);
+    }
+
+    auto CommandList::Internal::DrawIndexedIndirect(vk::Buffer buffer, vk::DeviceSize offset, uint32_t drawCount, uint32_t stride) -> void {
+        assert(drawCount <= 1 || reinterpret_cast<Device::Internal*>(m_pDevice)->IsMultiDrawIndirectEnabled());
+
+        this->FlushBarriers();
+        this->FlushBindState(CommandListBindPoint::Graphics);
+        this->FlushGraphicsState();
+        m_pCommandBuffer->drawIndexedIndirect(buffer, offset, drawCount, stride);
+    }
+
+    auto CommandList::Internal::DrawIndexedIndirectCount(vk::Buffer buffer, vk::DeviceSize offset, vk::Buffer countBuffer, vk::DeviceSize countOffset, uint32_t maxDrawCount, uint32_t stride) -> void {
+        assert(reinterpret_cast<Device::Internal*>(m_pDevice)->IsDrawIndirectCountEnabled());
+
+        this->FlushBarriers();
+        this->FlushBindState(CommandListBindPoint::Graphics);
+        this->FlushGraphicsState();
+        m_pCommandBuffer->drawIndexedIndirectCount(buffer, offset, countBuffer, countOffset, maxDrawCount, stride);
+    }
+
+    auto CommandList::Internal::InvalidateState() -> void {
+        m_BindStates = {};
+        m_GraphicsState = {};
+    }
+
+    auto CommandList::Internal::SetPipeline(CommandListBindPoint bindPoint, vk::Pipeline pipeline, vk::PipelineLayout layout) -> void {
+        auto& state = m_BindStates[uint32_t(bindPoint)];
+        if (state.Pipeline == pipeline || state.IsPipelineDirty)
+            m_Statistic.ElidedCommandCount++;
+        if (state.Pipeline == pipeline)
+            return;
+
+        state.Pipeline = pipeline;
+        state.IsPipelineDirty = true;
+
+        //Sets bound through another layout may be disturbed, so every set is bound again with the new one
+        if (state.Layout != layout) {
+            state.Layout = layout;
+            for (uint32_t slot = 0; slot < MaxDescriptorSetCount; slot++)
+                if (state.DescriptorSets[slot])
+                    state.DirtyDescriptorSetMask |= 1u << slot;
+        }
+    }
+
+    auto CommandList::Internal::FlushBindState(CommandListBindPoint bindPoint) -> void {
+        auto& state = m_BindStates[uint32_t(bindPoint)];
+        auto vkBindPoint = GetVkPipelineBindPoint(bindPoint);
+
+        if (state.IsPipelineDirty) {
+            m_pCommandBuffer->bindPipeline(vkBindPoint, state.Pipeline);
+            m_Statistic.RecordedCommandCount++;
+            state.IsPipelineDirty = false;
+        }
+
+        //Sets and push constants need a layout, so they stay pending until a pipeline is set
+        if (!state.Layout)
+            return;
+
+        //Contiguous dirty slots are bound with a single call
+        for (uint32_t slot = 0; slot < MaxDescriptorSetCount;) {
+            if (!(state.DirtyDescriptorSetMask & (1u << slot)) || !state.DescriptorSets[slot]) {
+                slot++;
+                continue;
+            }
+            uint32_t count = 1;
+            while (slot + count < MaxDescriptorSetCount && (state.DirtyDescriptorSetMask & (1u << (slot + count))) && state.DescriptorSets[slot + count])
+                count++;
+            m_pCommandBuffer->bindDescriptorSets(vkBindPoint, state.Layout, slot, count, std::data(state.DescriptorSets) + slot, 0, nullptr);
+            m_Statistic.RecordedCommandCount++;
+            slot += count;
+        }
+        state.DirtyDescriptorSetMask = 0;
+
+        if (state.PushConstantDirtyBegin != state.PushConstantDirtyEnd) {
+            auto size = state.PushConstantDirtyEnd - state.PushConstantDirtyBegin;
+            m_pCommandBuffer->pushConstants(state.Layout, vk::ShaderStageFlagBits::eAll, state.PushConstantDirtyBegin, size, std::data(state.PushConstants) + state.PushConstantDirtyBegin);
+            m_Statistic.RecordedCommandCount++;
+
+            bool isAdjacent = state.PushConstantDirtyBegin <= state.PushConstantKnownEnd && state.PushConstantDirtyEnd >= state.PushConstantKnownBegin && state.PushConstantKnownBegin != state.PushConstantKnownEnd;
+            state.PushConstantKnownBegin = isAdjacent ? std::min(state.PushConstantKnownBegin, state.PushConstantDirtyBegin) : state.PushConstantDirtyBegin;
+            state.PushConstantKnownEnd = isAdjacent ? std::max(state.PushConstantKnownEnd, state.PushConstantDirtyEnd) : state.PushConstantDirtyEnd;
+            state.PushConstantDirtyBegin = 0;
+            state.PushConstantDirtyEnd = 0;
+        }
+    }
+
+    auto CommandList::Internal::FlushGraphicsState() -> void {
+        auto& state = m_GraphicsState;
+
+        if (state.IsViewportDirty) {
+            m_pCommandBuffer->setViewport(0, 1, &state.Viewport);
+            m_Statistic.RecordedCommandCount++;
+            state.IsViewportDirty = false;
+        }
+
+        if (state.IsScissorDirty) {
+            m_pCommandBuffer->setScissor(0, 1, &state.Scissor);
+            m_Statistic.RecordedCommandCount++;
+            state.IsScissorDirty = false;
+        }
+
+        for (uint32_t slot = 0; slot < MaxVertexBufferCount;) {
+            if (!(state.DirtyVertexBufferMask & (1u << slot))) {
+                slot++;
+                continue;
+            }
+            uint32_t count = 1;
+            while (slot + count < MaxVertexBufferCount && (state.DirtyVertexBufferMask & (1u << (slot + count))))
+                count++;
+            m_pCommandBuffer->bindVertexBuffers(slot, count, std::data(state.VertexBuffers) + slot, std::data(state.VertexBufferOffsets) + slot);
+            m_Statistic.RecordedCommandCount++;
+            slot += count;
+        }
+        state.DirtyVertexBufferMask = 0;
+
+        if (state.IsIndexBufferDirty) {
+            m_pCommandBuffer->bindIndexBuffer(state.IndexBuffer, state.IndexBufferOffset, state.IndexType);
+            m_Statistic.RecordedCommandCount++;
+            state.IsIndexBufferDirty = false;
+        }
+    }
 }
 
 namespace HAL {
 
-    CommandList::CommandList(CommandAllocator const& allocator) : m_pInternal(allocator) {}
+    CommandList::CommandList(CommandAllocator const& allocator, CommandListLevel level) : m_pInternal(allocator, level) {}
 
     CommandList::CommandList(CommandList&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
 
@@ -55,10 +726,23 @@ namespace HAL {
         m_pInternal->SetComputePipeline(pipeline, state);      
     }
 
+    auto ComputeCommandList::SetComputeDescriptorSet(uint32_t slot, vk::DescriptorSet descriptorSet) -> void {
+        m_pInternal->SetDescriptorSet(CommandListBindPoint::Compute, slot, descriptorSet);
+    }
+
+    auto ComputeCommandList::SetComputePushConstants(uint32_t offset, std::span<const std::byte> data) -> void {
+        m_pInternal->SetPushConstants(CommandListBindPoint::Compute, offset, data);
+    }
+
     auto ComputeCommandList::Dispatch(uint32_t threadGroupCountX, uint32_t threadGroupCountY, uint32_t threadGroupCountZ) -> void {
         m_pInternal->Dispath(threadGroupCountX, threadGroupCountY, threadGroupCountZ);
     }
 
+    auto ComputeCommandList::DispatchIndirect(Buffer const& buffer, uint64_t offset) -> void {
+        m_pInternal->UseResource(GetTrackedBuffer(buffer), ResourceState::IndirectArgument);
+        m_pInternal->DispatchIndirect(buffer.GetVkBuffer(), buffer.GetOffset() + offset);
+    }
+
     CommandList::~CommandList() = default;
 
     auto CommandList::Begin() -> void {
@@ -69,22 +753,134 @@ namespace HAL {
         m_pInternal->End();
     }
 
+    auto CommandList::TransitionBuffer(Buffer const& buffer, ResourceState state) -> void {
+        m_pInternal->TransitionResource(GetTrackedBuffer(buffer), state);
+    }
+
+    auto CommandList::TransitionTexture(Texture const& texture, ResourceState state) -> void {
+        m_pInternal->TransitionResource(GetTrackedTexture(texture), state);
+    }
+
+    auto CommandList::BeginTransitionBuffer(Buffer const& buffer, ResourceState state) -> void {
+        m_pInternal->BeginTransitionResource(GetTrackedBuffer(buffer), state);
+    }
+
+    auto CommandList::EndTransitionBuffer(Buffer const& buffer) -> void {
+        m_pInternal->EndTransitionResource(GetTrackedBuffer(buffer).pGlobalState);
+    }
+
+    auto CommandList::BeginTransitionTexture(Texture const& texture, ResourceState state) -> void {
+        m_pInternal->BeginTransitionResource(GetTrackedTexture(texture), state);
+    }
+
+    auto CommandList::EndTransitionTexture(Texture const& texture) -> void {
+        m_pInternal->EndTransitionResource(GetTrackedTexture(texture).pGlobalState);
+    }
+
+    auto CommandList::FlushBarriers() -> void {
+        m_pInternal->FlushBarriers();
+    }
+
+    auto CommandList::InvalidateState() -> void {
+        m_pInternal->InvalidateState();
+    }
+
+    auto CommandList::GetStatistic() const -> CommandListStatistic {
+        return m_pInternal->GetStatistic();
+    }
+
     auto CommandList::GetVkCommandBuffer() const -> vk::CommandBuffer {
         return m_pInternal->GetVkCommandBuffer();
     }
 
     TransferCommandList::TransferCommandList(TransferCommandAllocator const& allocator) : CommandList(*reinterpret_cast<CommandAllocator const*>(&allocator)) {}
 
+    TransferCommandList::TransferCommandList(CommandAllocator const& allocator, CommandListLevel level) : CommandList(allocator, level) {}
+
     ComputeCommandList::ComputeCommandList(ComputeCommandAllocator const& allocator) : TransferCommandList(*reinterpret_cast<TransferCommandAllocator const*>(&allocator)) {}
 
+    ComputeCommandList::ComputeCommandList(CommandAllocator const& allocator, CommandListLevel level) : TransferCommandList(allocator, level) {}
+
    
-    GraphicsCommandList::GraphicsCommandList(GraphicsCommandAllocator const& allocator) : ComputeCommandList(*reinterpret_cast<ComputeCommandAllocator const*>(&allocator)) {}
+    GraphicsCommandList::GraphicsCommandList(GraphicsCommandAllocator const& allocator, CommandListLevel level) : ComputeCommandList(allocator, level) {}
 
     auto GraphicsCommandList::BeginRenderPass(RenderPassBeginInfo const& beginInfo) -> void {
         m_pInternal->BeginRenderPass(beginInfo);
     }
 
+    auto GraphicsCommandList::NextSubpass(vk::SubpassContents contents) -> void {
+        m_pInternal->NextSubpass(contents);
+    }
+
     auto GraphicsCommandList::EndRenderPass() -> void {
         m_pInternal->EndRenderPass();
     }
+
+    auto GraphicsCommandList::BeginSecondary(GraphicsCommandList const& primary) -> void {
+        m_pInternal->BeginSecondary(*primary.m_pInternal);
+    }
+
+    auto GraphicsCommandList::ExecuteCommands(ArraySpan<GraphicsCommandList> cmdLists) -> void {
+        std::vector<const CommandList::Internal*> pImplCmdLists;
+        pImplCmdLists.reserve(std::size(cmdLists));
+        for (auto const& cmdList : cmdLists)
+            pImplCmdLists.push_back(reinterpret_cast<const CommandList::Internal*>(&cmdList.get()));
+        m_pInternal->ExecuteCommands(pImplCmdLists);
+    }
+
+    auto GraphicsCommandList::ExecuteCommands(ArrayView<GraphicsCommandList> cmdLists) -> void {
+        this->ExecuteCommands(ArraySpan<GraphicsCommandList>(std::begin(cmdLists), std::size(cmdLists)));
+    }
+
+    auto GraphicsCommandList::SetGraphicsPipeline(GraphicsPipeline const& pipeline, GraphicsState const& state) -> void {
+        m_pInternal->SetGraphicsPipeline(pipeline, state);
+    }
+
+    auto GraphicsCommandList::SetGraphicsDescriptorSet(uint32_t slot, vk::DescriptorSet descriptorSet) -> void {
+        m_pInternal->SetDescriptorSet(CommandListBindPoint::Graphics, slot, descriptorSet);
+    }
+
+    auto GraphicsCommandList::SetGraphicsPushConstants(uint32_t offset, std::span<const std::byte> data) -> void {
+        m_pInternal->SetPushConstants(CommandListBindPoint::Graphics, offset, data);
+    }
+
+    auto GraphicsCommandList::SetViewport(vk::Viewport const& viewport) -> void {
+        m_pInternal->SetViewport(viewport);
+    }
+
+    auto GraphicsCommandList::SetScissor(vk::Rect2D const& scissor) -> void {
+        m_pInternal->SetScissor(scissor);
+    }
+
+    auto GraphicsCommandList::SetVertexBuffer(uint32_t slot, Buffer const& buffer) -> void {
+        m_pInternal->SetVertexBuffer(slot, buffer.GetVkBuffer(), buffer.GetOffset());
+    }
+
+    auto GraphicsCommandList::SetIndexBuffer(Buffer const& buffer, vk::IndexType indexType) -> void {
+        m_pInternal->SetIndexBuffer(buffer.GetVkBuffer(), buffer.GetOffset(), indexType);
+    }
+
+    auto GraphicsCommandList::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) -> void {
+        m_pInternal->Draw(vertexCount, instanceCount, firstVertex, firstInstance);
+    }
+
+    auto GraphicsCommandList::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) -> void {
+        m_pInternal->DrawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+    }
+
+    auto GraphicsCommandList::DrawIndirect(Buffer const& buffer, uint64_t offset, uint32_t drawCount, uint32_t stride) -> void {
+        m_pInternal->UseResource(GetTrackedBuffer(buffer), ResourceState::IndirectArgument);
+        m_pInternal->DrawIndirect(buffer.GetVkBuffer(), buffer.GetOffset() + offset, drawCount, stride);
+    }
+
+    auto GraphicsCommandList::DrawIndexedIndirect(Buffer const& buffer, uint64_t offset, uint32_t drawCount, uint32_t stride) -> void {
+        m_pInternal->UseResource(GetTrackedBuffer(buffer), ResourceState::IndirectArgument);
+        m_pInternal->DrawIndexedIndirect(buffer.GetVkBuffer(), buffer.GetOffset() + offset, drawCount, stride);
+    }
+
+    auto GraphicsCommandList::DrawIndexedIndirectCount(Buffer const& buffer, uint64_t offset, Buffer const& countBuffer, uint64_t countOffset, uint32_t maxDrawCount, uint32_t stride) -> void {
+        m_pInternal->UseResource(GetTrackedBuffer(buffer), ResourceState::IndirectArgument);
+        m_pInternal->UseResource(GetTrackedBuffer(countBuffer), ResourceState::IndirectArgument);
+        m_pInternal->DrawIndexedIndirectCount(buffer.GetVkBuffer(), buffer.GetOffset() + offset, countBuffer.GetVkBuffer(), countBuffer.GetOffset() + countOffset, maxDrawCount, stride);
+    }
 }
\ No newline at end of file
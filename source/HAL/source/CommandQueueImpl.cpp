@@ -2,124 +2,359 @@
 #include "../include/SwapChainImpl.hpp"
 #include "../include/FenceImpl.hpp"
 #include "../include/CommandListImpl.hpp"
+#include "../include/SubmitBatchImpl.hpp"
+#include "../include/HostAllocator.hpp"
 
-//TODO Lock
+#include <future>
 
 namespace HAL {
-    CommandQueue::Internal::Internal(vk::Queue queue) : m_Queue(queue) {}
-
-    auto CommandQueue::Internal::Signal(Fence const& fence, std::optional<uint64_t> value) const -> void {
-        vk::Semaphore signalSemaphores[] = {fence.GetVkSemaphore()};
-        uint64_t signalSemaphoreValues[] = {value.value_or(fence.GetExpectedValue())};
-
-        vk::TimelineSemaphoreSubmitInfo timelineInfo = {
-            .signalSemaphoreValueCount = _countof(signalSemaphoreValues),
-            .pSignalSemaphoreValues = signalSemaphoreValues
+    CommandQueue::Internal::Internal(vk::Device device, vk::Queue queue, uint32_t queueFamilyIndex, bool isSynchronization2Enabled) {
+        vk::SemaphoreTypeCreateInfo semaphoreTypeCI = {
+            .semaphoreType = vk::SemaphoreType::eTimeline,
+            .initialValue = 0
         };
-        vk::SubmitInfo submitInfo = {
-            .pNext = &timelineInfo,
-            .signalSemaphoreCount = _countof(signalSemaphores),
-            .pSignalSemaphores = signalSemaphores
+        vk::SemaphoreCreateInfo semaphoreCI = {
+            .pNext = &semaphoreTypeCI
         };
-        m_Queue.submit({submitInfo}, {});
+
+        m_pState = std::make_unique<SubmissionState>();
+        m_pState->Queue = queue;
+        m_pState->QueueFamilyIndex = queueFamilyIndex;
+        m_pState->IsSynchronization2Enabled = isSynchronization2Enabled;
+        m_pState->pProgressSemaphore = device.createSemaphoreUnique(semaphoreCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Synchronization));
+        m_pState->pFixupPool = device.createCommandPoolUnique(vk::CommandPoolCreateInfo{.flags = vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer, .queueFamilyIndex = queueFamilyIndex}, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Command));
+        m_pState->Thread = std::thread(&Internal::SubmitLoop, m_pState.get());
     }
 
-    auto CommandQueue::Internal::Wait(Fence const& fence, std::optional<uint64_t> value) const -> void {
-        vk::Semaphore pWaitSemaphores[] = {fence.GetVkSemaphore()};
-        uint64_t pWaitSemaphoreValues[] = {value.value_or(fence.GetExpectedValue())};
-        vk::PipelineStageFlags pWaitStages[] = {vk::PipelineStageFlagBits::eAllCommands};
+    CommandQueue::Internal& CommandQueue::Internal::operator=(Internal&& rhs) noexcept {
+        if (this != &rhs) {
+            this->Release();
+            m_pState = std::move(rhs.m_pState);
+        }
+        return *this;
+    }
 
-        vk::TimelineSemaphoreSubmitInfo timelineInfo = {
-            .waitSemaphoreValueCount = 1,
-            .pWaitSemaphoreValues = pWaitSemaphoreValues
-        };
-        vk::SubmitInfo submitInfo = {
-            .pNext = &timelineInfo,
-            .waitSemaphoreCount = 1,
-            .pWaitSemaphores = pWaitSemaphores,
-            .pWaitDstStageMask = pWaitStages
-        };
-        m_Queue.submit({submitInfo}, {});
+    CommandQueue::Internal::~Internal() {
+        this->Release();
     }
 
-    auto CommandQueue::Internal::NextImage(SwapChain const& swapChain, Fence const& fence, std::optional<uint64_t> value) const -> uint32_t {
+    auto CommandQueue::Internal::Enqueue(SubmissionJob&& job) const -> void {
+        auto pNode = new SubmissionNode{.Job = std::move(job), .pNext = m_pState->pHead.load(std::memory_order_relaxed)};
+        while (!m_pState->pHead.compare_exchange_weak(pNode->pNext, pNode, std::memory_order_release, std::memory_order_relaxed));
+
+        m_pState->PendingJobCount.fetch_add(1, std::memory_order_relaxed);
+        m_pState->PushCount.fetch_add(1, std::memory_order_release);
+        m_pState->PushCount.notify_one();
+    }
+
+    auto CommandQueue::Internal::Signal(Fence const& fence, std::optional<uint64_t> value) const -> void {
+        this->Enqueue([semaphore = fence.GetVkSemaphore(), signalValue = value.value_or(fence.GetExpectedValue())](SubmissionState& state) -> void {
+            Internal::SubmitSemaphores(state, {}, 0, {}, semaphore, signalValue);
+        });
+    }
+
+    auto CommandQueue::Internal::Wait(Fence const& fence, std::optional<uint64_t> value, vk::PipelineStageFlags2KHR stages) const -> void {
+        this->Enqueue([semaphore = fence.GetVkSemaphore(), waitValue = value.value_or(fence.GetExpectedValue()), stages](SubmissionState& state) -> void {
+            Internal::SubmitSemaphores(state, semaphore, waitValue, stages, {}, 0);
+        });
+    }
+
+    auto CommandQueue::Internal::AcquireNextImage(SwapChain const& swapChain) const -> uint32_t {
         auto pSwapChain = (SwapChain::Internal*)(&swapChain);
         pSwapChain->Acquire();
 
+        //vkAcquireNextImageKHR only synchronizes on the swapchain, so it stays on the calling thread
         auto [result, frameID] = pSwapChain->GetVkDevice().acquireNextImageKHR(pSwapChain->GetSwapChain(), std::numeric_limits<uint64_t>::max(), pSwapChain->GetSemaphoreAvailable(), nullptr);
         assert(result == vk::Result::eSuccess || result == vk::Result::eSuboptimalKHR);
+        return frameID;
+    }
 
-        vk::Semaphore pWaitSemaphores[] = {pSwapChain->GetSemaphoreAvailable()};
-        vk::Semaphore pSignalSemaphores[] = {fence.GetVkSemaphore()};
-
-        uint64_t pSignalSemaphoreValues[] = {value.value_or(fence.GetExpectedValue())};
-
-        vk::PipelineStageFlags pStageMask[] = {vk::PipelineStageFlagBits::eTransfer};
-
-        vk::TimelineSemaphoreSubmitInfo timelineSemaphoreSubmitInfo = {
-            .signalSemaphoreValueCount = _countof(pSignalSemaphoreValues),
-            .pSignalSemaphoreValues = pSignalSemaphoreValues
-        };
+    auto CommandQueue::Internal::NextImage(SwapChain const& swapChain, Fence const& fence, std::optional<uint64_t> value) const -> uint32_t {
+        auto pSwapChain = (SwapChain::Internal*)(&swapChain);
+        auto frameID = this->AcquireNextImage(swapChain);
 
-        vk::SubmitInfo submitInfo = {
-            .pNext = &timelineSemaphoreSubmitInfo,
-            .waitSemaphoreCount = _countof(pWaitSemaphores),
-            .pWaitSemaphores = pWaitSemaphores,
-            .pWaitDstStageMask = pStageMask,
-            .signalSemaphoreCount = _countof(pSignalSemaphores),
-            .pSignalSemaphores = pSignalSemaphores
-        };
-        m_Queue.submit(submitInfo, {});
+        //The image is first written as a color attachment, so only that stage has to wait for the presentation engine
+        this->Enqueue([waitSemaphore = pSwapChain->GetSemaphoreAvailable(), signalSemaphore = fence.GetVkSemaphore(), signalValue = value.value_or(fence.GetExpectedValue())](SubmissionState& state) -> void {
+            Internal::SubmitSemaphores(state, waitSemaphore, 0, vk::PipelineStageFlagBits2KHR::eColorAttachmentOutput, signalSemaphore, signalValue);
+        });
         return frameID;
     }
 
     auto CommandQueue::Internal::Present(SwapChain const& swapChain, uint32_t frameID, Fence const& fence, std::optional<uint64_t> value) const -> void {
         auto pSwapChain = (SwapChain::Internal*)(&swapChain);
 
-        uint64_t pWaitSemaphoreValues[] = {value.value_or(fence.GetExpectedValue())};
+        //The semaphores are captured now, so the swapchain slot can be released on the calling thread
+        //The bridge has no work of its own, so the binary semaphore must wait for everything before it
+        this->Enqueue([waitSemaphore = fence.GetVkSemaphore(), waitValue = value.value_or(fence.GetExpectedValue()), signalSemaphore = pSwapChain->GetSemaphoreFinished(), vkSwapChain = pSwapChain->GetSwapChain(), frameID](SubmissionState& state) -> void {
+            Internal::SubmitSemaphores(state, waitSemaphore, waitValue, vk::PipelineStageFlagBits2KHR::eAllCommands, signalSemaphore, 0);
+            Internal::PresentImage(state.Queue, vkSwapChain, signalSemaphore, frameID);
+        });
+        pSwapChain->Release();
+    }
 
-        vk::Semaphore pSignalSemaphores[] = {pSwapChain->GetSemaphoreFinished()};
-        vk::Semaphore pWaitSemahores[] = {fence.GetVkSemaphore()};
+    auto CommandQueue::Internal::Submit(SubmitBatch const& batch) const -> void {
+        auto pBatch = reinterpret_cast<const SubmitBatch::Internal*>(&batch);
+        auto pPresentSwapChain = (SwapChain::Internal*)(pBatch->GetPresentSwapChain());
+
+        std::vector<SubmitBatchSubmission> submissions = pBatch->GetSubmissions();
+        vk::SwapchainKHR presentSwapChain = {};
+        vk::Semaphore presentSemaphore = {};
+        if (pPresentSwapChain) {
+            presentSwapChain = pPresentSwapChain->GetSwapChain();
+            presentSemaphore = pPresentSwapChain->GetSemaphoreFinished();
+
+            //The binary present semaphore rides on the last submission; its timeline value is ignored
+            if (submissions.empty())
+                submissions.emplace_back();
+            submissions.back().SignalSemaphores.push_back(presentSemaphore);
+            submissions.back().SignalValues.push_back(0);
+            pPresentSwapChain->Release();
+        }
+
+        //The lock spans the enqueue, so another thread cannot resolve against these states and reach the queue first
+        std::lock_guard<std::mutex> lock(GetResourceStateMutex());
+        std::vector<std::vector<ResourceBarrierBatch>> fixups(std::size(submissions));
+        for (size_t index = 0; index < std::size(submissions); index++)
+            for (auto pCmdList : submissions[index].CommandLists)
+                fixups[index].push_back(const_cast<CommandList::Internal*>(reinterpret_cast<const CommandList::Internal*>(pCmdList))->ResolveInitialStates(m_pState->QueueFamilyIndex));
+
+        this->Enqueue([submissions = std::move(submissions), fixups = std::move(fixups), presentSwapChain, presentSemaphore, frameID = pBatch->GetPresentFrameID()](SubmissionState& state) mutable -> void {
+            if (!submissions.empty()) {
+                submissions.back().SignalSemaphores.push_back(*state.pProgressSemaphore);
+                submissions.back().SignalValues.push_back(++state.SubmittedValue);
+            }
+            for (size_t index = 0; index < std::size(submissions); index++)
+                submissions[index].CommandBuffers = Internal::InsertFixups(state, submissions[index].CommandBuffers, fixups[index]);
+
+            if (state.IsSynchronization2Enabled) {
+                //Every wait keeps its full 64-bit stage mask
+                std::vector<std::vector<vk::SemaphoreSubmitInfoKHR>> waitInfos(std::size(submissions));
+                std::vector<std::vector<vk::CommandBufferSubmitInfoKHR>> cmdBufferInfos(std::size(submissions));
+                std::vector<std::vector<vk::SemaphoreSubmitInfoKHR>> signalInfos(std::size(submissions));
+                std::vector<vk::SubmitInfo2KHR> submitInfos(std::size(submissions));
+                for (size_t index = 0; index < std::size(submissions); index++) {
+                    auto const& submission = submissions[index];
+                    for (size_t waitIndex = 0; waitIndex < std::size(submission.WaitSemaphores); waitIndex++)
+                        waitInfos[index].push_back(vk::SemaphoreSubmitInfoKHR{.semaphore = submission.WaitSemaphores[waitIndex], .value = submission.WaitValues[waitIndex], .stageMask = submission.WaitStages[waitIndex]});
+                    for (auto cmdBuffer : submission.CommandBuffers)
+                        cmdBufferInfos[index].push_back(vk::CommandBufferSubmitInfoKHR{.commandBuffer = cmdBuffer});
+                    for (size_t signalIndex = 0; signalIndex < std::size(submission.SignalSemaphores); signalIndex++)
+                        signalInfos[index].push_back(vk::SemaphoreSubmitInfoKHR{.semaphore = submission.SignalSemaphores[signalIndex], .value = submission.SignalValues[signalIndex], .stageMask = vk::PipelineStageFlagBits2KHR::eAllCommands});
+
+                    submitInfos[index] = vk::SubmitInfo2KHR{
+                        .waitSemaphoreInfoCount = static_cast<uint32_t>(std::size(waitInfos[index])),
+                        .pWaitSemaphoreInfos = std::data(waitInfos[index]),
+                        .commandBufferInfoCount = static_cast<uint32_t>(std::size(cmdBufferInfos[index])),
+                        .pCommandBufferInfos = std::data(cmdBufferInfos[index]),
+                        .signalSemaphoreInfoCount = static_cast<uint32_t>(std::size(signalInfos[index])),
+                        .pSignalSemaphoreInfos = std::data(signalInfos[index])
+                    };
+                }
+
+                if (!submitInfos.empty())
+                    state.Queue.submit2KHR(submitInfos, {});
+            } else {
+                std::vector<std::vector<vk::PipelineStageFlags>> waitStages(std::size(submissions));
+                std::vector<vk::TimelineSemaphoreSubmitInfo> timelineInfos(std::size(submissions));
+                std::vector<vk::SubmitInfo> submitInfos(std::size(submissions));
+                for (size_t index = 0; index < std::size(submissions); index++) {
+                    auto const& submission = submissions[index];
+                    for (auto stages : submission.WaitStages)
+                        waitStages[index].push_back(ToPipelineStageFlags(stages));
+
+                    timelineInfos[index] = vk::TimelineSemaphoreSubmitInfo{
+                        .waitSemaphoreValueCount = static_cast<uint32_t>(std::size(submission.WaitValues)),
+                        .pWaitSemaphoreValues = std::data(submission.WaitValues),
+                        .signalSemaphoreValueCount = static_cast<uint32_t>(std::size(submission.SignalValues)),
+                        .pSignalSemaphoreValues = std::data(submission.SignalValues)
+                    };
+                    submitInfos[index] = vk::SubmitInfo{
+                        .pNext = &timelineInfos[index],
+                        .waitSemaphoreCount = static_cast<uint32_t>(std::size(submission.WaitSemaphores)),
+                        .pWaitSemaphores = std::data(submission.WaitSemaphores),
+                        .pWaitDstStageMask = std::data(waitStages[index]),
+                        .commandBufferCount = static_cast<uint32_t>(std::size(submission.CommandBuffers)),
+                        .pCommandBuffers = std::data(submission.CommandBuffers),
+                        .signalSemaphoreCount = static_cast<uint32_t>(std::size(submission.SignalSemaphores)),
+                        .pSignalSemaphores = std::data(submission.SignalSemaphores)
+                    };
+                }
+
+                if (!submitInfos.empty())
+                    state.Queue.submit(submitInfos, {});
+            }
+            if (presentSwapChain)
+                Internal::PresentImage(state.Queue, presentSwapChain, presentSemaphore, frameID);
+        });
+    }
 
-        vk::PipelineStageFlags pStageMask[] = {vk::PipelineStageFlagBits::eTransfer};
+    auto CommandQueue::Internal::WaitIdle() const -> void {
+        //vkQueueWaitIdle needs the queue as well, so it runs after everything already handed to the submit thread
+        std::promise<void> promise;
+        auto future = promise.get_future();
+        this->Enqueue([&promise](SubmissionState& state) -> void {
+            state.Queue.waitIdle();
+            promise.set_value();
+        });
+        future.wait();
+    }
 
-        vk::TimelineSemaphoreSubmitInfo timelineSemaphoreSubmitInfo = {
-            .waitSemaphoreValueCount = _countof(pWaitSemaphoreValues),
-            .pWaitSemaphoreValues = pWaitSemaphoreValues
-        };
+    auto CommandQueue::Internal::GetVkQueue() const -> vk::Queue {
+        return m_pState->Queue;
+    }
+
+    auto CommandQueue::Internal::GetOutstandingWork() const -> uint64_t {
+        //Jobs still waiting for the submit thread plus submissions the GPU has not completed yet
+        auto completedValue = m_pState->pProgressSemaphore.getOwner().getSemaphoreCounterValue(*m_pState->pProgressSemaphore);
+        return m_pState->PendingJobCount.load(std::memory_order_relaxed) + m_pState->SubmittedValue.load(std::memory_order_relaxed) - completedValue;
+    }
 
-        vk::SubmitInfo submitInfo = {
-            .pNext = &timelineSemaphoreSubmitInfo,
-            .waitSemaphoreCount = _countof(pWaitSemahores),
-            .pWaitSemaphores = pWaitSemahores,
-            .pWaitDstStageMask = pStageMask,
-            .signalSemaphoreCount = _countof(pSignalSemaphores),
-            .pSignalSemaphores = pSignalSemaphores,
+    auto CommandQueue::Internal::Release() -> void {
+        if (!m_pState)
+            return;
+
+        //The submit thread drains every pending job before it exits
+        m_pState->IsStopping = true;
+        m_pState->PushCount.fetch_add(1, std::memory_order_release);
+        m_pState->PushCount.notify_one();
+        m_pState->Thread.join();
+
+        //Fix-up command buffers and the progress semaphore may still be in use by the GPU
+        auto progressSemaphore = *m_pState->pProgressSemaphore;
+        auto submittedValue = m_pState->SubmittedValue.load();
+        vk::SemaphoreWaitInfo waitInfo = {
+            .semaphoreCount = 1,
+            .pSemaphores = &progressSemaphore,
+            .pValues = &submittedValue
         };
+        auto result = m_pState->pProgressSemaphore.getOwner().waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
+        assert(result == vk::Result::eSuccess);
+        m_pState.reset();
+    }
 
-        m_Queue.submit(submitInfo, {});
+    auto CommandQueue::Internal::InsertFixups(SubmissionState& state, std::span<const vk::CommandBuffer> cmdBuffers, std::span<const ResourceBarrierBatch> fixups) -> std::vector<vk::CommandBuffer> {
+        std::vector<vk::CommandBuffer> result;
+        result.reserve(std::size(cmdBuffers));
+
+        auto device = state.pFixupPool.getOwner();
+        for (size_t index = 0; index < std::size(cmdBuffers); index++) {
+            if (index < std::size(fixups) && !fixups[index].IsEmpty()) {
+                //Recycled once the submission that used it has retired, allocated otherwise
+                FixupCommandBuffer fixup = {};
+                auto completedValue = device.getSemaphoreCounterValue(*state.pProgressSemaphore);
+                if (!state.FixupCmdBuffers.empty() && state.FixupCmdBuffers.front().ProgressValue <= completedValue) {
+                    fixup = std::move(state.FixupCmdBuffers.front());
+                    state.FixupCmdBuffers.pop_front();
+                } else {
+                    vk::CommandBufferAllocateInfo cmdBufferAI = {
+                        .commandPool = *state.pFixupPool,
+                        .level = vk::CommandBufferLevel::ePrimary,
+                        .commandBufferCount = 1
+                    };
+                    fixup.pCmdBuffer = std::move(device.allocateCommandBuffersUnique(cmdBufferAI).at(0));
+                }
+
+                auto const& barriers = fixups[index];
+                fixup.pCmdBuffer->begin(vk::CommandBufferBeginInfo{.flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit});
+                fixup.pCmdBuffer->pipelineBarrier(barriers.SrcStages, barriers.DstStages, {}, {}, barriers.BufferBarriers, barriers.ImageBarriers);
+                fixup.pCmdBuffer->end();
+                fixup.ProgressValue = state.SubmittedValue;
+
+                result.push_back(*fixup.pCmdBuffer);
+                state.FixupCmdBuffers.push_back(std::move(fixup));
+            }
+            result.push_back(cmdBuffers[index]);
+        }
+        return result;
+    }
 
-        vk::SwapchainKHR pSwapChains[] = {pSwapChain->GetSwapChain()};
+    auto CommandQueue::Internal::SubmitSemaphores(SubmissionState& state, vk::Semaphore waitSemaphore, uint64_t waitValue, vk::PipelineStageFlags2KHR waitStages, vk::Semaphore signalSemaphore, uint64_t signalValue) -> void {
+        uint32_t waitCount = waitSemaphore ? 1 : 0;
+        uint32_t signalCount = signalSemaphore ? 1 : 0;
+
+        if (state.IsSynchronization2Enabled) {
+            vk::SemaphoreSubmitInfoKHR waitInfo = {
+                .semaphore = waitSemaphore,
+                .value = waitValue,
+                .stageMask = waitStages
+            };
+            vk::SemaphoreSubmitInfoKHR signalInfo = {
+                .semaphore = signalSemaphore,
+                .value = signalValue,
+                .stageMask = vk::PipelineStageFlagBits2KHR::eAllCommands
+            };
+            vk::SubmitInfo2KHR submitInfo = {
+                .waitSemaphoreInfoCount = waitCount,
+                .pWaitSemaphoreInfos = &waitInfo,
+                .signalSemaphoreInfoCount = signalCount,
+                .pSignalSemaphoreInfos = &signalInfo
+            };
+            state.Queue.submit2KHR(submitInfo, {});
+        } else {
+            vk::PipelineStageFlags stageMask = ToPipelineStageFlags(waitStages);
+
+            vk::TimelineSemaphoreSubmitInfo timelineInfo = {
+                .waitSemaphoreValueCount = waitCount,
+                .pWaitSemaphoreValues = &waitValue,
+                .signalSemaphoreValueCount = signalCount,
+                .pSignalSemaphoreValues = &signalValue
+            };
+            vk::SubmitInfo submitInfo = {
+                .pNext = &timelineInfo,
+                .waitSemaphoreCount = waitCount,
+                .pWaitSemaphores = &waitSemaphore,
+                .pWaitDstStageMask = &stageMask,
+                .signalSemaphoreCount = signalCount,
+                .pSignalSemaphores = &signalSemaphore
+            };
+            state.Queue.submit(submitInfo, {});
+        }
+    }
 
+    auto CommandQueue::Internal::PresentImage(vk::Queue queue, vk::SwapchainKHR swapChain, vk::Semaphore semaphore, uint32_t frameID) -> void {
         vk::PresentInfoKHR presentInfo = {
-            .waitSemaphoreCount = _countof(pSignalSemaphores),
-            .pWaitSemaphores = pSignalSemaphores,
-            .swapchainCount = _countof(pSwapChains),
-            .pSwapchains = pSwapChains,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &semaphore,
+            .swapchainCount = 1,
+            .pSwapchains = &swapChain,
             .pImageIndices = &frameID,
         };
 
-        vk::Result result = m_Queue.presentKHR(presentInfo);
+        vk::Result result = queue.presentKHR(presentInfo);
         assert(result == vk::Result::eSuccess || result == vk::Result::eSuboptimalKHR);
-        pSwapChain->Release();
     }
 
-    auto CommandQueue::Internal::WaitIdle() const -> void {
-        m_Queue.waitIdle();
-    }
-
-    auto CommandQueue::Internal::GetVkQueue() const -> vk::Queue {
-        return m_Queue;
+    auto CommandQueue::Internal::SubmitLoop(SubmissionState* pState) -> void {
+        while (true) {
+            auto pNode = pState->pHead.exchange(nullptr, std::memory_order_acquire);
+            if (!pNode) {
+                if (pState->IsStopping)
+                    return;
+
+                //Read the counter before re-checking the list, so a push in between always changes it and the wait returns
+                auto pushCount = pState->PushCount.load(std::memory_order_acquire);
+                if (!pState->pHead.load(std::memory_order_acquire))
+                    pState->PushCount.wait(pushCount, std::memory_order_acquire);
+                continue;
+            }
+
+            //The list is LIFO, so it is reversed to submit in push order
+            SubmissionNode* pOrdered = nullptr;
+            while (pNode) {
+                auto pNext = pNode->pNext;
+                pNode->pNext = pOrdered;
+                pOrdered = pNode;
+                pNode = pNext;
+            }
+
+            while (pOrdered) {
+                auto pNext = pOrdered->pNext;
+                pOrdered->Job(*pState);
+                pState->PendingJobCount.fetch_sub(1, std::memory_order_relaxed);
+                delete pOrdered;
+                pOrdered = pNext;
+            }
+        }
     }
 }
 
@@ -128,12 +363,14 @@ namespace HAL {
 
     CommandQueue& CommandQueue::operator=(CommandQueue&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
 
+    CommandQueue::~CommandQueue() = default;
+
     auto CommandQueue::Signal(Fence const& fence, std::optional<uint64_t> value) const -> void {
         m_pInternal->Signal(fence, value);
     }
 
-    auto CommandQueue::Wait(Fence const& fence, std::optional<uint64_t> value) const -> void {
-        m_pInternal->Wait(fence, value);
+    auto CommandQueue::Wait(Fence const& fence, std::optional<uint64_t> value, vk::PipelineStageFlags2KHR stages) const -> void {
+        m_pInternal->Wait(fence, value, stages);
     }
 
     auto CommandQueue::NextImage(SwapChain const& swapChain, Fence const& fence, std::optional<uint64_t> signalValue) const -> uint32_t {
@@ -144,10 +381,22 @@ namespace HAL {
         return m_pInternal->Present(swapChain, frameID, fence, waitValue);
     }
 
+    auto CommandQueue::AcquireNextImage(SwapChain const& swapChain) const -> uint32_t {
+        return m_pInternal->AcquireNextImage(swapChain);
+    }
+
+    auto CommandQueue::Submit(SubmitBatch const& batch) const -> void {
+        m_pInternal->Submit(batch);
+    }
+
     auto CommandQueue::WaitIdle() const -> void {
         m_pInternal->WaitIdle();
     }
 
+    auto CommandQueue::GetOutstandingWork() const -> uint64_t {
+        return m_pInternal->GetOutstandingWork();
+    }
+
     auto CommandQueue::GetVkQueue() const -> vk::Queue {
         return m_pInternal->GetVkQueue();
     }
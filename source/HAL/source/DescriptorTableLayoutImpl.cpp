@@ -1,4 +1,5 @@
 #include "../include/DescriptorTableLayoutImpl.hpp"
+#include "../include/HostAllocator.hpp"
 
 namespace HAL {
 
@@ -24,7 +25,7 @@ namespace HAL {
             .bindingCount = static_cast<uint32_t>(descriptorSetLayoutBindings.size()),
             .pBindings = descriptorSetLayoutBindings.data()
         };
-        m_pDescritptorSetLayout = device.GetVkDevice().createDescriptorSetLayoutUnique(descriptorSetLayoutCI);      
+        m_pDescritptorSetLayout = device.GetVkDevice().createDescriptorSetLayoutUnique(descriptorSetLayoutCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Descriptor));      
     }
 
     auto DescriptorTableLayout::Internal::GetPipelineResource(uint32_t slotID) const -> PipelineResource const& { return m_PipelineResources.at(slotID); }
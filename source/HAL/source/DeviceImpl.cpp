@@ -4,6 +4,8 @@
 #include "../include/InstanceImpl.hpp"
 #include "../include/DeviceImpl.hpp"
 #include "../include/CommandQueueImpl.hpp"
+#include "../include/HostAllocator.hpp"
+#include "../include/FenceImpl.hpp"
 
 namespace HAL {
 
@@ -27,9 +29,15 @@ namespace HAL {
         std::vector<std::vector<float>> deviceQueuePriorities;
         std::vector<vk::DeviceQueueCreateInfo> deviceQueueCIs;
 
-        auto GenerateQueueCreateInfo = [&deviceQueuePriorities, &deviceQueueCIs](vkx::QueueFamilyInfo queueInfo) -> void {
-            std::vector<float> queuePriorities(queueInfo.queueCount);
-            std::generate(queuePriorities.begin(), queuePriorities.end(), []() -> float { return 1.0f; });
+        //An explicit priority list also limits how many queues of the family are created
+        auto GenerateQueueCreateInfo = [&deviceQueuePriorities, &deviceQueueCIs](vkx::QueueFamilyInfo& queueInfo, std::vector<float> const& priorities) -> void {
+            std::vector<float> queuePriorities(queueInfo.queueCount, 1.0f);
+            if (!priorities.empty()) {
+                queuePriorities.resize(std::min<size_t>(std::size(priorities), queueInfo.queueCount));
+                for (size_t index = 0; index < std::size(queuePriorities); index++)
+                    queuePriorities[index] = std::clamp(priorities[index], 0.0f, 1.0f);
+                queueInfo.queueCount = static_cast<uint32_t>(std::size(queuePriorities));
+            }
 
             vk::DeviceQueueCreateInfo deviceQueueCI = {
                 .queueFamilyIndex = queueInfo.queueIndex,
@@ -41,19 +49,19 @@ namespace HAL {
         };
 
         if (m_QueueFamilyGraphics = vkx::getIndexQueueFamilyGraphicsInfo(pImplAdapter->GetQueueFamilyProperty())) {
-            GenerateQueueCreateInfo(*m_QueueFamilyGraphics);
+            GenerateQueueCreateInfo(*m_QueueFamilyGraphics, createInfo.GraphicsQueuePriorities);
         } else {
             fmt::print("Error: Vulkan Device doesnt't support Graphics Queue Family \n");
         }
 
         if (m_QueueFamilyCompute = vkx::getIndexQueueFamilyComputeInfo(pImplAdapter->GetQueueFamilyProperty())) {
-            GenerateQueueCreateInfo(*m_QueueFamilyCompute);
+            GenerateQueueCreateInfo(*m_QueueFamilyCompute, createInfo.ComputeQueuePriorities);
         } else {
             fmt::print("Warning: Vulkan Device doesn't support Async Compute \n");
         }
 
         if (m_QueueFamilyTransfer = vkx::getIndexQueueFamilyTransferInfo(pImplAdapter->GetQueueFamilyProperty())) {
-            GenerateQueueCreateInfo(*m_QueueFamilyTransfer);
+            GenerateQueueCreateInfo(*m_QueueFamilyTransfer, createInfo.TransferQueuePriorities);
         } else {
             fmt::print("Warning: Vulkan Device dosen't support Async Transfer \n");
         }
@@ -68,6 +76,10 @@ namespace HAL {
             fmt::print("Error: Vulkan Device dosen't support vk::PhysicalDeviceImagelessFramebufferFeatures \n");
         }
 
+        if (!deviceFeatures.Vulkan12Features.drawIndirectCount) {
+            fmt::print("Warning: Vulkan Device dosen't support vkCmdDrawIndexedIndirectCount \n");
+        }
+
         vk::StructureChain<
             vk::PhysicalDeviceFeatures2,
             vk::PhysicalDevice16BitStorageFeatures,
@@ -75,12 +87,15 @@ namespace HAL {
         > enabledFeatures = {
             vk::PhysicalDeviceFeatures2 {
                 .features = vk::PhysicalDeviceFeatures {
+                    .multiDrawIndirect = deviceFeatures.Features.multiDrawIndirect,
+                    .drawIndirectFirstInstance = deviceFeatures.Features.drawIndirectFirstInstance,
                     .shaderInt64 = deviceFeatures.Features.shaderInt64,
                     .shaderInt16 = deviceFeatures.Features.shaderInt16,
                 }
             },
             deviceFeatures.Shader16BitStorageFeatures,
             vk::PhysicalDeviceVulkan12Features {
+                .drawIndirectCount = deviceFeatures.Vulkan12Features.drawIndirectCount,
                 .shaderFloat16 = deviceFeatures.Vulkan12Features.shaderFloat16,
                 .shaderInt8 = deviceFeatures.Vulkan12Features.shaderInt8,
                 .descriptorIndexing = deviceFeatures.Vulkan12Features.descriptorIndexing,
@@ -106,6 +121,21 @@ namespace HAL {
             fmt::print("Warning: Required Vulkan Device Extension {} not supported \n", DEVICE_EXTENSION[index]);
         }
 
+        //Chained in front of the other features only when requested, the legacy path needs nothing of it
+        vk::PhysicalDeviceSynchronization2FeaturesKHR synchronization2Features = {
+            .synchronization2 = true
+        };
+        if (createInfo.IsSynchronization2Enabled) {
+            if (pImplAdapter->IsExtensionSupported(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) {
+                deviceExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+                synchronization2Features.pNext = enabledFeatures.get<vk::PhysicalDeviceFeatures2>().pNext;
+                enabledFeatures.get<vk::PhysicalDeviceFeatures2>().pNext = &synchronization2Features;
+                m_IsSynchronization2Enabled = true;
+            } else {
+                fmt::print("Warning: Vulkan Device doesn't support {}, the legacy synchronization path is used \n", VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+            }
+        }
+
         vk::DeviceCreateInfo deviceCI = {
             .pNext = &enabledFeatures.get<vk::PhysicalDeviceFeatures2>(),
             .queueCreateInfoCount = static_cast<uint32_t>(std::size(deviceQueueCIs)),
@@ -116,7 +146,9 @@ namespace HAL {
 
         auto const& deviceInfo = pImplAdapter->GetProperties().Properties;
 
-        m_pDevice = pImplAdapter->GetVkPhysicalDevice().createDeviceUnique(deviceCI);
+        m_pDevice = pImplAdapter->GetVkPhysicalDevice().createDeviceUnique(deviceCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Device));
+        m_IsDrawIndirectCountEnabled = deviceFeatures.Vulkan12Features.drawIndirectCount;
+        m_IsMultiDrawIndirectEnabled = deviceFeatures.Features.multiDrawIndirect;
         m_PhysicalDevice = pImplAdapter->GetVkPhysicalDevice();
 
         vkx::setDebugName(*m_pDevice, pImplAdapter->GetVkPhysicalDevice(), fmt::format("Name: {} Type: {}", deviceInfo.deviceName, vk::to_string(deviceInfo.deviceType)));
@@ -126,30 +158,73 @@ namespace HAL {
 
         if (m_QueueFamilyGraphics) {
             for (size_t index = 0; index < m_QueueFamilyGraphics.value().queueCount; index++) {
-                auto queue = HAL::CommandQueue::Internal(m_pDevice->getQueue(m_QueueFamilyGraphics.value().queueIndex, index));
+                auto queue = HAL::CommandQueue::Internal(*m_pDevice, m_pDevice->getQueue(m_QueueFamilyGraphics.value().queueIndex, index), m_QueueFamilyGraphics.value().queueIndex, m_IsSynchronization2Enabled);
                 m_QueuesGraphics.push_back(std::move(*reinterpret_cast<HAL::CommandQueue*>(&queue)));
-                vkx::setDebugName(*m_pDevice, queue.GetVkQueue(), fmt::format("Graphics: [{}]", index));
+                vkx::setDebugName(*m_pDevice, m_QueuesGraphics.back().GetVkQueue(), fmt::format("Graphics: [{}]", index));
             }
         }
 
         if (m_QueueFamilyCompute) {
             for (size_t index = 0; index < m_QueueFamilyCompute.value().queueCount; index++) {
-                auto queue = HAL::CommandQueue::Internal(m_pDevice->getQueue(m_QueueFamilyCompute.value().queueIndex, index));
+                auto queue = HAL::CommandQueue::Internal(*m_pDevice, m_pDevice->getQueue(m_QueueFamilyCompute.value().queueIndex, index), m_QueueFamilyCompute.value().queueIndex, m_IsSynchronization2Enabled);
                 m_QueuesCompute.push_back(std::move(*reinterpret_cast<HAL::CommandQueue*>(&queue)));
-                vkx::setDebugName(*m_pDevice, queue.GetVkQueue(), fmt::format("Compute: [{}]", index));
+                vkx::setDebugName(*m_pDevice, m_QueuesCompute.back().GetVkQueue(), fmt::format("Compute: [{}]", index));
             }
         }
 
         if (m_QueueFamilyTransfer) {
             for (size_t index = 0; index < m_QueueFamilyTransfer.value().queueCount; index++) {
-                auto queue = HAL::CommandQueue::Internal(m_pDevice->getQueue(m_QueueFamilyTransfer.value().queueIndex, index));
+                auto queue = HAL::CommandQueue::Internal(*m_pDevice, m_pDevice->getQueue(m_QueueFamilyTransfer.value().queueIndex, index), m_QueueFamilyTransfer.value().queueIndex, m_IsSynchronization2Enabled);
                 m_QueuesTransfer.push_back(std::move(*reinterpret_cast<HAL::CommandQueue*>(&queue)));
-                vkx::setDebugName(*m_pDevice, queue.GetVkQueue(), fmt::format("Transfer: [{}]", index));
+                vkx::setDebugName(*m_pDevice, m_QueuesTransfer.back().GetVkQueue(), fmt::format("Transfer: [{}]", index));
             }
         }
 
-        m_pAllocator = std::make_unique<HAL::MemoryAllocator>(instance, *reinterpret_cast<HAL::Device*>(this), HAL::AllocatorCreateInfo{});  
+        auto isMemoryBudgetEnabled = std::find_if(std::begin(deviceExtensions), std::end(deviceExtensions), [](const char* extension) { 
+            return std::strcmp(extension, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0; 
+        }) != std::end(deviceExtensions);
+
+        HAL::AllocatorCreateInfo allocatorCI = {
+            .Flags = isMemoryBudgetEnabled ? vma::AllocatorCreateFlags(vma::AllocatorCreateFlagBits::eExtMemoryBudget) : vma::AllocatorCreateFlags{},
+            .SoftThreshold = createInfo.MemorySoftThreshold,
+            .HardThreshold = createInfo.MemoryHardThreshold
+        };
+
+        m_pAllocator = std::make_unique<HAL::MemoryAllocator>(instance, *reinterpret_cast<HAL::Device*>(this), allocatorCI);  
         m_pPipelineCache = std::make_unique<HAL::PipelineCache>(*reinterpret_cast<HAL::Device*>(this), HAL::PipelineCacheCreateInfo{});
+        m_pBufferAllocator = std::make_unique<HAL::BufferAllocator>(*reinterpret_cast<HAL::Device*>(this));
+        m_pReleaseQueue = std::make_unique<HAL::ReleaseQueue>(*m_pDevice);
+    }
+
+    Device::Internal::~Internal() {
+        //Deferred releases run once the queues are destroyed, after every submission has retired
+        this->WaitIdle();
+    }
+
+    auto Device::Internal::SelectLeastLoaded(std::vector<HAL::CommandQueue>& queues) -> HAL::CommandQueue& {
+        assert(!queues.empty());
+        return *std::min_element(std::begin(queues), std::end(queues), [](auto const& lhs, auto const& rhs) -> bool {
+            return lhs.GetOutstandingWork() < rhs.GetOutstandingWork();
+        });
+    }
+
+    auto Device::Internal::WaitIdle() const -> void {
+        //Submit threads own their queues, so each one is drained through its own thread instead of vkDeviceWaitIdle
+        for (auto const& queue : m_QueuesGraphics)
+            queue.WaitIdle();
+        for (auto const& queue : m_QueuesCompute)
+            queue.WaitIdle();
+        for (auto const& queue : m_QueuesTransfer)
+            queue.WaitIdle();
+    }
+
+    auto Device::Internal::NextFrame() -> void {
+        m_pReleaseQueue->Poll();
+        m_pAllocator->NextFrame();
+    }
+
+    auto Device::Internal::ReleaseDeferred(std::function<void()>&& release, Fence const& fence, std::optional<uint64_t> value) -> void {
+        m_pReleaseQueue->Enqueue(fence.GetVkSemaphore(), value.value_or(fence.GetExpectedValue()), std::move(release));
     }
 
     auto Device::Internal::GetPipelineCache() const -> PipelineCache const& {
@@ -163,20 +238,80 @@ namespace HAL {
 
     Device::~Device() = default;
 
-    auto Device::GetTransferCommandQueue() -> TransferCommandQueue const& {
-        return m_pInternal->GetTransferCommandQueue();
+    auto Device::GetTransferCommandQueue(uint32_t index) -> TransferCommandQueue const& {
+        return m_pInternal->GetTransferCommandQueue(index);
+    }
+
+    auto Device::GetComputeCommandQueue(uint32_t index) -> ComputeCommandQueue const& {
+        return m_pInternal->GetComputeCommandQueue(index);
+    }
+
+    auto Device::GetGraphicsCommandQueue(uint32_t index) -> GraphicsCommandQueue const& {
+        return m_pInternal->GetGraphicsCommandQueue(index);
+    }
+
+    auto Device::GetTransferCommandQueueCount() const -> uint32_t {
+        return m_pInternal->GetTransferCommandQueueCount();
+    }
+
+    auto Device::GetComputeCommandQueueCount() const -> uint32_t {
+        return m_pInternal->GetComputeCommandQueueCount();
+    }
+
+    auto Device::GetGraphicsCommandQueueCount() const -> uint32_t {
+        return m_pInternal->GetGraphicsCommandQueueCount();
+    }
+
+    auto Device::AcquireTransferCommandQueue() -> TransferCommandQueue const& {
+        return m_pInternal->AcquireTransferCommandQueue();
     }
 
-    auto Device::GetComputeCommandQueue() -> ComputeCommandQueue const& {
-        return m_pInternal->GetComputeCommandQueue();
+    auto Device::AcquireComputeCommandQueue() -> ComputeCommandQueue const& {
+        return m_pInternal->AcquireComputeCommandQueue();
     }
 
-    auto Device::GetGraphicsCommandQueue() -> GraphicsCommandQueue const& {
-        return m_pInternal->GetGraphicsCommandQueue();
+    auto Device::AcquireGraphicsCommandQueue() -> GraphicsCommandQueue const& {
+        return m_pInternal->AcquireGraphicsCommandQueue();
     }
 
     auto Device::WaitIdle() -> void { m_pInternal->WaitIdle(); }
 
+    auto Device::NextFrame() -> void {
+        m_pInternal->NextFrame();
+    }
+
+    auto Device::ReleaseDeferred(std::function<void()>&& release, Fence const& fence, std::optional<uint64_t> value) -> void {
+        m_pInternal->ReleaseDeferred(std::move(release), fence, value);
+    }
+
+    auto Device::GetMemoryBudget() const -> std::vector<MemoryHeapBudget> {
+        return m_pInternal->GetMemoryAllocator().GetMemoryBudget();
+    }
+
+    auto Device::AddMemoryPressureCallback(MemoryPressureCallback&& callback) -> uint32_t {
+        return m_pInternal->GetMemoryAllocator().AddMemoryPressureCallback(std::move(callback));
+    }
+
+    auto Device::RemoveMemoryPressureCallback(uint32_t callbackID) -> void {
+        m_pInternal->GetMemoryAllocator().RemoveMemoryPressureCallback(callbackID);
+    }
+
+    auto Device::Defragment(Fence const& fence, std::optional<uint64_t> value, DefragmentationInfo const& info) -> DefragmentationStatistic {
+        return m_pInternal->GetMemoryAllocator().Defragment(fence, value, info);
+    }
+
+    auto Device::GetMemoryStatistic() const -> MemoryStatistic {
+        return m_pInternal->GetMemoryAllocator().GetMemoryStatistic();
+    }
+
+    auto Device::GetMemorySnapshot() const -> MemorySnapshot {
+        return m_pInternal->GetMemoryAllocator().GetMemoryTelemetry().GetSnapshot();
+    }
+
+    auto Device::ReadMemoryEvents(uint64_t sequence, std::vector<MemoryEvent>& events) const -> uint64_t {
+        return m_pInternal->GetMemoryAllocator().GetMemoryTelemetry().ReadEvents(sequence, events);
+    }
+
     auto Device::GetVkDevice() const -> vk::Device {
         return m_pInternal->GetVkDevice();
     }
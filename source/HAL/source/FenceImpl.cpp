@@ -1,6 +1,7 @@
 
 #include "../include/FenceImpl.hpp"
 #include "../include/DeviceImpl.hpp"
+#include "../include/HostAllocator.hpp"
 
 namespace HAL {
     Fence::Internal::Internal(Device const& device, uint64_t value) {
@@ -11,7 +12,7 @@ namespace HAL {
         vk::SemaphoreCreateInfo semaphoreCI = {
             .pNext = &semaphoreTypeCI
         };
-        m_pSemaphore = device.GetVkDevice().createSemaphoreUnique(semaphoreCI);
+        m_pSemaphore = device.GetVkDevice().createSemaphoreUnique(semaphoreCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Synchronization));
         m_ExpectedValue = value;
     }
 
@@ -0,0 +1,783 @@
+#include "../include/FrameGraphImpl.hpp"
+#include "../include/DeviceImpl.hpp"
+
+#include <HAL/Buffer.hpp>
+#include <HAL/CommandQueue.hpp>
+#include <HAL/SubmitBatch.hpp>
+#include <HAL/Texture.hpp>
+
+#include <fmt/format.h>
+#include <chrono>
+#include <numeric>
+#include <queue>
+
+namespace HAL {
+
+    static auto HashCombine(uint64_t seed, uint64_t value) -> uint64_t {
+        return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    }
+
+    static auto GetQueueIndex(FrameGraphQueue queue) -> uint32_t {
+        return static_cast<uint32_t>(queue);
+    }
+
+    static auto RecordBarriers(vk::CommandBuffer cmdBuffer, ResourceBarrierBatch const& batch) -> void {
+        if (!batch.IsEmpty())
+            cmdBuffer.pipelineBarrier(batch.SrcStages, batch.DstStages, {}, {}, batch.BufferBarriers, batch.ImageBarriers);
+    }
+
+    static auto GetBarrierCount(ResourceBarrierBatch const& batch) -> uint32_t {
+        return static_cast<uint32_t>(std::size(batch.BufferBarriers) + std::size(batch.ImageBarriers));
+    }
+
+    //The memory of an aliased resource was last written through another resource, which has to finish first
+    static auto AppendAliasingTransition(ResourceBarrierBatch& batch, TrackedResource const& resource, ResourceState stateAfter, vk::PipelineStageFlags supportedStages) -> void {
+        auto infoAfter = GetResourceStateInfo(stateAfter);
+        auto dstStages = infoAfter.Stages & supportedStages;
+        batch.SrcStages |= vk::PipelineStageFlagBits::eAllCommands;
+        batch.DstStages |= dstStages ? dstStages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eBottomOfPipe);
+
+        if (resource.Image) {
+            batch.ImageBarriers.push_back(vk::ImageMemoryBarrier{
+                .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+                .dstAccessMask = infoAfter.Access,
+                .oldLayout = vk::ImageLayout::eUndefined,
+                .newLayout = infoAfter.Layout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = resource.Image,
+                .subresourceRange = {resource.Aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}
+            });
+        } else {
+            batch.BufferBarriers.push_back(vk::BufferMemoryBarrier{
+                .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+                .dstAccessMask = infoAfter.Access,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .buffer = resource.Buffer,
+                .offset = resource.Offset,
+                .size = resource.Size
+            });
+        }
+    }
+
+    //After a wait on the other queue's semaphore its writes are already visible, so only a layout change is left
+    static auto AppendQueueTransition(ResourceBarrierBatch& batch, TrackedResource const& resource, ResourceState stateBefore, ResourceState stateAfter, vk::PipelineStageFlags supportedStages) -> void {
+        auto infoBefore = GetResourceStateInfo(stateBefore);
+        auto infoAfter = GetResourceStateInfo(stateAfter);
+        if (!resource.Image || infoBefore.Layout == infoAfter.Layout)
+            return;
+
+        auto dstStages = infoAfter.Stages & supportedStages;
+        batch.SrcStages |= vk::PipelineStageFlagBits::eAllCommands;
+        batch.DstStages |= dstStages ? dstStages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eBottomOfPipe);
+        batch.ImageBarriers.push_back(vk::ImageMemoryBarrier{
+            .dstAccessMask = infoAfter.Access,
+            .oldLayout = infoBefore.Layout,
+            .newLayout = infoAfter.Layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = resource.Image,
+            .subresourceRange = {resource.Aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}
+        });
+    }
+
+    //The release on the source family and the acquire on the destination family must describe the same transfer.
+    //The release makes the writes available, the acquire makes them visible to the new state
+    static auto AppendOwnershipTransfer(ResourceBarrierBatch& release, ResourceBarrierBatch& acquire, TrackedResource const& resource, ResourceState stateBefore, ResourceState stateAfter, std::array<uint32_t, 2> families, std::array<vk::PipelineStageFlags, 2> supportedStages) -> void {
+        auto infoBefore = GetResourceStateInfo(stateBefore);
+        auto infoAfter = GetResourceStateInfo(stateAfter);
+        auto srcStages = infoBefore.Stages & supportedStages[0];
+        auto dstStages = infoAfter.Stages & supportedStages[1];
+        release.SrcStages |= srcStages ? srcStages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTopOfPipe);
+        release.DstStages |= vk::PipelineStageFlagBits::eBottomOfPipe;
+        acquire.SrcStages |= vk::PipelineStageFlagBits::eAllCommands;
+        acquire.DstStages |= dstStages ? dstStages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eBottomOfPipe);
+
+        auto srcAccess = infoBefore.IsWrite ? infoBefore.Access : vk::AccessFlags{};
+        if (resource.Image) {
+            vk::ImageMemoryBarrier barrier = {
+                .srcAccessMask = srcAccess,
+                .oldLayout = infoBefore.Layout,
+                .newLayout = infoAfter.Layout,
+                .srcQueueFamilyIndex = families[0],
+                .dstQueueFamilyIndex = families[1],
+                .image = resource.Image,
+                .subresourceRange = {resource.Aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}
+            };
+            release.ImageBarriers.push_back(barrier);
+            barrier.srcAccessMask = {};
+            barrier.dstAccessMask = infoAfter.Access;
+            acquire.ImageBarriers.push_back(barrier);
+        } else {
+            vk::BufferMemoryBarrier barrier = {
+                .srcAccessMask = srcAccess,
+                .srcQueueFamilyIndex = families[0],
+                .dstQueueFamilyIndex = families[1],
+                .buffer = resource.Buffer,
+                .offset = resource.Offset,
+                .size = resource.Size
+            };
+            release.BufferBarriers.push_back(barrier);
+            barrier.srcAccessMask = {};
+            barrier.dstAccessMask = infoAfter.Access;
+            acquire.BufferBarriers.push_back(barrier);
+        }
+    }
+
+    FrameGraph::Internal::Internal(Device const& device, FrameGraphCreateInfo const& createInfo) {
+        assert(createInfo.FrameCount > 0);
+
+        auto pImplDevice = reinterpret_cast<const Device::Internal*>(&device);
+        auto queueFamilyProperties = device.GetVkPhysicalDevice().getQueueFamilyProperties();
+
+        m_pDevice = const_cast<Device*>(&device);
+        m_pGraphicsFence = std::make_unique<Fence>(device);
+        m_pComputeFence = std::make_unique<Fence>(device);
+        m_QueueFamilyIndices = {pImplDevice->GetGraphicsQueueFamilyIndex(), pImplDevice->GetComputeQueueFamilyIndex()};
+        m_SupportedStages = {
+            GetSupportedStages(queueFamilyProperties[m_QueueFamilyIndices[0]].queueFlags),
+            GetSupportedStages(queueFamilyProperties[m_QueueFamilyIndices[1]].queueFlags)
+        };
+        m_IsAsyncComputeEnabled = m_QueueFamilyIndices[0] != m_QueueFamilyIndices[1];
+
+        m_Frames.resize(createInfo.FrameCount);
+        for (auto& frame : m_Frames)
+            frame.pPlanner = std::make_unique<TransientResourcePlanner>(device);
+    }
+
+    FrameGraph::Internal& FrameGraph::Internal::operator=(Internal&& rhs) noexcept {
+        if (this != &rhs) {
+            this->Release();
+            m_pDevice = rhs.m_pDevice;
+            m_pGraphicsFence = std::move(rhs.m_pGraphicsFence);
+            m_pComputeFence = std::move(rhs.m_pComputeFence);
+            m_Resources = std::move(rhs.m_Resources);
+            m_Passes = std::move(rhs.m_Passes);
+            m_Usages = std::move(rhs.m_Usages);
+            m_CompiledPasses = std::move(rhs.m_CompiledPasses);
+            m_ImportedResources = std::move(rhs.m_ImportedResources);
+            m_Frames = std::move(rhs.m_Frames);
+            m_PrologueBarriers = std::move(rhs.m_PrologueBarriers);
+            m_EpilogueBarriers = std::move(rhs.m_EpilogueBarriers);
+            m_QueueFamilyIndices = rhs.m_QueueFamilyIndices;
+            m_SupportedStages = rhs.m_SupportedStages;
+            m_EpilogueWaitPass = rhs.m_EpilogueWaitPass;
+            m_FrameIndex = rhs.m_FrameIndex;
+            m_Statistic = rhs.m_Statistic;
+            m_IsAsyncComputeEnabled = rhs.m_IsAsyncComputeEnabled;
+            m_IsPrologueSignaled = rhs.m_IsPrologueSignaled;
+            m_IsCompiled = rhs.m_IsCompiled;
+        }
+        return *this;
+    }
+
+    FrameGraph::Internal::~Internal() {
+        this->Release();
+    }
+
+    auto FrameGraph::Internal::ImportResource(TrackedResource const& resource) -> FrameGraphResource {
+        //Resources sharing a state, like suballocations of one buffer, are one node just as in the command list tracking
+        auto [iterator, isInserted] = m_ImportedResources.try_emplace(resource.pGlobalState, static_cast<uint32_t>(std::size(m_Resources)));
+        if (isInserted)
+            m_Resources.push_back(FrameGraphResourceNode{.Resource = resource});
+        return FrameGraphResource{iterator->second};
+    }
+
+    auto FrameGraph::Internal::CreateBuffer(vk::BufferCreateInfo const& createInfo) -> FrameGraphResource {
+        m_Resources.push_back(FrameGraphResourceNode{
+            .Resource = TrackedResource{.Offset = 0, .Size = VK_WHOLE_SIZE},
+            .BufferCI = createInfo,
+            .IsTransient = true
+        });
+        return FrameGraphResource{static_cast<uint32_t>(std::size(m_Resources) - 1)};
+    }
+
+    auto FrameGraph::Internal::CreateTexture(vk::ImageCreateInfo const& createInfo) -> FrameGraphResource {
+        m_Resources.push_back(FrameGraphResourceNode{
+            .Resource = TrackedResource{.Aspect = GetImageAspect(createInfo.format)},
+            .ImageCI = createInfo,
+            .IsTransient = true
+        });
+        return FrameGraphResource{static_cast<uint32_t>(std::size(m_Resources) - 1)};
+    }
+
+    auto FrameGraph::Internal::MarkOutput(FrameGraphResource resource) -> void {
+        m_Resources.at(resource.Index).IsOutput = true;
+    }
+
+    auto FrameGraph::Internal::AddPass(FrameGraphPassCreateInfo const& createInfo, FrameGraphPassExecutor&& executor) -> void {
+        assert(!m_IsCompiled);
+        m_Passes.push_back(FrameGraphPassNode{
+            .Name = std::string(createInfo.Name),
+            .Executor = std::move(executor),
+            .FirstUsage = static_cast<uint32_t>(std::size(m_Usages)),
+            .UsageCount = static_cast<uint32_t>(std::size(createInfo.Usages)),
+            .Queue = createInfo.Queue,
+            .HasSideEffects = createInfo.HasSideEffects
+        });
+        m_Usages.insert(m_Usages.end(), std::begin(createInfo.Usages), std::end(createInfo.Usages));
+    }
+
+    auto FrameGraph::Internal::Compile() -> void {
+        auto timeBegin = std::chrono::high_resolution_clock::now();
+        auto& frame = m_Frames[m_FrameIndex % std::size(m_Frames)];
+        this->RecycleFrame(frame);
+
+        m_Statistic = {};
+        m_Statistic.PassCount = static_cast<uint32_t>(std::size(m_Passes));
+
+        //A cycle has no valid order; declaration order is kept so the frame still runs, with the hazards the cycle implies
+        if (!this->SortPasses()) {
+            fmt::print("Error: frame graph passes form a dependency cycle \n");
+            assert(false);
+            m_CompiledPasses.resize(std::size(m_Passes));
+            std::iota(std::begin(m_CompiledPasses), std::end(m_CompiledPasses), 0u);
+        }
+        this->CullPasses();
+        std::erase_if(m_CompiledPasses, [&](uint32_t passIndex) -> bool { return m_Passes[passIndex].IsCulled; });
+
+        //A transient resource read before any surviving pass wrote it would have undefined contents and is rejected
+        for (uint32_t order = 0; order < std::size(m_CompiledPasses); order++) {
+            auto& pass = m_Passes[m_CompiledPasses[order]];
+
+            pass.Order = order;
+            if (!m_IsAsyncComputeEnabled)
+                pass.Queue = FrameGraphQueue::Graphics;
+            if (pass.Queue == FrameGraphQueue::AsyncCompute)
+                m_Statistic.AsyncComputePassCount++;
+
+            for (uint32_t usageIndex = pass.FirstUsage; usageIndex < pass.FirstUsage + pass.UsageCount; usageIndex++) {
+                auto const& usage = m_Usages[usageIndex];
+                auto& resource = m_Resources[usage.Resource.Index];
+                bool isWrite = GetResourceStateInfo(usage.State).IsWrite;
+                if (resource.IsTransient && !resource.IsWritten && !isWrite) {
+                    fmt::print("Error: pass {} reads transient resource {} before any pass writes it \n", pass.Name, usage.Resource.Index);
+                    assert(false);
+                }
+                resource.IsWritten |= isWrite;
+                if (!resource.IsReferenced)
+                    resource.FirstOrder = pass.Order;
+                resource.LastOrder = pass.Order;
+                resource.IsReferenced = true;
+                resource.IsUsedAsync |= pass.Queue == FrameGraphQueue::AsyncCompute;
+            }
+        }
+
+        this->PlaceTransientResources(frame);
+        this->BuildBarriers(frame);
+        m_IsCompiled = true;
+
+        m_Statistic.CompileTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - timeBegin).count();
+    }
+
+    auto FrameGraph::Internal::Execute(FrameGraphExecuteInfo const& executeInfo) -> void {
+        assert(m_IsCompiled);
+
+        auto timeBegin = std::chrono::high_resolution_clock::now();
+        auto pImplDevice = reinterpret_cast<Device::Internal*>(m_pDevice);
+        auto& frame = m_Frames[m_FrameIndex % std::size(m_Frames)];
+
+        //Every pass records into its own list, so the lists stay independent of the order they are recorded in
+        if (std::size(frame.Recorders) < std::size(m_CompiledPasses))
+            frame.Recorders.resize(std::size(m_CompiledPasses));
+        for (auto passIndex : m_CompiledPasses) {
+            this->PrepareRecorder(frame.Recorders[m_Passes[passIndex].Order], m_Passes[passIndex].Queue);
+            this->RecordPass(frame, passIndex);
+        }
+
+        auto RecordBatch = [&](FrameGraphRecorder& recorder, ResourceBarrierBatch const& batch) -> CommandList& {
+            auto& cmdList = this->PrepareRecorder(recorder, FrameGraphQueue::Graphics);
+            cmdList.Begin();
+            RecordBarriers(cmdList.GetVkCommandBuffer(), batch);
+            cmdList.End();
+            return cmdList;
+        };
+
+        std::array<SubmitBatch, 2> batches;
+        std::array<Fence*, 2> fences = {m_pGraphicsFence.get(), m_pComputeFence.get()};
+        std::array<uint64_t, 2> waitedValues = {};
+
+        auto WaitQueue = [&](FrameGraphQueue queue, uint64_t value) -> void {
+            auto queueIndex = GetQueueIndex(queue);
+            if (value <= waitedValues[queueIndex])
+                return;
+            batches[queueIndex].Wait(*fences[1 - queueIndex], value, vk::PipelineStageFlagBits::eAllCommands);
+            waitedValues[queueIndex] = value;
+            m_Statistic.CrossQueueWaitCount++;
+        };
+
+        if (executeInfo.pSwapChain)
+            batches[GetQueueIndex(FrameGraphQueue::Graphics)].WaitImage(*executeInfo.pSwapChain, vk::PipelineStageFlagBits::eColorAttachmentOutput);
+
+        uint64_t prologueValue = 0;
+        if (!m_PrologueBarriers.IsEmpty()) {
+            batches[GetQueueIndex(FrameGraphQueue::Graphics)].Execute(RecordBatch(frame.Prologue, m_PrologueBarriers));
+            if (m_IsPrologueSignaled) {
+                prologueValue = m_pGraphicsFence->Increment();
+                batches[GetQueueIndex(FrameGraphQueue::Graphics)].Signal(*m_pGraphicsFence, prologueValue);
+            }
+        }
+
+        //A queue only waits on the other at the passes that consume its results, so independent work overlaps
+        for (auto passIndex : m_CompiledPasses) {
+            auto& pass = m_Passes[passIndex];
+            auto queueIndex = GetQueueIndex(pass.Queue);
+            auto const& recorder = frame.Recorders[pass.Order];
+
+            if (pass.IsPrologueWaited)
+                WaitQueue(pass.Queue, prologueValue);
+            for (auto waitPass : pass.WaitPasses) {
+                if (waitPass >= 0)
+                    WaitQueue(pass.Queue, m_Passes[waitPass].SignalValue);
+            }
+
+            if (pass.Queue == FrameGraphQueue::Graphics)
+                batches[queueIndex].Execute(*recorder.pGraphicsCmdList);
+            else
+                batches[queueIndex].Execute(*recorder.pComputeCmdList);
+
+            if (pass.IsSignaled) {
+                pass.SignalValue = fences[queueIndex]->Increment();
+                batches[queueIndex].Signal(*fences[queueIndex], pass.SignalValue);
+            }
+        }
+
+        if (!m_EpilogueBarriers.IsEmpty()) {
+            WaitQueue(FrameGraphQueue::Graphics, m_Passes[m_EpilogueWaitPass].SignalValue);
+            batches[GetQueueIndex(FrameGraphQueue::Graphics)].Execute(RecordBatch(frame.Epilogue, m_EpilogueBarriers));
+        }
+
+        //Both streams end with a signal, so the frame slot can be recycled once the two values are reached
+        for (uint32_t queueIndex = 0; queueIndex < std::size(batches); queueIndex++) {
+            if (!batches[queueIndex].IsEmpty())
+                batches[queueIndex].Signal(*fences[queueIndex], fences[queueIndex]->Increment());
+        }
+        frame.GraphicsValue = m_pGraphicsFence->GetExpectedValue();
+        frame.ComputeValue = m_pComputeFence->GetExpectedValue();
+        frame.IsSubmitted = true;
+
+        if (executeInfo.pSwapChain)
+            batches[GetQueueIndex(FrameGraphQueue::Graphics)].Present(*executeInfo.pSwapChain, executeInfo.FrameID);
+
+        //Each queue may wait for a value the other one signals in its own batch, which timeline semaphores allow
+        if (!batches[GetQueueIndex(FrameGraphQueue::Graphics)].IsEmpty())
+            pImplDevice->GetGraphicsCommandQueue().Submit(batches[GetQueueIndex(FrameGraphQueue::Graphics)]);
+        if (!batches[GetQueueIndex(FrameGraphQueue::AsyncCompute)].IsEmpty())
+            pImplDevice->GetComputeCommandQueue().Submit(batches[GetQueueIndex(FrameGraphQueue::AsyncCompute)]);
+
+        //States are published once the pass lists resolved theirs against the states the frame started from, so only
+        //lists submitted after the frame see the final ones. The epilogue hands every imported resource back to the
+        //graphics family
+        {
+            std::lock_guard<std::mutex> lock(GetResourceStateMutex());
+            for (auto const& resource : m_Resources) {
+                if (!resource.IsTransient && resource.IsReferenced) {
+                    assert(*resource.Resource.pGlobalState == resource.InitialState);
+                    *resource.Resource.pGlobalState = resource.LastState;
+                    *resource.Resource.pGlobalQueueFamilyIndex = m_QueueFamilyIndices[GetQueueIndex(FrameGraphQueue::Graphics)];
+                }
+            }
+        }
+
+        m_Statistic.RecordTime = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - timeBegin).count();
+
+        m_Resources.clear();
+        m_Passes.clear();
+        m_Usages.clear();
+        m_CompiledPasses.clear();
+        m_ImportedResources.clear();
+        m_IsCompiled = false;
+        m_FrameIndex++;
+    }
+
+    auto FrameGraph::Internal::SortPasses() -> bool {
+        //Per resource, in declaration order: a write follows the previous write and the reads since, and a read follows
+        //the previous write. A transient resource has no contents before its first write, so reads declared before it
+        //follow that write instead; an imported one is read with the contents of the previous frame first
+        std::vector<std::vector<uint32_t>> successors(std::size(m_Passes));
+        std::vector<uint32_t> predecessorCounts(std::size(m_Passes));
+        auto AddEdge = [&](uint32_t from, uint32_t to) -> void {
+            if (from == to)
+                return;
+            successors[from].push_back(to);
+            predecessorCounts[to]++;
+        };
+
+        struct ResourceDependency {
+            int32_t               LastWriter = -1;
+            std::vector<uint32_t> Readers = {};
+        };
+        std::vector<ResourceDependency> dependencies(std::size(m_Resources));
+
+        for (uint32_t passIndex = 0; passIndex < std::size(m_Passes); passIndex++) {
+            auto const& pass = m_Passes[passIndex];
+            for (uint32_t usageIndex = pass.FirstUsage; usageIndex < pass.FirstUsage + pass.UsageCount; usageIndex++) {
+                auto const& usage = m_Usages[usageIndex];
+                auto& dependency = dependencies[usage.Resource.Index];
+                bool isEarlyRead = m_Resources[usage.Resource.Index].IsTransient && dependency.LastWriter < 0;
+
+                if (!GetResourceStateInfo(usage.State).IsWrite) {
+                    if (dependency.LastWriter >= 0)
+                        AddEdge(dependency.LastWriter, passIndex);
+                    dependency.Readers.push_back(passIndex);
+                    continue;
+                }
+
+                if (dependency.LastWriter >= 0)
+                    AddEdge(dependency.LastWriter, passIndex);
+                for (auto reader : dependency.Readers) {
+                    if (isEarlyRead)
+                        AddEdge(passIndex, reader);
+                    else
+                        AddEdge(reader, passIndex);
+                }
+                dependency.LastWriter = static_cast<int32_t>(passIndex);
+                dependency.Readers.clear();
+            }
+        }
+
+        //Kahn's algorithm; among the ready passes the earliest declared runs first, so a valid declaration order is kept
+        std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> readyPasses;
+        for (uint32_t passIndex = 0; passIndex < std::size(m_Passes); passIndex++) {
+            if (predecessorCounts[passIndex] == 0)
+                readyPasses.push(passIndex);
+        }
+
+        m_CompiledPasses.clear();
+        while (!readyPasses.empty()) {
+            auto passIndex = readyPasses.top();
+            readyPasses.pop();
+            m_CompiledPasses.push_back(passIndex);
+            for (auto successor : successors[passIndex]) {
+                if (--predecessorCounts[successor] == 0)
+                    readyPasses.push(successor);
+            }
+        }
+        return std::size(m_CompiledPasses) == std::size(m_Passes);
+    }
+
+    auto FrameGraph::Internal::CullPasses() -> void {
+        //Walks the sorted passes backwards: a pass survives when it has side effects or writes a resource that is an
+        //output or is used by a surviving pass after it. Everything a surviving pass touches is then needed before it
+        for (auto& resource : m_Resources)
+            resource.IsNeeded = resource.IsOutput;
+
+        for (auto iterator = std::rbegin(m_CompiledPasses); iterator != std::rend(m_CompiledPasses); ++iterator) {
+            auto& pass = m_Passes[*iterator];
+            auto usages = std::span(m_Usages).subspan(pass.FirstUsage, pass.UsageCount);
+
+            pass.IsCulled = !pass.HasSideEffects && std::none_of(std::begin(usages), std::end(usages), [&](auto const& usage) -> bool {
+                return GetResourceStateInfo(usage.State).IsWrite && m_Resources[usage.Resource.Index].IsNeeded;
+            });
+            if (pass.IsCulled) {
+                m_Statistic.CulledPassCount++;
+                continue;
+            }
+
+            for (auto const& usage : usages)
+                m_Resources[usage.Resource.Index].IsNeeded = true;
+        }
+    }
+
+    auto FrameGraph::Internal::PlaceTransientResources(FrameGraphFrame& frame) -> void {
+        //Resources touched by the compute queue may be in use while any graphics pass runs, so they span the whole
+        //frame and are never aliased. The placement is only redone when the descriptions or lifetimes change
+        auto lastOrder = std::empty(m_CompiledPasses) ? 0u : static_cast<uint32_t>(std::size(m_CompiledPasses) - 1);
+        uint64_t hash = 0xcbf29ce484222325ull;
+        uint32_t transientCount = 0;
+
+        for (auto& resource : m_Resources) {
+            if (!resource.IsTransient || !resource.IsReferenced)
+                continue;
+
+            if (resource.IsUsedAsync) {
+                resource.FirstOrder = 0;
+                resource.LastOrder = lastOrder;
+            }
+
+            auto sharingMode = resource.IsUsedAsync ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive;
+            auto queueFamilyIndexCount = resource.IsUsedAsync ? static_cast<uint32_t>(std::size(m_QueueFamilyIndices)) : 0u;
+            auto pQueueFamilyIndices = resource.IsUsedAsync ? std::data(m_QueueFamilyIndices) : nullptr;
+            resource.TransientID = transientCount++;
+
+            hash = HashCombine(hash, resource.FirstOrder);
+            hash = HashCombine(hash, resource.LastOrder);
+            hash = HashCombine(hash, static_cast<uint64_t>(sharingMode));
+            if (resource.Resource.Aspect) {
+                auto& imageCI = resource.ImageCI;
+                imageCI.sharingMode = sharingMode;
+                imageCI.queueFamilyIndexCount = queueFamilyIndexCount;
+                imageCI.pQueueFamilyIndices = pQueueFamilyIndices;
+
+                hash = HashCombine(hash, static_cast<VkImageCreateFlags>(imageCI.flags));
+                hash = HashCombine(hash, static_cast<uint64_t>(imageCI.imageType));
+                hash = HashCombine(hash, static_cast<uint64_t>(imageCI.format));
+                hash = HashCombine(hash, (uint64_t(imageCI.extent.width) << 32) | imageCI.extent.height);
+                hash = HashCombine(hash, (uint64_t(imageCI.extent.depth) << 32) | imageCI.mipLevels);
+                hash = HashCombine(hash, (uint64_t(imageCI.arrayLayers) << 32) | static_cast<VkSampleCountFlags>(imageCI.samples));
+                hash = HashCombine(hash, static_cast<uint64_t>(imageCI.tiling));
+                hash = HashCombine(hash, static_cast<VkImageUsageFlags>(imageCI.usage));
+            } else {
+                auto& bufferCI = resource.BufferCI;
+                bufferCI.sharingMode = sharingMode;
+                bufferCI.queueFamilyIndexCount = queueFamilyIndexCount;
+                bufferCI.pQueueFamilyIndices = pQueueFamilyIndices;
+
+                hash = HashCombine(hash, static_cast<VkBufferCreateFlags>(bufferCI.flags));
+                hash = HashCombine(hash, bufferCI.size);
+                hash = HashCombine(hash, static_cast<VkBufferUsageFlags>(bufferCI.usage));
+            }
+        }
+        hash = HashCombine(hash, transientCount);
+        m_Statistic.TransientResourceCount = transientCount;
+
+        if (hash != frame.PlannerHash) {
+            frame.pPlanner->Reset(*m_pGraphicsFence);
+            for (auto const& resource : m_Resources) {
+                if (!resource.IsTransient || !resource.IsReferenced)
+                    continue;
+                if (resource.Resource.Aspect)
+                    frame.pPlanner->AddImage(TransientImageCreateInfo{.ImageCI = resource.ImageCI, .FirstPass = resource.FirstOrder, .LastPass = resource.LastOrder});
+                else
+                    frame.pPlanner->AddBuffer(TransientBufferCreateInfo{.BufferCI = resource.BufferCI, .FirstPass = resource.FirstOrder, .LastPass = resource.LastOrder});
+            }
+            frame.pPlanner->Compile(*m_pGraphicsFence);
+            frame.PlannerHash = hash;
+        }
+
+        for (auto& resource : m_Resources) {
+            if (!resource.IsTransient || !resource.IsReferenced)
+                continue;
+            if (resource.Resource.Aspect)
+                resource.Resource.Image = frame.pPlanner->GetVkImage(resource.TransientID);
+            else
+                resource.Resource.Buffer = frame.pPlanner->GetVkBuffer(resource.TransientID);
+        }
+    }
+
+    auto FrameGraph::Internal::BuildBarriers(FrameGraphFrame const& frame) -> void {
+        auto const graphicsIndex = GetQueueIndex(FrameGraphQueue::Graphics);
+        auto const computeIndex = GetQueueIndex(FrameGraphQueue::AsyncCompute);
+
+        m_PrologueBarriers = {};
+        m_EpilogueBarriers = {};
+        m_EpilogueWaitPass = -1;
+        m_IsPrologueSignaled = false;
+
+        {
+            std::lock_guard<std::mutex> lock(GetResourceStateMutex());
+            for (auto& resource : m_Resources) {
+                resource.LastPass = -1;
+                if (!resource.IsTransient && resource.IsReferenced)
+                    resource.InitialState = *resource.Resource.pGlobalState;
+            }
+        }
+
+        //Signal values grow in execution order, so the pass waited for is the one that runs last, not the last declared
+        auto LatestPass = [&](int32_t lhs, int32_t rhs) -> int32_t {
+            if (lhs < 0 || rhs < 0)
+                return std::max(lhs, rhs);
+            return m_Passes[lhs].Order >= m_Passes[rhs].Order ? lhs : rhs;
+        };
+
+        //Consecutive uses on one queue get a barrier; a change of queue gets a semaphore wait on the last use instead,
+        //plus a queue family ownership transfer for imported resources, which are exclusive to one family
+        for (auto passIndex : m_CompiledPasses) {
+            auto& pass = m_Passes[passIndex];
+            auto queueIndex = GetQueueIndex(pass.Queue);
+            auto aliasingBarriers = frame.pPlanner->GetAliasingBarriers(pass.Order);
+
+            for (uint32_t usageIndex = pass.FirstUsage; usageIndex < pass.FirstUsage + pass.UsageCount; usageIndex++) {
+                auto const& usage = m_Usages[usageIndex];
+                auto& resource = m_Resources[usage.Resource.Index];
+                assert(resource.LastPass != static_cast<int32_t>(passIndex));
+
+                if (resource.LastPass < 0 && resource.IsTransient) {
+                    bool isAliased = std::any_of(std::begin(aliasingBarriers), std::end(aliasingBarriers), [&](auto const& barrier) -> bool {
+                        return barrier.ResourceID == resource.TransientID;
+                    });
+                    if (isAliased)
+                        AppendAliasingTransition(pass.PreBarriers, resource.Resource, usage.State, m_SupportedStages[queueIndex]);
+                    else
+                        AppendTransition(pass.PreBarriers, resource.Resource, ResourceState::Undefined, usage.State, m_SupportedStages[queueIndex]);
+                } else if (resource.LastPass < 0) {
+                    //Undefined contents need no release on the graphics queue, the compute queue simply discards them
+                    auto initialLayout = GetResourceStateInfo(resource.InitialState).Layout;
+                    bool isContentDefined = resource.Resource.Image ? initialLayout != vk::ImageLayout::eUndefined : resource.InitialState != ResourceState::Undefined;
+                    if (pass.Queue == FrameGraphQueue::AsyncCompute && isContentDefined) {
+                        AppendOwnershipTransfer(m_PrologueBarriers, pass.PreBarriers, resource.Resource, resource.InitialState, usage.State, m_QueueFamilyIndices, m_SupportedStages);
+                        pass.IsPrologueWaited = true;
+                        m_IsPrologueSignaled = true;
+                    } else {
+                        AppendTransition(pass.PreBarriers, resource.Resource, resource.InitialState, usage.State, m_SupportedStages[queueIndex]);
+                    }
+                } else if (resource.LastQueue == pass.Queue) {
+                    AppendTransition(pass.PreBarriers, resource.Resource, resource.LastState, usage.State, m_SupportedStages[queueIndex]);
+                } else {
+                    auto& producer = m_Passes[resource.LastPass];
+                    auto lastQueueIndex = GetQueueIndex(resource.LastQueue);
+                    producer.IsSignaled = true;
+                    pass.WaitPasses[lastQueueIndex] = LatestPass(pass.WaitPasses[lastQueueIndex], resource.LastPass);
+
+                    if (resource.IsTransient)
+                        AppendQueueTransition(pass.PreBarriers, resource.Resource, resource.LastState, usage.State, m_SupportedStages[queueIndex]);
+                    else
+                        AppendOwnershipTransfer(producer.PostBarriers, pass.PreBarriers, resource.Resource, resource.LastState, usage.State, {m_QueueFamilyIndices[lastQueueIndex], m_QueueFamilyIndices[queueIndex]}, {m_SupportedStages[lastQueueIndex], m_SupportedStages[queueIndex]});
+                }
+
+                resource.LastPass = static_cast<int32_t>(passIndex);
+                resource.LastQueue = pass.Queue;
+                resource.LastState = usage.State;
+            }
+        }
+
+        //Imported resources go back to the graphics family at the end of the frame
+        for (auto const& resource : m_Resources) {
+            if (resource.IsTransient || !resource.IsReferenced || resource.LastQueue != FrameGraphQueue::AsyncCompute)
+                continue;
+
+            auto& producer = m_Passes[resource.LastPass];
+            producer.IsSignaled = true;
+            m_EpilogueWaitPass = LatestPass(m_EpilogueWaitPass, resource.LastPass);
+            AppendOwnershipTransfer(producer.PostBarriers, m_EpilogueBarriers, resource.Resource, resource.LastState, resource.LastState, {m_QueueFamilyIndices[computeIndex], m_QueueFamilyIndices[graphicsIndex]}, {m_SupportedStages[computeIndex], m_SupportedStages[graphicsIndex]});
+        }
+
+        m_Statistic.BarrierCount = GetBarrierCount(m_PrologueBarriers) + GetBarrierCount(m_EpilogueBarriers);
+        for (auto passIndex : m_CompiledPasses)
+            m_Statistic.BarrierCount += GetBarrierCount(m_Passes[passIndex].PreBarriers) + GetBarrierCount(m_Passes[passIndex].PostBarriers);
+    }
+
+    auto FrameGraph::Internal::PrepareRecorder(FrameGraphRecorder& recorder, FrameGraphQueue queue) -> CommandList& {
+        if (queue == FrameGraphQueue::Graphics) {
+            if (!recorder.pGraphicsAllocator) {
+                recorder.pGraphicsAllocator = std::make_unique<GraphicsCommandAllocator>(*m_pDevice, CommandAllocatorResetMode::Pool);
+                recorder.pGraphicsCmdList = std::make_unique<GraphicsCommandList>(*recorder.pGraphicsAllocator);
+            }
+            return *recorder.pGraphicsCmdList;
+        }
+
+        if (!recorder.pComputeAllocator) {
+            recorder.pComputeAllocator = std::make_unique<ComputeCommandAllocator>(*m_pDevice, CommandAllocatorResetMode::Pool);
+            recorder.pComputeCmdList = std::make_unique<ComputeCommandList>(*recorder.pComputeAllocator);
+        }
+        return *recorder.pComputeCmdList;
+    }
+
+    auto FrameGraph::Internal::RecordPass(FrameGraphFrame& frame, uint32_t passIndex) const -> void {
+        auto const& pass = m_Passes[passIndex];
+        auto& recorder = frame.Recorders[pass.Order];
+
+        FrameGraphPassContext context = {.PassIndex = passIndex};
+        if (pass.Queue == FrameGraphQueue::Graphics) {
+            context.pGraphicsCmdList = recorder.pGraphicsCmdList.get();
+            context.pComputeCmdList = recorder.pGraphicsCmdList.get();
+        } else {
+            context.pComputeCmdList = recorder.pComputeCmdList.get();
+        }
+
+        auto& cmdList = *context.pComputeCmdList;
+        cmdList.Begin();
+        RecordBarriers(cmdList.GetVkCommandBuffer(), pass.PreBarriers);
+        if (pass.Executor)
+            pass.Executor(context);
+        cmdList.FlushBarriers();
+        RecordBarriers(cmdList.GetVkCommandBuffer(), pass.PostBarriers);
+        cmdList.End();
+    }
+
+    auto FrameGraph::Internal::RecycleFrame(FrameGraphFrame& frame) -> void {
+        this->WaitFrame(frame);
+
+        auto ResetRecorder = [](FrameGraphRecorder& recorder) -> void {
+            if (recorder.pGraphicsAllocator)
+                recorder.pGraphicsAllocator->Reset();
+            if (recorder.pComputeAllocator)
+                recorder.pComputeAllocator->Reset();
+        };
+
+        for (auto& recorder : frame.Recorders)
+            ResetRecorder(recorder);
+        ResetRecorder(frame.Prologue);
+        ResetRecorder(frame.Epilogue);
+    }
+
+    auto FrameGraph::Internal::WaitFrame(FrameGraphFrame& frame) -> void {
+        if (!frame.IsSubmitted)
+            return;
+
+        m_pGraphicsFence->Wait(frame.GraphicsValue);
+        m_pComputeFence->Wait(frame.ComputeValue);
+        frame.IsSubmitted = false;
+    }
+
+    auto FrameGraph::Internal::Release() -> void {
+        //Transient resources and command pools must outlive the submissions that use them
+        for (auto& frame : m_Frames)
+            this->WaitFrame(frame);
+        m_Frames.clear();
+    }
+}
+
+namespace HAL {
+
+    FrameGraph::FrameGraph(Device const& device, FrameGraphCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    FrameGraph::FrameGraph(FrameGraph&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    FrameGraph& FrameGraph::operator=(FrameGraph&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    FrameGraph::~FrameGraph() = default;
+
+    auto FrameGraph::ImportBuffer(Buffer const& buffer) -> FrameGraphResource {
+        return m_pInternal->ImportResource(GetTrackedBuffer(buffer));
+    }
+
+    auto FrameGraph::ImportTexture(Texture const& texture) -> FrameGraphResource {
+        return m_pInternal->ImportResource(GetTrackedTexture(texture));
+    }
+
+    auto FrameGraph::CreateBuffer(vk::BufferCreateInfo const& createInfo) -> FrameGraphResource {
+        return m_pInternal->CreateBuffer(createInfo);
+    }
+
+    auto FrameGraph::CreateTexture(vk::ImageCreateInfo const& createInfo) -> FrameGraphResource {
+        return m_pInternal->CreateTexture(createInfo);
+    }
+
+    auto FrameGraph::MarkOutput(FrameGraphResource resource) -> void {
+        m_pInternal->MarkOutput(resource);
+    }
+
+    auto FrameGraph::AddPass(FrameGraphPassCreateInfo const& createInfo, FrameGraphPassExecutor&& executor) -> void {
+        m_pInternal->AddPass(createInfo, std::move(executor));
+    }
+
+    auto FrameGraph::Compile() -> void {
+        m_pInternal->Compile();
+    }
+
+    auto FrameGraph::Execute(FrameGraphExecuteInfo const& executeInfo) -> void {
+        m_pInternal->Execute(executeInfo);
+    }
+
+    auto FrameGraph::GetVkBuffer(FrameGraphResource resource) const -> vk::Buffer {
+        return m_pInternal->GetVkBuffer(resource);
+    }
+
+    auto FrameGraph::GetVkImage(FrameGraphResource resource) const -> vk::Image {
+        return m_pInternal->GetVkImage(resource);
+    }
+
+    auto FrameGraph::GetGraphicsFence() const -> Fence const& {
+        return m_pInternal->GetGraphicsFence();
+    }
+
+    auto FrameGraph::GetComputeFence() const -> Fence const& {
+        return m_pInternal->GetComputeFence();
+    }
+
+    auto FrameGraph::GetStatistic() const -> FrameGraphStatistic {
+        return m_pInternal->GetStatistic();
+    }
+}
@@ -0,0 +1,254 @@
+#include "../include/HostAllocator.hpp"
+
+namespace HAL {
+
+    struct ArenaChunk {
+        std::atomic<uint32_t> References = {};
+        size_t                Offset = {};
+        size_t                Capacity = {};
+
+        auto GetData() -> uint8_t* { return reinterpret_cast<uint8_t*>(this + 1); }
+    };
+
+    //The owning thread holds one reference to its current chunk, every live allocation holds another one
+    struct ThreadArena {
+        ArenaChunk* pChunk = {};
+
+        ~ThreadArena() {
+            if (pChunk)
+                HostAllocator::Get().FreeArena(pChunk);
+        }
+    };
+
+    static thread_local ThreadArena s_ThreadArena = {};
+
+    HostAllocator::HostAllocator() {
+        for (size_t index = 0; index < m_Callbacks.size(); index++) {
+            m_Callbacks[index] = vk::AllocationCallbacks{
+                .pUserData = reinterpret_cast<void*>(index),
+                .pfnAllocation = [](void* pUserData, size_t size, size_t alignment, VkSystemAllocationScope scope) -> void* {
+                    return HostAllocator::Get().Allocate(static_cast<HostMemoryTag>(reinterpret_cast<uintptr_t>(pUserData)), size, alignment, static_cast<vk::SystemAllocationScope>(scope));
+                },
+                .pfnReallocation = [](void* pUserData, void* pOriginal, size_t size, size_t alignment, VkSystemAllocationScope scope) -> void* {
+                    return HostAllocator::Get().Reallocate(static_cast<HostMemoryTag>(reinterpret_cast<uintptr_t>(pUserData)), pOriginal, size, alignment, static_cast<vk::SystemAllocationScope>(scope));
+                },
+                .pfnFree = [](void* pUserData, void* pMemory) -> void {
+                    HostAllocator::Get().Free(pMemory);
+                },
+                .pfnInternalAllocation = [](void* pUserData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope) -> void {
+                    HostAllocator::Get().m_InternalAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+                },
+                .pfnInternalFree = [](void* pUserData, size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope) -> void {
+                    HostAllocator::Get().m_InternalAllocatedBytes.fetch_sub(size, std::memory_order_relaxed);
+                }
+            };
+        }
+    }
+
+    HostAllocator::~HostAllocator() {
+        for (auto& pool : m_Pools)
+            for (auto pPage : pool.Pages)
+                std::free(pPage);
+    }
+
+    auto HostAllocator::Get() -> HostAllocator& {
+        static HostAllocator allocator;
+        return allocator;
+    }
+
+    auto HostAllocator::Allocate(HostMemoryTag tag, size_t size, size_t alignment, vk::SystemAllocationScope scope) -> void* {
+        alignment = std::max(alignment, DefaultAlignment);
+
+        AllocationHeader header = {
+            .Size = size,
+            .Tag = static_cast<uint32_t>(tag),
+            .Scope = static_cast<uint16_t>(scope)
+        };
+
+        uint8_t* pMemory = nullptr;
+        if (scope == vk::SystemAllocationScope::eCommand) {
+            auto [pUser, pChunk] = this->AllocateArena(size, alignment);
+            if (pUser) {
+                header.Kind = AllocationKind::Arena;
+                header.pSource = pChunk;
+                pMemory = static_cast<uint8_t*>(pUser);
+            }
+        }
+
+        size_t required = sizeof(AllocationHeader) + size + (alignment > DefaultAlignment ? alignment : 0);
+        bool isPoolScope = scope == vk::SystemAllocationScope::eCommand || scope == vk::SystemAllocationScope::eObject || scope == vk::SystemAllocationScope::eCache;
+        if (!pMemory && isPoolScope && required <= (MinSizeClass << (SizeClassCount - 1))) {
+            uint32_t sizeClass = 0;
+            while ((MinSizeClass << sizeClass) < required)
+                sizeClass++;
+
+            if (auto pBlock = this->AllocatePool(sizeClass)) {
+                header.Kind = AllocationKind::Pool;
+                header.pSource = pBlock;
+                header.SizeClass = sizeClass;
+                pMemory = reinterpret_cast<uint8_t*>(AlignUp(reinterpret_cast<uintptr_t>(pBlock) + sizeof(AllocationHeader), alignment));
+            }
+        }
+
+        if (!pMemory) {
+            void* pRaw = std::malloc(sizeof(AllocationHeader) + size + alignment);
+            if (!pRaw)
+                return nullptr;
+            header.Kind = AllocationKind::System;
+            header.pSource = pRaw;
+            pMemory = reinterpret_cast<uint8_t*>(AlignUp(reinterpret_cast<uintptr_t>(pRaw) + sizeof(AllocationHeader), alignment));
+        }
+
+        new (GetHeader(pMemory)) AllocationHeader(header);
+        this->TrackAllocation(header);
+        return pMemory;
+    }
+
+    auto HostAllocator::Reallocate(HostMemoryTag tag, void* pOriginal, size_t size, size_t alignment, vk::SystemAllocationScope scope) -> void* {
+        if (!pOriginal)
+            return this->Allocate(tag, size, alignment, scope);
+
+        if (size == 0) {
+            this->Free(pOriginal);
+            return nullptr;
+        }
+
+        void* pMemory = this->Allocate(tag, size, alignment, scope);
+        if (!pMemory)
+            return nullptr;
+
+        std::memcpy(pMemory, pOriginal, std::min<size_t>(size, GetHeader(pOriginal)->Size));
+        this->Free(pOriginal);
+        return pMemory;
+    }
+
+    auto HostAllocator::Free(void* pMemory) -> void {
+        if (!pMemory)
+            return;
+
+        AllocationHeader header = *GetHeader(pMemory);
+        this->TrackFree(header);
+
+        switch (header.Kind) {
+            case AllocationKind::Arena:  this->FreeArena(header.pSource); break;
+            case AllocationKind::Pool:   this->FreePool(header.SizeClass, header.pSource); break;
+            case AllocationKind::System: std::free(header.pSource); break;
+        }
+    }
+
+    auto HostAllocator::AllocateArena(size_t size, size_t alignment) -> std::pair<void*, void*> {
+        //Large command allocations would waste most of a chunk
+        if (sizeof(AllocationHeader) + size + alignment > ArenaChunkSize / 4)
+            return {nullptr, nullptr};
+
+        auto tryPlace = [&](ArenaChunk* pChunk) -> void* {
+            auto pBase = pChunk->GetData();
+            auto user = AlignUp(reinterpret_cast<uintptr_t>(pBase) + pChunk->Offset + sizeof(AllocationHeader), alignment);
+            if (user + size > reinterpret_cast<uintptr_t>(pBase) + pChunk->Capacity)
+                return nullptr;
+            pChunk->Offset = user + size - reinterpret_cast<uintptr_t>(pBase);
+            pChunk->References.fetch_add(1, std::memory_order_relaxed);
+            return reinterpret_cast<void*>(user);
+        };
+
+        auto& arena = s_ThreadArena;
+        if (arena.pChunk) {
+            //Every allocation of the chunk has been released, rewind it
+            if (arena.pChunk->References.load(std::memory_order_acquire) == 1)
+                arena.pChunk->Offset = 0;
+
+            if (auto pUser = tryPlace(arena.pChunk))
+                return {pUser, arena.pChunk};
+
+            this->FreeArena(arena.pChunk);
+            arena.pChunk = nullptr;
+        }
+
+        void* pRaw = std::malloc(sizeof(ArenaChunk) + ArenaChunkSize);
+        if (!pRaw)
+            return {nullptr, nullptr};
+
+        arena.pChunk = new (pRaw) ArenaChunk{};
+        arena.pChunk->References.store(1, std::memory_order_relaxed);
+        arena.pChunk->Capacity = ArenaChunkSize;
+        m_ArenaReservedBytes.fetch_add(ArenaChunkSize, std::memory_order_relaxed);
+        return {tryPlace(arena.pChunk), arena.pChunk};
+    }
+
+    auto HostAllocator::FreeArena(void* pChunk) -> void {
+        auto pArenaChunk = static_cast<ArenaChunk*>(pChunk);
+        if (pArenaChunk->References.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            m_ArenaReservedBytes.fetch_sub(pArenaChunk->Capacity, std::memory_order_relaxed);
+            pArenaChunk->~ArenaChunk();
+            std::free(pArenaChunk);
+        }
+    }
+
+    auto HostAllocator::AllocatePool(uint32_t sizeClass) -> void* {
+        auto& pool = m_Pools[sizeClass];
+        std::lock_guard lock(pool.Mutex);
+
+        if (!pool.pFreeList) {
+            auto pPage = static_cast<uint8_t*>(std::malloc(PageSize));
+            if (!pPage)
+                return nullptr;
+            pool.Pages.push_back(pPage);
+            m_PoolReservedBytes.fetch_add(PageSize, std::memory_order_relaxed);
+
+            size_t blockSize = MinSizeClass << sizeClass;
+            for (size_t offset = 0; offset + blockSize <= PageSize; offset += blockSize)
+                pool.pFreeList = new (pPage + offset) FreeBlock{pool.pFreeList};
+        }
+
+        auto pBlock = pool.pFreeList;
+        pool.pFreeList = pBlock->pNext;
+        return pBlock;
+    }
+
+    auto HostAllocator::FreePool(uint32_t sizeClass, void* pBlock) -> void {
+        auto& pool = m_Pools[sizeClass];
+        std::lock_guard lock(pool.Mutex);
+        pool.pFreeList = new (pBlock) FreeBlock{pool.pFreeList};
+    }
+
+    auto HostAllocator::TrackAllocation(AllocationHeader const& header) -> void {
+        for (auto pCounter : {&m_TagCounters[header.Tag], &m_ScopeCounters[header.Scope]}) {
+            uint64_t allocated = pCounter->AllocatedBytes.fetch_add(header.Size, std::memory_order_relaxed) + header.Size;
+            pCounter->AllocationCount.fetch_add(1, std::memory_order_relaxed);
+            pCounter->TotalAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+            uint64_t peak = pCounter->PeakBytes.load(std::memory_order_relaxed);
+            while (peak < allocated && !pCounter->PeakBytes.compare_exchange_weak(peak, allocated, std::memory_order_relaxed));
+        }
+    }
+
+    auto HostAllocator::TrackFree(AllocationHeader const& header) -> void {
+        for (auto pCounter : {&m_TagCounters[header.Tag], &m_ScopeCounters[header.Scope]}) {
+            pCounter->AllocatedBytes.fetch_sub(header.Size, std::memory_order_relaxed);
+            pCounter->AllocationCount.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    auto HostAllocator::GetStatistic() const -> HostMemoryStatistic {
+        auto loadCounter = [](Counter const& counter) -> HostMemoryCounter {
+            return HostMemoryCounter{
+                .AllocatedBytes = counter.AllocatedBytes.load(std::memory_order_relaxed),
+                .PeakBytes = counter.PeakBytes.load(std::memory_order_relaxed),
+                .AllocationCount = counter.AllocationCount.load(std::memory_order_relaxed),
+                .TotalAllocationCount = counter.TotalAllocationCount.load(std::memory_order_relaxed)
+            };
+        };
+
+        HostMemoryStatistic statistic = {
+            .ArenaReservedBytes = m_ArenaReservedBytes.load(std::memory_order_relaxed),
+            .PoolReservedBytes = m_PoolReservedBytes.load(std::memory_order_relaxed),
+            .InternalAllocatedBytes = m_InternalAllocatedBytes.load(std::memory_order_relaxed)
+        };
+
+        for (size_t index = 0; index < m_TagCounters.size(); index++)
+            statistic.Tags[index] = loadCounter(m_TagCounters[index]);
+        for (size_t index = 0; index < m_ScopeCounters.size(); index++)
+            statistic.Scopes[index] = loadCounter(m_ScopeCounters[index]);
+        return statistic;
+    }
+}
@@ -0,0 +1,224 @@
+#include "../include/InstanceCullerImpl.hpp"
+#include "../include/DeviceImpl.hpp"
+#include "../include/HostAllocator.hpp"
+
+#include <HAL/Buffer.hpp>
+#include <HAL/CommandList.hpp>
+#include <HAL/DescriptorTableLayout.hpp>
+#include <HAL/Fence.hpp>
+#include <HAL/ShaderCompiler.hpp>
+#include <HAL/Texture.hpp>
+
+#include <fmt/format.h>
+#include <cstring>
+
+namespace HAL {
+
+    constexpr uint32_t InstanceCullingGroupSize = 64;
+
+    constexpr uint32_t InstanceCullingSetCountPerPool = 16;
+
+    static auto GetDescriptorBufferInfo(Buffer const& buffer) -> vk::DescriptorBufferInfo {
+        return vk::DescriptorBufferInfo{
+            .buffer = buffer.GetVkBuffer(),
+            .offset = buffer.GetOffset(),
+            .range = buffer.GetSize()
+        };
+    }
+
+    InstanceCuller::Internal::Internal(Device const& device, InstanceCullerCreateInfo const& createInfo) {
+        assert(createInfo.pCompiler);
+        assert(createInfo.FrameCount > 0);
+
+        m_pDevice = const_cast<Device*>(&device);
+        m_Frames.resize(createInfo.FrameCount);
+        m_FrameIndex = 0;
+
+        //The occlusion variant binds the depth pyramid, the frustum variant runs without one
+        std::wstring_view occlusionDefines[] = { L"OCCLUSION_CULLING" };
+        auto spirvFrustumCS = createInfo.pCompiler->CompileFromFile(createInfo.ShaderPath, L"CSMain", ShaderStage::Compute);
+        auto spirvOcclusionCS = createInfo.pCompiler->CompileFromFile(createInfo.ShaderPath, L"CSMain", ShaderStage::Compute, occlusionDefines);
+        if (!spirvFrustumCS || !spirvOcclusionCS) {
+            fmt::print("Error: Failed to compile instance culling shader \n");
+            return;
+        }
+
+        m_pFrustumPipeline = std::make_unique<ComputePipeline>(device, ComputePipelineCreateInfo{ .CS = { std::data(*spirvFrustumCS), std::size(*spirvFrustumCS) } });
+        m_pOcclusionPipeline = std::make_unique<ComputePipeline>(device, ComputePipelineCreateInfo{ .CS = { std::data(*spirvOcclusionCS), std::size(*spirvOcclusionCS) } });
+    }
+
+    InstanceCuller::Internal& InstanceCuller::Internal::operator=(Internal&& rhs) noexcept {
+        if (this != &rhs) {
+            this->Release();
+            m_pDevice = rhs.m_pDevice;
+            m_pFrustumPipeline = std::move(rhs.m_pFrustumPipeline);
+            m_pOcclusionPipeline = std::move(rhs.m_pOcclusionPipeline);
+            m_Frames = std::move(rhs.m_Frames);
+            m_FrameIndex = rhs.m_FrameIndex;
+        }
+        return *this;
+    }
+
+    InstanceCuller::Internal::~Internal() {
+        this->Release();
+    }
+
+    auto InstanceCuller::Internal::Cull(ComputeCommandList& cmdList, InstanceCullingInfo const& cullingInfo) -> void {
+        assert(cullingInfo.pInstances && cullingInfo.pVisibleInstances && cullingInfo.pDrawArguments && cullingInfo.pDrawCount);
+        assert(!cullingInfo.pDepthPyramid == !cullingInfo.pDepthPyramidView);
+
+        if (!m_pFrustumPipeline)
+            return;
+
+        bool isOcclusionEnabled = cullingInfo.pDepthPyramid != nullptr;
+        auto const& pipeline = isOcclusionEnabled ? *m_pOcclusionPipeline : *m_pFrustumPipeline;
+        auto descriptorSet = this->AllocateDescriptorSet(pipeline.GetDescriptorTableLayout(0).GetVkDescriptorSetLayout());
+
+        vk::DescriptorBufferInfo bufferInfos[] = {
+            GetDescriptorBufferInfo(*cullingInfo.pInstances),
+            GetDescriptorBufferInfo(*cullingInfo.pVisibleInstances),
+            GetDescriptorBufferInfo(*cullingInfo.pDrawArguments),
+            GetDescriptorBufferInfo(*cullingInfo.pDrawCount)
+        };
+
+        std::vector<vk::WriteDescriptorSet> descriptorWrites;
+        for (uint32_t index = 0; index < _countof(bufferInfos); index++) {
+            descriptorWrites.push_back(vk::WriteDescriptorSet{
+                .dstSet = descriptorSet,
+                .dstBinding = index,
+                .descriptorCount = 1,
+                .descriptorType = vk::DescriptorType::eStorageBuffer,
+                .pBufferInfo = &bufferInfos[index]
+            });
+        }
+
+        vk::DescriptorImageInfo depthPyramidInfo = {};
+        InstanceCullingConstants constants = {};
+        if (isOcclusionEnabled) {
+            auto const& textureCI = cullingInfo.pDepthPyramid->GetCreateInfo();
+            auto const& viewCI = cullingInfo.pDepthPyramidView->GetCreateInfo();
+
+            depthPyramidInfo = vk::DescriptorImageInfo{
+                .imageView = cullingInfo.pDepthPyramidView->GetVkImageView(),
+                .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
+            };
+            descriptorWrites.push_back(vk::WriteDescriptorSet{
+                .dstSet = descriptorSet,
+                .dstBinding = _countof(bufferInfos),
+                .descriptorCount = 1,
+                .descriptorType = vk::DescriptorType::eSampledImage,
+                .pImageInfo = &depthPyramidInfo
+            });
+
+            constants.DepthPyramidMipCount = std::min(viewCI.MipLevelCount, textureCI.MipLevels - viewCI.BaseMipLevel);
+            constants.DepthPyramidWidth = static_cast<float>(std::max(textureCI.Width >> viewCI.BaseMipLevel, 1u));
+            constants.DepthPyramidHeight = static_cast<float>(std::max(textureCI.Height >> viewCI.BaseMipLevel, 1u));
+        }
+        m_pDevice->GetVkDevice().updateDescriptorSets(descriptorWrites, {});
+
+        std::memcpy(constants.View, cullingInfo.Camera.View, sizeof(constants.View));
+        constants.P00 = cullingInfo.Camera.P00;
+        constants.P11 = cullingInfo.Camera.P11;
+        constants.P22 = cullingInfo.Camera.P22;
+        constants.P23 = cullingInfo.Camera.P23;
+        constants.ZNear = cullingInfo.Camera.ZNear;
+        constants.ZFar = cullingInfo.Camera.ZFar;
+        constants.InstanceCount = cullingInfo.InstanceCount;
+
+        //The counter is cleared on the GPU, so the CPU never has to touch any of the outputs
+        cmdList.TransitionBuffer(*cullingInfo.pDrawCount, ResourceState::CopyDest);
+        cmdList.FlushBarriers();
+        cmdList.GetVkCommandBuffer().fillBuffer(cullingInfo.pDrawCount->GetVkBuffer(), cullingInfo.pDrawCount->GetOffset(), sizeof(uint32_t), 0);
+
+        cmdList.TransitionBuffer(*cullingInfo.pInstances, ResourceState::ShaderResource);
+        cmdList.TransitionBuffer(*cullingInfo.pVisibleInstances, ResourceState::UnorderedAccess);
+        cmdList.TransitionBuffer(*cullingInfo.pDrawArguments, ResourceState::UnorderedAccess);
+        cmdList.TransitionBuffer(*cullingInfo.pDrawCount, ResourceState::UnorderedAccess);
+        if (isOcclusionEnabled)
+            cmdList.TransitionTexture(*cullingInfo.pDepthPyramid, ResourceState::ShaderResource);
+
+        cmdList.SetComputePipeline(pipeline, {});
+        cmdList.SetComputeDescriptorSet(0, descriptorSet);
+        cmdList.SetComputePushConstants(0, std::as_bytes(std::span{&constants, 1}));
+        cmdList.Dispatch((cullingInfo.InstanceCount + InstanceCullingGroupSize - 1) / InstanceCullingGroupSize, 1, 1);
+    }
+
+    auto InstanceCuller::Internal::NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void {
+        m_Frames[m_FrameIndex].Semaphore = fence.GetVkSemaphore();
+        m_Frames[m_FrameIndex].FenceValue = value.value_or(fence.GetExpectedValue());
+
+        m_FrameIndex = (m_FrameIndex + 1) % std::size(m_Frames);
+        this->WaitFrame(m_Frames[m_FrameIndex]);
+
+        auto& frame = m_Frames[m_FrameIndex];
+        for (auto& pDescriptorPool : frame.DescriptorPools)
+            m_pDevice->GetVkDevice().resetDescriptorPool(*pDescriptorPool);
+        frame.SetCount = 0;
+    }
+
+    auto InstanceCuller::Internal::AllocateDescriptorSet(vk::DescriptorSetLayout layout) -> vk::DescriptorSet {
+        //Pools are only added, never freed, so a frame settles at the number of culls it records
+        auto& frame = m_Frames[m_FrameIndex];
+        auto poolIndex = frame.SetCount / InstanceCullingSetCountPerPool;
+        if (poolIndex == std::size(frame.DescriptorPools)) {
+            vk::DescriptorPoolSize poolSizes[] = {
+                vk::DescriptorPoolSize{ .type = vk::DescriptorType::eStorageBuffer, .descriptorCount = 4 * InstanceCullingSetCountPerPool },
+                vk::DescriptorPoolSize{ .type = vk::DescriptorType::eSampledImage, .descriptorCount = InstanceCullingSetCountPerPool }
+            };
+            vk::DescriptorPoolCreateInfo descriptorPoolCI = {
+                .maxSets = InstanceCullingSetCountPerPool,
+                .poolSizeCount = _countof(poolSizes),
+                .pPoolSizes = poolSizes
+            };
+            frame.DescriptorPools.push_back(m_pDevice->GetVkDevice().createDescriptorPoolUnique(descriptorPoolCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Descriptor)));
+        }
+        frame.SetCount++;
+
+        vk::DescriptorSetAllocateInfo descriptorSetAI = {
+            .descriptorPool = *frame.DescriptorPools[poolIndex],
+            .descriptorSetCount = 1,
+            .pSetLayouts = &layout
+        };
+        return m_pDevice->GetVkDevice().allocateDescriptorSets(descriptorSetAI).at(0);
+    }
+
+    auto InstanceCuller::Internal::WaitFrame(InstanceCullerFrame& frame) -> void {
+        if (!frame.Semaphore)
+            return;
+
+        vk::SemaphoreWaitInfo waitInfo = {
+            .semaphoreCount = 1,
+            .pSemaphores = &frame.Semaphore,
+            .pValues = &frame.FenceValue
+        };
+        auto result = m_pDevice->GetVkDevice().waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
+        assert(result == vk::Result::eSuccess);
+        frame.Semaphore = vk::Semaphore{};
+    }
+
+    auto InstanceCuller::Internal::Release() -> void {
+        //Descriptor sets must outlive the command lists that bind them
+        for (auto& frame : m_Frames)
+            this->WaitFrame(frame);
+        m_Frames.clear();
+    }
+}
+
+namespace HAL {
+
+    InstanceCuller::InstanceCuller(Device const& device, InstanceCullerCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    InstanceCuller::InstanceCuller(InstanceCuller&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    InstanceCuller& InstanceCuller::operator=(InstanceCuller&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    InstanceCuller::~InstanceCuller() = default;
+
+    auto InstanceCuller::Cull(ComputeCommandList& cmdList, InstanceCullingInfo const& cullingInfo) -> void {
+        m_pInternal->Cull(cmdList, cullingInfo);
+    }
+
+    auto InstanceCuller::NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void {
+        m_pInternal->NextFrame(fence, value);
+    }
+}
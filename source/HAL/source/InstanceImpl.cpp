@@ -1,5 +1,6 @@
 #include "../include/InstanceImpl.hpp"
 #include "../include/AdapterImpl.hpp"
+#include "../include/HostAllocator.hpp"
 
 namespace HAL {
     Instance::Internal::Internal(InstanceCreateInfo const& createInfo) {
@@ -63,7 +64,7 @@ namespace HAL {
             .enabledExtensionCount = static_cast<uint32_t>(std::size(instanceExtensions)),
             .ppEnabledExtensionNames = std::data(instanceExtensions)
         };
-        m_pInstance = vk::createInstanceUnique(instanceCI);
+        m_pInstance = vk::createInstanceUnique(instanceCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Instance));
         VULKAN_HPP_DEFAULT_DISPATCHER.init(*m_pInstance);
 
         for (auto const& physicalDevice : m_pInstance->enumeratePhysicalDevices()) {
@@ -85,4 +86,8 @@ namespace HAL {
     auto Instance::GetAdapters() const -> std::vector<HAL::Adapter> const& {
         return m_pInternal->GetAdapters();
     }
+
+    auto Instance::GetHostMemoryStatistic() const -> HostMemoryStatistic {
+        return HostAllocator::Get().GetStatistic();
+    }
 }
\ No newline at end of file
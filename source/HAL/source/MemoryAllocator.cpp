@@ -1,14 +1,14 @@
 #include "../include/MemoryAllocator.hpp"
+#include "../include/DeviceImpl.hpp"
+#include "../include/CommandQueueImpl.hpp"
+#include "../include/HostAllocator.hpp"
 
 
 namespace HAL {
     
     MemoryAllocator::MemoryAllocator(Instance const& instance, Device const& device, AllocatorCreateInfo const& createInfo) {
-        vma::DeviceMemoryCallbacks deviceMemoryCallbacks = {
-            .pfnAllocate = createInfo.DeviceMemoryCallbacks.pfnAllocate,
-            .pfnFree = createInfo.DeviceMemoryCallbacks.pfnFree,
-            .pUserData = createInfo.DeviceMemoryCallbacks.pUserData
-        };
+        m_pTelemetry = std::make_unique<MemoryTelemetry>(device.GetVkPhysicalDevice().getMemoryProperties());
+        vma::DeviceMemoryCallbacks deviceMemoryCallbacks = m_pTelemetry->GetDeviceMemoryCallbacks();
 
         vma::VulkanFunctions vulkanFunctions = {
             .vkGetPhysicalDeviceProperties = VULKAN_HPP_DEFAULT_DISPATCHER.vkGetPhysicalDeviceProperties,
@@ -39,6 +39,7 @@ namespace HAL {
             .flags = createInfo.Flags,
             .physicalDevice = device.GetVkPhysicalDevice(),
             .device = device.GetVkDevice(),
+            .pAllocationCallbacks = HostAllocator::GetAllocationCallbacks(HostMemoryTag::Resource),
             .pDeviceMemoryCallbacks = &deviceMemoryCallbacks,
             .frameInUseCount = createInfo.FrameInUseCount,
             .pVulkanFunctions = &vulkanFunctions,
@@ -47,12 +48,372 @@ namespace HAL {
         };
 
         m_pAllocator = vma::createAllocatorUnique(allocatorCI);
+        m_Device = device.GetVkDevice();
+        m_MemoryProperties = device.GetVkPhysicalDevice().getMemoryProperties();
         m_FrameIndex = 0;
-        m_FrameCount = createInfo.FrameInUseCount;
+        m_SoftThreshold = createInfo.SoftThreshold;
+        m_HardThreshold = createInfo.HardThreshold;
+        m_CallbackID = 0;
+        m_pDevice = const_cast<Device*>(&device);
+        m_DefragmentationValue = 0;
+
+        m_HostMemoryTypeBits = 0;
+        for (uint32_t index = 0; index < m_MemoryProperties.memoryTypeCount; index++) {
+            auto const& memoryType = m_MemoryProperties.memoryTypes[index];
+            if (!(m_MemoryProperties.memoryHeaps[memoryType.heapIndex].flags & vk::MemoryHeapFlagBits::eDeviceLocal))
+                m_HostMemoryTypeBits |= 1 << index;
+        }
+
+        //On UMA devices every heap is device local, so there is no other heap to relieve and the fallback is disabled
+        if (!m_HostMemoryTypeBits)
+            fmt::print("Warning: No memory heap outside device local memory, host memory fallback is disabled \n");
+
+        m_HeapBudgets.resize(m_MemoryProperties.memoryHeapCount);
+        for (uint32_t index = 0; index < m_MemoryProperties.memoryHeapCount; index++)
+            m_HeapBudgets[index].IsDeviceLocal = static_cast<bool>(m_MemoryProperties.memoryHeaps[index].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+        this->UpdateBudget();
+    }
+
+    //The device drained its queues before the allocator is destroyed, so the last pass has already finished
+    MemoryAllocator::~MemoryAllocator() {
+        this->EndDefragmentation();
     }
 
     auto MemoryAllocator::NextFrame() -> void {
-        m_FrameIndex = m_FrameIndex++ % m_FrameCount;
-        m_pAllocator->setCurrentFrameIndex(m_FrameIndex);
+        m_pAllocator->setCurrentFrameIndex(++m_FrameIndex);
+        this->UpdateBudget();
+    }
+
+    auto MemoryAllocator::UpdateBudget() -> void {
+        std::array<vma::Budget, VK_MAX_MEMORY_HEAPS> budgets = {};
+        m_pAllocator->getBudget(std::data(budgets));
+
+        std::vector<std::pair<uint32_t, MemoryHeapBudget>> changedHeaps;
+        {
+            std::lock_guard<std::mutex> lock(m_BudgetMutex);
+            for (uint32_t index = 0; index < std::size(m_HeapBudgets); index++) {
+                auto& heap = m_HeapBudgets[index];
+                heap.BudgetSize = budgets[index].budget;
+                heap.UsageSize = budgets[index].usage;
+                heap.BlockSize = budgets[index].blockBytes;
+                heap.AllocationSize = budgets[index].allocationBytes;
+
+                float ratio = heap.BudgetSize > 0 ? static_cast<float>(heap.UsageSize) / static_cast<float>(heap.BudgetSize) : 1.0f;
+                auto pressure = MemoryPressure::None;
+                if (ratio >= m_HardThreshold)
+                    pressure = MemoryPressure::Hard;
+                else if (ratio >= m_SoftThreshold)
+                    pressure = MemoryPressure::Soft;
+
+                bool isChanged = pressure != heap.Pressure;
+                heap.Pressure = pressure;
+                if (isChanged)
+                    changedHeaps.emplace_back(index, heap);
+            }
+        }
+
+        if (changedHeaps.empty())
+            return;
+
+        //Callbacks run on a copy without the lock held, so they may add or remove callbacks themselves
+        std::vector<std::pair<uint32_t, MemoryPressureCallback>> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(m_CallbackMutex);
+            callbacks = m_PressureCallbacks;
+        }
+
+        for (auto const& [heapIndex, budget] : changedHeaps) {
+            for (auto const& [id, callback] : callbacks)
+                callback(heapIndex, budget);
+        }
+    }
+
+    auto MemoryAllocator::GetMemoryBudget() const -> std::vector<MemoryHeapBudget> {
+        std::lock_guard<std::mutex> lock(m_BudgetMutex);
+        return m_HeapBudgets;
+    }
+
+    auto MemoryAllocator::GetHeapPressure(uint32_t memoryTypeIndex) const -> MemoryPressure {
+        std::lock_guard<std::mutex> lock(m_BudgetMutex);
+        return m_HeapBudgets[m_MemoryProperties.memoryTypes[memoryTypeIndex].heapIndex].Pressure;
+    }
+
+    auto MemoryAllocator::IsDeviceLocalRequest(vma::AllocationCreateInfo const& allocationCI) const -> bool {
+        if (allocationCI.pool)
+            return false;
+        if (allocationCI.usage == vma::MemoryUsage::eGpuOnly || allocationCI.usage == vma::MemoryUsage::eGpuLazilyAllocated)
+            return true;
+        return static_cast<bool>((allocationCI.requiredFlags | allocationCI.preferredFlags) & vk::MemoryPropertyFlagBits::eDeviceLocal);
+    }
+
+    auto MemoryAllocator::GetHostFallbackCreateInfo(vma::AllocationCreateInfo const& allocationCI) const -> vma::AllocationCreateInfo {
+        auto fallbackCI = allocationCI;
+        fallbackCI.flags = vma::AllocationCreateFlags(static_cast<VmaAllocationCreateFlags>(allocationCI.flags) & ~VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT);
+        fallbackCI.usage = vma::MemoryUsage::eUnknown;
+        fallbackCI.requiredFlags &= ~vk::MemoryPropertyFlags(vk::MemoryPropertyFlagBits::eDeviceLocal);
+        fallbackCI.preferredFlags &= ~vk::MemoryPropertyFlags(vk::MemoryPropertyFlagBits::eDeviceLocal);
+        fallbackCI.memoryTypeBits = (allocationCI.memoryTypeBits ? allocationCI.memoryTypeBits : ~0u) & m_HostMemoryTypeBits;
+        return fallbackCI;
+    }
+
+    auto MemoryAllocator::CreateBuffer(vk::BufferCreateInfo const& bufferCI, vma::AllocationCreateInfo const& allocationCI, MemoryFallbackPolicy policy, vma::AllocationInfo* pAllocationInfo) -> std::pair<vk::UniqueBuffer, vma::UniqueAllocation> {
+        bool isFallbackAllowed = policy == MemoryFallbackPolicy::HostMemory && m_HostMemoryTypeBits && this->IsDeviceLocalRequest(allocationCI);
+
+        auto requestCI = allocationCI;
+        if (isFallbackAllowed) {
+            uint32_t memoryTypeIndex = 0;
+            if (m_pAllocator->findMemoryTypeIndexForBufferInfo(&bufferCI, &allocationCI, &memoryTypeIndex) == vk::Result::eSuccess && this->GetHeapPressure(memoryTypeIndex) == MemoryPressure::Hard)
+                requestCI = this->GetHostFallbackCreateInfo(allocationCI);
+            else
+                requestCI.flags |= vma::AllocationCreateFlagBits::eWithinBudget;
+        }
+
+        vk::Buffer buffer = {};
+        vma::Allocation allocation = {};
+        auto result = m_pAllocator->createBuffer(&bufferCI, &requestCI, &buffer, &allocation, pAllocationInfo);
+        if (result != vk::Result::eSuccess && isFallbackAllowed && requestCI.usage != vma::MemoryUsage::eUnknown) {
+            fmt::print("Warning: Device local memory budget exceeded, buffer of {} bytes falls back to host memory \n", bufferCI.size);
+            requestCI = this->GetHostFallbackCreateInfo(allocationCI);
+            result = m_pAllocator->createBuffer(&bufferCI, &requestCI, &buffer, &allocation, pAllocationInfo);
+        }
+
+        if (result != vk::Result::eSuccess) {
+            fmt::print("Error: Failed to allocate buffer of {} bytes: {} \n", bufferCI.size, vk::to_string(result));
+            return {};
+        }
+
+        return std::make_pair(vk::UniqueBuffer(buffer, vk::ObjectDestroy<vk::Device, VULKAN_HPP_DEFAULT_DISPATCHER_TYPE>(m_Device, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Resource))), vma::UniqueAllocation(allocation, vma::ObjectFree<vma::Allocator>(*m_pAllocator)));
+    }
+
+    auto MemoryAllocator::CreateImage(vk::ImageCreateInfo const& imageCI, vma::AllocationCreateInfo const& allocationCI, MemoryFallbackPolicy policy, vma::AllocationInfo* pAllocationInfo) -> std::pair<vk::UniqueImage, vma::UniqueAllocation> {
+        bool isFallbackAllowed = policy == MemoryFallbackPolicy::HostMemory && m_HostMemoryTypeBits && this->IsDeviceLocalRequest(allocationCI);
+
+        auto requestCI = allocationCI;
+        if (isFallbackAllowed) {
+            uint32_t memoryTypeIndex = 0;
+            if (m_pAllocator->findMemoryTypeIndexForImageInfo(&imageCI, &allocationCI, &memoryTypeIndex) == vk::Result::eSuccess && this->GetHeapPressure(memoryTypeIndex) == MemoryPressure::Hard)
+                requestCI = this->GetHostFallbackCreateInfo(allocationCI);
+            else
+                requestCI.flags |= vma::AllocationCreateFlagBits::eWithinBudget;
+        }
+
+        vk::Image image = {};
+        vma::Allocation allocation = {};
+        auto result = m_pAllocator->createImage(&imageCI, &requestCI, &image, &allocation, pAllocationInfo);
+        if (result != vk::Result::eSuccess && isFallbackAllowed && requestCI.usage != vma::MemoryUsage::eUnknown) {
+            fmt::print("Warning: Device local memory budget exceeded, image {}x{} falls back to host memory \n", imageCI.extent.width, imageCI.extent.height);
+            requestCI = this->GetHostFallbackCreateInfo(allocationCI);
+            result = m_pAllocator->createImage(&imageCI, &requestCI, &image, &allocation, pAllocationInfo);
+        }
+
+        if (result != vk::Result::eSuccess) {
+            fmt::print("Error: Failed to allocate image {}x{}: {} \n", imageCI.extent.width, imageCI.extent.height, vk::to_string(result));
+            return {};
+        }
+
+        return std::make_pair(vk::UniqueImage(image, vk::ObjectDestroy<vk::Device, VULKAN_HPP_DEFAULT_DISPATCHER_TYPE>(m_Device, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Resource))), vma::UniqueAllocation(allocation, vma::ObjectFree<vma::Allocator>(*m_pAllocator)));
+    }
+
+    auto MemoryAllocator::CreatePool(MemoryPoolCreateInfo const& createInfo) const -> std::pair<vma::UniquePool, uint32_t> {
+        vma::AllocationCreateInfo allocationCI = {
+            .usage = createInfo.MemoryUsage
+        };
+
+        uint32_t memoryTypeIndex = 0;
+        vk::Result result = vk::Result::eSuccess;
+        if (createInfo.ImageUsage) {
+            vk::ImageCreateInfo imageCI = {
+                .imageType = vk::ImageType::e2D,
+                .format = createInfo.ImageFormat,
+                .extent = vk::Extent3D{.width = 1, .height = 1, .depth = 1},
+                .mipLevels = 1,
+                .arrayLayers = 1,
+                .samples = vk::SampleCountFlagBits::e1,
+                .tiling = vk::ImageTiling::eOptimal,
+                .usage = createInfo.ImageUsage,
+                .sharingMode = vk::SharingMode::eExclusive,
+                .initialLayout = vk::ImageLayout::eUndefined
+            };
+            result = m_pAllocator->findMemoryTypeIndexForImageInfo(&imageCI, &allocationCI, &memoryTypeIndex);
+        } else {
+            vk::BufferCreateInfo bufferCI = {
+                .size = 1024,
+                .usage = createInfo.BufferUsage,
+                .sharingMode = vk::SharingMode::eExclusive
+            };
+            result = m_pAllocator->findMemoryTypeIndexForBufferInfo(&bufferCI, &allocationCI, &memoryTypeIndex);
+        }
+
+        if (result != vk::Result::eSuccess) {
+            fmt::print("Error: No memory type for memory pool {}: {} \n", createInfo.Name, vk::to_string(result));
+            return {};
+        }
+
+        auto GetAlgorithmFlags = [](MemoryPoolAlgorithm algorithm) -> vma::PoolCreateFlags {
+            switch (algorithm) {
+                case MemoryPoolAlgorithm::Linear: return vma::PoolCreateFlagBits::eLinearAlgorithm;
+                case MemoryPoolAlgorithm::Buddy:  return vma::PoolCreateFlagBits::eBuddyAlgorithm;
+                default: return {};
+            }
+        };
+
+        vma::PoolCreateInfo poolCI = {
+            .memoryTypeIndex = memoryTypeIndex,
+            .flags = GetAlgorithmFlags(createInfo.Algorithm),
+            .blockSize = createInfo.BlockSize,
+            .minBlockCount = createInfo.MinBlockCount,
+            .maxBlockCount = createInfo.MaxBlockCount,
+        };
+
+        //Linear pools used as ring buffers never outlive a single block
+        if (createInfo.Algorithm == MemoryPoolAlgorithm::Linear && createInfo.MaxBlockCount == 0)
+            poolCI.maxBlockCount = 1;
+
+        //A MaxBlockCount * BlockSize beyond the heap or a failed MinBlockCount preallocation fails here, so report it instead of throwing
+        vma::Pool pool = {};
+        result = m_pAllocator->createPool(&poolCI, &pool);
+        if (result != vk::Result::eSuccess) {
+            fmt::print("Error: Failed to create memory pool {}: {} \n", createInfo.Name, vk::to_string(result));
+            return {};
+        }
+
+        m_pAllocator->setPoolName(pool, createInfo.Name.c_str());
+        return std::make_pair(vma::UniquePool{pool, vma::ObjectDestroy<vma::Allocator>(*m_pAllocator)}, memoryTypeIndex);
+    }
+
+    auto MemoryAllocator::AddMemoryPressureCallback(MemoryPressureCallback&& callback) -> uint32_t {
+        std::lock_guard<std::mutex> lock(m_CallbackMutex);
+        m_PressureCallbacks.emplace_back(++m_CallbackID, std::move(callback));
+        return m_CallbackID;
+    }
+
+    auto MemoryAllocator::RemoveMemoryPressureCallback(uint32_t callbackID) -> void {
+        std::lock_guard<std::mutex> lock(m_CallbackMutex);
+        std::erase_if(m_PressureCallbacks, [callbackID](auto const& e) { return e.first == callbackID; });
+    }
+
+    auto MemoryAllocator::RegisterRelocatable(vma::Allocation allocation, RelocationCallback&& callback) -> void {
+        std::lock_guard<std::recursive_mutex> lock(m_RelocationMutex);
+        m_Relocatables.emplace_back(allocation, std::move(callback));
+    }
+
+    auto MemoryAllocator::UnregisterRelocatable(vma::Allocation allocation) -> void {
+        std::lock_guard<std::recursive_mutex> lock(m_RelocationMutex);
+        std::erase_if(m_Relocatables, [allocation](auto const& e) { return e.first == allocation; });
+
+        //The allocation is freed right after this, which VMA forbids while a pass that may move it is still open
+        this->EndDefragmentation();
+    }
+
+    auto MemoryAllocator::Defragment(Fence const& fence, std::optional<uint64_t> value, DefragmentationInfo const& info) -> DefragmentationStatistic {
+        std::lock_guard<std::recursive_mutex> lock(m_RelocationMutex);
+
+        if (m_Relocatables.empty())
+            return {};
+
+        if (!m_pDefragmentationAllocator) {
+            m_pDefragmentationAllocator = std::make_unique<GraphicsCommandAllocator>(*m_pDevice);
+            m_pDefragmentationCommandList = std::make_unique<GraphicsCommandList>(*m_pDefragmentationAllocator);
+            m_pDefragmentationFence = std::make_unique<Fence>(*m_pDevice);
+            vkx::setDebugName(m_Device, m_pDefragmentationFence->GetVkSemaphore(), "Defragmentation");
+        }
+
+        //defragmentationEnd frees the blocks the previous pass moved out of, so it has to wait for the copies of that
+        //pass. A pass still in flight skips this call instead of stalling the frame
+        if (m_DefragmentationContext && !m_pDefragmentationFence->IsCompleted(m_DefragmentationValue))
+            return {};
+        this->EndDefragmentation();
+
+        m_DefragmentationAllocations.clear();
+        for (auto const& [allocation, callback] : m_Relocatables)
+            m_DefragmentationAllocations.push_back(allocation);
+        m_DefragmentationChanged.assign(std::size(m_DefragmentationAllocations), VK_FALSE);
+
+        vma::DefragmentationInfo2 defragmentationInfo = {
+            .allocationCount = static_cast<uint32_t>(std::size(m_DefragmentationAllocations)),
+            .pAllocations = std::data(m_DefragmentationAllocations),
+            .pAllocationsChanged = std::data(m_DefragmentationChanged),
+            .maxCpuBytesToMove = 0,
+            .maxCpuAllocationsToMove = 0,
+            .maxGpuBytesToMove = info.MaxBytesPerFrame,
+            .maxGpuAllocationsToMove = info.MaxAllocationsPerFrame,
+            .commandBuffer = m_pDefragmentationCommandList->GetVkCommandBuffer()
+        };
+
+        //Relocatable buffers are exclusive to the graphics family, so the moves are recorded on the graphics queue the
+        //frames run on. Queue order puts them after the last frame that used the old location and before the next one,
+        //which needs neither an ownership transfer nor a wait on the frame fence
+        vk::MemoryBarrier beginBarrier = {
+            .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+            .dstAccessMask = vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite
+        };
+        vk::MemoryBarrier endBarrier = {
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite
+        };
+
+        vma::DefragmentationStats defragmentationStats = {};
+        vma::DefragmentationContext defragmentationContext = {};
+        m_pDefragmentationCommandList->Begin();
+        auto cmdBuffer = m_pDefragmentationCommandList->GetVkCommandBuffer();
+        cmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, {}, beginBarrier, {}, {});
+        auto result = m_pAllocator->defragmentationBegin(&defragmentationInfo, &defragmentationStats, &defragmentationContext);
+        cmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, endBarrier, {}, {});
+        m_pDefragmentationCommandList->End();
+
+        if (result != vk::Result::eSuccess && result != vk::Result::eNotReady) {
+            fmt::print("Error: Failed to begin defragmentation: {} \n", vk::to_string(result));
+            return {};
+        }
+
+        if (defragmentationContext) {
+            auto& graphicsQueue = reinterpret_cast<Device::Internal*>(m_pDevice)->GetGraphicsCommandQueue();
+            graphicsQueue.ExecuteCommandList({*m_pDefragmentationCommandList});
+            m_DefragmentationValue = m_pDefragmentationFence->Increment();
+            graphicsQueue.Signal(*m_pDefragmentationFence, m_DefragmentationValue);
+            m_DefragmentationContext = defragmentationContext;
+        }
+
+        //Allocations point at their new location once the pass began, so owners recreate their buffers there right away
+        //and fix up views and descriptors; the next frame is queued behind the copies. The old handles retire with the
+        //frame fence
+        for (size_t index = 0; index < std::size(m_DefragmentationAllocations); index++) {
+            if (!m_DefragmentationChanged[index])
+                continue;
+
+            auto allocation = m_DefragmentationAllocations[index];
+            auto iterator = std::find_if(std::begin(m_Relocatables), std::end(m_Relocatables), [allocation](auto const& e) { return e.first == allocation; });
+            if (iterator != std::end(m_Relocatables))
+                iterator->second(allocation, fence, value);
+        }
+
+        m_DefragmentationAllocations.clear();
+        m_DefragmentationChanged.clear();
+
+        return DefragmentationStatistic{
+            .BytesMoved = defragmentationStats.bytesMoved,
+            .BytesFreed = defragmentationStats.bytesFreed,
+            .AllocationsMoved = defragmentationStats.allocationsMoved,
+            .BlocksFreed = defragmentationStats.deviceMemoryBlocksFreed
+        };
+    }
+
+    auto MemoryAllocator::EndDefragmentation() -> void {
+        if (!m_DefragmentationContext)
+            return;
+        m_pDefragmentationFence->Wait(m_DefragmentationValue);
+        m_pAllocator->defragmentationEnd(m_DefragmentationContext);
+        m_DefragmentationContext = vma::DefragmentationContext{};
+    }
+
+    auto MemoryAllocator::GetMemoryStatistic() const -> MemoryStatistic {
+        vma::Stats stats = {};
+        m_pAllocator->calculateStats(&stats);
+        return MemoryStatistic{
+            .BlockCount = stats.total.blockCount,
+            .AllocationCount = stats.total.allocationCount,
+            .UsedBytes = stats.total.usedBytes,
+            .UnusedBytes = stats.total.unusedBytes
+        };
     }
 }
\ No newline at end of file
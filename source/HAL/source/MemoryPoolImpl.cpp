@@ -0,0 +1,53 @@
+#include "../include/MemoryPoolImpl.hpp"
+#include "../include/DeviceImpl.hpp"
+
+namespace HAL {
+
+    MemoryPool::Internal::Internal(Device const& device, MemoryPoolCreateInfo const& createInfo) {
+        auto pImplDevice = reinterpret_cast<const Device::Internal*>(&device);
+        std::tie(m_pPool, m_MemoryTypeIndex) = pImplDevice->GetMemoryAllocator().CreatePool(createInfo);
+        m_Name = createInfo.Name;
+        m_Algorithm = createInfo.Algorithm;
+    }
+
+    auto MemoryPool::Internal::GetStatistic() const -> MemoryPoolStatistic {
+        if (!m_pPool)
+            return {};
+
+        vma::PoolStats poolStats = {};
+        m_pPool.getOwner().getPoolStats(*m_pPool, &poolStats);
+        return MemoryPoolStatistic{
+            .Size = poolStats.size,
+            .UnusedSize = poolStats.unusedSize,
+            .AllocationCount = poolStats.allocationCount,
+            .BlockCount = poolStats.blockCount
+        };
+    }
+}
+
+namespace HAL {
+
+    MemoryPool::MemoryPool(Device const& device, MemoryPoolCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    MemoryPool::MemoryPool(MemoryPool&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    MemoryPool& MemoryPool::operator=(MemoryPool&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    MemoryPool::~MemoryPool() = default;
+
+    auto MemoryPool::GetName() const -> std::string const& {
+        return m_pInternal->GetName();
+    }
+
+    auto MemoryPool::GetStatistic() const -> MemoryPoolStatistic {
+        return m_pInternal->GetStatistic();
+    }
+
+    auto MemoryPool::GetVmaPool() const -> vma::Pool {
+        return m_pInternal->GetVmaPool();
+    }
+
+    auto MemoryPool::IsValid() const -> bool {
+        return m_pInternal->IsValid();
+    }
+}
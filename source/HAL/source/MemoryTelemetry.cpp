@@ -0,0 +1,124 @@
+#include "../include/MemoryTelemetry.hpp"
+
+namespace HAL {
+
+    MemoryTelemetry::MemoryTelemetry(vk::PhysicalDeviceMemoryProperties const& memoryProperties) {
+        assert(memoryProperties.memoryHeapCount <= MemorySnapshot::MaxHeapCount);
+
+        m_HeapCount = memoryProperties.memoryHeapCount;
+        for (uint32_t index = 0; index < memoryProperties.memoryHeapCount; index++) {
+            m_HeapSizes[index] = memoryProperties.memoryHeaps[index].size;
+            m_HeapDeviceLocal[index] = static_cast<bool>(memoryProperties.memoryHeaps[index].flags & vk::MemoryHeapFlagBits::eDeviceLocal);
+        }
+
+        for (uint32_t index = 0; index < memoryProperties.memoryTypeCount; index++)
+            m_TypeToHeap[index] = memoryProperties.memoryTypes[index].heapIndex;
+
+        m_pEvents = std::make_unique<EventSlot[]>(EventCapacity);
+        m_TimeStamp = std::chrono::steady_clock::now();
+    }
+
+    auto MemoryTelemetry::OnAllocate(uint32_t memoryTypeIndex, uint64_t size) -> void {
+        uint32_t heapIndex = m_TypeToHeap[memoryTypeIndex];
+        auto& heap = m_Heaps[heapIndex];
+
+        uint64_t usage = heap.UsedBytes.fetch_add(size, std::memory_order_relaxed) + size;
+        heap.AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        heap.AllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+        uint64_t peak = heap.PeakBytes.load(std::memory_order_relaxed);
+        while (peak < usage && !heap.PeakBytes.compare_exchange_weak(peak, usage, std::memory_order_relaxed));
+
+        this->PushEvent(MemoryEventType::Allocate, heapIndex, size, usage);
+    }
+
+    auto MemoryTelemetry::OnFree(uint32_t memoryTypeIndex, uint64_t size) -> void {
+        uint32_t heapIndex = m_TypeToHeap[memoryTypeIndex];
+        auto& heap = m_Heaps[heapIndex];
+
+        uint64_t usage = heap.UsedBytes.fetch_sub(size, std::memory_order_relaxed) - size;
+        heap.FreedBytes.fetch_add(size, std::memory_order_relaxed);
+        heap.AllocationCount.fetch_sub(1, std::memory_order_relaxed);
+
+        this->PushEvent(MemoryEventType::Free, heapIndex, size, usage);
+    }
+
+    auto MemoryTelemetry::PushEvent(MemoryEventType type, uint32_t heapIndex, uint64_t size, uint64_t heapUsage) -> void {
+        uint64_t index = m_EventHead.fetch_add(1, std::memory_order_relaxed);
+        auto& slot = m_pEvents[index % EventCapacity];
+
+        slot.Sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.TimePoint.store(this->GetTimePoint(), std::memory_order_relaxed);
+        slot.Size.store(size, std::memory_order_relaxed);
+        slot.HeapUsage.store(heapUsage, std::memory_order_relaxed);
+        slot.HeapIndex.store(heapIndex, std::memory_order_relaxed);
+        slot.Type.store(static_cast<uint32_t>(type), std::memory_order_relaxed);
+        slot.Sequence.store(index + 1, std::memory_order_release);
+    }
+
+    auto MemoryTelemetry::ReadEvents(uint64_t sequence, std::vector<MemoryEvent>& events) const -> uint64_t {
+        uint64_t head = m_EventHead.load(std::memory_order_acquire);
+        uint64_t begin = std::max(sequence, head > EventCapacity ? head - EventCapacity : 0);
+
+        for (uint64_t index = begin; index < head; index++) {
+            auto const& slot = m_pEvents[index % EventCapacity];
+
+            //Slots that are being written or were already overwritten are skipped
+            uint64_t sequenceBegin = slot.Sequence.load(std::memory_order_acquire);
+            if (sequenceBegin != index + 1)
+                continue;
+
+            MemoryEvent event = {
+                .TimePoint = static_cast<double>(slot.TimePoint.load(std::memory_order_relaxed)) * 1.0e-9,
+                .Size = slot.Size.load(std::memory_order_relaxed),
+                .HeapUsage = slot.HeapUsage.load(std::memory_order_relaxed),
+                .HeapIndex = slot.HeapIndex.load(std::memory_order_relaxed),
+                .Type = static_cast<MemoryEventType>(slot.Type.load(std::memory_order_relaxed))
+            };
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.Sequence.load(std::memory_order_relaxed) != sequenceBegin)
+                continue;
+            events.push_back(event);
+        }
+        return head;
+    }
+
+    auto MemoryTelemetry::GetSnapshot() const -> MemorySnapshot {
+        MemorySnapshot snapshot = {
+            .HeapCount = m_HeapCount,
+            .EventSequence = m_EventHead.load(std::memory_order_acquire),
+            .TimePoint = static_cast<double>(this->GetTimePoint()) * 1.0e-9
+        };
+
+        for (uint32_t index = 0; index < m_HeapCount; index++) {
+            snapshot.Heaps[index] = MemoryHeapSnapshot{
+                .HeapSize = m_HeapSizes[index],
+                .UsedBytes = m_Heaps[index].UsedBytes.load(std::memory_order_relaxed),
+                .PeakBytes = m_Heaps[index].PeakBytes.load(std::memory_order_relaxed),
+                .AllocatedBytes = m_Heaps[index].AllocatedBytes.load(std::memory_order_relaxed),
+                .FreedBytes = m_Heaps[index].FreedBytes.load(std::memory_order_relaxed),
+                .AllocationCount = m_Heaps[index].AllocationCount.load(std::memory_order_relaxed),
+                .IsDeviceLocal = m_HeapDeviceLocal[index]
+            };
+        }
+        return snapshot;
+    }
+
+    auto MemoryTelemetry::GetDeviceMemoryCallbacks() -> vma::DeviceMemoryCallbacks {
+        return vma::DeviceMemoryCallbacks{
+            .pfnAllocate = [](VmaAllocator allocator, uint32_t memoryType, VkDeviceMemory memory, VkDeviceSize size, void* pUserData) -> void {
+                reinterpret_cast<MemoryTelemetry*>(pUserData)->OnAllocate(memoryType, size);
+            },
+            .pfnFree = [](VmaAllocator allocator, uint32_t memoryType, VkDeviceMemory memory, VkDeviceSize size, void* pUserData) -> void {
+                reinterpret_cast<MemoryTelemetry*>(pUserData)->OnFree(memoryType, size);
+            },
+            .pUserData = this
+        };
+    }
+
+    auto MemoryTelemetry::GetTimePoint() const -> int64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_TimeStamp).count();
+    }
+}
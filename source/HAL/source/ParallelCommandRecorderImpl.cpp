@@ -0,0 +1,184 @@
+#include "../include/ParallelCommandRecorderImpl.hpp"
+
+#include <HAL/Fence.hpp>
+
+namespace HAL {
+
+    ParallelCommandRecorder::Internal::Internal(Device const& device, ParallelCommandRecorderCreateInfo const& createInfo) {
+        assert(createInfo.FrameCount > 0);
+
+        m_pState = std::make_unique<RecorderState>();
+        m_pState->Device = device.GetVkDevice();
+        m_pState->ThreadCount = std::max(createInfo.ThreadCount ? createInfo.ThreadCount : std::thread::hardware_concurrency(), 1u);
+        m_pState->Frames.resize(createInfo.FrameCount);
+
+        for (auto& frame : m_pState->Frames) {
+            for (uint32_t threadIndex = 0; threadIndex < m_pState->ThreadCount; threadIndex++) {
+                auto pContext = std::make_unique<RecorderContext>();
+                pContext->pAllocator = std::make_unique<GraphicsCommandAllocator>(device, CommandAllocatorResetMode::Pool);
+                frame.Contexts.push_back(std::move(pContext));
+            }
+        }
+
+        //The calling thread records as thread zero, so one worker fewer is spawned
+        for (uint32_t threadIndex = 1; threadIndex < m_pState->ThreadCount; threadIndex++)
+            m_pState->Workers.emplace_back(&Internal::WorkerLoop, m_pState.get(), threadIndex);
+    }
+
+    ParallelCommandRecorder::Internal& ParallelCommandRecorder::Internal::operator=(Internal&& rhs) noexcept {
+        if (this != &rhs) {
+            this->Release();
+            m_pState = std::move(rhs.m_pState);
+        }
+        return *this;
+    }
+
+    ParallelCommandRecorder::Internal::~Internal() {
+        this->Release();
+    }
+
+    auto ParallelCommandRecorder::Internal::Record(GraphicsCommandList& primary, uint32_t chunkCount, CommandChunkRecorder const& recorder) -> void {
+        if (chunkCount == 0)
+            return;
+
+        auto& state = *m_pState;
+        {
+            std::lock_guard<std::mutex> lock(state.Mutex);
+            state.pPrimary = &primary;
+            state.pRecorder = &recorder;
+            state.ChunkCount = chunkCount;
+            state.NextChunk = 0;
+            state.ChunkCmdLists.assign(chunkCount, nullptr);
+            state.ActiveWorkerCount = static_cast<uint32_t>(std::size(state.Workers));
+            state.JobIndex++;
+        }
+        state.WorkCondition.notify_all();
+
+        Internal::RecordChunks(state, 0);
+        {
+            std::unique_lock<std::mutex> lock(state.Mutex);
+            state.DoneCondition.wait(lock, [&] { return state.ActiveWorkerCount == 0; });
+        }
+
+        //Executing in chunk order keeps the draw order independent of which thread recorded what
+        std::vector<std::reference_wrapper<const GraphicsCommandList>> cmdLists;
+        cmdLists.reserve(chunkCount);
+        for (auto pCmdList : state.ChunkCmdLists)
+            cmdLists.push_back(std::cref(*pCmdList));
+        primary.ExecuteCommands(cmdLists);
+
+        state.pPrimary = nullptr;
+        state.pRecorder = nullptr;
+        state.ChunkCmdLists.clear();
+    }
+
+    auto ParallelCommandRecorder::Internal::NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void {
+        auto& state = *m_pState;
+        state.Frames[state.FrameIndex].Semaphore = fence.GetVkSemaphore();
+        state.Frames[state.FrameIndex].FenceValue = value.value_or(fence.GetExpectedValue());
+
+        state.FrameIndex = (state.FrameIndex + 1) % std::size(state.Frames);
+        Internal::WaitFrame(state, state.Frames[state.FrameIndex]);
+    }
+
+    auto ParallelCommandRecorder::Internal::Release() -> void {
+        if (!m_pState)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_pState->Mutex);
+            m_pState->IsStopping = true;
+        }
+        m_pState->WorkCondition.notify_all();
+        for (auto& worker : m_pState->Workers)
+            worker.join();
+
+        //Secondary lists may still be referenced by submitted primaries
+        for (auto& frame : m_pState->Frames)
+            Internal::WaitFrame(*m_pState, frame);
+        m_pState.reset();
+    }
+
+    auto ParallelCommandRecorder::Internal::WaitFrame(RecorderState& state, RecorderFrame& frame) -> void {
+        if (frame.Semaphore) {
+            vk::SemaphoreWaitInfo waitInfo = {
+                .semaphoreCount = 1,
+                .pSemaphores = &frame.Semaphore,
+                .pValues = &frame.FenceValue
+            };
+            auto result = state.Device.waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
+            assert(result == vk::Result::eSuccess);
+            frame.Semaphore = vk::Semaphore{};
+        }
+
+        for (auto& pContext : frame.Contexts) {
+            if (pContext->CmdLists.empty())
+                continue;
+            pContext->pAllocator->Reset();
+            std::move(pContext->CmdLists.begin(), pContext->CmdLists.end(), std::back_inserter(pContext->FreeCmdLists));
+            pContext->CmdLists.clear();
+        }
+    }
+
+    auto ParallelCommandRecorder::Internal::RecordChunks(RecorderState& state, uint32_t threadIndex) -> void {
+        auto& context = *state.Frames[state.FrameIndex].Contexts[threadIndex];
+
+        for (uint32_t chunkIndex = state.NextChunk++; chunkIndex < state.ChunkCount; chunkIndex = state.NextChunk++) {
+            if (context.FreeCmdLists.empty()) {
+                context.CmdLists.push_back(std::make_unique<GraphicsCommandList>(*context.pAllocator, CommandListLevel::Secondary));
+            } else {
+                context.CmdLists.push_back(std::move(context.FreeCmdLists.back()));
+                context.FreeCmdLists.pop_back();
+            }
+
+            auto& pCmdList = context.CmdLists.back();
+            pCmdList->BeginSecondary(*state.pPrimary);
+            (*state.pRecorder)(*pCmdList, chunkIndex);
+            pCmdList->End();
+            state.ChunkCmdLists[chunkIndex] = pCmdList.get();
+        }
+    }
+
+    auto ParallelCommandRecorder::Internal::WorkerLoop(RecorderState* pState, uint32_t threadIndex) -> void {
+        uint64_t jobIndex = 0;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(pState->Mutex);
+                pState->WorkCondition.wait(lock, [&] { return pState->IsStopping || pState->JobIndex != jobIndex; });
+                if (pState->IsStopping)
+                    return;
+                jobIndex = pState->JobIndex;
+            }
+
+            Internal::RecordChunks(*pState, threadIndex);
+
+            std::lock_guard<std::mutex> lock(pState->Mutex);
+            if (--pState->ActiveWorkerCount == 0)
+                pState->DoneCondition.notify_one();
+        }
+    }
+}
+
+namespace HAL {
+
+    ParallelCommandRecorder::ParallelCommandRecorder(Device const& device, ParallelCommandRecorderCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    ParallelCommandRecorder::ParallelCommandRecorder(ParallelCommandRecorder&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    ParallelCommandRecorder& ParallelCommandRecorder::operator=(ParallelCommandRecorder&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    ParallelCommandRecorder::~ParallelCommandRecorder() = default;
+
+    auto ParallelCommandRecorder::Record(GraphicsCommandList& primary, uint32_t chunkCount, CommandChunkRecorder const& recorder) -> void {
+        m_pInternal->Record(primary, chunkCount, recorder);
+    }
+
+    auto ParallelCommandRecorder::NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void {
+        m_pInternal->NextFrame(fence, value);
+    }
+
+    auto ParallelCommandRecorder::GetThreadCount() const -> uint32_t {
+        return m_pInternal->GetThreadCount();
+    }
+}
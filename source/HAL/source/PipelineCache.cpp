@@ -1,4 +1,5 @@
 #include "..\include\PipelineCache.hpp"
+#include "..\include\HostAllocator.hpp"
 
 namespace HAL {
 
@@ -13,14 +14,23 @@ namespace HAL {
         },
             .layout = pImplPipeline->GetVkPiplineLayout()
         };
-        auto [result, vkPipelines] = device.createComputePipelinesUnique(cache, {pipelineCI});
+        auto [result, vkPipelines] = device.createComputePipelinesUnique(cache, {pipelineCI}, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Pipeline));
         return std::move(vkPipelines.front());
     }
 
-    static auto CreateGraphicsPipeline(vk::Device device, vk::PipelineCache cache, GraphicsPipeline const& pipeline, RenderPass const& renderPass, GraphicsState const& state) -> vk::UniquePipeline {
+    static auto CreateGraphicsPipeline(vk::Device device, vk::PipelineCache cache, GraphicsPipeline const& pipeline, vk::RenderPass renderPass, uint32_t subpassIndex, GraphicsState const& state) -> vk::UniquePipeline {
 
         auto pImplPipeline = reinterpret_cast<const Pipeline*>(&pipeline);
 
+        vk::PipelineShaderStageCreateInfo shaderStagesCI[2] = {};
+        for (uint32_t index = 0; index < _countof(shaderStagesCI); index++) {
+            shaderStagesCI[index] = vk::PipelineShaderStageCreateInfo{
+                .stage = pImplPipeline->GetShaderModule(index).GetVkShaderStage(),
+                .module = pImplPipeline->GetShaderModule(index).GetVkShadeModule(),
+                .pName = pImplPipeline->GetShaderModule(index).GetEntryPoint().c_str()
+            };
+        }
+
         vk::PipelineViewportStateCreateInfo viewportStateCI = {
             .viewportCount = 1,
             .scissorCount = 1
@@ -81,8 +91,8 @@ namespace HAL {
 
 
         vk::GraphicsPipelineCreateInfo pipelineCI = {
-            //.stageCount = _countof(shaderStagesCI),
-            // .pStages = shaderStagesCI,
+            .stageCount = _countof(shaderStagesCI),
+            .pStages = shaderStagesCI,
             .pVertexInputState = &vertexInputStateCI,
             .pViewportState = &viewportStateCI,
             .pRasterizationState = &rasterizationStateCI,
@@ -91,10 +101,11 @@ namespace HAL {
             .pColorBlendState = &colorBlendStateCI,
             .pDynamicState = &dynamicStateCI,
             .layout = pImplPipeline->GetVkPiplineLayout(),
-            .renderPass = renderPass.GetVkRenderPass(),
+            .renderPass = renderPass,
+            .subpass = subpassIndex
         };
 
-        auto [result, vkPipelines] = device.createGraphicsPipelinesUnique(cache, {pipelineCI});
+        auto [result, vkPipelines] = device.createGraphicsPipelinesUnique(cache, {pipelineCI}, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Pipeline));
         return std::move(vkPipelines.front());
     }
 
@@ -117,7 +128,7 @@ namespace HAL {
             .pInitialData = std::data(cacheData)
         };
 
-        m_pVkPipelineCache = device.GetVkDevice().createPipelineCacheUnique(pipelineCacheCI);
+        m_pVkPipelineCache = device.GetVkDevice().createPipelineCacheUnique(pipelineCacheCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Pipeline));
         vkx::setDebugName(device.GetVkDevice(), *m_pVkPipelineCache, "");
     }
 
@@ -126,6 +137,8 @@ namespace HAL {
 
         vk::Pipeline result;
 
+        //Command lists may be recorded from several threads at once
+        std::lock_guard<std::mutex> lock(m_Mutex);
         ComputePipelineKey key = {.Stage = pImplPipeline->GetShaderModule(0).GetVkShadeModule()};
         if (auto it = m_ComputePipelineCache.find(key); it == m_ComputePipelineCache.end()) {
             auto vkPipeline = CreateComputePipeline(m_pVkPipelineCache.getOwner(), m_pVkPipelineCache.get(), pipeline, state);
@@ -136,4 +149,32 @@ namespace HAL {
         }
         return result;
     }
+
+    auto PipelineCache::GetGraphicsPipeline(GraphicsPipeline const& pipeline, vk::RenderPass renderPass, uint32_t subpassIndex, GraphicsState const& state) const -> vk::Pipeline {
+        auto pImplPipeline = reinterpret_cast<const Pipeline*>(&pipeline);
+
+        vk::Pipeline result;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        GraphicsPipelineKey key = {
+            .VertexStage = pImplPipeline->GetShaderModule(0).GetVkShadeModule(),
+            .PixelStage = pImplPipeline->GetShaderModule(1).GetVkShadeModule(),
+            .RenderPass = renderPass,
+            .SubpassIndex = subpassIndex,
+            .FillMode = state.RasterState.FillMode,
+            .CullMode = state.RasterState.CullMode,
+            .FrontFace = state.RasterState.FrontFace,
+            .DepthEnable = state.DepthStencilState.DepthEnable,
+            .DepthWrite = state.DepthStencilState.DepthWrite,
+            .DepthFunc = state.DepthStencilState.DepthFunc
+        };
+        if (auto it = m_GraphicsPipelineCache.find(key); it == m_GraphicsPipelineCache.end()) {
+            auto vkPipeline = CreateGraphicsPipeline(m_pVkPipelineCache.getOwner(), m_pVkPipelineCache.get(), pipeline, renderPass, subpassIndex, state);
+            result = vkPipeline.get();
+            m_GraphicsPipelineCache.emplace(key, std::move(vkPipeline));
+        } else {
+            result = it->second.get();
+        }
+        return result;
+    }
 }
\ No newline at end of file
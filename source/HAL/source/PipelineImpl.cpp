@@ -1,6 +1,7 @@
 #include "..\interface\HAL\Pipeline.hpp"
 #include "..\include\PipelineImpl.hpp"
 #include "..\include\DescriptorTableLayoutImpl.hpp"
+#include "..\include\HostAllocator.hpp"
 
 namespace HAL {
 
@@ -21,11 +22,19 @@ namespace HAL {
     }
 
     static auto CreatePipelineLayout(Device const& device, std::vector<vk::DescriptorSetLayout> descriptorSetLayouts) -> vk::UniquePipelineLayout {
+        vk::PushConstantRange pushConstantRange = {
+            .stageFlags = vk::ShaderStageFlagBits::eAll,
+            .offset = 0,
+            .size = MaxPushConstantSize
+        };
+
         vk::PipelineLayoutCreateInfo pipelineLayoutCI = {
             .setLayoutCount = static_cast<uint32_t>(std::size(descriptorSetLayouts)),
-            .pSetLayouts = std::data(descriptorSetLayouts)
+            .pSetLayouts = std::data(descriptorSetLayouts),
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = &pushConstantRange
         };
-        return device.GetVkDevice().createPipelineLayoutUnique(pipelineLayoutCI);
+        return device.GetVkDevice().createPipelineLayoutUnique(pipelineLayoutCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Pipeline));
     }
 
     static auto SeparateResources(ShaderModule::StagePipelineResources resources) -> std::vector<std::vector<PipelineResource>> { 
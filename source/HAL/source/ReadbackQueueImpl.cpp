@@ -0,0 +1,239 @@
+#include "../include/ReadbackQueueImpl.hpp"
+#include "../include/DeviceImpl.hpp"
+
+#include <HAL/Buffer.hpp>
+#include <HAL/CommandList.hpp>
+#include <HAL/Fence.hpp>
+
+namespace HAL {
+
+    ReadbackQueue::Internal::Internal(Device const& device, ReadbackQueueCreateInfo const& createInfo) {
+        vk::BufferCreateInfo bufferCI = {
+            .size = createInfo.RingSize,
+            .usage = vk::BufferUsageFlagBits::eTransferDst,
+            .sharingMode = vk::SharingMode::eExclusive
+        };
+
+        vma::AllocationCreateInfo allocationCI = {
+            .flags = vma::AllocationCreateFlagBits::eMapped,
+            .usage = vma::MemoryUsage::eGpuToCpu
+        };
+
+        auto pImplDevice = reinterpret_cast<const Device::Internal*>(&device);
+        auto const& limits = device.GetVkPhysicalDevice().getProperties().limits;
+
+        m_pState = std::make_unique<ReadbackState>();
+        m_pState->Device = device.GetVkDevice();
+        m_pState->Allocator = pImplDevice->GetVmaAllocator();
+        m_pState->Capacity = createInfo.RingSize;
+        m_pState->Alignment = std::max<uint64_t>(limits.nonCoherentAtomSize, 16);
+
+        vma::AllocationInfo allocationInfo = {};
+        std::tie(m_pState->pBuffer, m_pState->pAllocation) = pImplDevice->GetMemoryAllocator().CreateBuffer(bufferCI, allocationCI, MemoryFallbackPolicy::None, &allocationInfo);
+        vkx::setDebugName(device.GetVkDevice(), *m_pState->pBuffer, "ReadbackQueue");
+        m_pState->pMappedData = static_cast<uint8_t*>(allocationInfo.pMappedData);
+        m_pState->Watcher = std::thread(&Internal::WatcherLoop, m_pState.get());
+    }
+
+    ReadbackQueue::Internal& ReadbackQueue::Internal::operator=(Internal&& rhs) noexcept {
+        if (this != &rhs) {
+            this->Release();
+            m_pState = std::move(rhs.m_pState);
+            m_Requests = std::move(rhs.m_Requests);
+        }
+        return *this;
+    }
+
+    ReadbackQueue::Internal::~Internal() {
+        this->Release();
+    }
+
+    auto ReadbackQueue::Internal::ReadBuffer(ComputeCommandList& cmdList, Buffer const& buffer, uint64_t offset, uint64_t size, ReadbackCallback&& callback) -> bool {
+        assert(offset + size <= buffer.GetSize());
+
+        auto allocation = this->AllocateRing(size);
+        if (!allocation) {
+            fmt::print("Warning: ReadbackQueue ring is full, read of {} bytes skipped \n", size);
+            return false;
+        }
+
+        auto [ringOffset, allocatedSize] = *allocation;
+
+        //The source goes through the tracked state, so later transitions of the command list see the copy read it
+        cmdList.TransitionBuffer(buffer, ResourceState::CopySource);
+        cmdList.FlushBarriers();
+        auto cmdBuffer = cmdList.GetVkCommandBuffer();
+
+        vk::BufferCopy region = {
+            .srcOffset = buffer.GetOffset() + offset,
+            .dstOffset = ringOffset,
+            .size = size
+        };
+        cmdBuffer.copyBuffer(buffer.GetVkBuffer(), *m_pState->pBuffer, region);
+
+        //The ring is not a tracked resource and host reads are outside the tracked states, so this barrier stays raw
+        vk::BufferMemoryBarrier hostBarrier = {
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eHostRead,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = *m_pState->pBuffer,
+            .offset = ringOffset,
+            .size = size
+        };
+        cmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, {}, hostBarrier, {});
+
+        m_Requests.push_back(ReadbackRequest{
+            .Offset = ringOffset,
+            .Size = size,
+            .AllocatedSize = allocatedSize,
+            .Callback = std::move(callback)
+        });
+        return true;
+    }
+
+    auto ReadbackQueue::Internal::Commit(Fence const& fence, uint64_t value) -> void {
+        if (m_Requests.empty())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_pState->Mutex);
+            m_pState->Batches.push_back(ReadbackBatch{
+                .Semaphore = fence.GetVkSemaphore(),
+                .FenceValue = value,
+                .Requests = std::move(m_Requests)
+            });
+        }
+        m_pState->Condition.notify_one();
+        m_Requests.clear();
+    }
+
+    auto ReadbackQueue::Internal::GetPendingCount() const -> uint32_t {
+        std::lock_guard<std::mutex> lock(m_pState->Mutex);
+
+        size_t count = std::size(m_Requests);
+        for (auto const& batch : m_pState->Batches)
+            count += std::size(batch.Requests);
+        return static_cast<uint32_t>(count);
+    }
+
+    auto ReadbackQueue::Internal::AllocateRing(uint64_t size) -> std::optional<std::pair<uint64_t, uint64_t>> {
+        auto& state = *m_pState;
+        uint64_t alignedSize = (std::max<uint64_t>(size, 1) + state.Alignment - 1) / state.Alignment * state.Alignment;
+
+        std::lock_guard<std::mutex> lock(state.Mutex);
+        if (state.UsedSize == 0)
+            state.Head = 0;
+
+        //Live data occupies [tail, head) modulo capacity; a read never straddles the end, the skipped bytes are charged to it
+        uint64_t tail = (state.Head + state.Capacity - state.UsedSize) % state.Capacity;
+        bool isWrapped = state.UsedSize != 0 && state.Head <= tail;
+
+        uint64_t offset = state.Head;
+        uint64_t padding = 0;
+        if (isWrapped) {
+            if (offset + alignedSize > tail)
+                return std::nullopt;
+        } else if (offset + alignedSize > state.Capacity) {
+            padding = state.Capacity - offset;
+            offset = 0;
+            if (alignedSize > tail)
+                return std::nullopt;
+        }
+
+        state.Head = (offset + alignedSize) % state.Capacity;
+        state.UsedSize += padding + alignedSize;
+        return std::make_pair(offset, padding + alignedSize);
+    }
+
+    auto ReadbackQueue::Internal::Release() -> void {
+        if (!m_pState)
+            return;
+
+        if (!m_Requests.empty())
+            fmt::print("Warning: ReadbackQueue destroyed with {} uncommitted reads \n", std::size(m_Requests));
+
+        //The watcher drains the committed batches before it exits, so the GPU never writes into a freed ring. Batches that
+        //are still pending after a wait timeout are abandoned, the owner must have finished the GPU work by then
+        {
+            std::lock_guard<std::mutex> lock(m_pState->Mutex);
+            m_pState->IsStopping = true;
+        }
+        m_pState->Condition.notify_one();
+        m_pState->Watcher.join();
+        m_pState.reset();
+        m_Requests.clear();
+    }
+
+    auto ReadbackQueue::Internal::WatcherLoop(ReadbackState* pState) -> void {
+        constexpr uint64_t WaitTimeout = 100'000'000;
+
+        while (true) {
+            ReadbackBatch* pBatch = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(pState->Mutex);
+                pState->Condition.wait(lock, [&] { return pState->IsStopping || !pState->Batches.empty(); });
+                if (pState->Batches.empty())
+                    return;
+                pBatch = &pState->Batches.front();
+            }
+
+            //Only the watcher removes batches and deque push_back keeps references, so the front stays valid unlocked
+            vk::SemaphoreWaitInfo waitInfo = {
+                .semaphoreCount = 1,
+                .pSemaphores = &pBatch->Semaphore,
+                .pValues = &pBatch->FenceValue
+            };
+            //The pointer overload reports a lost device as a result instead of throwing on the watcher thread
+            auto result = pState->Device.waitSemaphores(&waitInfo, WaitTimeout);
+            if (result == vk::Result::eTimeout) {
+                //A value that is never signaled must not hang the shutdown, so stopping abandons the remaining batches
+                std::lock_guard<std::mutex> lock(pState->Mutex);
+                if (!pState->IsStopping)
+                    continue;
+                fmt::print("Warning: ReadbackQueue stopped with {} batches still pending \n", std::size(pState->Batches));
+                return;
+            }
+
+            if (result != vk::Result::eSuccess) {
+                fmt::print("Error: ReadbackQueue failed to wait for a batch: {} \n", vk::to_string(result));
+                return;
+            }
+
+            uint64_t releaseSize = 0;
+            for (auto const& request : pBatch->Requests) {
+                pState->Allocator.invalidateAllocation(*pState->pAllocation, request.Offset, request.Size);
+                if (request.Callback)
+                    request.Callback(std::span<const uint8_t>(pState->pMappedData + request.Offset, request.Size));
+                releaseSize += request.AllocatedSize;
+            }
+
+            std::lock_guard<std::mutex> lock(pState->Mutex);
+            pState->UsedSize -= releaseSize;
+            pState->Batches.erase(pState->Batches.begin());
+        }
+    }
+}
+
+namespace HAL {
+
+    ReadbackQueue::ReadbackQueue(Device const& device, ReadbackQueueCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    ReadbackQueue::ReadbackQueue(ReadbackQueue&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    ReadbackQueue& ReadbackQueue::operator=(ReadbackQueue&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    ReadbackQueue::~ReadbackQueue() = default;
+
+    auto ReadbackQueue::ReadBuffer(ComputeCommandList& cmdList, Buffer const& buffer, uint64_t offset, uint64_t size, ReadbackCallback&& callback) -> bool {
+        return m_pInternal->ReadBuffer(cmdList, buffer, offset, size, std::move(callback));
+    }
+
+    auto ReadbackQueue::Commit(Fence const& fence, uint64_t value) -> void {
+        m_pInternal->Commit(fence, value);
+    }
+
+    auto ReadbackQueue::GetPendingCount() const -> uint32_t {
+        return m_pInternal->GetPendingCount();
+    }
+}
@@ -0,0 +1,63 @@
+#include "../include/ReleaseQueue.hpp"
+
+namespace HAL {
+
+    ReleaseQueue::ReleaseQueue(vk::Device device) : m_Device(device) {}
+
+    //The device drains its queues before the release queue is destroyed; waiting here would race the submit threads
+    ReleaseQueue::~ReleaseQueue() {
+        this->Flush();
+    }
+
+    auto ReleaseQueue::Enqueue(vk::Semaphore semaphore, uint64_t value, std::function<void()>&& release) -> void {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Entries.push_back(ReleaseEntry{.Semaphore = semaphore, .Value = value, .Release = std::move(release)});
+    }
+
+    auto ReleaseQueue::Poll() -> void {
+        std::vector<ReleaseEntry> completed;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_Entries.empty())
+                return;
+
+            //Query each timeline once per poll
+            std::vector<std::pair<vk::Semaphore, uint64_t>> completedValues;
+            auto GetCompletedValue = [&](vk::Semaphore semaphore) -> uint64_t {
+                for (auto const& [key, value] : completedValues) {
+                    if (key == semaphore)
+                        return value;
+                }
+                auto value = m_Device.getSemaphoreCounterValue(semaphore);
+                completedValues.emplace_back(semaphore, value);
+                return value;
+            };
+
+            auto iterator = std::stable_partition(std::begin(m_Entries), std::end(m_Entries), [&](ReleaseEntry const& entry) -> bool {
+                return GetCompletedValue(entry.Semaphore) < entry.Value;
+            });
+            std::move(iterator, std::end(m_Entries), std::back_inserter(completed));
+            m_Entries.erase(iterator, std::end(m_Entries));
+        }
+
+        //Release outside of the lock, a deleter may enqueue new entries
+        for (auto& entry : completed)
+            entry.Release();
+    }
+
+    auto ReleaseQueue::Flush() -> void {
+        for (;;) {
+            std::vector<ReleaseEntry> entries;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                entries.swap(m_Entries);
+            }
+
+            if (entries.empty())
+                break;
+
+            for (auto& entry : entries)
+                entry.Release();
+        }
+    }
+}
@@ -1,16 +1,17 @@
 #include "../include/RenderPassImpl.hpp"
 #include "../include/DeviceImpl.hpp"
 #include "../include/CommandListImpl.hpp"
+#include "../include/HostAllocator.hpp"
 
 namespace HAL {
 
     RenderPass::Internal::Internal(Device const& device, vk::RenderPassCreateInfo const& createInfo) {
-        m_pRenderPass = device.GetVkDevice().createRenderPassUnique(createInfo);
+        m_pRenderPass = device.GetVkDevice().createRenderPassUnique(createInfo, HostAllocator::GetAllocationCallbacks(HostMemoryTag::RenderPass));
         for (size_t index = 0; index < createInfo.attachmentCount; index++)
             m_AttachmentsFormat.push_back(createInfo.pAttachments[index].format);
     }
 
-    auto RenderPass::Internal::GenerateFrameBufferAndCommit(vk::CommandBuffer cmdBuffer, RenderPassBeginInfo const& beginInfo) -> void {
+    auto RenderPass::Internal::GenerateFrameBufferAndCommit(vk::CommandBuffer cmdBuffer, RenderPassBeginInfo const& beginInfo) -> vk::Framebuffer {
 
         std::vector<vk::FramebufferAttachmentImageInfo> frameBufferAttanchments;
         std::vector<vk::ImageView>  frameBufferImageViews;
@@ -61,7 +62,7 @@ namespace HAL {
                     .pAttachmentImageInfos = std::data(key.Attachments)
                 }
             };
-            auto pFrameBuffer = m_pRenderPass.getOwner().createFramebufferUnique(framebufferCI.get<vk::FramebufferCreateInfo>());
+            auto pFrameBuffer = m_pRenderPass.getOwner().createFramebufferUnique(framebufferCI.get<vk::FramebufferCreateInfo>(), HostAllocator::GetAllocationCallbacks(HostMemoryTag::RenderPass));
             frameBuffer = pFrameBuffer.get();
             m_FrameBufferCache.emplace(key, std::move(pFrameBuffer));
         } else {
@@ -81,7 +82,8 @@ namespace HAL {
                 .pAttachments = std::data(frameBufferImageViews)
             }
         };
-        cmdBuffer.beginRenderPass(renderPassBeginInfo.get<vk::RenderPassBeginInfo>(), vk::SubpassContents::eInline);
+        cmdBuffer.beginRenderPass(renderPassBeginInfo.get<vk::RenderPassBeginInfo>(), beginInfo.Contents);
+        return frameBuffer;
     }
 }
 
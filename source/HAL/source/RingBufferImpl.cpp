@@ -0,0 +1,118 @@
+#include "../include/RingBufferImpl.hpp"
+#include "../include/DeviceImpl.hpp"
+#include "../include/FenceImpl.hpp"
+#include "../include/MemoryPoolImpl.hpp"
+
+namespace HAL {
+
+    RingBuffer::Internal::Internal(Device const& device, RingBufferCreateInfo const& createInfo) {
+        assert(createInfo.SegmentCount > 0);
+
+        vk::BufferCreateInfo bufferCI = {
+            .size = createInfo.SegmentSize * createInfo.SegmentCount,
+            .usage = vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+            .sharingMode = vk::SharingMode::eExclusive
+        };
+
+        vma::AllocationCreateInfo allocationCI = {
+            .flags = vma::AllocationCreateFlagBits::eMapped,
+            .usage = vma::MemoryUsage::eCpuToGpu,
+            .requiredFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+            .pool = createInfo.pMemoryPool ? createInfo.pMemoryPool->GetVmaPool() : vma::Pool{}
+        };
+
+        m_SegmentOffset = 0;
+        m_SegmentIndex = 0;
+        m_SegmentCount = createInfo.SegmentCount;
+        m_Segments.resize(createInfo.SegmentCount);
+
+        //Without a buffer the segments stay empty, so every allocation fails instead of writing through a null mapping
+        vma::AllocationInfo allocationInfo = {};
+        std::tie(m_pBuffer, m_pAllocation) = reinterpret_cast<const Device::Internal*>(&device)->GetMemoryAllocator().CreateBuffer(bufferCI, allocationCI, MemoryFallbackPolicy::None, &allocationInfo);
+        if (!m_pBuffer || !allocationInfo.pMappedData) {
+            fmt::print("Error: RingBuffer failed to allocate {} bytes \n", bufferCI.size);
+            assert(false);
+            return;
+        }
+        vkx::setDebugName(device.GetVkDevice(), *m_pBuffer, "RingBuffer");
+
+        m_pMappedData = static_cast<uint8_t*>(allocationInfo.pMappedData);
+        m_SegmentSize = createInfo.SegmentSize;
+    }
+
+    auto RingBuffer::Internal::Allocate(uint64_t size, uint64_t alignment) -> std::optional<RingBufferAllocation> {
+        alignment = std::max<uint64_t>(alignment, 1);
+
+        //The segment size need not be a multiple of the alignment, so the offset is aligned within the whole buffer
+        uint64_t segmentBase = m_SegmentIndex * m_SegmentSize;
+        uint64_t offset = (segmentBase + m_SegmentOffset + alignment - 1) / alignment * alignment - segmentBase;
+        if (offset + size > m_SegmentSize) {
+            fmt::print("Warning: RingBuffer segment overflow, requested {} bytes, available {} bytes \n", size, m_SegmentSize - std::min(offset, m_SegmentSize));
+            return std::nullopt;
+        }
+        m_SegmentOffset = offset + size;
+
+        uint64_t bufferOffset = segmentBase + offset;
+        return RingBufferAllocation{
+            .Buffer = *m_pBuffer,
+            .Offset = bufferOffset,
+            .Size = size,
+            .pData = m_pMappedData + bufferOffset
+        };
+    }
+
+    auto RingBuffer::Internal::Push(void const* pData, uint64_t size, uint64_t alignment) -> std::optional<RingBufferAllocation> {
+        auto allocation = this->Allocate(size, alignment);
+        if (allocation)
+            std::memcpy(allocation->pData, pData, size);
+        return allocation;
+    }
+
+    auto RingBuffer::Internal::NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void {
+        m_Segments[m_SegmentIndex] = Segment{
+            .Semaphore = fence.GetVkSemaphore(),
+            .FenceValue = value.value_or(fence.GetExpectedValue())
+        };
+
+        m_SegmentIndex = (m_SegmentIndex + 1) % m_SegmentCount;
+        m_SegmentOffset = 0;
+
+        auto const& segment = m_Segments[m_SegmentIndex];
+        if (segment.Semaphore) {
+            vk::SemaphoreWaitInfo waitInfo = {
+                .semaphoreCount = 1,
+                .pSemaphores = &segment.Semaphore,
+                .pValues = &segment.FenceValue,
+            };
+            auto result = m_pBuffer.getOwner().waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
+            assert(result == vk::Result::eSuccess);
+        }
+    }
+}
+
+namespace HAL {
+
+    RingBuffer::RingBuffer(Device const& device, RingBufferCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    RingBuffer::RingBuffer(RingBuffer&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    RingBuffer& RingBuffer::operator=(RingBuffer&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    RingBuffer::~RingBuffer() = default;
+
+    auto RingBuffer::Allocate(uint64_t size, uint64_t alignment) -> std::optional<RingBufferAllocation> {
+        return m_pInternal->Allocate(size, alignment);
+    }
+
+    auto RingBuffer::Push(void const* pData, uint64_t size, uint64_t alignment) -> std::optional<RingBufferAllocation> {
+        return m_pInternal->Push(pData, size, alignment);
+    }
+
+    auto RingBuffer::NextFrame(Fence const& fence, std::optional<uint64_t> value) -> void {
+        m_pInternal->NextFrame(fence, value);
+    }
+
+    auto RingBuffer::GetVkBuffer() const -> vk::Buffer {
+        return m_pInternal->GetVkBuffer();
+    }
+}
@@ -1,5 +1,6 @@
 #include "../include/ShaderModule.hpp"
 #include "../include/DeviceImpl.hpp"
+#include "../include/HostAllocator.hpp"
 
 namespace HAL {
 
@@ -8,7 +9,7 @@ namespace HAL {
         m_EntryPoint = compiler.get_entry_points_and_stages()[0].name;
         m_ShaderStage = *GetVkShaderStage(compiler.get_execution_model());
         m_DescriptorsSets = this->ReflectPipelineResources(compiler);
-        m_pShaderModule = device.GetVkDevice().createShaderModuleUnique({.codeSize = static_cast<uint32_t>(code.Size), .pCode = reinterpret_cast<uint32_t*>(code.pData)});
+        m_pShaderModule = device.GetVkDevice().createShaderModuleUnique({.codeSize = static_cast<uint32_t>(code.Size), .pCode = reinterpret_cast<uint32_t*>(code.pData)}, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Pipeline));
     }
 
     auto ShaderModule::GetVkShaderStage(spv::ExecutionModel executionModel) const -> std::optional<vk::ShaderStageFlagBits> {
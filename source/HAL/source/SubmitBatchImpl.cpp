@@ -0,0 +1,108 @@
+#include "../include/SubmitBatchImpl.hpp"
+#include "../include/SwapChainImpl.hpp"
+#include "../include/CommandListImpl.hpp"
+
+#include <HAL/CommandList.hpp>
+#include <HAL/Fence.hpp>
+
+namespace HAL {
+
+    auto SubmitBatch::Internal::Wait(vk::Semaphore semaphore, uint64_t value, vk::PipelineStageFlags2KHR stages) -> void {
+        //Waits are applied before the first command buffer of a submission, so one after work needs a new submission
+        if (m_Submissions.empty() || !m_Submissions.back().CommandBuffers.empty() || !m_Submissions.back().SignalSemaphores.empty())
+            m_Submissions.emplace_back();
+
+        auto& submission = m_Submissions.back();
+        submission.WaitSemaphores.push_back(semaphore);
+        submission.WaitValues.push_back(value);
+        submission.WaitStages.push_back(stages);
+    }
+
+    auto SubmitBatch::Internal::Execute(CommandList const& cmdList) -> void {
+        //Signals fire after the last command buffer of a submission, so work after a signal needs a new submission
+        if (m_Submissions.empty() || !m_Submissions.back().SignalSemaphores.empty())
+            m_Submissions.emplace_back();
+        m_Submissions.back().CommandBuffers.push_back(cmdList.GetVkCommandBuffer());
+        m_Submissions.back().CommandLists.push_back(&cmdList);
+    }
+
+    auto SubmitBatch::Internal::Signal(vk::Semaphore semaphore, uint64_t value) -> void {
+        if (m_Submissions.empty())
+            m_Submissions.emplace_back();
+
+        auto& submission = m_Submissions.back();
+        submission.SignalSemaphores.push_back(semaphore);
+        submission.SignalValues.push_back(value);
+    }
+
+    auto SubmitBatch::Internal::Present(SwapChain const& swapChain, uint32_t frameID) -> void {
+        assert(!m_pPresentSwapChain);
+        m_pPresentSwapChain = &swapChain;
+        m_PresentFrameID = frameID;
+    }
+
+    auto SubmitBatch::Internal::Reset() -> void {
+        m_Submissions.clear();
+        m_pPresentSwapChain = nullptr;
+        m_PresentFrameID = 0;
+    }
+}
+
+namespace HAL {
+
+    SubmitBatch::SubmitBatch() : m_pInternal() {}
+
+    SubmitBatch::SubmitBatch(SubmitBatch&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    SubmitBatch& SubmitBatch::operator=(SubmitBatch&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    SubmitBatch::~SubmitBatch() = default;
+
+    auto SubmitBatch::Wait(Fence const& fence, std::optional<uint64_t> value, vk::PipelineStageFlags stages) -> SubmitBatch& {
+        return this->Wait(fence, value, ToPipelineStageFlags2(stages));
+    }
+
+    auto SubmitBatch::Wait(Fence const& fence, std::optional<uint64_t> value, vk::PipelineStageFlags2KHR stages) -> SubmitBatch& {
+        m_pInternal->Wait(fence.GetVkSemaphore(), value.value_or(fence.GetExpectedValue()), stages);
+        return *this;
+    }
+
+    auto SubmitBatch::WaitImage(SwapChain const& swapChain, vk::PipelineStageFlags stages) -> SubmitBatch& {
+        return this->WaitImage(swapChain, ToPipelineStageFlags2(stages));
+    }
+
+    auto SubmitBatch::WaitImage(SwapChain const& swapChain, vk::PipelineStageFlags2KHR stages) -> SubmitBatch& {
+        auto pSwapChain = reinterpret_cast<const SwapChain::Internal*>(&swapChain);
+        m_pInternal->Wait(pSwapChain->GetSemaphoreAvailable(), 0, stages);
+        return *this;
+    }
+
+    auto SubmitBatch::Execute(CommandList const& cmdList) -> SubmitBatch& {
+        m_pInternal->Execute(cmdList);
+        return *this;
+    }
+
+    auto SubmitBatch::Execute(ArraySpan<CommandList> cmdLists) -> SubmitBatch& {
+        for (auto const& cmdList : cmdLists)
+            m_pInternal->Execute(cmdList.get());
+        return *this;
+    }
+
+    auto SubmitBatch::Signal(Fence const& fence, std::optional<uint64_t> value) -> SubmitBatch& {
+        m_pInternal->Signal(fence.GetVkSemaphore(), value.value_or(fence.GetExpectedValue()));
+        return *this;
+    }
+
+    auto SubmitBatch::Present(SwapChain const& swapChain, uint32_t frameID) -> SubmitBatch& {
+        m_pInternal->Present(swapChain, frameID);
+        return *this;
+    }
+
+    auto SubmitBatch::Reset() -> void {
+        m_pInternal->Reset();
+    }
+
+    auto SubmitBatch::IsEmpty() const -> bool {
+        return m_pInternal->IsEmpty();
+    }
+}
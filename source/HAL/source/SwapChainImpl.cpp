@@ -3,6 +3,7 @@
 #include "../include/DeviceImpl.hpp"
 #include "../include/FenceImpl.hpp"
 #include "../include/CommandQueueImpl.hpp"
+#include "../include/HostAllocator.hpp"
 
 
 namespace HAL {
@@ -34,7 +35,7 @@ namespace HAL {
 
         auto pDeviceImpl = reinterpret_cast<const Device::Internal*>(&device);
 
-        m_pSurface = reinterpret_cast<const Instance::Internal*>(&instance)->GetVkInstance().createWin32SurfaceKHRUnique(surfaceCI);
+        m_pSurface = reinterpret_cast<const Instance::Internal*>(&instance)->GetVkInstance().createWin32SurfaceKHRUnique(surfaceCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::SwapChain));
         vkx::setDebugName(pDeviceImpl->GetVkDevice(), *m_pSurface, "Win32SurfaceKHR");
 
         if (m_PhysicalDevice.getSurfaceSupportKHR(pDeviceImpl->GetGraphicsQueueFamilyIndex(), *m_pSurface))
@@ -136,7 +137,7 @@ namespace HAL {
               .clipped = true
         };
 
-        m_pSwapChain = device.createSwapchainKHRUnique(swapchainCI);
+        m_pSwapChain = device.createSwapchainKHRUnique(swapchainCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::SwapChain));
         vkx::setDebugName(device, *m_pSwapChain, fmt::format("Format: {} PresentMode: {} Width: {} Height: {}", vk::to_string(swapchainCI.imageFormat), vk::to_string(swapchainCI.presentMode), width, height));
 
         m_SwapChainImages = device.getSwapchainImagesKHR(*m_pSwapChain);
@@ -153,7 +154,7 @@ namespace HAL {
                     .layerCount = VK_REMAINING_ARRAY_LAYERS
             }
             };
-            auto pImageView = device.createImageViewUnique(imageViewCI);
+            auto pImageView = device.createImageViewUnique(imageViewCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::SwapChain));
             vkx::setDebugName(device, m_SwapChainImages[index], fmt::format("SwapChain[{0}]", index));
             vkx::setDebugName(device, *pImageView, fmt::format("SwapChain[{0}]", index));
             m_SwapChainImageViews.push_back(std::move(pImageView));
@@ -162,8 +163,8 @@ namespace HAL {
 
     auto SwapChain::Internal::CreateSyncPrimitives(vk::Device device) -> void {
         for (uint32_t index = 0; index < m_BufferCount; index++) {
-            auto pSemaphoresAvailable = device.createSemaphoreUnique(vk::SemaphoreCreateInfo{});
-            auto pSemaphoresFinished = device.createSemaphoreUnique(vk::SemaphoreCreateInfo{});
+            auto pSemaphoresAvailable = device.createSemaphoreUnique(vk::SemaphoreCreateInfo{}, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Synchronization));
+            auto pSemaphoresFinished = device.createSemaphoreUnique(vk::SemaphoreCreateInfo{}, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Synchronization));
 
             vkx::setDebugName(device, *pSemaphoresAvailable, fmt::format("SwapChain Available[{}]", index));
             vkx::setDebugName(device, *pSemaphoresFinished, fmt::format("SwapChain Finished[{}]", index));
@@ -0,0 +1,157 @@
+#include <Windows.h>
+#include "../include/TextureContainerImpl.hpp"
+
+namespace HAL {
+
+    TextureContainer::Internal::Internal(std::filesystem::path const& path) {
+        m_hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (m_hFile == INVALID_HANDLE_VALUE) {
+            m_hFile = nullptr;
+            fmt::print("Error: Failed to open texture container {} \n", path.string());
+            return;
+        }
+
+        LARGE_INTEGER fileSize = {};
+        GetFileSizeEx(m_hFile, &fileSize);
+        m_Size = static_cast<uint64_t>(fileSize.QuadPart);
+
+        m_hMapping = CreateFileMappingW(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_hMapping)
+            m_pData = static_cast<uint8_t const*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+
+        if (!m_pData || !this->Validate()) {
+            fmt::print("Error: Invalid texture container {} \n", path.string());
+            this->Release();
+        }
+    }
+
+    TextureContainer::Internal::Internal(Internal&& rhs) noexcept {
+        m_hFile = std::exchange(rhs.m_hFile, nullptr);
+        m_hMapping = std::exchange(rhs.m_hMapping, nullptr);
+        m_pData = std::exchange(rhs.m_pData, nullptr);
+        m_Size = std::exchange(rhs.m_Size, 0);
+    }
+
+    TextureContainer::Internal& TextureContainer::Internal::operator=(Internal&& rhs) noexcept {
+        if (this != &rhs) {
+            this->Release();
+            m_hFile = std::exchange(rhs.m_hFile, nullptr);
+            m_hMapping = std::exchange(rhs.m_hMapping, nullptr);
+            m_pData = std::exchange(rhs.m_pData, nullptr);
+            m_Size = std::exchange(rhs.m_Size, 0);
+        }
+        return *this;
+    }
+
+    TextureContainer::Internal::~Internal() {
+        this->Release();
+    }
+
+    auto TextureContainer::Internal::GetTextureCreateInfo() const -> TextureCreateInfo {
+        auto const& header = this->GetHeader();
+        return TextureCreateInfo{
+            .Type = static_cast<vk::ImageType>(header.Type),
+            .Format = static_cast<vk::Format>(header.Format),
+            .Width = header.Width,
+            .Height = header.Height,
+            .Depth = header.Depth,
+            .ArraySize = header.ArraySize,
+            .MipLevels = header.MipLevels
+        };
+    }
+
+    auto TextureContainer::Internal::GetSubresourceData(uint32_t mipLevel, uint32_t arrayLayer) const -> std::span<const uint8_t> {
+        auto const& header = this->GetHeader();
+        assert(mipLevel < header.MipLevels && arrayLayer < header.ArraySize);
+
+        auto pSubresources = reinterpret_cast<TextureContainerSubresource const*>(m_pData + sizeof(TextureContainerHeader));
+        auto const& subresource = pSubresources[mipLevel * header.ArraySize + arrayLayer];
+        return std::span<const uint8_t>(m_pData + subresource.Offset, subresource.Size);
+    }
+
+    auto TextureContainer::Internal::GetMipWriter() const -> TextureMipWriter {
+        //Captures the mapped view rather than this object, which moves with its owner
+        return [pData = m_pData](uint32_t mipLevel, uint32_t arrayLayer, std::span<uint8_t> data) -> void {
+            auto const& header = *reinterpret_cast<TextureContainerHeader const*>(pData);
+            auto pSubresources = reinterpret_cast<TextureContainerSubresource const*>(pData + sizeof(TextureContainerHeader));
+            auto const& subresource = pSubresources[mipLevel * header.ArraySize + arrayLayer];
+            assert(subresource.Size == std::size(data));
+            std::memcpy(std::data(data), pData + subresource.Offset, std::size(data));
+        };
+    }
+
+    auto TextureContainer::Internal::Validate() const -> bool {
+        if (m_Size < sizeof(TextureContainerHeader))
+            return false;
+
+        auto const& header = this->GetHeader();
+        if (header.Magic != TextureContainerHeader::MagicValue || header.Version != TextureContainerHeader::VersionValue)
+            return false;
+        if (header.MipLevels == 0 || header.ArraySize == 0 || header.DataOffset + header.DataSize > m_Size)
+            return false;
+
+        uint64_t subresourceCount = uint64_t(header.MipLevels) * header.ArraySize;
+        if (sizeof(TextureContainerHeader) + subresourceCount * sizeof(TextureContainerSubresource) > header.DataOffset)
+            return false;
+
+        //Every subresource must hold exactly the tightly packed texel blocks a copyBufferToImage with zero row length expects
+        auto blockInfo = vkx::getFormatBlockInfo(static_cast<vk::Format>(header.Format));
+        if (blockInfo.size == 0)
+            return false;
+
+        auto pSubresources = reinterpret_cast<TextureContainerSubresource const*>(m_pData + sizeof(TextureContainerHeader));
+        for (uint32_t mipLevel = 0; mipLevel < header.MipLevels; mipLevel++) {
+            uint64_t blockCountX = (std::max(header.Width >> mipLevel, 1u) + blockInfo.width - 1) / blockInfo.width;
+            uint64_t blockCountY = (std::max(header.Height >> mipLevel, 1u) + blockInfo.height - 1) / blockInfo.height;
+            uint64_t size = blockCountX * blockCountY * std::max(header.Depth >> mipLevel, 1u) * blockInfo.size;
+
+            for (uint32_t arrayLayer = 0; arrayLayer < header.ArraySize; arrayLayer++) {
+                auto const& subresource = pSubresources[mipLevel * header.ArraySize + arrayLayer];
+                if (subresource.Size != size || subresource.Offset < header.DataOffset || subresource.Offset + subresource.Size > header.DataOffset + header.DataSize)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    auto TextureContainer::Internal::Release() -> void {
+        if (m_pData)
+            UnmapViewOfFile(m_pData);
+        if (m_hMapping)
+            CloseHandle(m_hMapping);
+        if (m_hFile)
+            CloseHandle(m_hFile);
+
+        m_pData = nullptr;
+        m_hMapping = nullptr;
+        m_hFile = nullptr;
+        m_Size = 0;
+    }
+}
+
+namespace HAL {
+
+    TextureContainer::TextureContainer(std::filesystem::path const& path) : m_pInternal(path) {}
+
+    TextureContainer::TextureContainer(TextureContainer&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    TextureContainer& TextureContainer::operator=(TextureContainer&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    TextureContainer::~TextureContainer() = default;
+
+    auto TextureContainer::IsValid() const -> bool {
+        return m_pInternal->IsValid();
+    }
+
+    auto TextureContainer::GetTextureCreateInfo() const -> TextureCreateInfo {
+        return m_pInternal->GetTextureCreateInfo();
+    }
+
+    auto TextureContainer::GetSubresourceData(uint32_t mipLevel, uint32_t arrayLayer) const -> std::span<const uint8_t> {
+        return m_pInternal->GetSubresourceData(mipLevel, arrayLayer);
+    }
+
+    auto TextureContainer::GetMipWriter() const -> TextureMipWriter {
+        return m_pInternal->GetMipWriter();
+    }
+}
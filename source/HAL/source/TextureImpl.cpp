@@ -0,0 +1,100 @@
+#include "../include/TextureImpl.hpp"
+#include "../include/DeviceImpl.hpp"
+#include "../include/HostAllocator.hpp"
+
+namespace HAL {
+
+    Texture::Internal::Internal(Device const& device, TextureCreateInfo const& createInfo) {
+        assert(createInfo.MipLevels > 0 && createInfo.ArraySize > 0);
+
+        vk::ImageCreateInfo imageCI = {
+            .imageType = createInfo.Type,
+            .format = createInfo.Format,
+            .extent = vk::Extent3D{createInfo.Width, createInfo.Height, createInfo.Depth},
+            .mipLevels = createInfo.MipLevels,
+            .arrayLayers = createInfo.ArraySize,
+            .samples = vk::SampleCountFlagBits::e1,
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = createInfo.Usage,
+            .sharingMode = vk::SharingMode::eExclusive,
+            .initialLayout = vk::ImageLayout::eUndefined
+        };
+
+        vma::AllocationCreateInfo allocationCI = {
+            .usage = vma::MemoryUsage::eGpuOnly
+        };
+
+        m_CreateInfo = createInfo;
+        m_ResidentMipLevel = createInfo.MipLevels;
+
+        std::tie(m_pImage, m_pAllocation) = reinterpret_cast<const Device::Internal*>(&device)->GetMemoryAllocator().CreateImage(imageCI, allocationCI, MemoryFallbackPolicy::HostMemory);
+        assert(m_pImage);
+    }
+
+    TextureView::Internal::Internal(Device const& device, Texture const& texture, TextureViewCreateInfo const& createInfo) {
+        auto const& textureCI = texture.GetCreateInfo();
+        auto format = createInfo.Format != vk::Format::eUndefined ? createInfo.Format : textureCI.Format;
+
+        vk::ImageViewCreateInfo imageViewCI = {
+            .image = texture.GetVkImage(),
+            .viewType = createInfo.ViewType,
+            .format = format,
+            .subresourceRange = {
+                .aspectMask = vkx::getImageAspectFlags(format),
+                .baseMipLevel = createInfo.BaseMipLevel,
+                .levelCount = createInfo.MipLevelCount,
+                .baseArrayLayer = createInfo.BaseArrayLayer,
+                .layerCount = createInfo.ArrayLayerCount
+            }
+        };
+
+        m_CreateInfo = createInfo;
+        m_pImageView = device.GetVkDevice().createImageViewUnique(imageViewCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Resource));
+    }
+}
+
+namespace HAL {
+
+    Texture::Texture(Device const& device, TextureCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    Texture::Texture(Texture&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    Texture& Texture::operator=(Texture&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    Texture::~Texture() = default;
+
+    auto Texture::GetCreateInfo() const -> TextureCreateInfo const& {
+        return m_pInternal->GetCreateInfo();
+    }
+
+    auto Texture::GetVkImage() const -> vk::Image {
+        return m_pInternal->GetVkImage();
+    }
+
+    auto Texture::GetResidentMipLevel() const -> uint32_t {
+        return m_pInternal->GetResidentMipLevel();
+    }
+
+    TextureView::TextureView(Device const& device, Texture const& texture, TextureViewCreateInfo const& createInfo) : m_pInternal(device, texture, createInfo) {}
+
+    TextureView::TextureView(TextureView&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    TextureView& TextureView::operator=(TextureView&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    TextureView::~TextureView() = default;
+
+    auto TextureView::GetCreateInfo() const -> TextureViewCreateInfo const& {
+        return m_pInternal->GetCreateInfo();
+    }
+
+    auto TextureView::GetVkImageView() const -> vk::ImageView {
+        return m_pInternal->GetVkImageView();
+    }
+
+    auto TextureView::GetDescriptorImageInfo() const -> vk::DescriptorImageInfo {
+        return vk::DescriptorImageInfo{
+            .imageView = m_pInternal->GetVkImageView(),
+            .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
+        };
+    }
+}
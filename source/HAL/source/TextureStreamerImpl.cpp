@@ -0,0 +1,332 @@
+#include "../include/TextureStreamerImpl.hpp"
+#include "../include/TextureImpl.hpp"
+#include "../include/CommandListImpl.hpp"
+#include "../include/DeviceImpl.hpp"
+
+namespace HAL {
+
+    TextureStreamer::Internal::Internal(Device const& device, TextureStreamerCreateInfo const& createInfo)
+        : m_StagingBuffer(device, RingBufferCreateInfo{.SegmentSize = createInfo.StagingSegmentSize, .SegmentCount = createInfo.StagingSegmentCount})
+        , m_TransferFence(device)
+        , m_GraphicsFence(device)
+        , m_ComputeFence(device) {
+
+        m_pDevice = const_cast<Device*>(&device);
+        m_CreateInfo = createInfo;
+
+        //Offsets must satisfy both the texel block size and the transfer queue's preferred copy alignment
+        auto const& limits = device.GetVkPhysicalDevice().getProperties().limits;
+        m_Alignment = std::max<uint64_t>(limits.optimalBufferCopyOffsetAlignment, 16);
+
+        for (uint32_t index = 0; index < createInfo.StagingSegmentCount; index++)
+            m_Contexts.push_back(std::make_unique<StreamContext>(device));
+    }
+
+    auto TextureStreamer::Internal::Request(Texture& texture, TextureMipWriter&& writer, float priority) -> void {
+        auto const& createInfo = texture.GetCreateInfo();
+        assert(createInfo.Usage & vk::ImageUsageFlagBits::eTransferDst);
+
+        auto iterator = std::find_if(m_Requests.begin(), m_Requests.end(), [&](auto const& pRequest) { return pRequest->pTexture == &texture; });
+        if (iterator != m_Requests.end()) {
+            (*iterator)->Writer = std::move(writer);
+            (*iterator)->Priority = priority;
+            return;
+        }
+
+        //The mip tail is the longest run of smallest mips that fits in the budget, but at least the last mip
+        uint32_t mipTailLevel = createInfo.MipLevels - 1;
+        while (mipTailLevel > 0 && this->GetMipRangeSize(createInfo, mipTailLevel - 1, createInfo.MipLevels) <= m_CreateInfo.MipTailSize)
+            mipTailLevel--;
+
+        m_Requests.push_back(std::make_unique<StreamRequest>(StreamRequest{
+            .pTexture = &texture,
+            .Writer = std::move(writer),
+            .Priority = priority,
+            .MipTailLevel = mipTailLevel,
+            .StagedMipLevel = texture.GetResidentMipLevel()
+        }));
+    }
+
+    auto TextureStreamer::Internal::SetPriority(Texture const& texture, float priority) -> void {
+        for (auto const& pRequest : m_Requests)
+            if (pRequest->pTexture == &texture)
+                pRequest->Priority = priority;
+    }
+
+    auto TextureStreamer::Internal::Cancel(Texture const& texture) -> void {
+        std::erase_if(m_Requests, [&](auto const& pRequest) { return pRequest->pTexture == &texture; });
+
+        //The texture may be destroyed right after, so mips still in flight are never marked resident
+        auto pImplTexture = reinterpret_cast<Texture::Internal const*>(&texture);
+        for (auto const& pContext : m_Contexts)
+            std::erase_if(pContext->Residency, [&](auto const& e) { return e.first == pImplTexture; });
+    }
+
+    auto TextureStreamer::Internal::Update() -> uint64_t {
+        this->RetireContexts();
+        if (m_Requests.empty())
+            return m_TransferFence.GetExpectedValue();
+
+        //A context still in flight keeps its command lists and staging segment, streaming resumes on a later update
+        auto& context = *m_Contexts[m_ContextIndex];
+        if (!this->IsContextCompleted(context))
+            return m_TransferFence.GetExpectedValue();
+
+        //The staging segment of the previous batch is handed over only now, when the segment that becomes current is known to be free
+        if (m_IsStagingAdvancePending) {
+            m_StagingBuffer.NextFrame(m_TransferFence);
+            m_IsStagingAdvancePending = false;
+        }
+
+        StreamBatch batch = {};
+
+        //Mip tails first so that every requested texture becomes sampleable as early as possible
+        for (auto const& pRequest : m_Requests) {
+            auto mipLevels = pRequest->pTexture->GetCreateInfo().MipLevels;
+            if (pRequest->StagedMipLevel == mipLevels && !this->StageMips(*pRequest, pRequest->MipTailLevel, mipLevels, batch))
+                break;
+        }
+
+        //Higher mips fill the remaining staging space in priority order
+        std::stable_sort(m_Requests.begin(), m_Requests.end(), [](auto const& pLhs, auto const& pRhs) { return pLhs->Priority > pRhs->Priority; });
+        for (auto const& pRequest : m_Requests) {
+            while (pRequest->Writer && pRequest->StagedMipLevel > 0 && pRequest->StagedMipLevel <= pRequest->MipTailLevel) {
+                if (!this->StageMips(*pRequest, pRequest->StagedMipLevel - 1, pRequest->StagedMipLevel, batch))
+                    break;
+            }
+        }
+
+        //Requests that could never fit in a staging segment are dropped by StageMips
+        std::erase_if(m_Requests, [](auto const& pRequest) { return pRequest->StagedMipLevel == 0 || !pRequest->Writer; });
+        m_Statistic.PendingRequestCount = static_cast<uint32_t>(std::size(m_Requests));
+
+        if (batch.Copies.empty())
+            return m_TransferFence.GetExpectedValue();
+
+        auto value = this->RecordAndSubmit(context, batch);
+        context.Residency = std::move(batch.Residency);
+
+        m_IsStagingAdvancePending = true;
+        m_ContextIndex = (m_ContextIndex + 1) % std::size(m_Contexts);
+        return value;
+    }
+
+    auto TextureStreamer::Internal::IsContextCompleted(StreamContext const& context) const -> bool {
+        return m_TransferFence.GetCompletedValue() >= context.TransferFenceValue && m_GraphicsFence.GetCompletedValue() >= context.GraphicsFenceValue && m_ComputeFence.GetCompletedValue() >= context.ComputeFenceValue;
+    }
+
+    auto TextureStreamer::Internal::RetireContexts() -> void {
+        //Samplers may only rely on mips whose copies and ownership acquires have completed on the GPU
+        for (auto const& pContext : m_Contexts) {
+            if (pContext->Residency.empty() || !this->IsContextCompleted(*pContext))
+                continue;
+            std::lock_guard<std::mutex> lock(GetResourceStateMutex());
+            for (auto [pTexture, mipLevel] : pContext->Residency)
+                pTexture->SetResidentMipLevel(std::min(pTexture->GetResidentMipLevel(), mipLevel));
+            pContext->Residency.clear();
+        }
+    }
+
+    auto TextureStreamer::Internal::GetStatistic() const -> TextureStreamerStatistic {
+        return m_Statistic;
+    }
+
+    auto TextureStreamer::Internal::GetMipRangeSize(TextureCreateInfo const& createInfo, uint32_t firstMip, uint32_t lastMip) const -> uint64_t {
+        auto blockInfo = vkx::getFormatBlockInfo(createInfo.Format);
+
+        uint64_t size = 0;
+        for (uint32_t mipLevel = firstMip; mipLevel < lastMip; mipLevel++) {
+            uint64_t blockCountX = (std::max(createInfo.Width >> mipLevel, 1u) + blockInfo.width - 1) / blockInfo.width;
+            uint64_t blockCountY = (std::max(createInfo.Height >> mipLevel, 1u) + blockInfo.height - 1) / blockInfo.height;
+            uint64_t layerSize = blockCountX * blockCountY * std::max(createInfo.Depth >> mipLevel, 1u) * blockInfo.size;
+            size += (layerSize * createInfo.ArraySize + m_Alignment - 1) / m_Alignment * m_Alignment;
+        }
+        return size;
+    }
+
+    auto TextureStreamer::Internal::StageMips(StreamRequest& request, uint32_t firstMip, uint32_t lastMip, StreamBatch& batch) -> bool {
+        auto pImplDevice = reinterpret_cast<Device::Internal*>(m_pDevice);
+        auto pImplTexture = reinterpret_cast<Texture::Internal*>(request.pTexture);
+        auto const& createInfo = pImplTexture->GetCreateInfo();
+
+        auto size = this->GetMipRangeSize(createInfo, firstMip, lastMip);
+        if (size > m_CreateInfo.StagingSegmentSize) {
+            fmt::print("Warning: TextureStreamer mip levels [{}, {}) need {} bytes, staging segment is {} bytes, request dropped \n", firstMip, lastMip, size, m_CreateInfo.StagingSegmentSize);
+            request.Writer = nullptr;
+            return true;
+        }
+
+        if (batch.StagingSize + size > m_CreateInfo.StagingSegmentSize)
+            return false;
+        batch.StagingSize += size;
+
+        auto blockInfo = vkx::getFormatBlockInfo(createInfo.Format);
+        auto aspectMask = vkx::getImageAspectFlags(createInfo.Format);
+        for (uint32_t mipLevel = firstMip; mipLevel < lastMip; mipLevel++) {
+            vk::Extent3D extent = {
+                .width = std::max(createInfo.Width >> mipLevel, 1u),
+                .height = std::max(createInfo.Height >> mipLevel, 1u),
+                .depth = std::max(createInfo.Depth >> mipLevel, 1u)
+            };
+
+            uint64_t blockCountX = (extent.width + blockInfo.width - 1) / blockInfo.width;
+            uint64_t blockCountY = (extent.height + blockInfo.height - 1) / blockInfo.height;
+            uint64_t layerSize = blockCountX * blockCountY * extent.depth * blockInfo.size;
+
+            auto allocation = m_StagingBuffer.Allocate(layerSize * createInfo.ArraySize, m_Alignment);
+            assert(allocation);
+
+            for (uint32_t arrayLayer = 0; arrayLayer < createInfo.ArraySize; arrayLayer++)
+                request.Writer(mipLevel, arrayLayer, std::span<uint8_t>(static_cast<uint8_t*>(allocation->pData) + arrayLayer * layerSize, layerSize));
+
+            //Layers are tightly packed, so a single region covers the whole mip level
+            batch.Copies.push_back(StreamCopy{
+                .Image = pImplTexture->GetVkImage(),
+                .Region = vk::BufferImageCopy{
+                    .bufferOffset = allocation->Offset,
+                    .imageSubresource = {.aspectMask = aspectMask, .mipLevel = mipLevel, .baseArrayLayer = 0, .layerCount = createInfo.ArraySize},
+                    .imageExtent = extent
+                }
+            });
+
+            m_Statistic.UploadedBytes += layerSize * createInfo.ArraySize;
+            m_Statistic.UploadedMipCount++;
+        }
+
+        bool isGraphics = createInfo.Owner == TextureOwner::Graphics;
+        uint32_t transferFamily = pImplDevice->GetTransferQueueFamilyIndex();
+        uint32_t ownerFamily = isGraphics ? pImplDevice->GetGraphicsQueueFamilyIndex() : pImplDevice->GetComputeQueueFamilyIndex();
+        bool isOwnershipTransfer = transferFamily != ownerFamily;
+
+        vk::ImageSubresourceRange subresourceRange = {
+            .aspectMask = aspectMask,
+            .baseMipLevel = firstMip,
+            .levelCount = lastMip - firstMip,
+            .baseArrayLayer = 0,
+            .layerCount = createInfo.ArraySize
+        };
+
+        batch.TransferBarriers.push_back(vk::ImageMemoryBarrier{
+            .srcAccessMask = {},
+            .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .oldLayout = vk::ImageLayout::eUndefined,
+            .newLayout = vk::ImageLayout::eTransferDstOptimal,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = pImplTexture->GetVkImage(),
+            .subresourceRange = subresourceRange
+        });
+
+        //Release half of the queue family ownership transfer; the destination access is defined by the acquire
+        batch.ReleaseBarriers.push_back(vk::ImageMemoryBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = isOwnershipTransfer ? vk::AccessFlags{} : vk::AccessFlagBits::eShaderRead,
+            .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+            .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+            .srcQueueFamilyIndex = isOwnershipTransfer ? transferFamily : VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = isOwnershipTransfer ? ownerFamily : VK_QUEUE_FAMILY_IGNORED,
+            .image = pImplTexture->GetVkImage(),
+            .subresourceRange = subresourceRange
+        });
+
+        if (isOwnershipTransfer) {
+            auto& acquireBarriers = isGraphics ? batch.GraphicsAcquireBarriers : batch.ComputeAcquireBarriers;
+            acquireBarriers.push_back(vk::ImageMemoryBarrier{
+                .srcAccessMask = {},
+                .dstAccessMask = vk::AccessFlagBits::eShaderRead,
+                .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+                .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+                .srcQueueFamilyIndex = transferFamily,
+                .dstQueueFamilyIndex = ownerFamily,
+                .image = pImplTexture->GetVkImage(),
+                .subresourceRange = subresourceRange
+            });
+        }
+
+        (isGraphics ? batch.IsGraphicsUsed : batch.IsComputeUsed) = true;
+        batch.Residency.emplace_back(pImplTexture, firstMip);
+        request.StagedMipLevel = firstMip;
+        return true;
+    }
+
+    auto TextureStreamer::Internal::RecordAndSubmit(StreamContext& context, StreamBatch const& batch) -> uint64_t {
+        auto pImplDevice = reinterpret_cast<Device::Internal*>(m_pDevice);
+
+        context.TransferCmdList.Begin();
+        auto transferCmdBuffer = context.TransferCmdList.GetVkCommandBuffer();
+        transferCmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, batch.TransferBarriers);
+        for (auto const& copy : batch.Copies)
+            transferCmdBuffer.copyBufferToImage(m_StagingBuffer.GetVkBuffer(), copy.Image, vk::ImageLayout::eTransferDstOptimal, copy.Region);
+        transferCmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, {}, {}, batch.ReleaseBarriers);
+        context.TransferCmdList.End();
+
+        auto& transferQueue = pImplDevice->GetTransferCommandQueue();
+        auto transferValue = m_TransferFence.Increment();
+        transferQueue.ExecuteCommandList({context.TransferCmdList});
+        transferQueue.Signal(m_TransferFence, transferValue);
+        context.TransferFenceValue = transferValue;
+
+        //Owner queues wait for the copies even without an ownership transfer, so later submissions observe the new mips
+        if (batch.IsGraphicsUsed) {
+            auto& graphicsQueue = pImplDevice->GetGraphicsCommandQueue();
+            graphicsQueue.Wait(m_TransferFence, transferValue);
+            if (!batch.GraphicsAcquireBarriers.empty()) {
+                context.GraphicsCmdList.Begin();
+                context.GraphicsCmdList.GetVkCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader, {}, {}, {}, batch.GraphicsAcquireBarriers);
+                context.GraphicsCmdList.End();
+                graphicsQueue.ExecuteCommandLists({context.GraphicsCmdList});
+                context.GraphicsFenceValue = m_GraphicsFence.Increment();
+                graphicsQueue.Signal(m_GraphicsFence, context.GraphicsFenceValue);
+            }
+        }
+
+        if (batch.IsComputeUsed) {
+            auto& computeQueue = pImplDevice->GetComputeCommandQueue();
+            computeQueue.Wait(m_TransferFence, transferValue);
+            if (!batch.ComputeAcquireBarriers.empty()) {
+                context.ComputeCmdList.Begin();
+                context.ComputeCmdList.GetVkCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eComputeShader, {}, {}, {}, batch.ComputeAcquireBarriers);
+                context.ComputeCmdList.End();
+                computeQueue.ExecuteCommandList({context.ComputeCmdList});
+                context.ComputeFenceValue = m_ComputeFence.Increment();
+                computeQueue.Signal(m_ComputeFence, context.ComputeFenceValue);
+            }
+        }
+        return transferValue;
+    }
+}
+
+namespace HAL {
+
+    TextureStreamer::TextureStreamer(Device const& device, TextureStreamerCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    TextureStreamer::TextureStreamer(TextureStreamer&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    TextureStreamer& TextureStreamer::operator=(TextureStreamer&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    TextureStreamer::~TextureStreamer() = default;
+
+    auto TextureStreamer::Request(Texture& texture, TextureMipWriter&& writer, float priority) -> void {
+        m_pInternal->Request(texture, std::move(writer), priority);
+    }
+
+    auto TextureStreamer::SetPriority(Texture const& texture, float priority) -> void {
+        m_pInternal->SetPriority(texture, priority);
+    }
+
+    auto TextureStreamer::Cancel(Texture const& texture) -> void {
+        m_pInternal->Cancel(texture);
+    }
+
+    auto TextureStreamer::Update() -> uint64_t {
+        return m_pInternal->Update();
+    }
+
+    auto TextureStreamer::GetFence() const -> Fence const& {
+        return m_pInternal->GetFence();
+    }
+
+    auto TextureStreamer::GetStatistic() const -> TextureStreamerStatistic {
+        return m_pInternal->GetStatistic();
+    }
+}
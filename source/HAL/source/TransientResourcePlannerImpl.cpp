@@ -0,0 +1,283 @@
+#include "../include/TransientResourcePlannerImpl.hpp"
+#include "../include/CommandListImpl.hpp"
+#include "../include/DeviceImpl.hpp"
+#include "../include/HostAllocator.hpp"
+
+namespace HAL {
+
+    TransientResourcePlanner::Internal::Internal(Device const& device) {
+        m_pDevice = const_cast<Device*>(&device);
+    }
+
+    auto TransientResourcePlanner::Internal::AddImage(TransientImageCreateInfo const& createInfo) -> uint32_t {
+        assert(createInfo.FirstPass <= createInfo.LastPass);
+        m_Resources.push_back(TransientResource{
+            .ImageCI = createInfo.ImageCI,
+            .InitialLayout = createInfo.InitialLayout,
+            .FirstPass = createInfo.FirstPass,
+            .LastPass = createInfo.LastPass,
+            .IsImage = true
+        });
+        return static_cast<uint32_t>(m_Resources.size() - 1);
+    }
+
+    auto TransientResourcePlanner::Internal::AddBuffer(TransientBufferCreateInfo const& createInfo) -> uint32_t {
+        assert(createInfo.FirstPass <= createInfo.LastPass);
+        m_Resources.push_back(TransientResource{
+            .BufferCI = createInfo.BufferCI,
+            .FirstPass = createInfo.FirstPass,
+            .LastPass = createInfo.LastPass,
+            .IsImage = false
+        });
+        return static_cast<uint32_t>(m_Resources.size() - 1);
+    }
+
+    auto TransientResourcePlanner::Internal::PlaceResources(std::vector<uint32_t> const& resources) -> uint64_t {
+        //Greedy interval placement: largest first, lowest offset that doesn't overlap a live resource
+        std::vector<uint32_t> placed;
+        uint64_t heapSize = 0;
+
+        for (uint32_t id : resources) {
+            auto& resource = m_Resources[id];
+
+            std::vector<std::pair<uint64_t, uint64_t>> occupied;
+            for (uint32_t otherId : placed) {
+                auto const& other = m_Resources[otherId];
+                if (resource.FirstPass <= other.LastPass && other.FirstPass <= resource.LastPass)
+                    occupied.emplace_back(other.Offset, other.Offset + other.Requirements.size);
+            }
+            std::sort(occupied.begin(), occupied.end());
+
+            uint64_t alignment = std::max<uint64_t>(resource.Requirements.alignment, 1);
+            uint64_t offset = 0;
+            for (auto const& [begin, end] : occupied) {
+                if (offset + resource.Requirements.size <= begin)
+                    break;
+                offset = std::max(offset, (end + alignment - 1) / alignment * alignment);
+            }
+
+            for (uint32_t otherId : placed) {
+                auto& other = m_Resources[otherId];
+                if (offset < other.Offset + other.Requirements.size && other.Offset < offset + resource.Requirements.size) {
+                    resource.IsAliased = true;
+                    other.IsAliased = true;
+                }
+            }
+
+            resource.Offset = offset;
+            heapSize = std::max(heapSize, offset + resource.Requirements.size);
+            placed.push_back(id);
+        }
+        return heapSize;
+    }
+
+    auto TransientResourcePlanner::Internal::Retire(Fence const& fence, std::optional<uint64_t> value) -> void {
+        std::vector<vk::UniqueImage> images;
+        std::vector<vk::UniqueBuffer> buffers;
+        for (auto& resource : m_Resources) {
+            if (resource.pImage)
+                images.push_back(std::move(resource.pImage));
+            if (resource.pBuffer)
+                buffers.push_back(std::move(resource.pBuffer));
+        }
+
+        if (!images.empty())
+            m_pDevice->DestroyDeferred(std::move(images), fence, value);
+        if (!buffers.empty())
+            m_pDevice->DestroyDeferred(std::move(buffers), fence, value);
+        if (!m_Allocations.empty())
+            m_pDevice->DestroyDeferred(std::exchange(m_Allocations, {}), fence, value);
+    }
+
+    auto TransientResourcePlanner::Internal::Compile(Fence const& fence, std::optional<uint64_t> value) -> TransientMemoryReport {
+        auto pImplDevice = reinterpret_cast<Device::Internal*>(m_pDevice);
+        auto device = pImplDevice->GetVkDevice();
+        auto allocator = pImplDevice->GetVmaAllocator();
+
+        this->Retire(fence, value);
+        m_AliasingBarriers.clear();
+        m_Report = {};
+
+        for (auto& resource : m_Resources) {
+            if (resource.IsImage) {
+                resource.pImage = device.createImageUnique(resource.ImageCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Resource));
+                resource.Requirements = device.getImageMemoryRequirements(*resource.pImage);
+            } else {
+                resource.pBuffer = device.createBufferUnique(resource.BufferCI, HostAllocator::GetAllocationCallbacks(HostMemoryTag::Resource));
+                resource.Requirements = device.getBufferMemoryRequirements(*resource.pBuffer);
+            }
+            resource.Offset = 0;
+            resource.IsAliased = false;
+        }
+
+        //Images and buffers are kept in separate heaps to avoid bufferImageGranularity conflicts
+        std::vector<std::pair<uint64_t, std::vector<uint32_t>>> groups;
+        for (uint32_t id = 0; id < m_Resources.size(); id++) {
+            auto const& resource = m_Resources[id];
+            uint64_t key = (static_cast<uint64_t>(resource.IsImage) << 32) | resource.Requirements.memoryTypeBits;
+            auto iterator = std::find_if(groups.begin(), groups.end(), [&](auto const& group) { return group.first == key; });
+            if (iterator == groups.end())
+                iterator = groups.insert(groups.end(), {key, {}});
+            iterator->second.push_back(id);
+        }
+
+        //Without aliasing every resource would get its own allocation
+        for (auto const& resource : m_Resources)
+            m_Report.PeakMemoryUnaliased += resource.Requirements.size;
+
+        for (auto& [key, resources] : groups) {
+            std::sort(resources.begin(), resources.end(), [&](uint32_t lhs, uint32_t rhs) {
+                return m_Resources[lhs].Requirements.size > m_Resources[rhs].Requirements.size;
+            });
+
+            vk::MemoryRequirements memoryRequirements = {
+                .size = this->PlaceResources(resources),
+                .alignment = 1,
+                .memoryTypeBits = static_cast<uint32_t>(key)
+            };
+            for (uint32_t id : resources)
+                memoryRequirements.alignment = std::max(memoryRequirements.alignment, m_Resources[id].Requirements.alignment);
+
+            vma::AllocationCreateInfo allocationCI = {
+                .usage = vma::MemoryUsage::eGpuOnly
+            };
+
+            vma::Allocation allocation = {};
+            if (allocator.allocateMemory(&memoryRequirements, &allocationCI, &allocation, nullptr) != vk::Result::eSuccess) {
+                fmt::print("Error: TransientResourcePlanner failed to allocate {} bytes \n", memoryRequirements.size);
+                //Nothing created by this Compile has been submitted yet, so it is destroyed right away instead of retired
+                for (auto& resource : m_Resources) {
+                    resource.pImage.reset();
+                    resource.pBuffer.reset();
+                }
+                m_Allocations.clear();
+                m_AliasingBarriers.clear();
+                m_Report = {};
+                return m_Report;
+            }
+
+            uint32_t allocationIndex = static_cast<uint32_t>(m_Allocations.size());
+            m_Allocations.push_back(vma::UniqueAllocation(allocation, vma::ObjectFree<vma::Allocator>(allocator)));
+            m_Report.PeakMemoryAliased += memoryRequirements.size;
+
+            for (uint32_t id : resources) {
+                auto& resource = m_Resources[id];
+                resource.AllocationIndex = allocationIndex;
+                if (resource.IsImage)
+                    allocator.bindImageMemory2(allocation, resource.Offset, *resource.pImage, nullptr);
+                else
+                    allocator.bindBufferMemory2(allocation, resource.Offset, *resource.pBuffer, nullptr);
+                if (resource.IsAliased)
+                    m_AliasingBarriers.push_back(TransientAliasingBarrier{.PassIndex = resource.FirstPass, .ResourceID = id});
+            }
+        }
+
+        std::sort(m_AliasingBarriers.begin(), m_AliasingBarriers.end(), [](auto const& lhs, auto const& rhs) {
+            return std::tie(lhs.PassIndex, lhs.ResourceID) < std::tie(rhs.PassIndex, rhs.ResourceID);
+        });
+
+        m_Report.ResourceCount = static_cast<uint32_t>(m_Resources.size());
+        m_Report.AllocationCount = static_cast<uint32_t>(m_Allocations.size());
+        return m_Report;
+    }
+
+    auto TransientResourcePlanner::Internal::Reset(Fence const& fence, std::optional<uint64_t> value) -> void {
+        this->Retire(fence, value);
+        m_Resources.clear();
+        m_AliasingBarriers.clear();
+        m_Report = {};
+    }
+
+    auto TransientResourcePlanner::Internal::GetAliasingBarriers(uint32_t passIndex) const -> std::span<const TransientAliasingBarrier> {
+        auto [begin, end] = std::equal_range(m_AliasingBarriers.begin(), m_AliasingBarriers.end(), TransientAliasingBarrier{.PassIndex = passIndex}, [](auto const& lhs, auto const& rhs) {
+            return lhs.PassIndex < rhs.PassIndex;
+        });
+        return std::span<const TransientAliasingBarrier>(begin, end);
+    }
+
+    auto TransientResourcePlanner::Internal::RecordAliasingBarriers(CommandList& cmdList, uint32_t passIndex) const -> void {
+        auto barriers = this->GetAliasingBarriers(passIndex);
+        if (barriers.empty())
+            return;
+
+        //Writes of the previous owner of the memory must complete before the new owner touches it
+        vk::MemoryBarrier memoryBarrier = {
+            .srcAccessMask = vk::AccessFlagBits::eMemoryWrite,
+            .dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite
+        };
+
+        std::vector<vk::ImageMemoryBarrier> imageBarriers;
+        for (auto const& barrier : barriers) {
+            auto const& resource = m_Resources[barrier.ResourceID];
+            if (!resource.IsImage)
+                continue;
+
+            imageBarriers.push_back(vk::ImageMemoryBarrier{
+                .srcAccessMask = {},
+                .dstAccessMask = vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite,
+                .oldLayout = vk::ImageLayout::eUndefined,
+                .newLayout = resource.InitialLayout,
+                .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                .image = *resource.pImage,
+                .subresourceRange = {
+                    .aspectMask = vkx::getImageAspectFlags(resource.ImageCI.format),
+                    .baseMipLevel = 0,
+                    .levelCount = VK_REMAINING_MIP_LEVELS,
+                    .baseArrayLayer = 0,
+                    .layerCount = VK_REMAINING_ARRAY_LAYERS
+                }
+            });
+        }
+
+        auto cmdBuffer = reinterpret_cast<CommandList::Internal*>(&cmdList)->GetVkCommandBuffer();
+        cmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eAllCommands, {}, memoryBarrier, {}, imageBarriers);
+    }
+}
+
+namespace HAL {
+
+    TransientResourcePlanner::TransientResourcePlanner(Device const& device) : m_pInternal(device) {}
+
+    TransientResourcePlanner::TransientResourcePlanner(TransientResourcePlanner&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    TransientResourcePlanner& TransientResourcePlanner::operator=(TransientResourcePlanner&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    TransientResourcePlanner::~TransientResourcePlanner() = default;
+
+    auto TransientResourcePlanner::AddImage(TransientImageCreateInfo const& createInfo) -> uint32_t {
+        return m_pInternal->AddImage(createInfo);
+    }
+
+    auto TransientResourcePlanner::AddBuffer(TransientBufferCreateInfo const& createInfo) -> uint32_t {
+        return m_pInternal->AddBuffer(createInfo);
+    }
+
+    auto TransientResourcePlanner::Compile(Fence const& fence, std::optional<uint64_t> value) -> TransientMemoryReport {
+        return m_pInternal->Compile(fence, value);
+    }
+
+    auto TransientResourcePlanner::Reset(Fence const& fence, std::optional<uint64_t> value) -> void {
+        m_pInternal->Reset(fence, value);
+    }
+
+    auto TransientResourcePlanner::RecordAliasingBarriers(CommandList& cmdList, uint32_t passIndex) const -> void {
+        m_pInternal->RecordAliasingBarriers(cmdList, passIndex);
+    }
+
+    auto TransientResourcePlanner::GetAliasingBarriers(uint32_t passIndex) const -> std::span<const TransientAliasingBarrier> {
+        return m_pInternal->GetAliasingBarriers(passIndex);
+    }
+
+    auto TransientResourcePlanner::GetReport() const -> TransientMemoryReport {
+        return m_pInternal->GetReport();
+    }
+
+    auto TransientResourcePlanner::GetVkImage(uint32_t resourceID) const -> vk::Image {
+        return m_pInternal->GetVkImage(resourceID);
+    }
+
+    auto TransientResourcePlanner::GetVkBuffer(uint32_t resourceID) const -> vk::Buffer {
+        return m_pInternal->GetVkBuffer(resourceID);
+    }
+}
@@ -0,0 +1,365 @@
+#include "../include/UploadBatcherImpl.hpp"
+#include "../include/TextureImpl.hpp"
+#include "../include/CommandListImpl.hpp"
+#include "../include/DeviceImpl.hpp"
+
+namespace HAL {
+
+    UploadBatcher::Internal::Internal(Device const& device, UploadBatcherCreateInfo const& createInfo)
+        : m_StagingBuffer(device, RingBufferCreateInfo{.SegmentSize = createInfo.StagingSegmentSize, .SegmentCount = createInfo.StagingSegmentCount})
+        , m_TransferFence(device)
+        , m_GraphicsFence(device)
+        , m_ComputeFence(device) {
+
+        m_pDevice = const_cast<Device*>(&device);
+        m_SegmentSize = createInfo.StagingSegmentSize;
+        m_Alignment = std::max<uint64_t>(device.GetVkPhysicalDevice().getProperties().limits.optimalBufferCopyOffsetAlignment, 16);
+
+        for (uint32_t index = 0; index < createInfo.StagingSegmentCount; index++)
+            m_Contexts.push_back(std::make_unique<UploadContext>(device));
+    }
+
+    auto UploadBatcher::Internal::WriteBuffer(Buffer const& buffer, uint64_t offset, void const* pData, uint64_t size) -> void {
+        assert(offset + size <= buffer.GetSize());
+
+        auto allocation = this->AllocateStaging(size);
+        if (!allocation)
+            return;
+        std::memcpy(allocation->pData, pData, size);
+
+        //Keyed by the record so that copies follow the buffer when defragmentation relocates it before the flush.
+        //Adjacent writes to the same destination extend the previous region instead of adding a new one
+        auto& regions = m_BufferCopies[reinterpret_cast<Buffer::Internal const*>(&buffer)->GetRecord()];
+        auto dstOffset = buffer.GetOffset() + offset;
+        if (!regions.empty() && regions.back().srcOffset + regions.back().size == allocation->Offset && regions.back().dstOffset + regions.back().size == dstOffset) {
+            regions.back().size += size;
+        } else {
+            regions.push_back(vk::BufferCopy{
+                .srcOffset = allocation->Offset,
+                .dstOffset = dstOffset,
+                .size = size
+            });
+        }
+
+        m_Statistic.UploadedBytes += size;
+        m_Statistic.WriteCount++;
+    }
+
+    auto UploadBatcher::Internal::WriteTexture(Texture& texture, TextureUploadRegion const& region, void const* pData) -> void {
+        auto pImplTexture = reinterpret_cast<Texture::Internal*>(&texture);
+        auto const& createInfo = pImplTexture->GetCreateInfo();
+        assert(createInfo.Usage & vk::ImageUsageFlagBits::eTransferDst);
+        assert(region.MipLevel < createInfo.MipLevels && region.ArrayLayer < createInfo.ArraySize);
+        assert(region.MipLevel < 32);
+
+        vk::Extent3D extent = region.Extent;
+        if (extent.width == 0 || extent.height == 0 || extent.depth == 0) {
+            extent = vk::Extent3D{
+                .width = std::max(createInfo.Width >> region.MipLevel, 1u),
+                .height = std::max(createInfo.Height >> region.MipLevel, 1u),
+                .depth = std::max(createInfo.Depth >> region.MipLevel, 1u)
+            };
+        }
+
+        auto blockInfo = vkx::getFormatBlockInfo(createInfo.Format);
+        uint64_t blockCountX = (extent.width + blockInfo.width - 1) / blockInfo.width;
+        uint64_t blockCountY = (extent.height + blockInfo.height - 1) / blockInfo.height;
+        uint64_t size = blockCountX * blockCountY * extent.depth * blockInfo.size;
+
+        auto allocation = this->AllocateStaging(size);
+        if (!allocation)
+            return;
+        std::memcpy(allocation->pData, pData, size);
+
+        auto [iterator, isInserted] = m_TextureCopies.try_emplace(pImplTexture, TextureCopies{.MinMipLevel = region.MipLevel});
+        iterator->second.MinMipLevel = std::min(iterator->second.MinMipLevel, region.MipLevel);
+        iterator->second.MipLevelMask |= 1u << region.MipLevel;
+        iterator->second.Regions.push_back(vk::BufferImageCopy{
+            .bufferOffset = allocation->Offset,
+            .imageSubresource = {.aspectMask = vkx::getImageAspectFlags(createInfo.Format), .mipLevel = region.MipLevel, .baseArrayLayer = region.ArrayLayer, .layerCount = 1},
+            .imageOffset = region.Offset,
+            .imageExtent = extent
+        });
+
+        m_Statistic.UploadedBytes += size;
+        m_Statistic.WriteCount++;
+    }
+
+    auto UploadBatcher::Internal::Flush() -> uint64_t {
+        if (m_BufferCopies.empty() && m_TextureCopies.empty())
+            return m_TransferFence.GetExpectedValue();
+
+        auto pImplDevice = reinterpret_cast<Device::Internal*>(m_pDevice);
+        auto& context = *m_Contexts[m_ContextIndex];
+        m_TransferFence.Wait(context.TransferFenceValue);
+        m_GraphicsFence.Wait(context.GraphicsFenceValue);
+        m_ComputeFence.Wait(context.ComputeFenceValue);
+
+        uint32_t transferFamily = pImplDevice->GetTransferQueueFamilyIndex();
+        OwnerQueue ownerQueues[] = {this->GetOwnerQueue(context, TextureOwner::Graphics), this->GetOwnerQueue(context, TextureOwner::Compute)};
+        OwnerBarriers ownerBarriers[std::size(ownerQueues)] = {};
+
+        std::vector<vk::BufferMemoryBarrier> transferBufferBarriers;
+        std::vector<vk::ImageMemoryBarrier>  transferImageBarriers;
+        std::vector<vk::ImageMemoryBarrier>  releaseImageBarriers;
+        std::vector<vk::BufferMemoryBarrier> releaseBufferBarriers;
+
+        for (auto const& [pTexture, copies] : m_TextureCopies) {
+            auto const& createInfo = pTexture->GetCreateInfo();
+            auto const& ownerQueue = ownerQueues[static_cast<uint32_t>(createInfo.Owner)];
+            auto& barriers = ownerBarriers[static_cast<uint32_t>(createInfo.Owner)];
+            bool isOwnershipTransfer = ownerQueue.QueueFamily != transferFamily;
+            uint32_t residentMipLevel = pTexture->GetResidentMipLevel();
+            uint32_t firstMipLevel = std::min(copies.MinMipLevel, residentMipLevel);
+
+            //Only mips at or past the resident level are ShaderReadOnlyOptimal, the larger ones were never written and stay Undefined
+            vk::ImageSubresourceRange subresourceRange = {
+                .aspectMask = vkx::getImageAspectFlags(createInfo.Format),
+                .baseMipLevel = firstMipLevel,
+                .levelCount = createInfo.MipLevels - firstMipLevel,
+                .baseArrayLayer = 0,
+                .layerCount = createInfo.ArraySize
+            };
+
+            if (firstMipLevel < residentMipLevel) {
+                auto undefinedRange = subresourceRange;
+                undefinedRange.levelCount = residentMipLevel - firstMipLevel;
+                transferImageBarriers.push_back(vk::ImageMemoryBarrier{
+                    .srcAccessMask = {},
+                    .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
+                    .oldLayout = vk::ImageLayout::eUndefined,
+                    .newLayout = vk::ImageLayout::eTransferDstOptimal,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .image = pTexture->GetVkImage(),
+                    .subresourceRange = undefinedRange
+                });
+            }
+
+            //Resident texels outside the written regions must survive, so the owner hands the image over first
+            if (residentMipLevel < createInfo.MipLevels) {
+                auto residentRange = subresourceRange;
+                residentRange.baseMipLevel = residentMipLevel;
+                residentRange.levelCount = createInfo.MipLevels - residentMipLevel;
+
+                vk::ImageMemoryBarrier transferBarrier = {
+                    .srcAccessMask = {},
+                    .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
+                    .oldLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+                    .newLayout = vk::ImageLayout::eTransferDstOptimal,
+                    .srcQueueFamilyIndex = isOwnershipTransfer ? ownerQueue.QueueFamily : VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = isOwnershipTransfer ? transferFamily : VK_QUEUE_FAMILY_IGNORED,
+                    .image = pTexture->GetVkImage(),
+                    .subresourceRange = residentRange
+                };
+
+                if (isOwnershipTransfer) {
+                    barriers.ReleaseImages.push_back(transferBarrier);
+                    barriers.ReleaseImages.back().dstAccessMask = {};
+                }
+                transferImageBarriers.push_back(transferBarrier);
+            }
+
+            releaseImageBarriers.push_back(vk::ImageMemoryBarrier{
+                .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                .dstAccessMask = isOwnershipTransfer ? vk::AccessFlags{} : vk::AccessFlagBits::eShaderRead,
+                .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+                .newLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+                .srcQueueFamilyIndex = isOwnershipTransfer ? transferFamily : VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = isOwnershipTransfer ? ownerQueue.QueueFamily : VK_QUEUE_FAMILY_IGNORED,
+                .image = pTexture->GetVkImage(),
+                .subresourceRange = subresourceRange
+            });
+
+            if (isOwnershipTransfer) {
+                barriers.AcquireImages.push_back(releaseImageBarriers.back());
+                barriers.AcquireImages.back().srcAccessMask = {};
+                barriers.AcquireImages.back().dstAccessMask = vk::AccessFlagBits::eShaderRead;
+            }
+            barriers.IsUsed = true;
+        }
+
+        //Buffers have no owner of their own and are handed to the graphics queue family
+        for (auto const& [pRecord, regions] : m_BufferCopies) {
+            auto const& ownerQueue = ownerQueues[static_cast<uint32_t>(TextureOwner::Graphics)];
+            auto& barriers = ownerBarriers[static_cast<uint32_t>(TextureOwner::Graphics)];
+            bool isOwnershipTransfer = ownerQueue.QueueFamily != transferFamily;
+
+            for (auto const& region : regions) {
+                //Exclusive buffers are owned by the graphics family, which hands them over before the copy as with textures
+                if (isOwnershipTransfer) {
+                    vk::BufferMemoryBarrier transferBarrier = {
+                        .srcAccessMask = {},
+                        .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
+                        .srcQueueFamilyIndex = ownerQueue.QueueFamily,
+                        .dstQueueFamilyIndex = transferFamily,
+                        .buffer = pRecord->Buffer,
+                        .offset = region.dstOffset,
+                        .size = region.size
+                    };
+                    barriers.ReleaseBuffers.push_back(transferBarrier);
+                    barriers.ReleaseBuffers.back().srcAccessMask = vk::AccessFlagBits::eMemoryWrite;
+                    barriers.ReleaseBuffers.back().dstAccessMask = {};
+                    transferBufferBarriers.push_back(transferBarrier);
+                }
+
+                releaseBufferBarriers.push_back(vk::BufferMemoryBarrier{
+                    .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+                    .dstAccessMask = isOwnershipTransfer ? vk::AccessFlags{} : vk::AccessFlagBits::eMemoryRead,
+                    .srcQueueFamilyIndex = isOwnershipTransfer ? transferFamily : VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = isOwnershipTransfer ? ownerQueue.QueueFamily : VK_QUEUE_FAMILY_IGNORED,
+                    .buffer = pRecord->Buffer,
+                    .offset = region.dstOffset,
+                    .size = region.size
+                });
+
+                if (isOwnershipTransfer) {
+                    barriers.AcquireBuffers.push_back(releaseBufferBarriers.back());
+                    barriers.AcquireBuffers.back().srcAccessMask = {};
+                    barriers.AcquireBuffers.back().dstAccessMask = vk::AccessFlagBits::eMemoryRead;
+                }
+            }
+            barriers.IsUsed = true;
+        }
+
+        auto& transferQueue = pImplDevice->GetTransferCommandQueue();
+        for (size_t index = 0; index < std::size(ownerQueues); index++) {
+            if (ownerBarriers[index].ReleaseImages.empty() && ownerBarriers[index].ReleaseBuffers.empty())
+                continue;
+            auto value = this->SubmitBarriers(ownerQueues[index], *ownerQueues[index].pReleaseCmdList, vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eBottomOfPipe, ownerBarriers[index].ReleaseBuffers, ownerBarriers[index].ReleaseImages);
+            transferQueue.Wait(*ownerQueues[index].pFence, value);
+        }
+
+        context.TransferCmdList.Begin();
+        {
+            auto cmdBuffer = context.TransferCmdList.GetVkCommandBuffer();
+            auto stagingBuffer = m_StagingBuffer.GetVkBuffer();
+
+            if (!transferBufferBarriers.empty() || !transferImageBarriers.empty())
+                cmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, {}, {}, transferBufferBarriers, transferImageBarriers);
+            for (auto const& [pRecord, regions] : m_BufferCopies)
+                cmdBuffer.copyBuffer(stagingBuffer, pRecord->Buffer, regions);
+            for (auto const& [pTexture, copies] : m_TextureCopies)
+                cmdBuffer.copyBufferToImage(stagingBuffer, pTexture->GetVkImage(), vk::ImageLayout::eTransferDstOptimal, copies.Regions);
+            cmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, {}, releaseBufferBarriers, releaseImageBarriers);
+        }
+        context.TransferCmdList.End();
+
+        auto transferValue = m_TransferFence.Increment();
+        transferQueue.ExecuteCommandList({context.TransferCmdList});
+        transferQueue.Signal(m_TransferFence, transferValue);
+        context.TransferFenceValue = transferValue;
+
+        //Owner queues wait even without an ownership transfer, so their later submissions observe the new data
+        for (size_t index = 0; index < std::size(ownerQueues); index++) {
+            auto const& barriers = ownerBarriers[index];
+            if (!barriers.IsUsed)
+                continue;
+            ownerQueues[index].pQueue->Wait(m_TransferFence, transferValue);
+            if (!barriers.AcquireImages.empty() || !barriers.AcquireBuffers.empty())
+                this->SubmitBarriers(ownerQueues[index], *ownerQueues[index].pAcquireCmdList, vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eAllCommands, barriers.AcquireBuffers, barriers.AcquireImages);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(GetResourceStateMutex());
+            //A mip only becomes resident when every mip between it and the resident level was written as well
+            for (auto const& [pTexture, copies] : m_TextureCopies) {
+                uint32_t residentMipLevel = pTexture->GetResidentMipLevel();
+                while (residentMipLevel > 0 && (copies.MipLevelMask & (1u << (residentMipLevel - 1))))
+                    residentMipLevel--;
+                pTexture->SetResidentMipLevel(residentMipLevel);
+            }
+        }
+
+        m_BufferCopies.clear();
+        m_TextureCopies.clear();
+        m_StagingSize = 0;
+        m_StagingBuffer.NextFrame(m_TransferFence, transferValue);
+        m_ContextIndex = (m_ContextIndex + 1) % std::size(m_Contexts);
+        m_Statistic.SubmitCount++;
+        return transferValue;
+    }
+
+    auto UploadBatcher::Internal::AllocateStaging(uint64_t size) -> std::optional<RingBufferAllocation> {
+        uint64_t alignedSize = (size + m_Alignment - 1) / m_Alignment * m_Alignment;
+        if (alignedSize > m_SegmentSize) {
+            fmt::print("Warning: UploadBatcher write of {} bytes exceeds staging segment of {} bytes \n", size, m_SegmentSize);
+            return std::nullopt;
+        }
+
+        //Running out of staging space within a frame costs an extra submit rather than a failed write
+        if (m_StagingSize + alignedSize > m_SegmentSize)
+            this->Flush();
+
+        auto allocation = m_StagingBuffer.Allocate(alignedSize, m_Alignment);
+        if (allocation)
+            m_StagingSize += alignedSize;
+        return allocation;
+    }
+
+    auto UploadBatcher::Internal::GetOwnerQueue(UploadContext& context, TextureOwner owner) -> OwnerQueue {
+        auto pImplDevice = reinterpret_cast<Device::Internal*>(m_pDevice);
+        if (owner == TextureOwner::Graphics) {
+            return OwnerQueue{
+                .pQueue = &pImplDevice->GetGraphicsCommandQueue(),
+                .pReleaseCmdList = &context.GraphicsReleaseCmdList,
+                .pAcquireCmdList = &context.GraphicsAcquireCmdList,
+                .pFence = &m_GraphicsFence,
+                .pFenceValue = &context.GraphicsFenceValue,
+                .QueueFamily = pImplDevice->GetGraphicsQueueFamilyIndex()
+            };
+        }
+
+        return OwnerQueue{
+            .pQueue = &pImplDevice->GetComputeCommandQueue(),
+            .pReleaseCmdList = &context.ComputeReleaseCmdList,
+            .pAcquireCmdList = &context.ComputeAcquireCmdList,
+            .pFence = &m_ComputeFence,
+            .pFenceValue = &context.ComputeFenceValue,
+            .QueueFamily = pImplDevice->GetComputeQueueFamilyIndex()
+        };
+    }
+
+    auto UploadBatcher::Internal::SubmitBarriers(OwnerQueue const& owner, ComputeCommandList& cmdList, vk::PipelineStageFlags srcStage, vk::PipelineStageFlags dstStage, std::span<const vk::BufferMemoryBarrier> bufferBarriers, std::span<const vk::ImageMemoryBarrier> imageBarriers) -> uint64_t {
+        cmdList.Begin();
+        cmdList.GetVkCommandBuffer().pipelineBarrier(srcStage, dstStage, {}, {}, bufferBarriers, imageBarriers);
+        cmdList.End();
+
+        auto value = owner.pFence->Increment();
+        owner.pQueue->ExecuteCommandList({cmdList});
+        owner.pQueue->Signal(*owner.pFence, value);
+        *owner.pFenceValue = value;
+        return value;
+    }
+}
+
+namespace HAL {
+
+    UploadBatcher::UploadBatcher(Device const& device, UploadBatcherCreateInfo const& createInfo) : m_pInternal(device, createInfo) {}
+
+    UploadBatcher::UploadBatcher(UploadBatcher&& rhs) noexcept : m_pInternal(std::move(rhs.m_pInternal)) {}
+
+    UploadBatcher& UploadBatcher::operator=(UploadBatcher&& rhs) noexcept { m_pInternal = std::move(rhs.m_pInternal); return *this; }
+
+    UploadBatcher::~UploadBatcher() = default;
+
+    auto UploadBatcher::WriteBuffer(Buffer const& buffer, uint64_t offset, void const* pData, uint64_t size) -> void {
+        m_pInternal->WriteBuffer(buffer, offset, pData, size);
+    }
+
+    auto UploadBatcher::WriteTexture(Texture& texture, TextureUploadRegion const& region, void const* pData) -> void {
+        m_pInternal->WriteTexture(texture, region, pData);
+    }
+
+    auto UploadBatcher::Flush() -> uint64_t {
+        return m_pInternal->Flush();
+    }
+
+    auto UploadBatcher::GetFence() const -> Fence const& {
+        return m_pInternal->GetFence();
+    }
+
+    auto UploadBatcher::GetStatistic() const -> UploadBatcherStatistic {
+        return m_pInternal->GetStatistic();
+    }
+}
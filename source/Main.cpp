@@ -27,11 +27,17 @@
 #include <HAL/SwapChain.hpp>
 #include <HAL/Fence.hpp>
 #include <HAL/CommandQueue.hpp>
+#include <HAL/SubmitBatch.hpp>
 #include <HAL/CommandAllocator.hpp>
+#include <HAL/CommandAllocatorRing.hpp>
 #include <HAL/CommandList.hpp>
 #include <HAL/ShaderCompiler.hpp>
 #include <HAL/DescriptorTableLayout.hpp>
 #include <HAL/Pipeline.hpp>
+#include <HAL/Buffer.hpp>
+#include <HAL/Texture.hpp>
+#include <HAL/TextureStreamer.hpp>
+#include <HAL/UploadBatcher.hpp>
 
 
 
@@ -105,221 +111,102 @@ public:
         DeviceMemory,
         SystemMemory
     };
-    
-    struct MemoryFrame {
-        double   TimePoint;
-        uint64_t MemoryUsed;
-    };
 
     struct MemoryHeapStats {
-        uint64_t MemorySize;
-        uint64_t MemoryUsed;
-        uint32_t MemoryIndex;
-        uint32_t MemoryCount;
-        HeapType MemoryType;
-        std::vector<MemoryFrame> MemoryFrames = {};
+        uint64_t        MemorySize;
+        uint64_t        MemoryUsed;
+        uint64_t        MemoryPeak;
+        uint32_t        MemoryIndex;
+        uint32_t        MemoryCount;
+        HeapType        MemoryType;
+        ScrollingBuffer MemoryFrames = {};
     };
 public:
-    MemoryStatisticGPU(vk::PhysicalDevice physicalDevice) {
-        m_MemoryProperty = physicalDevice.getMemoryProperties();
-        for (uint32_t index = 0; index < m_MemoryProperty.memoryHeapCount; index++) {          
+    MemoryStatisticGPU(HAL::Device const& device) : m_pDevice(&device) {
+        auto snapshot = m_pDevice->GetMemorySnapshot();
+        for (uint32_t index = 0; index < snapshot.HeapCount; index++) {
             MemoryHeapStats heap = {
-                .MemorySize = m_MemoryProperty.memoryHeaps[index].size,
-                .MemoryUsed = 0,
+                .MemorySize = snapshot.Heaps[index].HeapSize,
+                .MemoryUsed = snapshot.Heaps[index].UsedBytes,
+                .MemoryPeak = snapshot.Heaps[index].PeakBytes,
                 .MemoryIndex = index,
-                .MemoryCount = 0,
-                .MemoryType = m_MemoryProperty.memoryHeaps[index].flags & vk::MemoryHeapFlagBits::eDeviceLocal ? HeapType::DeviceMemory : HeapType::SystemMemory,
-                .MemoryFrames = std::vector<MemoryFrame>{ {0, 0} } 
+                .MemoryCount = snapshot.Heaps[index].AllocationCount,
+                .MemoryType = snapshot.Heaps[index].IsDeviceLocal ? HeapType::DeviceMemory : HeapType::SystemMemory
             };
-            m_GpuMemory.push_back(heap);
+            heap.MemoryFrames.AddPoint(0.0f, static_cast<float>(heap.MemoryUsed >> 20));
+            m_GpuMemory.push_back(std::move(heap));
         }
-        m_TimeStamp = std::chrono::high_resolution_clock::now();
+        m_TimePoint = snapshot.TimePoint;
     }
 
-    auto AddMemoryInfo(uint32_t memoryTypeIndex, vk::DeviceSize size) -> void {
-        assert(memoryTypeIndex < m_MemoryProperty.memoryTypeCount);
-        auto time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_TimeStamp).count();
-        auto heapIndex = m_MemoryProperty.memoryTypes[memoryTypeIndex].heapIndex;
-        m_GpuMemory[heapIndex].MemoryUsed += size;
-        m_GpuMemory[heapIndex].MemoryCount++;
-        m_GpuMemory[heapIndex].MemoryFrames.push_back({ time, m_GpuMemory[heapIndex].MemoryUsed });
-    }
-    
-    auto RemoveMemoryInfo(uint32_t memoryTypeIndex, vk::DeviceSize size) -> void {
-        assert(memoryTypeIndex < m_MemoryProperty.memoryTypeCount);
-        auto time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_TimeStamp).count();
-        auto heapIndex = m_MemoryProperty.memoryTypes[memoryTypeIndex].heapIndex;
-        m_GpuMemory[heapIndex].MemoryUsed -= size;
-        m_GpuMemory[heapIndex].MemoryCount--;
-        m_GpuMemory[heapIndex].MemoryFrames.push_back({ time, m_GpuMemory[heapIndex].MemoryUsed });
+    //Drains the HAL telemetry ring; the history per heap is bounded by ScrollingBuffer
+    auto Update() -> void {
+        m_Events.clear();
+        m_EventSequence = m_pDevice->ReadMemoryEvents(m_EventSequence, m_Events);
+        for (auto const& event : m_Events)
+            m_GpuMemory[event.HeapIndex].MemoryFrames.AddPoint(static_cast<float>(event.TimePoint), static_cast<float>(event.HeapUsage >> 20));
+
+        auto snapshot = m_pDevice->GetMemorySnapshot();
+        for (auto& heap : m_GpuMemory) {
+            heap.MemoryUsed = snapshot.Heaps[heap.MemoryIndex].UsedBytes;
+            heap.MemoryPeak = snapshot.Heaps[heap.MemoryIndex].PeakBytes;
+            heap.MemoryCount = snapshot.Heaps[heap.MemoryIndex].AllocationCount;
+        }
+        m_TimePoint = snapshot.TimePoint;
     }
 
     auto GetMemoryStatistic() -> std::vector<MemoryHeapStats> const& {
         return m_GpuMemory;
     }
 
-    static auto GPUAllocate(VmaAllocator allocator, uint32_t memoryType, VkDeviceMemory memory, VkDeviceSize size, void* pUserData) -> void {
-        if (pUserData) {
-            auto pMemoryStat = reinterpret_cast<MemoryStatisticGPU*>(pUserData);
-            pMemoryStat->AddMemoryInfo(memoryType, size);
-        }
-          
-        vk::MemoryPropertyFlags memoryInfo = {};
-        VmaAllocatorInfo allocatorInfo = {};
-        vmaGetMemoryTypeProperties(allocator, memoryType, reinterpret_cast<VkMemoryPropertyFlags*>(&memoryInfo));
-        vmaGetAllocatorInfo(allocator, &allocatorInfo);
-
-        vkx::setDebugName(vk::Device(allocatorInfo.device), vk::DeviceMemory(memory), fmt::format("Type: {0} Size: {1} kb", vk::to_string(memoryInfo), (size >> 10)));
-        fmt::print("GPU Allocation -> Memory type: {0}, Size: {1} kb \n", vk::to_string(memoryInfo), (size >> 10));
-    }
-    
-    static auto GPUFree(VmaAllocator allocator, uint32_t memoryType, VkDeviceMemory memory, VkDeviceSize size, void* pUserData) -> void {
-         if (pUserData) {
-            auto pMemoryStat = reinterpret_cast<MemoryStatisticGPU*>(pUserData);
-            pMemoryStat->RemoveMemoryInfo(memoryType, size);
-         }
-
-         vk::MemoryPropertyFlags memoryInfo = {};
-         vmaGetMemoryTypeProperties(allocator, memoryType, reinterpret_cast<VkMemoryPropertyFlags*>(&memoryInfo));
-         fmt::print("GPU Free -> Memory type: {0}, Size: {1} kb \n", vk::to_string(memoryInfo), (size >> 10));    
+    auto GetTimePoint() const -> double {
+        return m_TimePoint;
     }
 
 private:
-    vk::PhysicalDeviceMemoryProperties    m_MemoryProperty;
-    std::vector<MemoryHeapStats>          m_GpuMemory;
-    std::chrono::steady_clock::time_point m_TimeStamp;
+    HAL::Device const*            m_pDevice;
+    std::vector<MemoryHeapStats>  m_GpuMemory;
+    std::vector<HAL::MemoryEvent> m_Events;
+    uint64_t                      m_EventSequence = 0;
+    double                        m_TimePoint = 0.0;
 };
 
 class MemoryStatisticCPU {
+public:
+    MemoryStatisticCPU(HAL::Instance const& instance) : m_pInstance(&instance) {}
 
-};
-
-
- 
-namespace HAL {
-
-    enum class MemoryUsage {
-         eUnknown,
-         eGpuOnly,
-         eCpuOnly,
-         eCpuToGpu,
-         eGpuToCpu,
-         eCpuCopy,
-         eGpuLazilyAllocated
-    };
-
-    enum class BufferUsageFlagBits {
-
-    };
-  
-    struct BufferViewCreateInfo {
-        uint64_t Offset = {};
-        uint64_t Range = {};
-        Format   Format = {};
-        bool     IsRawView = {};
-    };
-
-    struct BufferCreateInfo {
-        uint64_t            Size = {};
-        BufferUsageFlagBits BuffferUsage = {};
-        MemoryUsage         MemoryUsage = {};
-    };
-
-    struct TextureCreateInfo {
-        uint32_t Width = {};
-        uint32_t Height = {};
-        uint32_t Depth = {};
-        uint32_t ArraySize = {};
-        uint32_t MipLevels = {};
-        Format   Format = {};
-    };
-
-    template<typename T>
-    class ObjectBase {
-    public:
-        ObjectBase(T const& createInfo) : m_CreateInfo(createInfo) {}
-
-        auto GetCreateInfo() const -> T const& { return m_CreateInfo; };
-
-    protected:
-        T m_CreateInfo = {};       
-    };
-  
-    class Buffer final: public ObjectBase<BufferCreateInfo> {
-    public:
-        Buffer(Device const& device, BufferCreateInfo const& createInfo): ObjectBase(createInfo) {
-            
-            vk::BufferCreateInfo bufferCI = {
-                
-            };
+    auto Update() -> void {
+        m_Statistic = m_pInstance->GetHostMemoryStatistic();
+    }
 
-            vma::AllocationCreateInfo allocationCI = {
-                .flags = vma::AllocationCreateFlagBits::eWithinBudget,
-                .usage = static_cast<vma::MemoryUsage>(createInfo.MemoryUsage)
-            };
+    auto GetMemoryStatistic() const -> HAL::HostMemoryStatistic const& {
+        return m_Statistic;
+    }
 
-            std::tie(m_pBuffer, m_pAllocation) = device.GetVmaAllocator().createBufferUnique(bufferCI, allocationCI, m_AllocationInfo);         
+    static auto GetTagName(HAL::HostMemoryTag tag) -> const char* {
+        switch (tag) {
+            case HAL::HostMemoryTag::Instance:        return "Instance";
+            case HAL::HostMemoryTag::Device:          return "Device";
+            case HAL::HostMemoryTag::SwapChain:       return "SwapChain";
+            case HAL::HostMemoryTag::Command:         return "Command";
+            case HAL::HostMemoryTag::Pipeline:        return "Pipeline";
+            case HAL::HostMemoryTag::Descriptor:      return "Descriptor";
+            case HAL::HostMemoryTag::RenderPass:      return "RenderPass";
+            case HAL::HostMemoryTag::Resource:        return "Resource";
+            case HAL::HostMemoryTag::Synchronization: return "Synchronization";
+            default: return "Invalid";
         }
+    }
 
-        auto GetCreateInfo() const -> BufferCreateInfo const& { return m_CreateInfo; }
+private:
+    HAL::Instance const*      m_pInstance;
+    HAL::HostMemoryStatistic  m_Statistic = {};
+};
 
-        auto GetVkBuffer() const -> vk::Buffer { return m_pBuffer.get(); }
-    
-        auto GetVmaAllocation() const -> vma::Allocation { return m_pAllocation.get(); }
 
-    private:
-        vma::AllocationInfo   m_AllocationInfo = {};
-        vma::UniqueAllocation m_pAllocation = {};
-        vk::UniqueBuffer      m_pBuffer = {};       
-    };
  
-    class BufferView final: public ObjectBase<BufferViewCreateInfo> {
-    public:
-        BufferView(Device const& device, Buffer const& buffer, BufferViewCreateInfo const& createInfo) : ObjectBase(createInfo) {
-            m_Buffer = buffer.GetVkBuffer();
-            if (createInfo.IsRawView) {
-                vk::BufferViewCreateInfo bufferViewCI = {
-                    .buffer = buffer.GetVkBuffer(),
-                    .format = static_cast<vk::Format>(createInfo.Format),
-                    .offset = createInfo.Offset,
-                    .range = createInfo.Range
-                };
-                m_pBufferView = device.GetVkDevice().createBufferViewUnique(bufferViewCI);
-            }
-        }
-
-        auto GetVkBufferView() const -> vk::BufferView { return m_pBufferView.get(); }
-
-        auto GetVkBuffer() const -> vk::Buffer { return m_Buffer; }
-
-    private:
-        vk::Buffer           m_Buffer;
-        vk::UniqueBufferView m_pBufferView;
-    };
-
-    class TextureView {
-    public:
-        TextureView(Device const& device) {
-            
-        }
-
-    private:
-        vk::ImageViewCreateInfo m_CreateInfo;
-        vk::UniqueImageView     m_pImageView;
-        
-    };
-
-    class Texture {
-    public:
-        Texture(TextureCreateInfo const& createInfo) { }
-        
-       
+namespace HAL {
 
-    private:
-        vma::UniqueAllocation m_pAllocation;
-        vk::UniqueImage       m_pImage;
-    };
- 
     class Sampler;
     
     class DescriptorAllocator;
@@ -507,12 +394,10 @@ int main(int argc, char* argv[]) {
     auto pHALComputeCommandQueue  = &pHALDevice->GetComputeCommandQueue();
     auto pHALTransferCommandQueue = &pHALDevice->GetTransferCommandQueue();
 
-    auto pHALGraphicsCmdAllocator = std::make_unique<HAL::GraphicsCommandAllocator>(*pHALDevice);
-    auto pHALComputeCmdAllocator  = std::make_unique<HAL::ComputeCommandAllocator>(*pHALDevice);
-    auto pHALTransferCmdAllocator = std::make_unique<HAL::TransferCommandAllocator>(*pHALDevice);
+    auto pHALCommandAllocatorRing = std::make_unique<HAL::CommandAllocatorRing>(*pHALDevice, HAL::CommandAllocatorRingCreateInfo{});
 
-    MemoryStatisticGPU memoryGPU = { pHALDevice->GetVkPhysicalDevice() };
-    MemoryStatisticCPU memoryCPU;
+    MemoryStatisticGPU memoryGPU = { *pHALDevice };
+    MemoryStatisticCPU memoryCPU = { *pHALInstance };
 
     std::unique_ptr<HAL::RenderPass> pHALRenderPass; {
         vk::AttachmentDescription attachments[] = {
@@ -548,8 +433,8 @@ int main(int argc, char* argv[]) {
         pHALRenderPass = std::make_unique<HAL::RenderPass>(*pHALDevice, renderPassCI);
     } 
 
-    auto pHALCommandList = std::make_unique<HAL::GraphicsCommandList>(*pHALGraphicsCmdAllocator);
     auto pHALFence = std::make_unique<HAL::Fence>(*pHALDevice);
+    auto pHALUploadBatcher = std::make_unique<HAL::UploadBatcher>(*pHALDevice, HAL::UploadBatcherCreateInfo{});
     
     std::unique_ptr<HAL::ShaderCompiler> pHALCompiler; {
         HAL::ShaderCompilerCreateInfo shaderCompilerCI = {
@@ -609,7 +494,7 @@ int main(int argc, char* argv[]) {
     struct WindowUserData {
         HAL::CommandQueue* pCommandQueue;
         HAL::SwapChain*    pSwapChain;
-    } GLFWUserData = { (HAL::CommandQueue*)pHALComputeCommandQueue, pHALSwapChain.get() };
+    } GLFWUserData = { (HAL::CommandQueue*)pHALGraphicsCommandQueue, pHALSwapChain.get() };
 
    
     glfwSetWindowUserPointer(pWindow.get(), &GLFWUserData);
@@ -679,6 +564,7 @@ int main(int argc, char* argv[]) {
                 frameIndex++;
             }
       
+            memoryGPU.Update();
             if (ImGui::CollapsingHeader("Memory Statistic")) {
                 auto memoryType = [](MemoryStatisticGPU::HeapType type) -> std::string {
                     switch (type) {
@@ -689,18 +575,18 @@ int main(int argc, char* argv[]) {
                 };
                 
                 float maxMemorySize = 0.0f;
-                float maxMemoryTime = 0.0f;
+                float maxMemoryTime = static_cast<float>(memoryGPU.GetTimePoint());
    
                 for (auto const& heap : memoryGPU.GetMemoryStatistic()) {
                     auto id = fmt::format("Memory Heap: [{0}] Type: {1}", heap.MemoryIndex, memoryType(heap.MemoryType));
                     if (ImGui::TreeNode(id.c_str())) {
                         ImGui::BulletText("Memory size: %imb", heap.MemorySize >> 20);
                         ImGui::BulletText("Memory used: %imb", heap.MemoryUsed >> 20);
+                        ImGui::BulletText("Memory peak: %imb", heap.MemoryPeak >> 20);
                         ImGui::BulletText("Allocations count: %i", heap.MemoryCount);     
                         ImGui::TreePop();
                     }    
                     maxMemorySize = std::max(maxMemorySize, static_cast<float>(heap.MemorySize >> 20));
-                    maxMemoryTime = std::max(maxMemoryTime, static_cast<float>(heap.MemoryFrames.back().TimePoint));
                 }  
                
                 if (ImGui::TreeNode("Show Graphics ##Memory Statistic")) {
@@ -710,20 +596,33 @@ int main(int argc, char* argv[]) {
    
                     if (ImPlot::BeginPlot("##MemoryStatistic", 0, 0, ImVec2(-1, 175), 0, ImPlotAxisFlags_None, ImPlotAxisFlags_None)) {
                         for (auto const& heap : memoryGPU.GetMemoryStatistic()) {
-                            std::vector<ImVec2> memoryFrames{};
-                            std::transform(std::begin(heap.MemoryFrames), std::end(heap.MemoryFrames), std::back_inserter(memoryFrames), [](auto x) -> ImVec2 { return ImVec2(static_cast<float>(x.TimePoint), static_cast<float>(x.MemoryUsed >> 20)); });
+                            auto const& memoryFrames = heap.MemoryFrames;
    
                             auto id = fmt::format("Heap: [{0}] Type: {1}", heap.MemoryIndex, memoryType(heap.MemoryType));
                             ImPlot::PushStyleVar(ImPlotStyleVar_FillAlpha, 0.25f);
-                            ImPlot::PlotShaded(id.c_str(), &memoryFrames[0].x, &memoryFrames[0].y, static_cast<int32_t>(std::size(memoryFrames)), 0, 0, sizeof(ImVec2));
+                            ImPlot::PlotShaded(id.c_str(), &memoryFrames.Data[0].x, &memoryFrames.Data[0].y, static_cast<int32_t>(std::size(memoryFrames.Data)), 0, memoryFrames.Offset, sizeof(ImVec2));
                             ImPlot::PopStyleVar();
-                            ImPlot::PlotLine(id.c_str(), &memoryFrames[0].x, &memoryFrames[0].y, static_cast<int32_t>(std::size(memoryFrames)), 0, sizeof(ImVec2));
-                            ImPlot::PlotScatter(id.c_str(), &memoryFrames[0].x, &memoryFrames[0].y, static_cast<int32_t>(std::size(memoryFrames)), 0, sizeof(ImVec2));
+                            ImPlot::PlotLine(id.c_str(), &memoryFrames.Data[0].x, &memoryFrames.Data[0].y, static_cast<int32_t>(std::size(memoryFrames.Data)), memoryFrames.Offset, sizeof(ImVec2));
+                            ImPlot::PlotScatter(id.c_str(), &memoryFrames.Data[0].x, &memoryFrames.Data[0].y, static_cast<int32_t>(std::size(memoryFrames.Data)), memoryFrames.Offset, sizeof(ImVec2));
                         }
                         ImPlot::EndPlot();
                     }
                     ImGui::TreePop();
                 }      
+
+                memoryCPU.Update();
+                if (ImGui::TreeNode("Host Memory ##Memory Statistic")) {
+                    auto const& statistic = memoryCPU.GetMemoryStatistic();
+                    for (size_t index = 0; index < std::size(statistic.Tags); index++) {
+                        auto const& counter = statistic.Tags[index];
+                        ImGui::BulletText("%s: %ikb (peak %ikb), allocations: %i, total: %i", MemoryStatisticCPU::GetTagName(static_cast<HAL::HostMemoryTag>(index)), 
+                            static_cast<int32_t>(counter.AllocatedBytes >> 10), static_cast<int32_t>(counter.PeakBytes >> 10), static_cast<int32_t>(counter.AllocationCount), static_cast<int32_t>(counter.TotalAllocationCount));
+                    }
+                    ImGui::BulletText("Arena reserved: %ikb", static_cast<int32_t>(statistic.ArenaReservedBytes >> 10));
+                    ImGui::BulletText("Pool reserved: %ikb", static_cast<int32_t>(statistic.PoolReservedBytes >> 10));
+                    ImGui::BulletText("Driver internal: %ikb", static_cast<int32_t>(statistic.InternalAllocatedBytes >> 10));
+                    ImGui::TreePop();
+                }
             }              
         }
 
@@ -737,11 +636,19 @@ int main(int argc, char* argv[]) {
         //Wait until the previous frame is finished
         if (!pHALFence->IsCompleted())        
             pHALFence->Wait(pHALFence->GetExpectedValue());
+
+        //Release resources retired by completed frames
+        pHALDevice->NextFrame();
+        pHALDevice->Defragment(*pHALFence);
+
+        //Submit the uploads gathered this frame; the graphics queue waits on them before the frame's work
+        pHALUploadBatcher->Flush();
         
-        //Acquire Image and signal fence
-        uint32_t frameID = pHALComputeCommandQueue->NextImage(*pHALSwapChain, *pHALFence, pHALFence->Increment());
+        //Acquire Image; the batch below waits on it directly instead of bridging it to the fence
+        uint32_t frameID = pHALGraphicsCommandQueue->AcquireNextImage(*pHALSwapChain);
      
         //Render pass
+        auto pHALCommandList = &pHALCommandAllocatorRing->AllocateGraphicsCommandList();
         pHALCommandList->Begin();
         {
             HAL::RenderPassAttachmentInfo renderPassAttachments[] = {
@@ -762,6 +669,8 @@ int main(int argc, char* argv[]) {
             pHALCommandList->BeginRenderPass({.pRenderPass = pHALRenderPass.get(), .Attachments = renderPassAttachments});
             ImGui_ImplVulkan_NewFrame(pHALCommandList->GetVkCommandBuffer());               
             pHALCommandList->EndRenderPass();
+            //ImGui binds its own pipeline and descriptor sets behind the shadowed state
+            pHALCommandList->InvalidateState();
 
             pHALCommandList->SetComputePipeline(*pHALComputePipeline, {});
           //  pHALCommandList->SetDescriptorTable(0, HALDescriptorTable);
@@ -772,13 +681,14 @@ int main(int argc, char* argv[]) {
      
      
 
-        //Wait fence nad Execute command List
-        pHALGraphicsCommandQueue->Wait(*pHALFence, pHALFence->GetExpectedValue());  
-        pHALGraphicsCommandQueue->ExecuteCommandLists({*pHALCommandList});
-        pHALGraphicsCommandQueue->Signal(*pHALFence, pHALFence->Increment());
-     
-        //Wait fence and present
-        pHALComputeCommandQueue->Present(*pHALSwapChain, frameID, *pHALFence);
+        //Wait image, execute command list, signal fence and present in a single submit
+        HAL::SubmitBatch submitBatch;
+        submitBatch.WaitImage(*pHALSwapChain)
+            .Execute(*pHALCommandList)
+            .Signal(*pHALFence, pHALFence->Increment())
+            .Present(*pHALSwapChain, frameID);
+        pHALGraphicsCommandQueue->Submit(submitBatch);
+        pHALCommandAllocatorRing->NextFrame(*pHALFence);
         //------------------------------//
 
 
@@ -0,0 +1,396 @@
+#include <HAL/Instance.hpp>
+#include <HAL/Device.hpp>
+#include <HAL/Fence.hpp>
+#include <HAL/Buffer.hpp>
+#include <HAL/CommandAllocator.hpp>
+#include <HAL/CommandList.hpp>
+#include <HAL/CommandQueue.hpp>
+#include <HAL/SubmitBatch.hpp>
+#include <HAL/ShaderCompiler.hpp>
+#include <HAL/Texture.hpp>
+#include <HAL/InstanceCuller.hpp>
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+//Culls random bounding spheres on the GPU and compares the compacted draws against a CPU frustum cull, then again
+//with a synthetic depth pyramid against a CPU occlusion cull.
+//Meant to run headless on a software ICD such as lavapipe or SwiftShader, selected through VK_ICD_FILENAMES.
+//Spheres that touch a plane, a texel edge or an occluder depth within the tolerance are skipped, so float rounding on
+//the GPU cannot fail the test
+
+constexpr uint32_t InstanceCount = 1000;
+
+constexpr uint32_t DepthPyramidSize = 64;
+
+constexpr uint32_t DepthPyramidTileSize = 8;
+
+constexpr double PlaneTolerance = 1.0e-3;
+
+constexpr double TexelTolerance = 1.0e-2;
+
+constexpr double DepthTolerance = 1.0e-4;
+
+enum class CullResult {
+    Visible,
+    Culled,
+    Ambiguous
+};
+
+//Level 0 is the full resolution; every level holds the farthest depth of the 2x2 texels below it
+struct DepthPyramid {
+    std::vector<std::vector<float>> Levels = {};
+};
+
+static auto GetViewCenter(HAL::InstanceCullingCamera const& camera, HAL::CullInstance const& instance) -> std::array<double, 3> {
+    std::array<double, 3> center = {};
+    for (uint32_t row = 0; row < 3; row++) {
+        center[row] = camera.View[row][3];
+        for (uint32_t column = 0; column < 3; column++)
+            center[row] += static_cast<double>(camera.View[row][column]) * instance.BoundingSphere[column];
+    }
+    return center;
+}
+
+//Mirrors IsInsideFrustum in content/shaders/InstanceCulling.hlsl in double precision
+static auto CullSphere(HAL::InstanceCullingCamera const& camera, HAL::CullInstance const& instance) -> CullResult {
+    auto center = GetViewCenter(camera, instance);
+    double radius = instance.BoundingSphere[3];
+
+    double p00 = std::abs(camera.P00);
+    double p11 = std::abs(camera.P11);
+    double distances[] = {
+        center[2] + radius - camera.ZNear,
+        camera.ZFar - (center[2] - radius),
+        (center[2] - std::abs(center[0]) * p00) / std::sqrt(1.0 + p00 * p00) + radius,
+        (center[2] - std::abs(center[1]) * p11) / std::sqrt(1.0 + p11 * p11) + radius
+    };
+
+    double distance = *std::min_element(std::begin(distances), std::end(distances));
+    if (std::abs(distance) < PlaneTolerance)
+        return CullResult::Ambiguous;
+    return distance > 0.0 ? CullResult::Visible : CullResult::Culled;
+}
+
+//Mirrors IsOccluded in content/shaders/InstanceCulling.hlsl in double precision. The texel a bound falls into and the
+//mip the bounds select are only taken when they are away from a boundary the float math on the GPU could round across
+static auto OccludeSphere(HAL::InstanceCullingCamera const& camera, DepthPyramid const& pyramid, HAL::CullInstance const& instance) -> CullResult {
+    auto center = GetViewCenter(camera, instance);
+    double radius = instance.BoundingSphere[3];
+
+    double nearDistance = center[2] - radius - camera.ZNear;
+    if (std::abs(nearDistance) < PlaneTolerance)
+        return CullResult::Ambiguous;
+    if (nearDistance < 0.0)
+        return CullResult::Visible;
+
+    auto ProjectAxis = [&](double axis, double scale, double sign, double& minBound, double& maxBound) -> void {
+        double tangent = std::sqrt(axis * axis + center[2] * center[2] - radius * radius);
+        double minimum = (axis * tangent - center[2] * radius) / (axis * radius + center[2] * tangent);
+        double maximum = (axis * tangent + center[2] * radius) / (center[2] * tangent - axis * radius);
+        minBound = (sign > 0.0 ? minimum : -maximum) * scale * 0.5 + 0.5;
+        maxBound = (sign > 0.0 ? maximum : -minimum) * scale * 0.5 + 0.5;
+    };
+
+    double bounds[4] = {};
+    ProjectAxis(center[0], camera.P00, 1.0, bounds[0], bounds[2]);
+    ProjectAxis(center[1], camera.P11, -1.0, bounds[1], bounds[3]);
+    for (auto& bound : bounds)
+        bound = std::clamp(bound, 0.0, 1.0);
+
+    double size = std::max((bounds[2] - bounds[0]) * DepthPyramidSize, (bounds[3] - bounds[1]) * DepthPyramidSize);
+    double exponent = std::log2(std::max(size, 0.5));
+    if (size > 0.5 && std::abs(exponent - std::round(exponent)) < TexelTolerance)
+        return CullResult::Ambiguous;
+
+    uint32_t level = std::min(static_cast<uint32_t>(std::ceil(std::max(exponent, 0.0))), static_cast<uint32_t>(std::size(pyramid.Levels)) - 1);
+    uint32_t levelSize = std::max(DepthPyramidSize >> level, 1u);
+
+    uint32_t texels[4] = {};
+    for (uint32_t index = 0; index < 4; index++) {
+        double texel = bounds[index] * levelSize;
+        double edge = std::round(texel);
+        if (edge > 0.0 && edge < levelSize && std::abs(texel - edge) < TexelTolerance)
+            return CullResult::Ambiguous;
+        texels[index] = static_cast<uint32_t>(std::min(texel, levelSize - 1.0));
+    }
+
+    auto const& depths = pyramid.Levels[level];
+    double depth = std::max({
+        depths[texels[1] * levelSize + texels[0]], depths[texels[1] * levelSize + texels[2]],
+        depths[texels[3] * levelSize + texels[0]], depths[texels[3] * levelSize + texels[2]]
+    });
+
+    double sphereDepth = camera.P22 + camera.P23 / (center[2] - radius);
+    if (std::abs(sphereDepth - depth) < DepthTolerance)
+        return CullResult::Ambiguous;
+    return sphereDepth > depth ? CullResult::Culled : CullResult::Visible;
+}
+
+static auto CullSphere(HAL::InstanceCullingCamera const& camera, DepthPyramid const& pyramid, HAL::CullInstance const& instance) -> CullResult {
+    auto result = CullSphere(camera, instance);
+    return result == CullResult::Visible ? OccludeSphere(camera, pyramid, instance) : result;
+}
+
+//Rotates the world around Y by the angle and then moves it by the offset; the projection is a symmetric perspective
+//with depth 0 at the near and 1 at the far plane, as the farthest depth in the pyramid is its maximum
+static auto GetCamera(float angle, float offsetX, float offsetZ, float fovY, float aspect) -> HAL::InstanceCullingCamera {
+    float zNear = 0.1f;
+    float zFar = 100.0f;
+    float p11 = 1.0f / std::tan(0.5f * fovY);
+    return HAL::InstanceCullingCamera{
+        .View = {
+            { std::cos(angle), 0.0f, -std::sin(angle), offsetX },
+            { 0.0f,            1.0f, 0.0f,             0.0f    },
+            { std::sin(angle), 0.0f, std::cos(angle),  offsetZ }
+        },
+        .P00 = p11 / aspect,
+        .P11 = p11,
+        .P22 = zFar / (zFar - zNear),
+        .P23 = zNear * zFar / (zNear - zFar),
+        .ZNear = zNear,
+        .ZFar = zFar
+    };
+}
+
+static auto GenerateInstances(uint32_t instanceCount) -> std::vector<HAL::CullInstance> {
+    std::mt19937 generator(0x5EED);
+    std::uniform_real_distribution<float> lateral(-60.0f, 60.0f);
+    std::uniform_real_distribution<float> depth(-20.0f, 120.0f);
+    std::uniform_real_distribution<float> radius(0.05f, 4.0f);
+
+    std::vector<HAL::CullInstance> instances(instanceCount);
+    for (uint32_t index = 0; index < instanceCount; index++) {
+        instances[index] = HAL::CullInstance{
+            .BoundingSphere = { lateral(generator), lateral(generator), depth(generator), radius(generator) },
+            .IndexCount = 3 * (index + 1),
+            .FirstIndex = 7 * index,
+            .VertexOffset = -static_cast<int32_t>(index)
+        };
+    }
+    return instances;
+}
+
+//Square tiles either hold an occluder at a random view depth or stay at the far plane
+static auto GenerateDepthPyramid(HAL::InstanceCullingCamera const& camera) -> DepthPyramid {
+    std::mt19937 generator(0xDE97);
+    std::bernoulli_distribution isOccluder(0.6);
+    std::uniform_real_distribution<float> occluderDepth(2.0f, 40.0f);
+
+    constexpr uint32_t TileCount = DepthPyramidSize / DepthPyramidTileSize;
+    std::vector<float> tiles(TileCount * TileCount);
+    for (auto& tile : tiles)
+        tile = isOccluder(generator) ? camera.P22 + camera.P23 / occluderDepth(generator) : 1.0f;
+
+    DepthPyramid pyramid = {};
+    auto& base = pyramid.Levels.emplace_back(DepthPyramidSize * DepthPyramidSize);
+    for (uint32_t y = 0; y < DepthPyramidSize; y++) {
+        for (uint32_t x = 0; x < DepthPyramidSize; x++)
+            base[y * DepthPyramidSize + x] = tiles[(y / DepthPyramidTileSize) * TileCount + x / DepthPyramidTileSize];
+    }
+
+    for (uint32_t levelSize = DepthPyramidSize / 2; levelSize > 0; levelSize /= 2) {
+        auto const& source = pyramid.Levels.back();
+        std::vector<float> level(levelSize * levelSize);
+        for (uint32_t y = 0; y < levelSize; y++) {
+            for (uint32_t x = 0; x < levelSize; x++) {
+                uint32_t sourceIndex = 2 * y * 2 * levelSize + 2 * x;
+                level[y * levelSize + x] = std::max({source[sourceIndex], source[sourceIndex + 1], source[sourceIndex + 2 * levelSize], source[sourceIndex + 2 * levelSize + 1]});
+            }
+        }
+        pyramid.Levels.push_back(std::move(level));
+    }
+    return pyramid;
+}
+
+//Returns the number of mismatches between the GPU output and the CPU reference
+static auto Validate(std::vector<CullResult> const& expected, std::vector<HAL::CullInstance> const& instances, uint32_t drawCount, uint32_t const* pVisibleInstances, vk::DrawIndexedIndirectCommand const* pDrawArguments) -> uint32_t {
+    uint32_t errorCount = 0;
+    if (drawCount > std::size(instances)) {
+        fmt::print("Error: draw count {} exceeds the instance count {} \n", drawCount, std::size(instances));
+        return 1;
+    }
+
+    //Survivors are compacted in whatever order the waves reach the counter, so only the set is compared
+    std::vector<bool> isVisibleGPU(std::size(instances));
+    for (uint32_t slot = 0; slot < drawCount; slot++) {
+        uint32_t instanceID = pVisibleInstances[slot];
+        if (instanceID >= std::size(instances) || isVisibleGPU[instanceID]) {
+            fmt::print("Error: slot {} holds an invalid or repeated instance {} \n", slot, instanceID);
+            errorCount++;
+            continue;
+        }
+        isVisibleGPU[instanceID] = true;
+
+        auto const& instance = instances[instanceID];
+        auto const& command = pDrawArguments[slot];
+        if (command.indexCount != instance.IndexCount || command.instanceCount != 1 || command.firstIndex != instance.FirstIndex ||
+            command.vertexOffset != instance.VertexOffset || command.firstInstance != instanceID) {
+            fmt::print("Error: draw arguments in slot {} do not match instance {} \n", slot, instanceID);
+            errorCount++;
+        }
+    }
+
+    for (uint32_t index = 0; index < std::size(instances); index++) {
+        if (expected[index] == CullResult::Ambiguous)
+            continue;
+        if ((expected[index] == CullResult::Visible) != isVisibleGPU[index]) {
+            fmt::print("Error: instance {} is {} on the GPU but {} on the CPU \n", index, isVisibleGPU[index] ? "visible" : "culled", expected[index] == CullResult::Visible ? "visible" : "culled");
+            errorCount++;
+        }
+    }
+    return errorCount;
+}
+
+int main() {
+    auto pInstance = std::make_unique<HAL::Instance>(HAL::InstanceCreateInfo{});
+    if (pInstance->GetAdapters().empty()) {
+        fmt::print("Error: No Vulkan adapter found \n");
+        return 1;
+    }
+    auto pDevice = std::make_unique<HAL::Device>(*pInstance, pInstance->GetAdapters().at(0), HAL::DeviceCreateInfo{});
+
+    auto pCompiler = std::make_unique<HAL::ShaderCompiler>(HAL::ShaderCompilerCreateInfo{
+        .ShaderModelVersion = HAL::ShaderModel::SM_6_5,
+        .IsDebugMode = false
+    });
+    auto pCuller = std::make_unique<HAL::InstanceCuller>(*pDevice, HAL::InstanceCullerCreateInfo{.pCompiler = pCompiler.get()});
+
+    auto instances = GenerateInstances(InstanceCount);
+
+    //Software ICDs only expose host-coherent memory, so the mapped outputs need no explicit invalidation
+    HAL::Buffer instanceBuffer(*pDevice, HAL::BufferCreateInfo{
+        .Size = InstanceCount * sizeof(HAL::CullInstance),
+        .Usage = vk::BufferUsageFlagBits::eStorageBuffer,
+        .MemoryUsage = vma::MemoryUsage::eCpuToGpu
+    });
+    HAL::Buffer visibleInstanceBuffer(*pDevice, HAL::BufferCreateInfo{
+        .Size = InstanceCount * sizeof(uint32_t),
+        .Usage = vk::BufferUsageFlagBits::eStorageBuffer,
+        .MemoryUsage = vma::MemoryUsage::eGpuToCpu
+    });
+    HAL::Buffer drawArgumentBuffer(*pDevice, HAL::BufferCreateInfo{
+        .Size = InstanceCount * sizeof(vk::DrawIndexedIndirectCommand),
+        .Usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+        .MemoryUsage = vma::MemoryUsage::eGpuToCpu
+    });
+    HAL::Buffer drawCountBuffer(*pDevice, HAL::BufferCreateInfo{
+        .Size = sizeof(uint32_t),
+        .Usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst,
+        .MemoryUsage = vma::MemoryUsage::eGpuToCpu
+    });
+    std::memcpy(instanceBuffer.GetMappedData(), std::data(instances), std::size(instances) * sizeof(HAL::CullInstance));
+
+    HAL::InstanceCullingCamera cameras[] = {
+        GetCamera(0.0f, 0.0f, 0.0f, 1.5f, 1.0f),
+        GetCamera(0.6f, 5.0f, -10.0f, 1.0f, 16.0f / 9.0f),
+        GetCamera(-2.5f, -20.0f, 30.0f, 0.4f, 0.5f)
+    };
+
+    //Every camera shares the near and far planes, so one pyramid serves all of them
+    auto pyramid = GenerateDepthPyramid(cameras[0]);
+    HAL::Texture depthPyramid(*pDevice, HAL::TextureCreateInfo{
+        .Format = vk::Format::eR32Sfloat,
+        .Width = DepthPyramidSize,
+        .Height = DepthPyramidSize,
+        .MipLevels = static_cast<uint32_t>(std::size(pyramid.Levels)),
+        .Usage = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst
+    });
+    HAL::TextureView depthPyramidView(*pDevice, depthPyramid, HAL::TextureViewCreateInfo{.Format = vk::Format::eR32Sfloat});
+
+    uint64_t pyramidSize = 0;
+    for (auto const& level : pyramid.Levels)
+        pyramidSize += std::size(level) * sizeof(float);
+
+    HAL::Buffer pyramidUploadBuffer(*pDevice, HAL::BufferCreateInfo{
+        .Size = pyramidSize,
+        .Usage = vk::BufferUsageFlagBits::eTransferSrc,
+        .MemoryUsage = vma::MemoryUsage::eCpuToGpu
+    });
+
+    std::vector<vk::BufferImageCopy> pyramidRegions;
+    uint64_t levelOffset = 0;
+    for (uint32_t level = 0; level < std::size(pyramid.Levels); level++) {
+        uint32_t levelSize = DepthPyramidSize >> level;
+        std::memcpy(static_cast<uint8_t*>(pyramidUploadBuffer.GetMappedData()) + levelOffset, std::data(pyramid.Levels[level]), std::size(pyramid.Levels[level]) * sizeof(float));
+        pyramidRegions.push_back(vk::BufferImageCopy{
+            .bufferOffset = pyramidUploadBuffer.GetOffset() + levelOffset,
+            .imageSubresource = vk::ImageSubresourceLayers{.aspectMask = vk::ImageAspectFlagBits::eColor, .mipLevel = level, .layerCount = 1},
+            .imageExtent = vk::Extent3D{levelSize, levelSize, 1}
+        });
+        levelOffset += std::size(pyramid.Levels[level]) * sizeof(float);
+    }
+
+    //Software ICDs rarely expose a separate compute family, so the culling runs on the graphics queue
+    HAL::GraphicsCommandAllocator allocator(*pDevice);
+    HAL::GraphicsCommandList cmdList(allocator);
+    HAL::Fence fence(*pDevice);
+
+    bool isPyramidUploaded = false;
+    auto RunCulling = [&](HAL::InstanceCullingCamera const& camera, bool isOcclusionEnabled) -> uint32_t {
+        cmdList.Begin();
+        if (isOcclusionEnabled && !isPyramidUploaded) {
+            cmdList.TransitionTexture(depthPyramid, HAL::ResourceState::CopyDest);
+            cmdList.FlushBarriers();
+            cmdList.GetVkCommandBuffer().copyBufferToImage(pyramidUploadBuffer.GetVkBuffer(), depthPyramid.GetVkImage(), vk::ImageLayout::eTransferDstOptimal, pyramidRegions);
+            isPyramidUploaded = true;
+        }
+        pCuller->Cull(cmdList, HAL::InstanceCullingInfo{
+            .pInstances = &instanceBuffer,
+            .pVisibleInstances = &visibleInstanceBuffer,
+            .pDrawArguments = &drawArgumentBuffer,
+            .pDrawCount = &drawCountBuffer,
+            .pDepthPyramid = isOcclusionEnabled ? &depthPyramid : nullptr,
+            .pDepthPyramidView = isOcclusionEnabled ? &depthPyramidView : nullptr,
+            .InstanceCount = InstanceCount,
+            .Camera = camera
+        });
+        //The outputs are read on the host, which the tracked resource states do not cover
+        cmdList.FlushBarriers();
+        vk::MemoryBarrier hostBarrier = {
+            .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+            .dstAccessMask = vk::AccessFlagBits::eHostRead
+        };
+        cmdList.GetVkCommandBuffer().pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost, {}, hostBarrier, {}, {});
+        cmdList.End();
+
+        HAL::SubmitBatch submitBatch;
+        submitBatch.Execute(cmdList).Signal(fence, fence.Increment());
+        pDevice->GetGraphicsCommandQueue().Submit(submitBatch);
+        pCuller->NextFrame(fence);
+        fence.Wait(fence.GetExpectedValue());
+
+        std::vector<CullResult> expected(InstanceCount);
+        for (uint32_t index = 0; index < InstanceCount; index++)
+            expected[index] = isOcclusionEnabled ? CullSphere(camera, pyramid, instances[index]) : CullSphere(camera, instances[index]);
+
+        uint32_t drawCount = *static_cast<uint32_t const*>(drawCountBuffer.GetMappedData());
+        uint32_t mismatchCount = Validate(expected, instances, drawCount,
+            static_cast<uint32_t const*>(visibleInstanceBuffer.GetMappedData()),
+            static_cast<vk::DrawIndexedIndirectCommand const*>(drawArgumentBuffer.GetMappedData()));
+
+        fmt::print("{} {} of {} instances visible, {} mismatches \n", isOcclusionEnabled ? "occlusion:" : "frustum:  ", drawCount, InstanceCount, mismatchCount);
+        return mismatchCount;
+    };
+
+    uint32_t errorCount = 0;
+    for (uint32_t cameraIndex = 0; cameraIndex < std::size(cameras); cameraIndex++) {
+        fmt::print("Camera {} \n", cameraIndex);
+        errorCount += RunCulling(cameras[cameraIndex], false);
+        errorCount += RunCulling(cameras[cameraIndex], true);
+    }
+
+    if (errorCount > 0) {
+        fmt::print("Error: GPU instance culling differs from the CPU reference \n");
+        return 1;
+    }
+    fmt::print("Instance culling matches the CPU reference \n");
+    return 0;
+}
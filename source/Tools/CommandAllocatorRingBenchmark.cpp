@@ -0,0 +1,128 @@
+#include <HAL/Instance.hpp>
+#include <HAL/Device.hpp>
+#include <HAL/Fence.hpp>
+#include <HAL/CommandAllocator.hpp>
+#include <HAL/CommandAllocatorRing.hpp>
+#include <HAL/CommandList.hpp>
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+//Measures the CPU cost of beginning and ending command lists per frame for the two recycling strategies:
+//lists that reset themselves on Begin from an eResetCommandBuffer pool, and CommandAllocatorRing with whole-pool resets.
+//The frames are retired with host signals, so only command buffer begin and reset cost is measured.
+//Usage: CommandAllocatorRingBenchmark [--lists <count>] [--frames <count>]
+
+struct BenchmarkInfo {
+    uint32_t ListCount = 64;
+    uint32_t FrameCount = 1000;
+    uint32_t WarmupFrameCount = 16;
+    uint32_t RingFrameCount = 3;
+};
+
+struct BenchmarkResult {
+    double FrameTime = {};
+    double ListTime = {};
+};
+
+using BenchmarkClock = std::chrono::steady_clock;
+
+static auto GetResult(BenchmarkInfo const& info, BenchmarkClock::duration duration) -> BenchmarkResult {
+    double microseconds = std::chrono::duration<double, std::micro>(duration).count();
+    return BenchmarkResult{
+        .FrameTime = microseconds / info.FrameCount,
+        .ListTime = microseconds / (static_cast<double>(info.FrameCount) * info.ListCount)
+    };
+}
+
+static auto RunPerListReset(HAL::Device const& device, BenchmarkInfo const& info) -> BenchmarkResult {
+    HAL::GraphicsCommandAllocator allocator(device, HAL::CommandAllocatorResetMode::CommandList);
+
+    //Every frame has its own lists, so a list is never begun while the frame that recorded it may be pending
+    std::vector<std::vector<HAL::GraphicsCommandList>> frames(info.RingFrameCount);
+    for (auto& cmdLists : frames) {
+        for (uint32_t index = 0; index < info.ListCount; index++)
+            cmdLists.emplace_back(allocator);
+    }
+
+    HAL::Fence fence(device);
+    auto RunFrame = [&](uint32_t frameIndex) -> void {
+        for (auto& cmdList : frames[frameIndex % info.RingFrameCount]) {
+            cmdList.Begin();
+            cmdList.End();
+        }
+        fence.Signal(fence.Increment());
+    };
+
+    for (uint32_t frameIndex = 0; frameIndex < info.WarmupFrameCount; frameIndex++)
+        RunFrame(frameIndex);
+
+    auto begin = BenchmarkClock::now();
+    for (uint32_t frameIndex = 0; frameIndex < info.FrameCount; frameIndex++)
+        RunFrame(frameIndex);
+    return GetResult(info, BenchmarkClock::now() - begin);
+}
+
+static auto RunRingReset(HAL::Device const& device, BenchmarkInfo const& info) -> BenchmarkResult {
+    HAL::CommandAllocatorRing ring(device, HAL::CommandAllocatorRingCreateInfo{.FrameCount = info.RingFrameCount});
+
+    HAL::Fence fence(device);
+    auto RunFrame = [&]() -> void {
+        for (uint32_t index = 0; index < info.ListCount; index++) {
+            auto& cmdList = ring.AllocateGraphicsCommandList();
+            cmdList.Begin();
+            cmdList.End();
+        }
+        auto value = fence.Increment();
+        fence.Signal(value);
+        ring.NextFrame(fence, value);
+    };
+
+    //The first frames of the ring allocate their lists, later ones only recycle them
+    for (uint32_t frameIndex = 0; frameIndex < info.WarmupFrameCount; frameIndex++)
+        RunFrame();
+
+    auto begin = BenchmarkClock::now();
+    for (uint32_t frameIndex = 0; frameIndex < info.FrameCount; frameIndex++)
+        RunFrame();
+    return GetResult(info, BenchmarkClock::now() - begin);
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkInfo info = {};
+    for (int index = 1; index < argc; index++) {
+        if (std::strcmp(argv[index], "--lists") == 0 && index + 1 < argc) {
+            info.ListCount = std::max<uint32_t>(std::stoul(argv[++index]), 1);
+        } else if (std::strcmp(argv[index], "--frames") == 0 && index + 1 < argc) {
+            info.FrameCount = std::max<uint32_t>(std::stoul(argv[++index]), 1);
+        } else {
+            fmt::print("Usage: CommandAllocatorRingBenchmark [--lists <count>] [--frames <count>] \n");
+            return 1;
+        }
+    }
+
+    auto pInstance = std::make_unique<HAL::Instance>(HAL::InstanceCreateInfo{});
+    if (pInstance->GetAdapters().empty()) {
+        fmt::print("Error: No Vulkan adapter found \n");
+        return 1;
+    }
+    auto pDevice = std::make_unique<HAL::Device>(*pInstance, pInstance->GetAdapters().at(0), HAL::DeviceCreateInfo{});
+
+    fmt::print("{} lists per frame, {} frames \n", info.ListCount, info.FrameCount);
+
+    auto perListResult = RunPerListReset(*pDevice, info);
+    fmt::print("Per-list reset: {:10.2f} us/frame {:8.3f} us/list \n", perListResult.FrameTime, perListResult.ListTime);
+
+    auto ringResult = RunRingReset(*pDevice, info);
+    fmt::print("Pool reset:     {:10.2f} us/frame {:8.3f} us/list \n", ringResult.FrameTime, ringResult.ListTime);
+
+    fmt::print("Speedup:        {:10.2f}x \n", perListResult.FrameTime / ringResult.FrameTime);
+    return 0;
+}
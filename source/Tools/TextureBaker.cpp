@@ -0,0 +1,286 @@
+#include <HAL/TextureContainer.hpp>
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+//Bakes PPM (P6) and uncompressed or RLE TGA images into a texture container.
+//Usage: TextureBaker [--srgb] [--no-mips] -o <output> <layer0> [<layer1> ...]
+
+struct Image {
+    uint32_t             Width = {};
+    uint32_t             Height = {};
+    std::vector<uint8_t> Texels = {};
+};
+
+static auto ReadFile(std::filesystem::path const& path) -> std::optional<std::vector<uint8_t>> {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return std::nullopt;
+
+    std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(std::data(data)), std::size(data));
+    return data;
+}
+
+static auto LoadPPM(std::vector<uint8_t> const& data) -> std::optional<Image> {
+    size_t position = 2;
+    auto ReadToken = [&]() -> std::optional<uint32_t> {
+        while (position < std::size(data)) {
+            if (data[position] == '#') {
+                while (position < std::size(data) && data[position] != '\n')
+                    position++;
+            } else if (std::isspace(data[position])) {
+                position++;
+            } else {
+                break;
+            }
+        }
+
+        if (position >= std::size(data) || !std::isdigit(data[position]))
+            return std::nullopt;
+
+        uint32_t value = 0;
+        while (position < std::size(data) && std::isdigit(data[position]))
+            value = value * 10 + (data[position++] - '0');
+        return value;
+    };
+
+    if (std::size(data) < 2 || data[0] != 'P' || data[1] != '6')
+        return std::nullopt;
+
+    auto width = ReadToken();
+    auto height = ReadToken();
+    auto maxValue = ReadToken();
+    if (!width || !height || maxValue != 255 || *width == 0 || *height == 0)
+        return std::nullopt;
+    position++;
+
+    uint64_t texelCount = uint64_t(*width) * *height;
+    if (position + texelCount * 3 > std::size(data))
+        return std::nullopt;
+
+    Image image = {.Width = *width, .Height = *height};
+    image.Texels.resize(texelCount * 4);
+    for (uint64_t index = 0; index < texelCount; index++) {
+        image.Texels[4 * index + 0] = data[position + 3 * index + 0];
+        image.Texels[4 * index + 1] = data[position + 3 * index + 1];
+        image.Texels[4 * index + 2] = data[position + 3 * index + 2];
+        image.Texels[4 * index + 3] = 255;
+    }
+    return image;
+}
+
+static auto LoadTGA(std::vector<uint8_t> const& data) -> std::optional<Image> {
+    constexpr size_t HeaderSize = 18;
+    if (std::size(data) < HeaderSize)
+        return std::nullopt;
+
+    uint32_t imageType = data[2];
+    uint32_t width = data[12] | (data[13] << 8);
+    uint32_t height = data[14] | (data[15] << 8);
+    uint32_t bytesPerPixel = data[16] / 8;
+    bool isTopLeft = data[17] & 0x20;
+
+    if ((imageType != 2 && imageType != 10) || (bytesPerPixel != 3 && bytesPerPixel != 4) || data[1] != 0 || width == 0 || height == 0)
+        return std::nullopt;
+
+    uint64_t texelCount = uint64_t(width) * height;
+    std::vector<uint8_t> pixels(texelCount * bytesPerPixel);
+
+    size_t position = HeaderSize + data[0];
+    if (imageType == 2) {
+        if (position + std::size(pixels) > std::size(data))
+            return std::nullopt;
+        std::memcpy(std::data(pixels), std::data(data) + position, std::size(pixels));
+    } else {
+        //Run-length packets: the high bit selects a repeated pixel, the low bits hold the count minus one
+        for (uint64_t index = 0; index < texelCount;) {
+            if (position >= std::size(data))
+                return std::nullopt;
+
+            uint8_t packet = data[position++];
+            uint64_t count = std::min<uint64_t>((packet & 0x7F) + 1, texelCount - index);
+            bool isRepeated = packet & 0x80;
+
+            uint64_t readSize = (isRepeated ? 1 : count) * bytesPerPixel;
+            if (position + readSize > std::size(data))
+                return std::nullopt;
+
+            for (uint64_t pixel = 0; pixel < count; pixel++) {
+                size_t source = position + (isRepeated ? 0 : pixel * bytesPerPixel);
+                std::memcpy(&pixels[(index + pixel) * bytesPerPixel], &data[source], bytesPerPixel);
+            }
+            position += readSize;
+            index += count;
+        }
+    }
+
+    Image image = {.Width = width, .Height = height};
+    image.Texels.resize(texelCount * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        uint32_t sourceY = isTopLeft ? y : height - 1 - y;
+        for (uint32_t x = 0; x < width; x++) {
+            auto pSource = &pixels[(uint64_t(sourceY) * width + x) * bytesPerPixel];
+            auto pDestination = &image.Texels[(uint64_t(y) * width + x) * 4];
+            pDestination[0] = pSource[2];
+            pDestination[1] = pSource[1];
+            pDestination[2] = pSource[0];
+            pDestination[3] = bytesPerPixel == 4 ? pSource[3] : 255;
+        }
+    }
+    return image;
+}
+
+static auto LoadImage(std::filesystem::path const& path) -> std::optional<Image> {
+    auto data = ReadFile(path);
+    if (!data)
+        return std::nullopt;
+
+    auto extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+    if (extension == ".ppm")
+        return LoadPPM(*data);
+    if (extension == ".tga")
+        return LoadTGA(*data);
+    return std::nullopt;
+}
+
+static auto DownsampleImage(Image const& image, bool isSRGB) -> Image {
+    auto ToLinear = [&](uint8_t value) -> float {
+        float c = value / 255.0f;
+        return isSRGB ? (c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f)) : c;
+    };
+
+    auto FromLinear = [&](float c) -> uint8_t {
+        c = isSRGB ? (c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f) : c;
+        return static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+    };
+
+    Image result = {.Width = std::max(image.Width / 2, 1u), .Height = std::max(image.Height / 2, 1u)};
+    result.Texels.resize(uint64_t(result.Width) * result.Height * 4);
+
+    //2x2 box filter; odd edges clamp to the last row or column
+    for (uint32_t y = 0; y < result.Height; y++) {
+        for (uint32_t x = 0; x < result.Width; x++) {
+            uint32_t x0 = std::min(2 * x, image.Width - 1);
+            uint32_t x1 = std::min(2 * x + 1, image.Width - 1);
+            uint32_t y0 = std::min(2 * y, image.Height - 1);
+            uint32_t y1 = std::min(2 * y + 1, image.Height - 1);
+
+            for (uint32_t channel = 0; channel < 4; channel++) {
+                auto Texel = [&](uint32_t sx, uint32_t sy) -> uint8_t { return image.Texels[(uint64_t(sy) * image.Width + sx) * 4 + channel]; };
+                if (channel == 3) {
+                    uint32_t sum = Texel(x0, y0) + Texel(x1, y0) + Texel(x0, y1) + Texel(x1, y1);
+                    result.Texels[(uint64_t(y) * result.Width + x) * 4 + channel] = static_cast<uint8_t>((sum + 2) / 4);
+                } else {
+                    float sum = ToLinear(Texel(x0, y0)) + ToLinear(Texel(x1, y0)) + ToLinear(Texel(x0, y1)) + ToLinear(Texel(x1, y1));
+                    result.Texels[(uint64_t(y) * result.Width + x) * 4 + channel] = FromLinear(0.25f * sum);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    bool isSRGB = false;
+    bool isMipsEnabled = true;
+    std::filesystem::path outputPath;
+    std::vector<std::filesystem::path> inputPaths;
+
+    for (int32_t index = 1; index < argc; index++) {
+        std::string_view argument = argv[index];
+        if (argument == "--srgb")
+            isSRGB = true;
+        else if (argument == "--no-mips")
+            isMipsEnabled = false;
+        else if (argument == "-o" && index + 1 < argc)
+            outputPath = argv[++index];
+        else
+            inputPaths.push_back(argument);
+    }
+
+    if (outputPath.empty() || inputPaths.empty()) {
+        fmt::print("Usage: TextureBaker [--srgb] [--no-mips] -o <output> <layer0> [<layer1> ...] \n");
+        return 1;
+    }
+
+    std::vector<std::vector<Image>> layers;
+    for (auto const& path : inputPaths) {
+        auto image = LoadImage(path);
+        if (!image) {
+            fmt::print("Error: Failed to load image {} \n", path.string());
+            return 1;
+        }
+
+        if (!layers.empty() && (image->Width != layers[0][0].Width || image->Height != layers[0][0].Height)) {
+            fmt::print("Error: Image {} is {}x{}, array layers must be {}x{} \n", path.string(), image->Width, image->Height, layers[0][0].Width, layers[0][0].Height);
+            return 1;
+        }
+        layers.push_back({std::move(*image)});
+    }
+
+    uint32_t width = layers[0][0].Width;
+    uint32_t height = layers[0][0].Height;
+    uint32_t mipLevels = isMipsEnabled ? static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1 : 1;
+    for (auto& mips : layers)
+        while (std::size(mips) < mipLevels)
+            mips.push_back(DownsampleImage(mips.back(), isSRGB));
+
+    auto AlignUp = [](uint64_t value, uint64_t alignment) -> uint64_t { return (value + alignment - 1) / alignment * alignment; };
+
+    HAL::TextureContainerHeader header = {
+        .Format = static_cast<uint32_t>(isSRGB ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm),
+        .Type = static_cast<uint32_t>(vk::ImageType::e2D),
+        .Width = width,
+        .Height = height,
+        .Depth = 1,
+        .ArraySize = static_cast<uint32_t>(std::size(layers)),
+        .MipLevels = mipLevels
+    };
+
+    //Smallest mips first, so the mip tail streamed first is read from the front of the file
+    std::vector<HAL::TextureContainerSubresource> subresources(uint64_t(mipLevels) * header.ArraySize);
+    header.DataOffset = AlignUp(sizeof(header) + std::size(subresources) * sizeof(HAL::TextureContainerSubresource), HAL::TextureContainerHeader::DataAlignment);
+
+    uint64_t offset = header.DataOffset;
+    for (uint32_t mipLevel = mipLevels; mipLevel-- > 0;) {
+        for (uint32_t arrayLayer = 0; arrayLayer < header.ArraySize; arrayLayer++) {
+            auto& subresource = subresources[mipLevel * header.ArraySize + arrayLayer];
+            subresource.Offset = AlignUp(offset, HAL::TextureContainerHeader::SubresourceAlignment);
+            subresource.Size = std::size(layers[arrayLayer][mipLevel].Texels);
+            offset = subresource.Offset + subresource.Size;
+        }
+    }
+    header.DataSize = offset - header.DataOffset;
+
+    std::vector<uint8_t> file(offset);
+    std::memcpy(std::data(file), &header, sizeof(header));
+    std::memcpy(std::data(file) + sizeof(header), std::data(subresources), std::size(subresources) * sizeof(HAL::TextureContainerSubresource));
+    for (uint32_t mipLevel = 0; mipLevel < mipLevels; mipLevel++) {
+        for (uint32_t arrayLayer = 0; arrayLayer < header.ArraySize; arrayLayer++) {
+            auto const& subresource = subresources[mipLevel * header.ArraySize + arrayLayer];
+            std::memcpy(std::data(file) + subresource.Offset, std::data(layers[arrayLayer][mipLevel].Texels), subresource.Size);
+        }
+    }
+
+    std::ofstream output(outputPath, std::ios::binary);
+    output.write(reinterpret_cast<char const*>(std::data(file)), std::size(file));
+    if (!output) {
+        fmt::print("Error: Failed to write {} \n", outputPath.string());
+        return 1;
+    }
+
+    fmt::print("{}: {}x{}, {} layers, {} mips, {} bytes \n", outputPath.string(), width, height, header.ArraySize, mipLevels, std::size(file));
+    return 0;
+}